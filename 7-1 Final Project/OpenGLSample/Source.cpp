@@ -1,606 +1,951 @@
-﻿#include <glad/glad.h>
-#include <GLFW/glfw3.h>
-
-#define STB_IMAGE_IMPLEMENTATION
-#include "stb_image.h"
-
-#include <glm/glm.hpp>
-#include <glm/gtc/matrix_transform.hpp>
-#include <glm/gtc/type_ptr.hpp>
-
-#include "shader.h"
-
-#include <iostream>
-
-#include "cylinder.h"
-
-#include "Sphere.h"
-#include "HalfSphere.h"
-
-void framebuffer_size_callback(GLFWwindow* window, int width, int height);
-void mouse_callback(GLFWwindow* window, double xpos, double ypos);
-void scroll_callback(GLFWwindow* window, double xoffset, double yoffset);
-void processInput(GLFWwindow* window);
-
-// settings
-const unsigned int SCR_WIDTH = 800;
-const unsigned int SCR_HEIGHT = 600;
-
-// camera
-glm::vec3 cameraPos = glm::vec3(-1.0f, 0.0f, 5.0f);
-glm::vec3 cameraFront = glm::vec3(0.0f, 0.0f, -1.0f);
-glm::vec3 cameraUp = glm::vec3(0.0f, 1.0f, 0.0f);
-
-bool firstMouse = true;
-float yaw = -90.0f;	// yaw is initialized to -90.0 degrees since a yaw of 0.0 results in a direction vector pointing to the right so we initially rotate a bit to the left.
-float pitch = 0.0f;
-float lastX = 800.0f / 2.0;
-float lastY = 600.0 / 2.0;
-float fov = 45.0f;
-
-// timing
-float deltaTime = 0.0f;	// time between current frame and last frame
-float lastFrame = 0.0f;
-
-int main()
-{
-	// glfw: initialize and configure
-	// ------------------------------
-	glfwInit();
-	glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
-	glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
-	glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
-
-#ifdef __APPLE__
-	glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
-#endif
-
-	// glfw window creation
-	// --------------------
-	GLFWwindow* window = glfwCreateWindow(SCR_WIDTH, SCR_HEIGHT, "Sorosh Khalili - 7-1 Final Project", NULL, NULL);
-	if (window == NULL)
-	{
-		std::cout << "Failed to create GLFW window" << std::endl;
-		glfwTerminate();
-		return -1;
-	}
-	glfwMakeContextCurrent(window);
-	glfwSetFramebufferSizeCallback(window, framebuffer_size_callback);
-	glfwSetCursorPosCallback(window, mouse_callback);
-	glfwSetScrollCallback(window, scroll_callback);
-
-	// tell GLFW to capture our mouse
-	glfwSetInputMode(window, GLFW_CURSOR, GLFW_CURSOR_DISABLED);
-
-	// glad: load all OpenGL function pointers
-	// ---------------------------------------
-	if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress))
-	{
-		std::cout << "Failed to initialize GLAD" << std::endl;
-		return -1;
-	}
-
-	// configure global opengl state
-	// -----------------------------
-	glEnable(GL_DEPTH_TEST);
-
-	// build and compile our shader zprogram
-	// ------------------------------------
-	Shader ourShader("shaderfiles/7.3.camera.vs", "shaderfiles/7.3.camera.fs");
-
-	// set up vertex data (and buffer(s)) and configure vertex attributes
-	// ------------------------------------------------------------------
-	float planeVertices[] = {
-		-5.0f, -1.0f, -5.0f,  0.0f, 0.0f,
-		 5.0f, -1.0f, -5.0f,  1.0f, 0.0f,
-		 5.0f, -1.0f,  5.0f,  1.0f, 1.0f,
-		 5.0f, -1.0f,  5.0f,  1.0f, 1.0f,
-		-5.0f, -1.0f,  5.0f,  0.0f, 1.0f,
-		-5.0f, -1.0f, -5.0f,  0.0f, 0.0f,
-	};
-	
-	
-	
-	float butterVertices[] = {
-		
-		-0.2f, -0.6f, -0.4f, 0.0f, 0.0f,
-		 0.2f, -0.6f, -0.4f, 1.0f, 0.0f,
-		 0.2f,  0.6f, -0.4f, 1.0f, 1.0f,
-		 0.2f,  0.6f, -0.4f, 1.0f, 1.0f,
-		-0.2f,  0.6f, -0.4f, 0.0f, 1.0f,
-		-0.2f, -0.6f, -0.4f, 0.0f, 0.0f,
-
-		-0.2f, -0.6f,  0.4f, 0.0f, 0.0f,
-		 0.2f, -0.6f,  0.4f, 1.0f, 0.0f,
-		 0.2f,  0.6f,  0.4f, 1.0f, 1.0f,
-		 0.2f,  0.6f,  0.4f, 1.0f, 1.0f,
-		-0.2f,  0.6f,  0.4f, 0.0f, 1.0f,
-		-0.2f, -0.6f,  0.4f, 0.0f, 0.0f,
-
-		-0.2f,  0.6f,  0.4f, 1.0f, 0.0f,
-		-0.2f,  0.6f, -0.4f, 1.0f, 1.0f,
-		-0.2f, -0.6f, -0.4f, 0.0f, 1.0f,
-		-0.2f, -0.6f, -0.4f, 0.0f, 1.0f,
-		-0.2f, -0.6f,  0.4f, 0.0f, 0.0f,
-		-0.2f,  0.6f,  0.4f, 1.0f, 0.0f,
-
-		 0.2f,  0.6f,  0.4f, 1.0f, 0.0f,
-		 0.2f,  0.6f, -0.4f, 1.0f, 1.0f,
-		 0.2f, -0.6f, -0.4f, 0.0f, 1.0f,
-		 0.2f, -0.6f, -0.4f, 0.0f, 1.0f,
-		 0.2f, -0.6f,  0.4f, 0.0f, 0.0f,
-		 0.2f,  0.6f,  0.4f, 1.0f, 0.0f,
-
-		-0.2f, -0.6f, -0.4f, 0.0f, 1.0f,
-		 0.2f, -0.6f, -0.4f, 1.0f, 1.0f,
-		 0.2f, -0.6f,  0.4f, 1.0f, 0.0f,
-		 0.2f, -0.6f,  0.4f, 1.0f, 0.0f,
-		-0.2f, -0.6f,  0.4f, 0.0f, 0.0f,
-		-0.2f, -0.6f, -0.4f, 0.0f, 1.0f,
-
-		-0.2f,  0.6f, -0.4f, 0.0f, 1.0f,
-		 0.2f,  0.6f, -0.4f, 1.0f, 1.0f,
-		 0.2f,  0.6f,  0.4f, 1.0f, 0.0f,
-		 0.2f,  0.6f,  0.4f, 1.0f, 0.0f,
-		-0.2f,  0.6f,  0.4f, 0.0f, 0.0f,
-		-0.2f,  0.6f, -0.4f, 0.0f, 1.0f  
-	};
-
-	unsigned int ButterVBO, ButterVAO;
-	unsigned int VBO2, VAO2;
-	unsigned int PlaneVBO, PlaneVAO;
-
-	glGenVertexArrays(1, &ButterVAO);
-	glGenBuffers(1, &ButterVBO);
-	glBindVertexArray(ButterVAO);
-	glBindBuffer(GL_ARRAY_BUFFER, ButterVBO);
-	glBufferData(GL_ARRAY_BUFFER, sizeof(butterVertices), butterVertices, GL_STATIC_DRAW);
-
-	
-	// position attribute
-	glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 5 * sizeof(float), (void*)0);
-	glEnableVertexAttribArray(0);
-	// texture coord attribute
-	glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 5 * sizeof(float), (void*)(3 * sizeof(float)));
-	glEnableVertexAttribArray(1);
-	
-	
-	glGenVertexArrays(1, &PlaneVAO);
-	glGenBuffers(1, &PlaneVBO);
-	glBindVertexArray(PlaneVAO);
-	glBindBuffer(GL_ARRAY_BUFFER, PlaneVBO);
-	glBufferData(GL_ARRAY_BUFFER, sizeof(planeVertices), planeVertices, GL_STATIC_DRAW);
-
-
-	// position attribute
-	glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 5 * sizeof(float), (void*)0);
-	glEnableVertexAttribArray(0);
-	// texture coord attribute
-	glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 5 * sizeof(float), (void*)(3 * sizeof(float)));
-	glEnableVertexAttribArray(1);
-
-
-	glGenVertexArrays(1, &VAO2);
-	glGenBuffers(1, &VBO2);
-	glBindVertexArray(VAO2);
-	glBindBuffer(GL_ARRAY_BUFFER, VBO2);
-
-	// load and create a texture 
-	// -------------------------
-	unsigned int texture1, texture2, texture3, texture4, texture5, texture6;
-	// texture 1
-	// ---------
-	glGenTextures(1, &texture1);
-	glBindTexture(GL_TEXTURE_2D, texture1);
-	// set the texture wrapping parameters
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-	// set texture filtering parameters
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-	// load image, create texture and generate mipmaps
-	int width, height, nrChannels;
-	stbi_set_flip_vertically_on_load(true); // tell stb_image.h to flip loaded texture's on the y-axis.
-	unsigned char* data = stbi_load("images/table.jpg", &width, &height, &nrChannels, 0);
-	if (data)
-	{
-		glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, width, height, 0, GL_RGB, GL_UNSIGNED_BYTE, data);
-		glGenerateMipmap(GL_TEXTURE_2D);
-	}
-	else
-	{
-		std::cout << "Failed to load texture" << std::endl;
-	}
-	stbi_image_free(data);
-	
-	// texture 2
-	// ---------
-	glGenTextures(1, &texture2);
-	glBindTexture(GL_TEXTURE_2D, texture2);
-	// set the texture wrapping parameters
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-	// set texture filtering parameters
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-	// load image, create texture and generate mipmaps
-	width, height, nrChannels;
-	stbi_set_flip_vertically_on_load(true); // tell stb_image.h to flip loaded texture's on the y-axis.
-	unsigned char* data1 = stbi_load("images/egg.jpg", &width, &height, &nrChannels, 0);
-	if (data1)
-	{
-		glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, width, height, 0, GL_RGB, GL_UNSIGNED_BYTE, data1);
-		glGenerateMipmap(GL_TEXTURE_2D);
-	}
-	else
-	{
-		std::cout << "Failed to load texture" << std::endl;
-	}
-	stbi_image_free(data1);
-
-	// texture 3
-// ---------
-	glGenTextures(1, &texture3);
-	glBindTexture(GL_TEXTURE_2D, texture3);
-	// set the texture wrapping parameters
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-	// set texture filtering parameters
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-	// load image, create texture and generate mipmaps
-	width, height, nrChannels;
-	stbi_set_flip_vertically_on_load(true); // tell stb_image.h to flip loaded texture's on the y-axis.
-	unsigned char* data2 = stbi_load("images/spoon.jpg", &width, &height, &nrChannels, 0);
-	if (data2)
-	{
-		glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, width, height, 0, GL_RGB, GL_UNSIGNED_BYTE, data2);
-		glGenerateMipmap(GL_TEXTURE_2D);
-	}
-	else
-	{
-		std::cout << "Failed to load texture" << std::endl;
-	}
-	stbi_image_free(data2);
-
-	// texture 4
-// ---------
-	glGenTextures(1, &texture4);
-	glBindTexture(GL_TEXTURE_2D, texture4);
-	// set the texture wrapping parameters
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-	// set texture filtering parameters
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-	// load image, create texture and generate mipmaps
-	width, height, nrChannels;
-	stbi_set_flip_vertically_on_load(true); // tell stb_image.h to flip loaded texture's on the y-axis.
-	unsigned char* data3 = stbi_load("images/flour.jpg", &width, &height, &nrChannels, 0);
-	if (data3)
-	{
-		glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, width, height, 0, GL_RGB, GL_UNSIGNED_BYTE, data3);
-		glGenerateMipmap(GL_TEXTURE_2D);
-	}
-	else
-	{
-		std::cout << "Failed to load texture" << std::endl;
-	}
-	stbi_image_free(data3);
-
-	// texture 5
-// ---------
-	glGenTextures(1, &texture5);
-	glBindTexture(GL_TEXTURE_2D, texture5);
-	// set the texture wrapping parameters
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-	// set texture filtering parameters
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-	// load image, create texture and generate mipmaps
-	width, height, nrChannels;
-	stbi_set_flip_vertically_on_load(true); // tell stb_image.h to flip loaded texture's on the y-axis.
-	unsigned char* data4 = stbi_load("images/bowlpattern.jpg", &width, &height, &nrChannels, 0);
-	if (data4)
-	{
-		glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, width, height, 0, GL_RGB, GL_UNSIGNED_BYTE, data4);
-		glGenerateMipmap(GL_TEXTURE_2D);
-	}
-	else
-	{
-		std::cout << "Failed to load texture" << std::endl;
-	}
-	stbi_image_free(data4);
-
-	// texture 6
-// ---------
-	glGenTextures(1, &texture6);
-	glBindTexture(GL_TEXTURE_2D, texture6);
-	// set the texture wrapping parameters
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-	// set texture filtering parameters
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-	// load image, create texture and generate mipmaps
-	width, height, nrChannels;
-	stbi_set_flip_vertically_on_load(true); // tell stb_image.h to flip loaded texture's on the y-axis.
-	unsigned char* data5 = stbi_load("images/butter.jpg", &width, &height, &nrChannels, 0);
-	if (data5)
-	{
-		glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, width, height, 0, GL_RGB, GL_UNSIGNED_BYTE, data5);
-		glGenerateMipmap(GL_TEXTURE_2D);
-	}
-	else
-	{
-		std::cout << "Failed to load texture" << std::endl;
-	}
-	stbi_image_free(data5);
-
-	// tell opengl for each sampler to which texture unit it belongs to (only has to be done once)
-	// -------------------------------------------------------------------------------------------
-	ourShader.use();
-	ourShader.setInt("texture1", 0);
-	ourShader.setInt("texture2", 1);
-	ourShader.setInt("texture3", 2);
-	ourShader.setInt("texture4", 2);
-	ourShader.setInt("texture5", 2);
-
-	glm::mat4 model;
-	float angle;
-
-	Sphere egg(0.5, 500, 500);
-	//float sphere_angle = 0;
-
-	HalfSphere HS(0.75, 500, 500);
-	HalfSphere bowl(1.0, 500, 500);
-	HalfSphere flourIn(0.99, 500, 500);
-
-
-	// render loop
-	// -----------
-	while (!glfwWindowShouldClose(window))
-	{
-		// per-frame time logic
-		// --------------------
-		float currentFrame = glfwGetTime();
-		deltaTime = currentFrame - lastFrame;
-		lastFrame = currentFrame;
-
-		// input
-		// -----
-		processInput(window);
-
-		// render
-		// ------
-		glClearColor(0.2f, 0.3f, 0.3f, 1.0f);
-		//glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
-		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
-
-		// bind textures on corresponding texture units
-		glActiveTexture(GL_TEXTURE0);
-		glBindTexture(GL_TEXTURE_2D, texture1);
-		//glActiveTexture(GL_TEXTURE1);
-		//glBindTexture(GL_TEXTURE_2D, texture2);
-
-		// activate shader
-		ourShader.use();
-
-		// pass projection matrix to shader (note that in this case it could change every frame)
-		glm::mat4 projection = glm::perspective(glm::radians(fov), (float)SCR_WIDTH / (float)SCR_HEIGHT, 0.1f, 100.0f);
-		ourShader.setMat4("projection", projection);
-
-		// camera/view transformation
-		glm::mat4 view = glm::lookAt(cameraPos, cameraPos + cameraFront, cameraUp);
-		ourShader.setMat4("view", view);
-
-		// render plane
-		glBindVertexArray(PlaneVAO);
-		model = glm::mat4(1.0f);  // make sure to initialize matrix to identity matrix first
-		model = glm::translate(model, glm::vec3(0.0f, 0.0f, 0.0f));
-		ourShader.setMat4("model", model);
-
-		glDrawArrays(GL_TRIANGLES, 0, 6);
-
-		
-		// render butter
-		glActiveTexture(GL_TEXTURE0);
-		glBindTexture(GL_TEXTURE_2D, texture6); 
-		glBindVertexArray(ButterVAO);
-		// calculate the model matrix for each object and pass it to shader before drawing
-		model = glm::mat4(1.0f); // make sure to initialize matrix to identity matrix first		
-		model = glm::translate(model, glm::vec3(-1.0f, -0.77f, -1.0f));
-		model = glm::rotate(model, glm::radians(-90.0f), glm::vec3(0.0f, 0.0f, 1.0f));
-		model = glm::rotate(model, glm::radians(-90.0f), glm::vec3(1.0f, 0.0f, 0.0f));
-		ourShader.setMat4("model", model);
-
-		glDrawArrays(GL_TRIANGLES, 0, 36);
-
-
-		glActiveTexture(GL_TEXTURE0);
-		glBindTexture(GL_TEXTURE_2D, texture3);
-		glBindVertexArray(VAO2);
-		model = glm::mat4(1.0f); // make sure to initialize matrix to identity matrix first		
-		//model = glm::translate(model, glm::vec3(0.0f, -0.65f, 0.0f));
-		model = glm::translate(model, glm::vec3(0.0f, -0.65f, -0.1f));
-		model = glm::rotate(model, glm::radians(-90.0f), glm::vec3(1.0f, 0.0f, 0.0f));
-		ourShader.setMat4("model", model);
-		
-		static_meshes_3D::Cylinder C(0.3, 100, 5, true, true, true);
-		C.render();
-		
-		
-		glActiveTexture(GL_TEXTURE0);
-		glBindTexture(GL_TEXTURE_2D, texture3);
-		glBindVertexArray(VAO2);
-		model = glm::mat4(1.0f); // make sure to initialize matrix to identity matrix first		
-		//model = glm::translate(model, glm::vec3(0.0f, 0.0f, 0.0f));
-		model = glm::translate(model, glm::vec3(0.0f, -0.65f, 0.0f));
-		model = glm::rotate(model, glm::radians(90.0f), glm::vec3(1.0f, 0.0f, 0.0f));
-		model = glm::translate(model, glm::vec3(0.0f, -3.2f, -0.4f));
-		ourShader.setMat4("model", model);
-		
-		HS.Draw();
-
-		glActiveTexture(GL_TEXTURE0);
-		glBindTexture(GL_TEXTURE_2D, texture5);
-		glBindVertexArray(VAO2);
-		model = glm::mat4(1.0f); // make sure to initialize matrix to identity matrix first		
-		//model = glm::translate(model, glm::vec3(0.0f, 0.0f, 0.0f));
-		model = glm::translate(model, glm::vec3(0.0f, -0.4f, 0.0f));
-		model = glm::rotate(model, glm::radians(90.0f), glm::vec3(1.0f, 0.0f, 0.0f));
-		model = glm::translate(model, glm::vec3(-2.0f, -3.5f, -0.4f));
-		ourShader.setMat4("model", model);
-
-		bowl.Draw();
-		
-		glActiveTexture(GL_TEXTURE0);
-		glBindTexture(GL_TEXTURE_2D, texture4);
-		glBindVertexArray(VAO2);
-		model = glm::mat4(1.0f); // make sure to initialize matrix to identity matrix first		
-		//model = glm::translate(model, glm::vec3(0.0f, 0.0f, 0.0f));
-		model = glm::translate(model, glm::vec3(0.0f, -0.4f, 0.0f));
-		model = glm::rotate(model, glm::radians(90.0f), glm::vec3(1.0f, 0.0f, 0.0f));
-		model = glm::translate(model, glm::vec3(-2.0f, -3.5f, -0.4f));
-		ourShader.setMat4("model", model);
-
-		flourIn.Draw();
-
-		glActiveTexture(GL_TEXTURE0);
-		glBindTexture(GL_TEXTURE_2D, texture2);
-		glBindVertexArray(VAO2);
-		model = glm::mat4(1.0f); // make sure to initialize matrix to identity matrix first		
-		model = glm::translate(model, glm::vec3(-3.0f, -0.47f, -2.0f));
-		//model = glm::rotate(model, glm::radians(sphere_angle), glm::vec3(1.0f, 0.3f, 0.5f));
-		//sphere_angle++;
-		ourShader.setMat4("model", model);
-
-		egg.Draw();
-		
-		glActiveTexture(GL_TEXTURE0);
-		glBindTexture(GL_TEXTURE_2D, texture2);
-		glBindVertexArray(VAO2);
-		model = glm::mat4(1.0f); // make sure to initialize matrix to identity matrix first		
-		model = glm::translate(model, glm::vec3(-2.0f, -0.47f, -1.5f));
-		//model = glm::rotate(model, glm::radians(sphere_angle), glm::vec3(1.0f, 0.3f, 0.5f));
-		//sphere_angle++;
-		ourShader.setMat4("model", model);
-
-		egg.Draw();
-
-		glActiveTexture(GL_TEXTURE0);
-		glBindTexture(GL_TEXTURE_2D, texture2);
-		glBindVertexArray(VAO2);
-		model = glm::mat4(1.0f); // make sure to initialize matrix to identity matrix first		
-		model = glm::translate(model, glm::vec3(-3.5f, -0.47f, -1.0f));
-		//model = glm::rotate(model, glm::radians(sphere_angle), glm::vec3(1.0f, 0.3f, 0.5f));
-		//sphere_angle++;
-		ourShader.setMat4("model", model);
-
-		egg.Draw();
-
-
-		//static_meshes_3D::Cylinder C2(1, 10, 1.5, true, true, true);
-		//C2.render();
-
-		// glfw: swap buffers and poll IO events (keys pressed/released, mouse moved etc.)
-		// -------------------------------------------------------------------------------
-		glfwSwapBuffers(window);
-		glfwPollEvents();
-	}
-
-	// optional: de-allocate all resources once they've outlived their purpose:
-	// ------------------------------------------------------------------------
-	glDeleteVertexArrays(1, &ButterVAO);
-	glDeleteBuffers(1, &ButterVBO);
-
-	glDeleteVertexArrays(1, &VAO2);
-	glDeleteBuffers(1, &VBO2);
-
-	glDeleteVertexArrays(1, &PlaneVAO);
-	glDeleteBuffers(1, &PlaneVBO);
-
-	// glfw: terminate, clearing all previously allocated GLFW resources.
-	// ------------------------------------------------------------------
-	glfwTerminate();
-	return 0;
-}
-
-// process all input: query GLFW whether relevant keys are pressed/released this frame and react accordingly
-// ---------------------------------------------------------------------------------------------------------
-void processInput(GLFWwindow* window)
-{
-	if (glfwGetKey(window, GLFW_KEY_ESCAPE) == GLFW_PRESS)
-		glfwSetWindowShouldClose(window, true);
-
-	float cameraSpeed = 2.5 * deltaTime;
-	if (glfwGetKey(window, GLFW_KEY_W) == GLFW_PRESS)
-		cameraPos += cameraSpeed * cameraFront;
-	if (glfwGetKey(window, GLFW_KEY_S) == GLFW_PRESS)
-		cameraPos -= cameraSpeed * cameraFront;
-	if (glfwGetKey(window, GLFW_KEY_A) == GLFW_PRESS)
-		cameraPos -= glm::normalize(glm::cross(cameraFront, cameraUp)) * cameraSpeed;
-	if (glfwGetKey(window, GLFW_KEY_D) == GLFW_PRESS)
-		cameraPos += glm::normalize(glm::cross(cameraFront, cameraUp)) * cameraSpeed;
-	if (glfwGetKey(window, GLFW_KEY_Q) == GLFW_PRESS)
-		cameraPos += cameraUp * cameraSpeed;
-	if (glfwGetKey(window, GLFW_KEY_E) == GLFW_PRESS)
-		cameraPos -= cameraUp * cameraSpeed;
-}
-
-// glfw: whenever the window size changed (by OS or user resize) this callback function executes
-// ---------------------------------------------------------------------------------------------
-void framebuffer_size_callback(GLFWwindow* window, int width, int height)
-{
-	// make sure the viewport matches the new window dimensions; note that width and 
-	// height will be significantly larger than specified on retina displays.
-	glViewport(0, 0, width, height);
-}
-
-// glfw: whenever the mouse moves, this callback is called
-// -------------------------------------------------------
-void mouse_callback(GLFWwindow* window, double xpos, double ypos)
-{
-	if (firstMouse)
-	{
-		lastX = xpos;
-		lastY = ypos;
-		firstMouse = false;
-	}
-
-	float xoffset = xpos - lastX;
-	float yoffset = lastY - ypos; // reversed since y-coordinates go from bottom to top
-	lastX = xpos;
-	lastY = ypos;
-
-	float sensitivity = 0.1f; // change this value to your liking
-	xoffset *= sensitivity;
-	yoffset *= sensitivity;
-
-	yaw += xoffset;
-	pitch += yoffset;
-
-	// make sure that when pitch is out of bounds, screen doesn't get flipped
-	if (pitch > 89.0f)
-		pitch = 89.0f;
-	if (pitch < -89.0f)
-		pitch = -89.0f;
-
-	glm::vec3 front;
-	front.x = cos(glm::radians(yaw)) * cos(glm::radians(pitch));
-	front.y = sin(glm::radians(pitch));
-	front.z = sin(glm::radians(yaw)) * cos(glm::radians(pitch));
-	cameraFront = glm::normalize(front);
-}
-
-// glfw: whenever the mouse scroll wheel scrolls, this callback is called
-// ----------------------------------------------------------------------
-void scroll_callback(GLFWwindow* window, double xoffset, double yoffset)
-{
-	fov -= (float)yoffset;
-	if (fov < 1.0f)
-		fov = 1.0f;
-	if (fov > 45.0f)
-		fov = 45.0f;
+﻿#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/type_ptr.hpp>
+
+#include "shader.h"
+#include "shaderPermutations.h"
+#include "glStateCache.h"
+#include "renderQueue.h"
+#include "instanceBatch.h"
+#include "scene.h"
+#include "framePipeline.h"
+#include "frameTiming.h"
+#include "headlessContext.h"
+#include "offscreenTarget.h"
+#include "cameraPath.h"
+#include "benchmark.h"
+#include "gpuProfiler.h"
+#include "cpuTracer.h"
+#include "performanceHud.h"
+#include "regressionSuite.h"
+#include "dynamicResolution.h"
+#include "textureManager.h"
+#include "blockCompressor.h"
+#include "textureCooker.h"
+
+#include <iostream>
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cmath>
+#include <thread>
+#include <mutex>
+#include <chrono>
+
+#include <sys/stat.h>
+
+void framebuffer_size_callback(GLFWwindow* window, int width, int height);
+void mouse_callback(GLFWwindow* window, double xpos, double ypos);
+void scroll_callback(GLFWwindow* window, double xoffset, double yoffset);
+
+// input sampled on the main thread, where GLFW has to be polled, and consumed by the simulation thread
+struct InputState
+{
+	bool forward, backward, left, right, up, down;
+	bool pick;
+	glm::vec3 front;	// from the mouse
+	float yaw, pitch;	// the angles front was made from, for recording camera paths
+	float fov;			// from the scroll wheel
+};
+InputState processInput(GLFWwindow* window);
+void moveCamera(const InputState& input, double step, const BVH& obstacles);
+bool isUpToDate(const char* generatedPath, const char* sourcePath);
+
+// command line
+struct AppOptions
+{
+	double frameRate;			// --fps
+	bool headless;				// --headless <width>x<height>
+	int width, height;
+	int frames;					// --frames, 0 = as many as the camera path lasts (1 without a path)
+	const char* cameraPath;		// --camera-path, or the path of --benchmark
+	const char* outputDirectory;	// --output, headless frames are written there as PPM images
+	bool benchmark;				// --benchmark <camera path>
+	const char* benchmarkOutput;	// --benchmark-output, <prefix>.json and <prefix>.csv
+	const char* baselinePath;		// --baseline, JSON of an earlier run to compare with
+	double tolerance;			// --tolerance, allowed slowdown against the baseline as a fraction
+	const char* recordPath;		// --record-path, the flight in the window is saved there as a camera path
+	const char* tracePath;		// --trace, CPU zones of all threads are written there as a Chrome trace
+	const char* regressionSuite;	// --regression <suite>, golden image and performance checks
+	const char* goldenDirectory;	// --golden, where the golden images of the suite are
+	bool updateGolden;			// --update-golden, writes the images as the new golden images
+	const char* reportPath;		// --report, results of the suite as JSON
+	double minScale;			// --min-scale, smallest fraction of the window resolution rendered, 1 = always full
+};
+bool parseOptions(int argc, char** argv, AppOptions& options);
+int runScripted(Scene& scene, ShaderPermutationCache& shaders, const AppOptions& options, GLFWwindow* window);
+int runRegression(Scene& scene, ShaderPermutationCache& shaders, const AppOptions& options);
+void renderPose(Scene& scene, ShaderPermutationCache& shaders, RenderQueue& renderQueue, RenderPacket& packet,
+	const CameraKeyframe& pose, int frame, int width, int height);
+
+// settings
+const unsigned int SCR_WIDTH = 800;
+const unsigned int SCR_HEIGHT = 600;
+const char* WINDOW_TITLE = "Sorosh Khalili - 7-1 Final Project";
+const double SIMULATION_STEP = 1.0 / 120.0;	// seconds per camera update
+const double TARGET_FRAME_RATE = 60.0;		// frames per second, --fps overrides it, 0 runs unpaced
+const double HEADLESS_FRAME_RATE = 60.0;	// camera path time between two scripted frames is 1 / this
+const int BENCHMARK_WARMUP_FRAMES = 5;		// first frames compile shaders and fill caches, they are not measured
+const int GPU_QUERY_LATENCY = 4;			// timer results are read this many frames later, so reading never stalls
+const double RECORD_INTERVAL = 0.1;			// seconds between keyframes when recording a camera path
+const double MIN_RESOLUTION_SCALE = 0.5;	// the scene is rendered at no less than half the window's width and height
+
+// camera; cameraPos belongs to the simulation thread, cameraFront and fov to the main thread's callbacks
+glm::vec3 cameraPos = glm::vec3(-1.0f, 0.0f, 5.0f);
+glm::vec3 previousCameraPos = cameraPos;	// before the last fixed step, rendering blends from it
+glm::vec3 cameraFront = glm::vec3(0.0f, 0.0f, -1.0f);
+glm::vec3 cameraUp = glm::vec3(0.0f, 1.0f, 0.0f);
+
+bool firstMouse = true;
+float yaw = -90.0f;	// yaw is initialized to -90.0 degrees since a yaw of 0.0 results in a direction vector pointing to the right so we initially rotate a bit to the left.
+float pitch = 0.0f;
+float lastX = 800.0f / 2.0;
+float lastY = 600.0 / 2.0;
+float fov = 45.0f;
+
+int main(int argc, char** argv)
+{
+	// offline: compile a text scene into its binary form and exit, no window needed
+	// usage: OpenGLSample --cook-scene <in.scene> <out.sceneb>
+	if (argc == 4 && std::string(argv[1]) == "--cook-scene")
+	{
+		SceneData sceneData;
+		return sceneData.loadText(argv[2]) && sceneData.saveBinary(argv[3]) ? 0 : -1;
+	}
+
+	// offline: compress an image with its mip chain into a BC1 / BC3 DDS file for loadDDS()
+	// usage: OpenGLSample --compress-texture <image> <out.dds> [bc1|bc3|auto] [fast|normal|high]
+	if (argc >= 4 && argc <= 6 && std::string(argv[1]) == "--compress-texture")
+	{
+		std::string format = argc > 4 ? argv[4] : "auto";
+		std::string quality = argc > 5 ? argv[5] : "normal";
+		BlockFormat blockFormat = format == "bc1" ? BLOCK_FORMAT_BC1 : format == "bc3" ? BLOCK_FORMAT_BC3 : BLOCK_FORMAT_AUTO;
+		BlockQuality blockQuality = quality == "fast" ? BLOCK_QUALITY_FAST : quality == "high" ? BLOCK_QUALITY_HIGH : BLOCK_QUALITY_NORMAL;
+		return BlockCompressor::compressFile(argv[2], argv[3], blockFormat, blockQuality) ? 0 : -1;
+	}
+
+	// offline: write an image with its precomputed mip chain as KTX, which loads without glGenerateMipmap
+	// usage: OpenGLSample --cook-texture <image> <out.ktx> [uncompressed|bc1|bc3|auto] [fast|normal|high]
+	if (argc >= 4 && argc <= 6 && std::string(argv[1]) == "--cook-texture")
+	{
+		std::string format = argc > 4 ? argv[4] : "uncompressed";
+		std::string quality = argc > 5 ? argv[5] : "normal";
+		TextureCookFormat cookFormat = format == "bc1" ? TEXTURE_COOK_BC1 : format == "bc3" ? TEXTURE_COOK_BC3
+			: format == "auto" ? TEXTURE_COOK_BC_AUTO : TEXTURE_COOK_UNCOMPRESSED;
+		BlockQuality blockQuality = quality == "fast" ? BLOCK_QUALITY_FAST : quality == "high" ? BLOCK_QUALITY_HIGH : BLOCK_QUALITY_NORMAL;
+		return TextureCooker::cookFile(argv[2], argv[3], cookFormat, blockQuality) ? 0 : -1;
+	}
+
+	AppOptions options;
+	if (!parseOptions(argc, argv, options))
+		return -1;
+
+	// CPU trace of startup and every frame, for chrome://tracing or ui.perfetto.dev
+#if OPENGLSAMPLE_CPU_TRACE
+	TRACE_THREAD_NAME("main");
+	if (options.tracePath != NULL && !CpuTracer::get().start(options.tracePath))
+		return -1;
+#else
+	if (options.tracePath != NULL)
+		std::cout << "ERROR::OPTIONS::--trace needs a build with OPENGLSAMPLE_CPU_TRACE=1" << std::endl;
+#endif
+
+	// headless: a surfaceless context and an offscreen framebuffer, for servers without a display or GPU
+	// ----------------------------------------------------------------------------------------------------
+	HeadlessContext headlessContext;
+	GLFWwindow* window = NULL;
+	if (options.headless)
+	{
+		TRACE_ZONE("create context");
+		if (!headlessContext.create() || !gladLoadGLLoader((GLADloadproc)HeadlessContext::getProcAddress))
+		{
+			std::cout << "Failed to create a headless OpenGL context" << std::endl;
+			return -1;
+		}
+		std::cout << "Headless rendering on " << headlessContext.getRenderer() << std::endl;
+	}
+	else
+	{
+		// glfw: initialize and configure
+		// ------------------------------
+		TRACE_ZONE("create window");
+		glfwInit();
+		glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+		glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+		glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+
+#ifdef __APPLE__
+		glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
+#endif
+
+		// glfw window creation
+		// --------------------
+		window = glfwCreateWindow(SCR_WIDTH, SCR_HEIGHT, WINDOW_TITLE, NULL, NULL);
+		if (window == NULL)
+		{
+			std::cout << "Failed to create GLFW window" << std::endl;
+			glfwTerminate();
+			return -1;
+		}
+		glfwMakeContextCurrent(window);
+		glfwSetFramebufferSizeCallback(window, framebuffer_size_callback);
+		glfwSetCursorPosCallback(window, mouse_callback);
+		glfwSetScrollCallback(window, scroll_callback);
+
+		// tell GLFW to capture our mouse
+		glfwSetInputMode(window, GLFW_CURSOR, GLFW_CURSOR_DISABLED);
+
+		// glad: load all OpenGL function pointers
+		// ---------------------------------------
+		if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress))
+		{
+			std::cout << "Failed to initialize GLAD" << std::endl;
+			return -1;
+		}
+	}
+
+	// configure global opengl state
+	// -----------------------------
+	// all binds and enables go through the state cache so redundant ones never reach the driver
+	GLStateCache& glState = GLStateCache::get();
+	glState.setDepthTest(true);
+
+	// GPU time per scope (frame, clear, scene and one per object kind), compiled out with OPENGLSAMPLE_GPU_PROFILER=0
+	GPU_PROFILE_INIT();
+
+	// build and compile our shader zprogram
+	// ------------------------------------
+	// every object in the scene binds a single texture, so they all share the cheapest
+	// permutation; the detail-texture and texture array variants are only compiled if
+	// something asks for them
+	ShaderPermutationCache cameraShaders("shaderfiles/7.3.camera.vs", "shaderfiles/7.3.camera.fs", { "DETAIL_TEXTURE", "INSTANCED", "TEXTURE_ARRAY" });
+	Shader& ourShader = cameraShaders.get(0);
+
+	// load the scene description; the binary form cooked with --cook-scene loads with a single
+	// read and is used as long as it is newer than the text form, which is compiled otherwise
+	// -------------------------------------------------------------------------------
+	Scene scene;
+	bool sceneLoaded = false;
+	if (isUpToDate("scenes/kitchen.sceneb", "scenes/kitchen.scene"))
+		sceneLoaded = scene.load("scenes/kitchen.sceneb", TextureManager::get());
+	// a binary from an older format version is rejected too; it is only ever written by --cook-scene
+	if (!sceneLoaded)
+		scene.load("scenes/kitchen.scene", TextureManager::get());
+
+	// tell opengl for each sampler to which texture unit it belongs to (only has to be done once)
+	// -------------------------------------------------------------------------------------------
+	ourShader.use();
+	ourShader.setInt("texture1", 0);
+	Shader& instancedShader = cameraShaders.get(CAMERA_FEATURE_INSTANCED);
+	instancedShader.use();
+	instancedShader.setInt("texture1", 0);
+
+	// scripted camera: regression checks, headless rendering and benchmarks
+	if (options.regressionSuite != NULL || options.headless || options.cameraPath != NULL)
+	{
+		// their frames are compared and timed, so none of them may still be waiting for a texture
+		TextureManager::get().flush();
+		int result = options.regressionSuite != NULL ? runRegression(scene, cameraShaders, options)
+			: runScripted(scene, cameraShaders, options, window);
+		GPU_PROFILE_RELEASE();
+		scene.release();
+#if OPENGLSAMPLE_CPU_TRACE
+		CpuTracer::get().stop();
+#endif
+		if (window != NULL)
+			glfwTerminate();
+		return result;
+	}
+
+	// the main thread polls input and renders; a simulation thread moves the camera, culls and
+	// fills render packets. Frame N + 1 is simulated while frame N is submitted to GL.
+	// -------------------------------------------------------------------------------------
+	FramePipeline pipeline;
+	std::mutex inputMutex;
+	CameraPath recordedPath;	// written by the simulation thread, saved after it finished
+	InputState latestInput = processInput(window);
+
+	std::thread simulation([&]()
+	{
+		glm::mat4 projection;
+		float projectionFov = 0.0f;	// fov the cached projection was built with, 0 forces the first build
+		bool pickWasPressed = false;
+		FixedTimestep timestep(SIMULATION_STEP);
+		double nextKeyframe = 0.0;
+
+		TRACE_THREAD_NAME("simulation");
+		RenderPacket* packet;
+		while ((packet = pipeline.beginSimulation()) != nullptr)
+		{
+			TRACE_ZONE("simulate");
+			auto start = std::chrono::high_resolution_clock::now();
+
+			InputState input;
+			{
+				std::lock_guard<std::mutex> lock(inputMutex);
+				input = latestInput;
+			}
+
+			// fixed steps for the real time passed, so movement does not depend on the frame rate
+			// ------------------------------------------------------------------------------------
+			int steps = timestep.advance(glfwGetTime());
+			for (int i = 0; i < steps; i++)
+			{
+				previousCameraPos = cameraPos;
+				moveCamera(input, timestep.getStep(), scene.getBVH());
+			}
+			// the frame shows the camera between the last two steps
+			glm::vec3 renderCameraPos = glm::mix(previousCameraPos, cameraPos, (float)timestep.getAlpha());
+
+			if (options.recordPath != NULL && timestep.getTime() >= nextKeyframe)
+			{
+				CameraKeyframe keyframe = { timestep.getTime(), cameraPos, input.yaw, input.pitch, input.fov };
+				recordedPath.add(keyframe);
+				nextKeyframe = timestep.getTime() + RECORD_INTERVAL;
+			}
+
+			// left click picks the object under the crosshair; the cursor is captured, so that is the screen center
+			if (input.pick && !pickWasPressed)
+			{
+				Ray ray = { cameraPos, input.front };
+				uint32_t object;
+				float distance;
+				if (scene.getBVH().raycast(ray, 100.0f, object, distance))
+				{
+					const SceneObjectRecord& record = scene.data().objects()[object];
+					std::cout << "Picked object " << object << " (mesh " << record.mesh << ", material " << record.material
+						<< ") at distance " << distance << std::endl;
+				}
+			}
+			pickWasPressed = input.pick;
+
+			// projection only changes when the scroll wheel zooms
+			if (input.fov != projectionFov)
+			{
+				projection = glm::perspective(glm::radians(input.fov), (float)SCR_WIDTH / (float)SCR_HEIGHT, 0.1f, 100.0f);
+				projectionFov = input.fov;
+			}
+
+			// camera/view transformation
+			packet->view = glm::lookAt(renderCameraPos, renderCameraPos + input.front, cameraUp);
+			packet->projection = projection;
+			packet->cameraPosition = renderCameraPos;
+			packet->nearPlane = 0.1f;
+			packet->farPlane = 100.0f;
+			scene.cull(*packet);
+
+			packet->simulationMilliseconds = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+			pipeline.endSimulation();
+		}
+	});
+
+	RenderQueue renderQueue;
+	double lastStatsTime = 0.0;
+	FramePacer pacer(options.frameRate);
+
+	// the scene renders at a fraction of the window resolution that keeps its GPU time inside the frame
+	DynamicResolution resolution(1000.0 / (options.frameRate > 0.0 ? options.frameRate : TARGET_FRAME_RATE), options.minScale);
+
+	// frame statistics drawn over the scene, H toggles them
+	PerformanceHud hud;
+	hud.init();
+	bool hudKeyWasPressed = false;
+
+	// render loop
+	// -----------
+	while (!glfwWindowShouldClose(window))
+	{
+		// input
+		// -----
+		TRACE_ZONE("frame");
+		{
+			TRACE_ZONE("input");
+			glfwPollEvents();
+			InputState input = processInput(window);
+			std::lock_guard<std::mutex> lock(inputMutex);
+			latestInput = input;
+		}
+		bool hudKey = glfwGetKey(window, GLFW_KEY_H) == GLFW_PRESS;
+		if (hudKey && !hudKeyWasPressed)
+			hud.setVisible(!hud.isVisible());
+		hudKeyWasPressed = hudKey;
+
+		// the packet simulated during the previous frame
+		const RenderPacket* packet;
+		{
+			TRACE_ZONE("wait for simulation");
+			packet = pipeline.beginRender();
+		}
+		if (packet == nullptr)
+			break;
+		auto renderStart = std::chrono::high_resolution_clock::now();
+
+		// close the previous frame's state cache counters
+		glState.beginFrame();
+		GPU_PROFILE_FRAME_BEGIN();
+		GPU_PROFILE_BEGIN("frame");
+
+		// textures loaded in the background get a budget of pixels each frame
+		{
+			GPU_PROFILE_SCOPE("stream textures");
+			TextureManager::get().update();
+		}
+
+		// render
+		// ------
+		int framebufferWidth, framebufferHeight;
+		glfwGetFramebufferSize(window, &framebufferWidth, &framebufferHeight);
+		resolution.begin(framebufferWidth, framebufferHeight);
+		GPU_PROFILE_BEGIN("clear");
+		glClearColor(0.2f, 0.3f, 0.3f, 1.0f);
+		//glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
+		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+		GPU_PROFILE_END();
+
+		// queue every visible object with a sort key, the sorted keys decide the draw order
+		{
+			TRACE_ZONE("submit");
+			renderQueue.clear();
+			scene.submit(renderQueue, cameraShaders, *packet);
+		}
+		{
+			TRACE_ZONE("sort");
+			renderQueue.sort();
+		}
+		{
+			TRACE_ZONE("execute");
+			GPU_PROFILE_BEGIN("scene");
+			hud.beginGeometry();
+			renderQueue.execute(packet->view, packet->projection);
+			hud.endGeometry();
+			GPU_PROFILE_END();
+		}
+
+		// scale up to the window, the overlay is drawn at the window's resolution on top
+		{
+			GPU_PROFILE_SCOPE("upscale");
+			resolution.end();
+		}
+
+		// overlay, all of its text in one draw call
+		{
+			TRACE_ZONE("hud");
+			PerformanceHud::FrameStats hudStats;
+			hudStats.frameMilliseconds = pacer.getFrameMilliseconds();
+			hudStats.gpuMilliseconds = -1.0;
+#if OPENGLSAMPLE_GPU_PROFILER
+			const GpuProfiler::ScopeStats* gpuFrame = GpuProfiler::get().find("frame");
+			if (gpuFrame != NULL)
+				hudStats.gpuMilliseconds = gpuFrame->average;
+#endif
+			hudStats.drawCalls = renderQueue.getStats().drawCalls;
+			hudStats.instances = renderQueue.getStats().instances;
+			hudStats.glCalls = glState.getFrameStats().issued;
+			hudStats.glCallsElided = glState.getFrameStats().elided;
+			hudStats.renderWidth = resolution.getWidth();
+			hudStats.renderHeight = resolution.getHeight();
+			hud.draw(hudStats, framebufferWidth, framebufferHeight);
+		}
+		GPU_PROFILE_END();
+		GPU_PROFILE_FRAME_END();
+
+		// culling reports in the title bar, refreshed twice a second so it stays readable
+		double now = glfwGetTime();
+		if (now - lastStatsTime >= 0.5)
+		{
+			char gpuText[64] = "";
+#if OPENGLSAMPLE_GPU_PROFILER
+			const GpuProfiler::ScopeStats* gpuFrame = GpuProfiler::get().find("frame");
+			if (gpuFrame != NULL)
+				snprintf(gpuText, sizeof(gpuText), " | gpu %.2f ms", gpuFrame->average);
+#endif
+			char title[320];
+			snprintf(title, sizeof(title), "%s | frame %.2f ms%s | culled %u/%u objects in %.3f ms | occluded %u/%u in %.3f ms | simulation %.3f ms",
+				WINDOW_TITLE, pacer.getFrameMilliseconds(), gpuText, packet->cullStats.culled, packet->cullStats.tested, packet->cullStats.milliseconds,
+				packet->occlusionStats.occluded, packet->occlusionStats.tested, packet->occlusionStats.milliseconds,
+				packet->simulationMilliseconds);
+			glfwSetWindowTitle(window, title);
+			lastStatsTime = now;
+		}
+
+		// everything GL needs from the packet has been submitted, the simulation may reuse it;
+		// what is still read below is copied out first
+		double simulationMilliseconds = packet->simulationMilliseconds;
+		pipeline.endRender();
+
+		//static_meshes_3D::Cylinder C2(1, 10, 1.5, true, true, true);
+		//C2.render();
+
+		// the CPU side of the frame is the slower of simulating and rendering, they run in parallel
+		double renderMilliseconds = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - renderStart).count();
+		resolution.update(std::max(renderMilliseconds, simulationMilliseconds));
+
+		// present on the frame rate grid; steady frame times matter more than the highest rate
+		{
+			TRACE_ZONE("pace");
+			pacer.wait();
+		}
+
+		// glfw: swap buffers (IO events are polled at the top of the loop)
+		// -----------------------------------------------------------------
+		TRACE_ZONE("swap");
+		glfwSwapBuffers(window);
+	}
+	pipeline.stop();
+	simulation.join();
+	if (options.recordPath != NULL && recordedPath.save(options.recordPath))
+		std::cout << "Recorded " << recordedPath.keyframes().size() << " keyframes to " << options.recordPath << std::endl;
+
+	// optional: de-allocate all resources once they've outlived their purpose:
+	// ------------------------------------------------------------------------
+	hud.release();
+	resolution.release();
+	GPU_PROFILE_RELEASE();
+	scene.release();
+#if OPENGLSAMPLE_CPU_TRACE
+	CpuTracer::get().stop();
+#endif
+
+	// glfw: terminate, clearing all previously allocated GLFW resources.
+	// ------------------------------------------------------------------
+	glfwTerminate();
+	return 0;
+}
+
+// reads the command line; --cook-scene, --compress-texture and --cook-texture are handled before, they need no GL at all
+// ---------------------------------------------------------------------------------------------------
+bool parseOptions(int argc, char** argv, AppOptions& options)
+{
+	options.frameRate = TARGET_FRAME_RATE;
+	options.headless = false;
+	options.width = SCR_WIDTH;
+	options.height = SCR_HEIGHT;
+	options.frames = 0;
+	options.cameraPath = NULL;
+	options.outputDirectory = NULL;
+	options.benchmark = false;
+	options.benchmarkOutput = "benchmark";
+	options.baselinePath = NULL;
+	options.tolerance = 0.1;
+	options.recordPath = NULL;
+	options.tracePath = NULL;
+	options.regressionSuite = NULL;
+	options.goldenDirectory = "regression/golden";
+	options.updateGolden = false;
+	options.reportPath = NULL;
+	options.minScale = MIN_RESOLUTION_SCALE;
+
+	for (int i = 1; i < argc; i++)
+	{
+		std::string option = argv[i];
+		bool hasValue = i + 1 < argc;
+		if (option == "--fps" && hasValue)
+			options.frameRate = atof(argv[++i]);
+		else if (option == "--headless" && hasValue)
+		{
+			options.headless = true;
+			if (sscanf(argv[++i], "%dx%d", &options.width, &options.height) != 2 || options.width <= 0 || options.height <= 0)
+			{
+				std::cout << "ERROR::OPTIONS::expected --headless <width>x<height>, e.g. 1920x1080" << std::endl;
+				return false;
+			}
+		}
+		else if (option == "--frames" && hasValue)
+			options.frames = atoi(argv[++i]);
+		else if (option == "--camera-path" && hasValue)
+			options.cameraPath = argv[++i];
+		else if (option == "--output" && hasValue)
+			options.outputDirectory = argv[++i];
+		else if (option == "--benchmark" && hasValue)
+		{
+			options.benchmark = true;
+			options.cameraPath = argv[++i];
+		}
+		else if (option == "--benchmark-output" && hasValue)
+			options.benchmarkOutput = argv[++i];
+		else if (option == "--baseline" && hasValue)
+			options.baselinePath = argv[++i];
+		else if (option == "--tolerance" && hasValue)
+			options.tolerance = atof(argv[++i]);
+		else if (option == "--record-path" && hasValue)
+			options.recordPath = argv[++i];
+		else if (option == "--trace" && hasValue)
+			options.tracePath = argv[++i];
+		else if (option == "--regression" && hasValue)
+			options.regressionSuite = argv[++i];
+		else if (option == "--golden" && hasValue)
+			options.goldenDirectory = argv[++i];
+		else if (option == "--update-golden")
+			options.updateGolden = true;
+		else if (option == "--report" && hasValue)
+			options.reportPath = argv[++i];
+		else if (option == "--min-scale" && hasValue)
+			options.minScale = atof(argv[++i]);
+		else
+		{
+			std::cout << "ERROR::OPTIONS::unknown option " << option << std::endl
+				<< "usage: OpenGLSample [--fps <rate>] [--min-scale <fraction>] [--record-path <file>] [--trace <file.json>]" << std::endl
+				<< "       OpenGLSample [--headless <width>x<height>] [--frames <count>] [--camera-path <file>] [--output <directory>]" << std::endl
+				<< "       OpenGLSample [--headless <width>x<height>] --benchmark <camera path> [--benchmark-output <prefix>]" << std::endl
+				<< "                    [--baseline <json>] [--tolerance <fraction>]" << std::endl
+				<< "       OpenGLSample [--headless <width>x<height>] --regression <suite> [--golden <directory>] [--update-golden]" << std::endl
+				<< "                    [--report <json>]" << std::endl
+				<< "       OpenGLSample --cook-scene <in.scene> <out.sceneb>" << std::endl
+				<< "       OpenGLSample --compress-texture <image> <out.dds> [bc1|bc3|auto] [fast|normal|high]" << std::endl
+				<< "       OpenGLSample --cook-texture <image> <out.ktx> [uncompressed|bc1|bc3|auto] [fast|normal|high]" << std::endl;
+			return false;
+		}
+	}
+	return true;
+}
+
+// renders along a scripted camera path (or from the start camera) as fast as the context allows, into
+// an offscreen framebuffer when headless or into the window otherwise. CPU and GPU time of every frame
+// are measured; a benchmark writes them out and checks them against a baseline
+// ---------------------------------------------------------------------------------------------------
+int runScripted(Scene& scene, ShaderPermutationCache& shaders, const AppOptions& options, GLFWwindow* window)
+{
+	OffscreenTarget target;
+	int width = options.width;
+	int height = options.height;
+	if (window == NULL)
+	{
+		if (!target.create(width, height))
+			return -1;
+	}
+	else
+	{
+		// vsync would measure the display, not the renderer
+		glfwGetFramebufferSize(window, &width, &height);
+		glfwSwapInterval(0);
+	}
+
+	CameraPath path;
+	if (options.cameraPath != NULL && !path.load(options.cameraPath))
+		return -1;
+	int frames = options.frames;
+	if (frames <= 0)
+		frames = path.empty() ? 1 : (int)std::ceil(path.getDuration() * HEADLESS_FRAME_RATE) + 1;
+
+	// GPU time per frame from timer queries, read back GPU_QUERY_LATENCY frames later
+	GLuint queries[GPU_QUERY_LATENCY];
+	glGenQueries(GPU_QUERY_LATENCY, queries);
+	std::vector<double> cpuMilliseconds(frames, 0.0);
+	std::vector<double> gpuMilliseconds(frames, -1.0);
+
+	GLStateCache& glState = GLStateCache::get();
+	RenderQueue renderQueue;
+	RenderPacket packet;
+	auto start = std::chrono::high_resolution_clock::now();
+	int frame = 0;
+	for (; frame < frames; frame++)
+	{
+		if (window != NULL && glfwWindowShouldClose(window))
+			break;
+		TRACE_ZONE("frame");
+		GLuint query = queries[frame % GPU_QUERY_LATENCY];
+		if (frame >= GPU_QUERY_LATENCY)
+		{
+			GLuint64 nanoseconds = 0;
+			glGetQueryObjectui64v(query, GL_QUERY_RESULT, &nanoseconds);
+			gpuMilliseconds[frame - GPU_QUERY_LATENCY] = nanoseconds / 1000000.0;
+		}
+		auto frameStart = std::chrono::high_resolution_clock::now();
+		glState.beginFrame();
+
+		// camera of this frame
+		CameraKeyframe pose = { 0.0, cameraPos, yaw, pitch, fov };
+		if (!path.empty())
+			pose = path.sample(frame / HEADLESS_FRAME_RATE);
+
+		glBeginQuery(GL_TIME_ELAPSED, query);
+		GPU_PROFILE_FRAME_BEGIN();
+		GPU_PROFILE_BEGIN("frame");
+		if (window == NULL)
+		{
+			target.bind();
+		}
+		else
+		{
+			glBindFramebuffer(GL_FRAMEBUFFER, 0);
+			glViewport(0, 0, width, height);
+		}
+		renderPose(scene, shaders, renderQueue, packet, pose, frame, width, height);
+		GPU_PROFILE_END();
+		GPU_PROFILE_FRAME_END();
+		glEndQuery(GL_TIME_ELAPSED);
+		cpuMilliseconds[frame] = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - frameStart).count();
+
+		if (window != NULL)
+		{
+			glfwSwapBuffers(window);
+			glfwPollEvents();
+		}
+		else if (options.outputDirectory != NULL)
+		{
+			TRACE_ZONE("save frame");
+			char name[512];
+			snprintf(name, sizeof(name), "%s/frame_%04d.ppm", options.outputDirectory, frame);
+			if (!target.savePPM(name))
+				return -1;
+		}
+	}
+	frames = frame;
+	for (frame = std::max(frames - GPU_QUERY_LATENCY, 0); frame < frames; frame++)
+	{
+		GLuint64 nanoseconds = 0;
+		glGetQueryObjectui64v(queries[frame % GPU_QUERY_LATENCY], GL_QUERY_RESULT, &nanoseconds);
+		gpuMilliseconds[frame] = nanoseconds / 1000000.0;
+	}
+	glDeleteQueries(GPU_QUERY_LATENCY, queries);
+	double milliseconds = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+
+	std::cout << "Rendered " << frames << " frames at " << width << "x" << height << " in " << milliseconds << " ms ("
+		<< milliseconds / std::max(frames, 1) << " ms per frame, " << frames * 1000.0 / milliseconds << " fps)" << std::endl;
+#if OPENGLSAMPLE_GPU_PROFILER
+	// GPU time per scope over the last frames that were read back, nested scopes indented
+	const std::vector<GpuProfiler::ScopeStats>& scopes = GpuProfiler::get().getScopes();
+	if (!scopes.empty())
+		printf("gpu scope              average       min       max (ms), %u frames dropped\n", GpuProfiler::get().getDroppedFrames());
+	for (size_t i = 0; i < scopes.size(); i++)
+		printf("%*s%-*s %9.3f %9.3f %9.3f\n", scopes[i].depth * 2, "", 20 - scopes[i].depth * 2, scopes[i].name.c_str(),
+			scopes[i].average, scopes[i].min, scopes[i].max);
+#endif
+	if (!options.benchmark)
+		return 0;
+
+	// the warm up frames are left out unless there is nothing else
+	Benchmark benchmark;
+	benchmark.begin(options.cameraPath, width, height);
+	int firstMeasured = frames > BENCHMARK_WARMUP_FRAMES ? BENCHMARK_WARMUP_FRAMES : 0;
+	for (frame = firstMeasured; frame < frames; frame++)
+		benchmark.addFrame(cpuMilliseconds[frame], gpuMilliseconds[frame]);
+
+	FrameStatistics::Summary cpu = benchmark.getCpu().summarize();
+	FrameStatistics::Summary gpu = benchmark.getGpu().summarize();
+	printf("          mean    median       p95       p99       max (ms)\n");
+	printf("cpu  %9.3f %9.3f %9.3f %9.3f %9.3f\n", cpu.mean, cpu.median, cpu.p95, cpu.p99, cpu.max);
+	printf("gpu  %9.3f %9.3f %9.3f %9.3f %9.3f\n", gpu.mean, gpu.median, gpu.p95, gpu.p99, gpu.max);
+
+	std::string prefix = options.benchmarkOutput;
+	if (!benchmark.saveJSON((prefix + ".json").c_str()) || !benchmark.saveCSV((prefix + ".csv").c_str()))
+		return -1;
+	if (options.baselinePath != NULL && !benchmark.compareWithBaseline(options.baselinePath, options.tolerance))
+	{
+		std::cout << "Benchmark regressed against " << options.baselinePath << std::endl;
+		return 1;
+	}
+	return 0;
+}
+
+// renders the suite's fixed cameras into an offscreen framebuffer of the suite's resolution, whether
+// there is a window or not, compares the images with the golden ones and checks frame times and memory
+// ---------------------------------------------------------------------------------------------------
+int runRegression(Scene& scene, ShaderPermutationCache& shaders, const AppOptions& options)
+{
+	RegressionSuite suite;
+	if (!suite.load(options.regressionSuite))
+		return -1;
+	const RegressionSuite::Settings& settings = suite.getSettings();
+	OffscreenTarget target;
+	if (!target.create(settings.width, settings.height))
+		return -1;
+
+	// one timer query per measured frame, read once all frames of a camera are issued
+	std::vector<GLuint> queries(settings.frames);
+	glGenQueries(settings.frames, queries.data());
+
+	GLStateCache& glState = GLStateCache::get();
+	RenderQueue renderQueue;
+	RenderPacket packet;
+	std::vector<unsigned char> pixels;
+	int frame = 0;
+	for (size_t i = 0; i < suite.cameras().size(); i++)
+	{
+		const RegressionCamera& camera = suite.cameras()[i];
+		FrameStatistics cpu, gpu;
+		for (int measured = -BENCHMARK_WARMUP_FRAMES; measured < settings.frames; measured++, frame++)
+		{
+			TRACE_ZONE("frame");
+			auto frameStart = std::chrono::high_resolution_clock::now();
+			glState.beginFrame();
+			if (measured >= 0)
+				glBeginQuery(GL_TIME_ELAPSED, queries[measured]);
+			target.bind();
+			renderPose(scene, shaders, renderQueue, packet, camera.pose, frame, settings.width, settings.height);
+			if (measured >= 0)
+			{
+				glEndQuery(GL_TIME_ELAPSED);
+				cpu.add(std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - frameStart).count());
+			}
+		}
+		for (int measured = 0; measured < settings.frames; measured++)
+		{
+			GLuint64 nanoseconds = 0;
+			glGetQueryObjectui64v(queries[measured], GL_QUERY_RESULT, &nanoseconds);
+			gpu.add(nanoseconds / 1000000.0);
+		}
+
+		target.readPixels(pixels);
+		suite.check(camera, pixels, cpu, gpu, options.goldenDirectory, options.updateGolden);
+	}
+	glDeleteQueries(settings.frames, queries.data());
+	suite.checkMemory(PerformanceHud::getProcessMemoryMegabytes());
+
+	if (options.reportPath != NULL && !suite.saveReport(options.reportPath))
+		return -1;
+	std::cout << "Regression suite " << (suite.passed() ? "passed" : "FAILED") << std::endl;
+	return suite.passed() ? 0 : 1;
+}
+
+// culls the scene for a camera pose and draws it into the bound framebuffer; culling and drawing
+// are the same as in the interactive loop
+// ---------------------------------------------------------------------------------------------------
+void renderPose(Scene& scene, ShaderPermutationCache& shaders, RenderQueue& renderQueue, RenderPacket& packet,
+	const CameraKeyframe& pose, int frame, int width, int height)
+{
+	glm::vec3 front = CameraPath::frontFromAngles(pose.yaw, pose.pitch);
+	packet.frame = frame;
+	packet.view = glm::lookAt(pose.position, pose.position + front, cameraUp);
+	packet.projection = glm::perspective(glm::radians(pose.fov), (float)width / (float)height, 0.1f, 100.0f);
+	packet.cameraPosition = pose.position;
+	packet.nearPlane = 0.1f;
+	packet.farPlane = 100.0f;
+	scene.cull(packet);
+
+	GPU_PROFILE_BEGIN("clear");
+	glClearColor(0.2f, 0.3f, 0.3f, 1.0f);
+	glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+	GPU_PROFILE_END();
+	renderQueue.clear();
+	scene.submit(renderQueue, shaders, packet);
+	renderQueue.sort();
+	GPU_PROFILE_BEGIN("scene");
+	renderQueue.execute(packet.view, packet.projection);
+	GPU_PROFILE_END();
+}
+
+// process all input: query GLFW whether relevant keys are pressed/released this frame and react accordingly
+// ---------------------------------------------------------------------------------------------------------
+InputState processInput(GLFWwindow* window)
+{
+	if (glfwGetKey(window, GLFW_KEY_ESCAPE) == GLFW_PRESS)
+		glfwSetWindowShouldClose(window, true);
+
+	InputState input;
+	input.forward = glfwGetKey(window, GLFW_KEY_W) == GLFW_PRESS;
+	input.backward = glfwGetKey(window, GLFW_KEY_S) == GLFW_PRESS;
+	input.left = glfwGetKey(window, GLFW_KEY_A) == GLFW_PRESS;
+	input.right = glfwGetKey(window, GLFW_KEY_D) == GLFW_PRESS;
+	input.up = glfwGetKey(window, GLFW_KEY_Q) == GLFW_PRESS;
+	input.down = glfwGetKey(window, GLFW_KEY_E) == GLFW_PRESS;
+	input.pick = glfwGetMouseButton(window, GLFW_MOUSE_BUTTON_LEFT) == GLFW_PRESS;
+	input.front = cameraFront;
+	input.yaw = yaw;
+	input.pitch = pitch;
+	input.fov = fov;
+	return input;
+}
+
+// move the camera by the sampled input over one fixed step; runs on the simulation thread
+// ---------------------------------------------------------------------------------------------------------
+void moveCamera(const InputState& input, double step, const BVH& obstacles)
+{
+	float cameraSpeed = (float)(2.5 * step);
+	glm::vec3 newPos = cameraPos;
+	if (input.forward)
+		newPos += cameraSpeed * input.front;
+	if (input.backward)
+		newPos -= cameraSpeed * input.front;
+	if (input.left)
+		newPos -= glm::normalize(glm::cross(input.front, cameraUp)) * cameraSpeed;
+	if (input.right)
+		newPos += glm::normalize(glm::cross(input.front, cameraUp)) * cameraSpeed;
+	if (input.up)
+		newPos += cameraUp * cameraSpeed;
+	if (input.down)
+		newPos -= cameraUp * cameraSpeed;
+
+	// don't walk into objects; moving is still allowed when already inside one, so the camera can get out again
+	static std::vector<uint32_t> hits;
+	BoundingSphere head = { newPos, 0.2f };
+	obstacles.querySphere(head, hits);
+	if (!hits.empty())
+	{
+		head.center = cameraPos;
+		obstacles.querySphere(head, hits);
+		if (hits.empty())
+			return;
+	}
+	cameraPos = newPos;
+}
+
+// true when the generated file exists and was written after the file it was made from; times are
+// in whole seconds, so a file generated in the second of the last edit counts as stale
+// ---------------------------------------------------------------------------------------------
+bool isUpToDate(const char* generatedPath, const char* sourcePath)
+{
+	struct stat generated, source;
+	if (stat(generatedPath, &generated) != 0)
+		return false;
+	return stat(sourcePath, &source) != 0 || generated.st_mtime > source.st_mtime;
+}
+
+// glfw: whenever the window size changed (by OS or user resize) this callback function executes
+// ---------------------------------------------------------------------------------------------
+void framebuffer_size_callback(GLFWwindow* window, int width, int height)
+{
+	// make sure the viewport matches the new window dimensions; note that width and 
+	// height will be significantly larger than specified on retina displays.
+	glViewport(0, 0, width, height);
+}
+
+// glfw: whenever the mouse moves, this callback is called
+// -------------------------------------------------------
+void mouse_callback(GLFWwindow* window, double xpos, double ypos)
+{
+	if (firstMouse)
+	{
+		lastX = xpos;
+		lastY = ypos;
+		firstMouse = false;
+	}
+
+	float xoffset = xpos - lastX;
+	float yoffset = lastY - ypos; // reversed since y-coordinates go from bottom to top
+	lastX = xpos;
+	lastY = ypos;
+
+	float sensitivity = 0.1f; // change this value to your liking
+	xoffset *= sensitivity;
+	yoffset *= sensitivity;
+
+	yaw += xoffset;
+	pitch += yoffset;
+
+	// make sure that when pitch is out of bounds, screen doesn't get flipped
+	if (pitch > 89.0f)
+		pitch = 89.0f;
+	if (pitch < -89.0f)
+		pitch = -89.0f;
+
+	glm::vec3 front;
+	front.x = cos(glm::radians(yaw)) * cos(glm::radians(pitch));
+	front.y = sin(glm::radians(pitch));
+	front.z = sin(glm::radians(yaw)) * cos(glm::radians(pitch));
+	cameraFront = glm::normalize(front);
+}
+
+// glfw: whenever the mouse scroll wheel scrolls, this callback is called
+// ----------------------------------------------------------------------
+void scroll_callback(GLFWwindow* window, double xoffset, double yoffset)
+{
+	fov -= (float)yoffset;
+	if (fov < 1.0f)
+		fov = 1.0f;
+	if (fov > 45.0f)
+		fov = 45.0f;
 }
\ No newline at end of file
@@ -0,0 +1,251 @@
+// STL
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+#include <iostream>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cmath>
+
+// Project
+#include "benchmark.h"
+
+namespace {
+
+	// nearest rank percentile of sorted samples, p in [0, 100]
+	double percentile(const std::vector<double>& sorted, double p)
+	{
+		size_t rank = (size_t)std::ceil(p / 100.0 * sorted.size());
+		return sorted[std::min(std::max(rank, (size_t)1), sorted.size()) - 1];
+	}
+
+	// names are camera path files, whose Windows separators and quotes have to be escaped to keep the JSON valid
+	void writeString(FILE* file, const char* text)
+	{
+		fputc('"', file);
+		for (const char* c = text; *c != '\0'; c++)
+		{
+			if (*c == '"' || *c == '\\')
+				fprintf(file, "\\%c", *c);
+			else if ((unsigned char)*c < 0x20)
+				fprintf(file, "\\u%04x", (unsigned char)*c);
+			else
+				fputc(*c, file);
+		}
+		fputc('"', file);
+	}
+
+	void writeSummary(FILE* file, const char* name, const FrameStatistics::Summary& summary)
+	{
+		fprintf(file, "  \"%s\": {\n", name);
+		fprintf(file, "    \"count\": %zu,\n", summary.count);
+		fprintf(file, "    \"mean\": %.4f,\n", summary.mean);
+		fprintf(file, "    \"median\": %.4f,\n", summary.median);
+		fprintf(file, "    \"p95\": %.4f,\n", summary.p95);
+		fprintf(file, "    \"p99\": %.4f,\n", summary.p99);
+		fprintf(file, "    \"max\": %.4f,\n", summary.max);
+		fprintf(file, "    \"histogram\": [\n");
+		for (int i = 0; i < FrameStatistics::HISTOGRAM_BUCKETS; i++)
+		{
+			double from = FrameStatistics::bucketStart(i);
+			if (i + 1 < FrameStatistics::HISTOGRAM_BUCKETS)
+				fprintf(file, "      { \"from\": %g, \"to\": %g, \"count\": %u },\n", from, FrameStatistics::bucketStart(i + 1), summary.histogram[i]);
+			else
+				fprintf(file, "      { \"from\": %g, \"to\": null, \"count\": %u }\n", from, summary.histogram[i]);
+		}
+		fprintf(file, "    ]\n  }");
+	}
+
+	// reads "key": <number> inside the object that follows "section", enough for the files saveJSON() writes
+	bool readNumber(const std::string& json, const char* section, const char* key, double& value)
+	{
+		size_t start = json.find(std::string("\"") + section + "\"");
+		if (start == std::string::npos)
+			return false;
+		size_t end = json.find('}', json.find('{', start));
+		size_t position = json.find(std::string("\"") + key + "\"", start);
+		if (position == std::string::npos || position > end)
+			return false;
+		position = json.find(':', position);
+		if (position == std::string::npos)
+			return false;
+		const char* text = json.c_str() + position + 1;
+		char* parsed;
+		value = strtod(text, &parsed);
+		return parsed != text;
+	}
+
+} // namespace
+
+// ---------------------------------------------------------------------------
+// FrameStatistics
+// ---------------------------------------------------------------------------
+
+void FrameStatistics::clear()
+{
+	_samples.clear();
+}
+
+void FrameStatistics::add(double milliseconds)
+{
+	_samples.push_back(milliseconds);
+}
+
+size_t FrameStatistics::size() const
+{
+	return _samples.size();
+}
+
+const std::vector<double>& FrameStatistics::samples() const
+{
+	return _samples;
+}
+
+double FrameStatistics::bucketStart(int bucket)
+{
+	return bucket == 0 ? 0.0 : 0.25 * std::ldexp(1.0, bucket - 1);
+}
+
+FrameStatistics::Summary FrameStatistics::summarize() const
+{
+	Summary summary;
+	memset(&summary, 0, sizeof(summary));
+	summary.count = _samples.size();
+	if (_samples.empty())
+		return summary;
+
+	std::vector<double> sorted(_samples);
+	std::sort(sorted.begin(), sorted.end());
+	double total = 0.0;
+	for (size_t i = 0; i < sorted.size(); i++)
+	{
+		total += sorted[i];
+		int bucket = 0;
+		while (bucket + 1 < HISTOGRAM_BUCKETS && sorted[i] >= bucketStart(bucket + 1))
+			bucket++;
+		summary.histogram[bucket]++;
+	}
+	summary.mean = total / sorted.size();
+	summary.median = percentile(sorted, 50.0);
+	summary.p95 = percentile(sorted, 95.0);
+	summary.p99 = percentile(sorted, 99.0);
+	summary.max = sorted.back();
+	return summary;
+}
+
+// ---------------------------------------------------------------------------
+// Benchmark
+// ---------------------------------------------------------------------------
+
+void Benchmark::begin(const std::string& name, int width, int height)
+{
+	_name = name;
+	_width = width;
+	_height = height;
+	_cpu.clear();
+	_gpu.clear();
+	_gpuPerFrame.clear();
+}
+
+void Benchmark::addFrame(double cpuMilliseconds, double gpuMilliseconds)
+{
+	_cpu.add(cpuMilliseconds);
+	if (gpuMilliseconds >= 0.0)
+		_gpu.add(gpuMilliseconds);
+	_gpuPerFrame.push_back(gpuMilliseconds >= 0.0 ? gpuMilliseconds : -1.0);
+}
+
+const FrameStatistics& Benchmark::getCpu() const
+{
+	return _cpu;
+}
+
+const FrameStatistics& Benchmark::getGpu() const
+{
+	return _gpu;
+}
+
+bool Benchmark::saveJSON(const char* path) const
+{
+	FILE* file = fopen(path, "w");
+	if (file == NULL)
+	{
+		std::cout << "ERROR::BENCHMARK::CANNOT_WRITE " << path << std::endl;
+		return false;
+	}
+	fprintf(file, "{\n");
+	fprintf(file, "  \"name\": ");
+	writeString(file, _name.c_str());
+	fprintf(file, ",\n");
+	fprintf(file, "  \"width\": %d,\n", _width);
+	fprintf(file, "  \"height\": %d,\n", _height);
+	fprintf(file, "  \"frames\": %zu,\n", _cpu.size());
+	writeSummary(file, "cpu", _cpu.summarize());
+	fprintf(file, ",\n");
+	writeSummary(file, "gpu", _gpu.summarize());
+	fprintf(file, "\n}\n");
+	fclose(file);
+	return true;
+}
+
+bool Benchmark::saveCSV(const char* path) const
+{
+	FILE* file = fopen(path, "w");
+	if (file == NULL)
+	{
+		std::cout << "ERROR::BENCHMARK::CANNOT_WRITE " << path << std::endl;
+		return false;
+	}
+	fprintf(file, "frame,cpu_ms,gpu_ms\n");
+	for (size_t i = 0; i < _cpu.size(); i++)
+	{
+		if (_gpuPerFrame[i] >= 0.0)
+			fprintf(file, "%zu,%.4f,%.4f\n", i, _cpu.samples()[i], _gpuPerFrame[i]);
+		else
+			fprintf(file, "%zu,%.4f,\n", i, _cpu.samples()[i]);
+	}
+	fclose(file);
+	return true;
+}
+
+bool Benchmark::compareWithBaseline(const char* path, double tolerance) const
+{
+	std::ifstream file(path);
+	if (!file.is_open())
+	{
+		std::cout << "ERROR::BENCHMARK::BASELINE_NOT_SUCCESFULLY_READ: " << path << std::endl;
+		return false;
+	}
+	std::stringstream stream;
+	stream << file.rdbuf();
+	std::string json = stream.str();
+
+	const char* sections[] = { "cpu", "gpu" };
+	const char* keys[] = { "median", "p95" };
+	FrameStatistics::Summary summaries[] = { _cpu.summarize(), _gpu.summarize() };
+	bool passed = true;
+	for (int s = 0; s < 2; s++)
+	{
+		for (int k = 0; k < 2; k++)
+		{
+			double baseline;
+			if (!readNumber(json, sections[s], keys[k], baseline))
+			{
+				std::cout << "ERROR::BENCHMARK::BASELINE_MISSING " << sections[s] << "." << keys[k] << " in " << path << std::endl;
+				return false;
+			}
+			double current = k == 0 ? summaries[s].median : summaries[s].p95;
+			// nothing to compare when either run had no samples, e.g. no GPU timers on one machine
+			if (summaries[s].count == 0 || baseline <= 0.0)
+				continue;
+
+			double change = current / baseline - 1.0;
+			bool regressed = change > tolerance;
+			printf("%s %-6s %9.3f ms  baseline %9.3f ms  %+6.1f %%%s\n", sections[s], keys[k], current, baseline, change * 100.0,
+				regressed ? "  REGRESSION" : "");
+			passed = passed && !regressed;
+		}
+	}
+	return passed;
+}
@@ -0,0 +1,75 @@
+#pragma once
+
+// STL
+#include <vector>
+#include <string>
+#include <cstddef>
+
+/**
+* Distribution of per frame times in milliseconds.
+*/
+class FrameStatistics
+{
+public:
+	// power of two buckets: [0, 0.25), [0.25, 0.5), [0.5, 1) ... [512, 1024), >= 1024 ms
+	static const int HISTOGRAM_BUCKETS = 14;
+
+	struct Summary
+	{
+		size_t count;
+		double mean;
+		double median;
+		double p95;
+		double p99;
+		double max;
+		unsigned int histogram[HISTOGRAM_BUCKETS];
+	};
+
+	void clear();
+	void add(double milliseconds);
+	size_t size() const;
+	const std::vector<double>& samples() const;
+
+	/** \brief  Computes the summary, percentiles use the nearest rank. All zero without samples. */
+	Summary summarize() const;
+
+	/** \brief  Gets the lower edge of a histogram bucket in milliseconds. */
+	static double bucketStart(int bucket);
+
+private:
+	std::vector<double> _samples;
+};
+
+/**
+* Frame times of one benchmark run over a camera path, CPU (culling, queueing and issuing
+* draws) and GPU (timer queries) separately. Results are written as a JSON summary and
+* a per frame CSV, and can be checked against the JSON of an earlier run.
+*/
+class Benchmark
+{
+public:
+	/** \brief  Starts a new run, the name and resolution go into the report. */
+	void begin(const std::string& name, int width, int height);
+
+	/** \param gpuMilliseconds  Negative when the GPU time is not known (no timer query support) */
+	void addFrame(double cpuMilliseconds, double gpuMilliseconds);
+
+	const FrameStatistics& getCpu() const;
+	const FrameStatistics& getGpu() const;
+
+	bool saveJSON(const char* path) const;
+	bool saveCSV(const char* path) const;
+
+	/** \brief  Compares median and p95 of CPU and GPU times with a baseline JSON written by saveJSON().
+	*           The comparison is printed.
+	*   \param tolerance  Allowed slowdown as a fraction, 0.1 = 10 %
+	*   \return False when a time regressed beyond the tolerance or the baseline can't be read
+	*/
+	bool compareWithBaseline(const char* path, double tolerance) const;
+
+private:
+	std::string _name;
+	int _width, _height;
+	FrameStatistics _cpu, _gpu;
+	std::vector<double> _gpuPerFrame; // -1 where unknown, so the CSV rows stay aligned
+};
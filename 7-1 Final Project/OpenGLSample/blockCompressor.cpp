@@ -0,0 +1,626 @@
+// STL
+#include <cstdio>
+#include <cstring>
+#include <cstdint>
+#include <cmath>
+#include <iostream>
+#include <algorithm>
+#include <chrono>
+
+// SIMD, SSE2 is always there on the x64 targets this is built for
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define BLOCK_COMPRESSOR_SSE2
+#endif
+
+// Project
+#include "blockCompressor.h"
+#include "textureCooker.h"
+#include "jobSystem.h"
+#include "cpuTracer.h"
+#include "stb_image.h"
+
+namespace {
+
+	const uint32_t FOURCC_DXT1 = 0x31545844; // "DXT1"
+	const uint32_t FOURCC_DXT5 = 0x35545844; // "DXT5"
+	const size_t ROWS_PER_JOB = 4; // block rows
+
+	// DDS_HEADER flags and caps
+	const uint32_t DDSD_CAPS = 0x1, DDSD_HEIGHT = 0x2, DDSD_WIDTH = 0x4, DDSD_PIXELFORMAT = 0x1000;
+	const uint32_t DDSD_MIPMAPCOUNT = 0x20000, DDSD_LINEARSIZE = 0x80000;
+	const uint32_t DDPF_FOURCC = 0x4;
+	const uint32_t DDSCAPS_COMPLEX = 0x8, DDSCAPS_TEXTURE = 0x1000, DDSCAPS_MIPMAP = 0x400000;
+
+	// one 4x4 block, colors split into channels so four pixels are one SSE register
+	struct Block
+	{
+		float r[16], g[16], b[16];
+		unsigned char a[16];
+	};
+
+	struct Color
+	{
+		float r, g, b;
+	};
+
+	// gathers the block at block column bx, row by; pixels past the edge repeat the last row / column
+	void loadBlock(const unsigned char* rgba, int width, int height, int bx, int by, Block& block)
+	{
+		for (int y = 0; y < 4; y++)
+		{
+			int row = std::min(by * 4 + y, height - 1);
+			for (int x = 0; x < 4; x++)
+			{
+				const unsigned char* pixel = rgba + ((size_t)row * width + std::min(bx * 4 + x, width - 1)) * 4;
+				block.r[y * 4 + x] = pixel[0];
+				block.g[y * 4 + x] = pixel[1];
+				block.b[y * 4 + x] = pixel[2];
+				block.a[y * 4 + x] = pixel[3];
+			}
+		}
+	}
+
+	// ---------------------------------------------------------------------------
+	// color endpoints
+	// ---------------------------------------------------------------------------
+
+	uint16_t quantize565(const Color& c)
+	{
+		int r = (int)(std::min(std::max(c.r, 0.0f), 255.0f) * 31.0f / 255.0f + 0.5f);
+		int g = (int)(std::min(std::max(c.g, 0.0f), 255.0f) * 63.0f / 255.0f + 0.5f);
+		int b = (int)(std::min(std::max(c.b, 0.0f), 255.0f) * 31.0f / 255.0f + 0.5f);
+		return (uint16_t)((r << 11) | (g << 5) | b);
+	}
+
+	// the bits are repeated into the low bits, like the hardware expands them
+	Color expand565(uint16_t c)
+	{
+		int r = (c >> 11) & 31, g = (c >> 5) & 63, b = c & 31;
+		Color color = { (float)((r << 3) | (r >> 2)), (float)((g << 2) | (g >> 4)), (float)((b << 3) | (b >> 2)) };
+		return color;
+	}
+
+	// corners of the bounding box, pulled in by a sixteenth so outliers do not waste the palette
+	void boundingBoxEndpoints(const Block& block, Color& low, Color& high)
+	{
+		low.r = low.g = low.b = 255.0f;
+		high.r = high.g = high.b = 0.0f;
+		for (int i = 0; i < 16; i++)
+		{
+			low.r = std::min(low.r, block.r[i]);
+			low.g = std::min(low.g, block.g[i]);
+			low.b = std::min(low.b, block.b[i]);
+			high.r = std::max(high.r, block.r[i]);
+			high.g = std::max(high.g, block.g[i]);
+			high.b = std::max(high.b, block.b[i]);
+		}
+		Color inset = { (high.r - low.r) / 16.0f, (high.g - low.g) / 16.0f, (high.b - low.b) / 16.0f };
+		low.r += inset.r;
+		low.g += inset.g;
+		low.b += inset.b;
+		high.r -= inset.r;
+		high.g -= inset.g;
+		high.b -= inset.b;
+	}
+
+	// extremes of the colors along the axis they vary most, found by power iteration on the covariance
+	void principalAxisEndpoints(const Block& block, Color& low, Color& high)
+	{
+		Color mean = { 0.0f, 0.0f, 0.0f };
+		for (int i = 0; i < 16; i++)
+		{
+			mean.r += block.r[i];
+			mean.g += block.g[i];
+			mean.b += block.b[i];
+		}
+		mean.r /= 16.0f;
+		mean.g /= 16.0f;
+		mean.b /= 16.0f;
+
+		float rr = 0, rg = 0, rb = 0, gg = 0, gb = 0, bb = 0;
+		for (int i = 0; i < 16; i++)
+		{
+			float r = block.r[i] - mean.r, g = block.g[i] - mean.g, b = block.b[i] - mean.b;
+			rr += r * r;
+			rg += r * g;
+			rb += r * b;
+			gg += g * g;
+			gb += g * b;
+			bb += b * b;
+		}
+
+		Color axis = { 1.0f, 1.0f, 1.0f };
+		for (int iteration = 0; iteration < 8; iteration++)
+		{
+			Color next = { rr * axis.r + rg * axis.g + rb * axis.b, rg * axis.r + gg * axis.g + gb * axis.b, rb * axis.r + gb * axis.g + bb * axis.b };
+			float length = std::max(std::max(std::fabs(next.r), std::fabs(next.g)), std::fabs(next.b));
+			if (length < 1e-6f)
+				break; // a flat block, any axis will do
+			axis.r = next.r / length;
+			axis.g = next.g / length;
+			axis.b = next.b / length;
+		}
+
+		float minimum = 1e30f, maximum = -1e30f;
+		for (int i = 0; i < 16; i++)
+		{
+			float t = (block.r[i] - mean.r) * axis.r + (block.g[i] - mean.g) * axis.g + (block.b[i] - mean.b) * axis.b;
+			minimum = std::min(minimum, t);
+			maximum = std::max(maximum, t);
+		}
+		float lengthSquared = axis.r * axis.r + axis.g * axis.g + axis.b * axis.b;
+		minimum /= lengthSquared;
+		maximum /= lengthSquared;
+		low.r = mean.r + axis.r * minimum;
+		low.g = mean.g + axis.g * minimum;
+		low.b = mean.b + axis.b * minimum;
+		high.r = mean.r + axis.r * maximum;
+		high.g = mean.g + axis.g * maximum;
+		high.b = mean.b + axis.b * maximum;
+	}
+
+	// index i of a 4-color block is this much of color 0, the rest is color 1
+	const float PALETTE_WEIGHTS[4] = { 1.0f, 0.0f, 2.0f / 3.0f, 1.0f / 3.0f };
+
+	// nearest palette entry for every pixel, returns the summed squared error
+	float selectIndices(const Block& block, const Color palette[4], unsigned char indices[16])
+	{
+#if defined(BLOCK_COMPRESSOR_SSE2)
+		__m128 total = _mm_setzero_ps();
+		for (int i = 0; i < 16; i += 4)
+		{
+			__m128 r = _mm_loadu_ps(block.r + i);
+			__m128 g = _mm_loadu_ps(block.g + i);
+			__m128 b = _mm_loadu_ps(block.b + i);
+			__m128 best = _mm_set1_ps(1e30f);
+			__m128i bestIndex = _mm_setzero_si128();
+			for (int k = 0; k < 4; k++)
+			{
+				__m128 dr = _mm_sub_ps(r, _mm_set1_ps(palette[k].r));
+				__m128 dg = _mm_sub_ps(g, _mm_set1_ps(palette[k].g));
+				__m128 db = _mm_sub_ps(b, _mm_set1_ps(palette[k].b));
+				__m128 distance = _mm_add_ps(_mm_add_ps(_mm_mul_ps(dr, dr), _mm_mul_ps(dg, dg)), _mm_mul_ps(db, db));
+				__m128i closer = _mm_castps_si128(_mm_cmplt_ps(distance, best));
+				best = _mm_min_ps(distance, best);
+				bestIndex = _mm_or_si128(_mm_andnot_si128(closer, bestIndex), _mm_and_si128(closer, _mm_set1_epi32(k)));
+			}
+			total = _mm_add_ps(total, best);
+			int32_t lanes[4];
+			_mm_storeu_si128((__m128i*)lanes, bestIndex);
+			for (int j = 0; j < 4; j++)
+				indices[i + j] = (unsigned char)lanes[j];
+		}
+		float sums[4];
+		_mm_storeu_ps(sums, total);
+		return sums[0] + sums[1] + sums[2] + sums[3];
+#else
+		float total = 0.0f;
+		for (int i = 0; i < 16; i++)
+		{
+			float best = 1e30f;
+			for (int k = 0; k < 4; k++)
+			{
+				float dr = block.r[i] - palette[k].r, dg = block.g[i] - palette[k].g, db = block.b[i] - palette[k].b;
+				float distance = dr * dr + dg * dg + db * db;
+				if (distance < best)
+				{
+					best = distance;
+					indices[i] = (unsigned char)k;
+				}
+			}
+			total += best;
+		}
+		return total;
+#endif
+	}
+
+	// the endpoints that fit the colors best for the given indices, by least squares
+	bool refineEndpoints(const Block& block, const unsigned char indices[16], Color& low, Color& high)
+	{
+		float alpha2 = 0, beta2 = 0, alphaBeta = 0;
+		Color alphaX = { 0, 0, 0 }, betaX = { 0, 0, 0 };
+		for (int i = 0; i < 16; i++)
+		{
+			float alpha = PALETTE_WEIGHTS[indices[i]], beta = 1.0f - alpha;
+			alpha2 += alpha * alpha;
+			beta2 += beta * beta;
+			alphaBeta += alpha * beta;
+			alphaX.r += alpha * block.r[i];
+			alphaX.g += alpha * block.g[i];
+			alphaX.b += alpha * block.b[i];
+			betaX.r += beta * block.r[i];
+			betaX.g += beta * block.g[i];
+			betaX.b += beta * block.b[i];
+		}
+		float determinant = alpha2 * beta2 - alphaBeta * alphaBeta;
+		if (std::fabs(determinant) < 1e-6f)
+			return false; // every pixel on one index
+		float scale = 1.0f / determinant;
+		high.r = (alphaX.r * beta2 - betaX.r * alphaBeta) * scale;
+		high.g = (alphaX.g * beta2 - betaX.g * alphaBeta) * scale;
+		high.b = (alphaX.b * beta2 - betaX.b * alphaBeta) * scale;
+		low.r = (betaX.r * alpha2 - alphaX.r * alphaBeta) * scale;
+		low.g = (betaX.g * alpha2 - alphaX.g * alphaBeta) * scale;
+		low.b = (betaX.b * alpha2 - alphaX.b * alphaBeta) * scale;
+		return true;
+	}
+
+	// a 4-color BC1 block from the endpoints; returns its error and the indices it picked
+	float encodeColor(const Block& block, const Color& low, const Color& high, unsigned char out[8], unsigned char indices[16])
+	{
+		uint16_t c0 = quantize565(high);
+		uint16_t c1 = quantize565(low);
+		// color 0 has to be the larger, the other order means 3 colors and transparent black
+		if (c0 < c1)
+			std::swap(c0, c1);
+
+		Color palette[4];
+		palette[0] = expand565(c0);
+		palette[1] = expand565(c1);
+		for (int k = 2; k < 4; k++)
+		{
+			palette[k].r = (palette[0].r * PALETTE_WEIGHTS[k] + palette[1].r * (1.0f - PALETTE_WEIGHTS[k]));
+			palette[k].g = (palette[0].g * PALETTE_WEIGHTS[k] + palette[1].g * (1.0f - PALETTE_WEIGHTS[k]));
+			palette[k].b = (palette[0].b * PALETTE_WEIGHTS[k] + palette[1].b * (1.0f - PALETTE_WEIGHTS[k]));
+		}
+		float error = selectIndices(block, palette, indices);
+		if (c0 == c1)
+		{
+			// one color: index 0 everywhere reads the same in either mode
+			memset(indices, 0, 16);
+		}
+
+		uint32_t bits = 0;
+		for (int i = 0; i < 16; i++)
+			bits |= (uint32_t)indices[i] << (2 * i);
+		out[0] = (unsigned char)(c0 & 0xFF);
+		out[1] = (unsigned char)(c0 >> 8);
+		out[2] = (unsigned char)(c1 & 0xFF);
+		out[3] = (unsigned char)(c1 >> 8);
+		memcpy(out + 4, &bits, 4);
+		return error;
+	}
+
+	void compressColorBlock(const Block& block, BlockQuality quality, unsigned char out[8])
+	{
+		unsigned char indices[16];
+		Color low, high;
+		if (quality == BLOCK_QUALITY_FAST)
+		{
+			boundingBoxEndpoints(block, low, high);
+			encodeColor(block, low, high, out, indices);
+			return;
+		}
+
+		principalAxisEndpoints(block, low, high);
+		float best = encodeColor(block, low, high, out, indices);
+		int passes = quality == BLOCK_QUALITY_HIGH ? 8 : 1;
+		unsigned char candidate[8];
+		unsigned char candidateIndices[16];
+		for (int pass = 0; pass < passes && best > 0.0f; pass++)
+		{
+			if (!refineEndpoints(block, indices, low, high))
+				break;
+			float error = encodeColor(block, low, high, candidate, candidateIndices);
+			if (error >= best)
+				break;
+			best = error;
+			memcpy(out, candidate, 8);
+			memcpy(indices, candidateIndices, 16);
+		}
+		if (quality == BLOCK_QUALITY_HIGH)
+		{
+			// the box corners now and then beat the axis, e.g. for blocks with two color clusters
+			boundingBoxEndpoints(block, low, high);
+			if (encodeColor(block, low, high, candidate, candidateIndices) < best)
+				memcpy(out, candidate, 8);
+		}
+	}
+
+	// ---------------------------------------------------------------------------
+	// alpha (BC3)
+	// ---------------------------------------------------------------------------
+
+	// the 8 alpha values a block's endpoints give, in the order of the 3 bit indices
+	void alphaPalette(int a0, int a1, int palette[8])
+	{
+		palette[0] = a0;
+		palette[1] = a1;
+		if (a0 > a1)
+		{
+			for (int k = 1; k < 7; k++)
+				palette[k + 1] = ((7 - k) * a0 + k * a1) / 7;
+		}
+		else
+		{
+			for (int k = 1; k < 5; k++)
+				palette[k + 1] = ((5 - k) * a0 + k * a1) / 5;
+			palette[6] = 0;
+			palette[7] = 255;
+		}
+	}
+
+	int encodeAlpha(const Block& block, int a0, int a1, unsigned char out[8])
+	{
+		int palette[8];
+		alphaPalette(a0, a1, palette);
+		int error = 0;
+		uint64_t bits = 0;
+		for (int i = 0; i < 16; i++)
+		{
+			int best = 1 << 30, index = 0;
+			for (int k = 0; k < 8; k++)
+			{
+				int d = (int)block.a[i] - palette[k];
+				if (d * d < best)
+				{
+					best = d * d;
+					index = k;
+				}
+			}
+			error += best;
+			bits |= (uint64_t)index << (3 * i);
+		}
+		out[0] = (unsigned char)a0;
+		out[1] = (unsigned char)a1;
+		for (int i = 0; i < 6; i++)
+			out[2 + i] = (unsigned char)(bits >> (8 * i));
+		return error;
+	}
+
+	void compressAlphaBlock(const Block& block, BlockQuality quality, unsigned char out[8])
+	{
+		// 8 values between the extremes
+		int minimum = 255, maximum = 0;
+		for (int i = 0; i < 16; i++)
+		{
+			minimum = std::min(minimum, (int)block.a[i]);
+			maximum = std::max(maximum, (int)block.a[i]);
+		}
+		int best = encodeAlpha(block, maximum, minimum, out);
+		if (quality != BLOCK_QUALITY_HIGH || best == 0)
+			return;
+
+		// or 6 values between the extremes that are not 0 or 255, which the block has exactly then
+		int inner0 = 255, inner1 = 0;
+		for (int i = 0; i < 16; i++)
+		{
+			if (block.a[i] != 0 && block.a[i] != 255)
+			{
+				inner0 = std::min(inner0, (int)block.a[i]);
+				inner1 = std::max(inner1, (int)block.a[i]);
+			}
+		}
+		if (inner0 > inner1)
+			inner0 = inner1 = 0;
+		unsigned char candidate[8];
+		if (encodeAlpha(block, inner0, inner1, candidate) < best)
+			memcpy(out, candidate, 8);
+	}
+
+	// ---------------------------------------------------------------------------
+	// decoding
+	// ---------------------------------------------------------------------------
+
+	void decodeColorBlock(const unsigned char* in, unsigned char pixels[16][4])
+	{
+		uint16_t c0 = (uint16_t)(in[0] | (in[1] << 8));
+		uint16_t c1 = (uint16_t)(in[2] | (in[3] << 8));
+		Color e0 = expand565(c0), e1 = expand565(c1);
+		int palette[4][4] = {
+			{ (int)e0.r, (int)e0.g, (int)e0.b, 255 },
+			{ (int)e1.r, (int)e1.g, (int)e1.b, 255 },
+		};
+		for (int c = 0; c < 3; c++)
+		{
+			if (c0 > c1)
+			{
+				palette[2][c] = (2 * palette[0][c] + palette[1][c]) / 3;
+				palette[3][c] = (palette[0][c] + 2 * palette[1][c]) / 3;
+			}
+			else
+			{
+				palette[2][c] = (palette[0][c] + palette[1][c]) / 2;
+				palette[3][c] = 0;
+			}
+		}
+		palette[2][3] = 255;
+		palette[3][3] = c0 > c1 ? 255 : 0;
+
+		uint32_t bits;
+		memcpy(&bits, in + 4, 4);
+		for (int i = 0; i < 16; i++)
+		{
+			const int* color = palette[(bits >> (2 * i)) & 3];
+			for (int c = 0; c < 4; c++)
+				pixels[i][c] = (unsigned char)color[c];
+		}
+	}
+
+	void decodeAlphaBlock(const unsigned char* in, unsigned char pixels[16][4])
+	{
+		int palette[8];
+		alphaPalette(in[0], in[1], palette);
+		uint64_t bits = 0;
+		for (int i = 0; i < 6; i++)
+			bits |= (uint64_t)in[2 + i] << (8 * i);
+		for (int i = 0; i < 16; i++)
+			pixels[i][3] = (unsigned char)palette[(bits >> (3 * i)) & 7];
+	}
+
+	const char* formatName(BlockFormat format)
+	{
+		return format == BLOCK_FORMAT_BC1 ? "BC1" : "BC3";
+	}
+
+} // namespace
+
+size_t BlockCompressor::getBlockBytes(BlockFormat format)
+{
+	return format == BLOCK_FORMAT_BC1 ? 8 : 16;
+}
+
+size_t BlockCompressor::getImageBytes(int width, int height, BlockFormat format)
+{
+	return (size_t)((width + 3) / 4) * ((height + 3) / 4) * getBlockBytes(format);
+}
+
+BlockFormat BlockCompressor::chooseFormat(const unsigned char* rgba, int width, int height)
+{
+	size_t pixelCount = (size_t)width * height;
+	for (size_t i = 0; i < pixelCount; i++)
+	{
+		if (rgba[i * 4 + 3] != 255)
+			return BLOCK_FORMAT_BC3;
+	}
+	return BLOCK_FORMAT_BC1;
+}
+
+void BlockCompressor::compress(const unsigned char* rgba, int width, int height, BlockFormat format, BlockQuality quality,
+	std::vector<unsigned char>& blocks)
+{
+	TRACE_ZONE("compress blocks");
+	int blocksWide = (width + 3) / 4, blocksHigh = (height + 3) / 4;
+	size_t blockBytes = getBlockBytes(format);
+	blocks.resize((size_t)blocksWide * blocksHigh * blockBytes);
+
+	// every block is independent, rows of them go to the workers
+	JobSystem::get().parallelFor((size_t)blocksHigh, ROWS_PER_JOB, [&](size_t begin, size_t end)
+	{
+		Block block;
+		for (size_t by = begin; by < end; by++)
+		{
+			for (int bx = 0; bx < blocksWide; bx++)
+			{
+				unsigned char* out = &blocks[((size_t)by * blocksWide + bx) * blockBytes];
+				loadBlock(rgba, width, height, bx, (int)by, block);
+				if (format == BLOCK_FORMAT_BC3)
+				{
+					compressAlphaBlock(block, quality, out);
+					out += 8;
+				}
+				compressColorBlock(block, quality, out);
+			}
+		}
+	});
+}
+
+void BlockCompressor::decompress(const unsigned char* blocks, int width, int height, BlockFormat format, std::vector<unsigned char>& rgba)
+{
+	int blocksWide = (width + 3) / 4, blocksHigh = (height + 3) / 4;
+	size_t blockBytes = getBlockBytes(format);
+	rgba.resize((size_t)width * height * 4);
+	for (int by = 0; by < blocksHigh; by++)
+	{
+		for (int bx = 0; bx < blocksWide; bx++)
+		{
+			const unsigned char* in = blocks + ((size_t)by * blocksWide + bx) * blockBytes;
+			unsigned char pixels[16][4];
+			decodeColorBlock(format == BLOCK_FORMAT_BC3 ? in + 8 : in, pixels);
+			if (format == BLOCK_FORMAT_BC3)
+				decodeAlphaBlock(in, pixels);
+			for (int i = 0; i < 16; i++)
+			{
+				int x = bx * 4 + i % 4, y = by * 4 + i / 4;
+				if (x < width && y < height)
+					memcpy(&rgba[((size_t)y * width + x) * 4], pixels[i], 4);
+			}
+		}
+	}
+}
+
+void BlockCompressor::compressMipChain(const unsigned char* rgba, int width, int height, BlockFormat format, BlockQuality quality,
+	std::vector<std::vector<unsigned char> >& levels)
+{
+	std::vector<std::vector<unsigned char> > images;
+	TextureCooker::generateMipChain(rgba, width, height, 4, images);
+	levels.resize(images.size());
+	for (size_t level = 0; level < images.size(); level++)
+	{
+		compress(images[level].data(), std::max(width >> level, 1), std::max(height >> level, 1), format, quality, levels[level]);
+		std::vector<unsigned char>().swap(images[level]);
+	}
+}
+
+bool BlockCompressor::writeDDS(const char* path, int width, int height, BlockFormat format, const std::vector<std::vector<unsigned char> >& levels)
+{
+	// DDS_HEADER, 31 dwords after the magic; the pixel format is dwords 18 to 25
+	uint32_t header[31];
+	memset(header, 0, sizeof(header));
+	header[0] = sizeof(header);
+	header[1] = DDSD_CAPS | DDSD_HEIGHT | DDSD_WIDTH | DDSD_PIXELFORMAT | DDSD_LINEARSIZE | (levels.size() > 1 ? DDSD_MIPMAPCOUNT : 0);
+	header[2] = height;
+	header[3] = width;
+	header[4] = levels.empty() ? 0 : (uint32_t)levels[0].size();
+	header[6] = (uint32_t)levels.size();
+	header[18] = 32;
+	header[19] = DDPF_FOURCC;
+	header[20] = format == BLOCK_FORMAT_BC1 ? FOURCC_DXT1 : FOURCC_DXT5;
+	header[26] = DDSCAPS_TEXTURE | (levels.size() > 1 ? DDSCAPS_COMPLEX | DDSCAPS_MIPMAP : 0);
+
+	FILE* file = fopen(path, "wb");
+	if (file == NULL)
+	{
+		std::cout << "ERROR::BLOCK_COMPRESSOR::FILE_NOT_SUCCESFULLY_WRITTEN: " << path << std::endl;
+		return false;
+	}
+	bool ok = fwrite("DDS ", 1, 4, file) == 4 && fwrite(header, 1, sizeof(header), file) == sizeof(header);
+	for (size_t i = 0; ok && i < levels.size(); i++)
+		ok = fwrite(levels[i].data(), 1, levels[i].size(), file) == levels[i].size();
+	fclose(file);
+	if (!ok)
+		std::cout << "ERROR::BLOCK_COMPRESSOR::FILE_NOT_SUCCESFULLY_WRITTEN: " << path << std::endl;
+	return ok;
+}
+
+bool BlockCompressor::compressFile(const char* imagePath, const char* ddsPath, BlockFormat format, BlockQuality quality)
+{
+	std::chrono::high_resolution_clock::time_point start = std::chrono::high_resolution_clock::now();
+	int width, height, channels;
+	stbi_set_flip_vertically_on_load(true);
+	unsigned char* pixels = stbi_load(imagePath, &width, &height, &channels, 4);
+	if (pixels == NULL)
+	{
+		std::cout << "ERROR::BLOCK_COMPRESSOR::IMAGE_NOT_SUCCESFULLY_READ: " << imagePath << std::endl;
+		return false;
+	}
+	size_t pixelCount = (size_t)width * height;
+	if (format == BLOCK_FORMAT_AUTO)
+		format = chooseFormat(pixels, width, height);
+
+	std::vector<std::vector<unsigned char> > levels;
+	compressMipChain(pixels, width, height, format, quality, levels);
+	double seconds = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start).count();
+
+	// what the compression costs in quality (of the full size level) and saves in memory
+	std::vector<unsigned char> decoded;
+	decompress(levels[0].data(), width, height, format, decoded);
+	int compared = format == BLOCK_FORMAT_BC3 ? 4 : 3;
+	double squares = 0.0;
+	for (size_t i = 0; i < pixelCount; i++)
+	{
+		for (int c = 0; c < compared; c++)
+		{
+			double d = (double)pixels[i * 4 + c] - decoded[i * 4 + c];
+			squares += d * d;
+		}
+	}
+	stbi_image_free(pixels);
+	double meanSquare = squares / ((double)pixelCount * compared);
+	double psnr = meanSquare > 0.0 ? 10.0 * std::log10(255.0 * 255.0 / meanSquare) : 99.0;
+
+	size_t compressedBytes = 0;
+	for (size_t i = 0; i < levels.size(); i++)
+		compressedBytes += levels[i].size();
+	size_t uncompressedBytes = pixelCount * channels * 4 / 3; // what the TextureManager would upload, mips included
+
+	if (!writeDDS(ddsPath, width, height, format, levels))
+		return false;
+	char line[256];
+	snprintf(line, sizeof(line), "%s -> %s: %dx%d %s, %d levels, %.2f MB (%.1f:1), PSNR %.1f dB, %.0f ms",
+		imagePath, ddsPath, width, height, formatName(format), (int)levels.size(), compressedBytes / (1024.0 * 1024.0),
+		(double)uncompressedBytes / compressedBytes, psnr, seconds * 1000.0);
+	std::cout << line << std::endl;
+	return true;
+}
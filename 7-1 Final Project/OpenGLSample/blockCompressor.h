@@ -0,0 +1,71 @@
+#pragma once
+
+// STL
+#include <vector>
+#include <cstddef>
+
+/**
+* Block compressed formats the compressor writes, both read by loadDDS().
+*/
+enum BlockFormat
+{
+	BLOCK_FORMAT_BC1 = 0, // DXT1: RGB, 8 bytes per 4x4 block (6:1 against RGB8)
+	BLOCK_FORMAT_BC3 = 1, // DXT5: RGB + interpolated alpha, 16 bytes per block (4:1 against RGBA8)
+	BLOCK_FORMAT_AUTO = 2 // BC3 for images with any alpha below 255, BC1 otherwise
+};
+
+/**
+* How hard the compressor looks for the block endpoints.
+*/
+enum BlockQuality
+{
+	BLOCK_QUALITY_FAST = 0, // corners of the color bounding box
+	BLOCK_QUALITY_NORMAL = 1, // principal axis of the colors, refined once by least squares
+	BLOCK_QUALITY_HIGH = 2 // principal axis, refined until the error stops falling; both alpha modes tried
+};
+
+/**
+* CPU compressor from RGBA8 images to BC1 / BC3 blocks, to keep textures compressed in
+* video memory (a quarter to a sixth of the uncompressed size, with the bandwidth to match).
+* Rows of blocks are compressed in parallel on the job system; the palette search of a block
+* uses SSE2 where the compiler targets it. Meant for offline use, e.g.
+*
+*   OpenGLSample --compress-texture images/egg.jpg images/egg.dds [bc1|bc3|auto] [fast|normal|high]
+*/
+class BlockCompressor
+{
+public:
+	/** \brief  Gets the bytes of one 4x4 block, 8 for BC1 and 16 for BC3. */
+	static size_t getBlockBytes(BlockFormat format);
+
+	/** \brief  Gets the bytes of an image of the given size, partial blocks count as whole ones. */
+	static size_t getImageBytes(int width, int height, BlockFormat format);
+
+	/** \brief  Picks BC3 for an RGBA8 image with any alpha below 255, BC1 otherwise. */
+	static BlockFormat chooseFormat(const unsigned char* rgba, int width, int height);
+
+	/** \brief  Compresses one RGBA8 image, rows in the order given. Edge blocks repeat the last row and column.
+	*   \param format  BC1 or BC3
+	*/
+	static void compress(const unsigned char* rgba, int width, int height, BlockFormat format, BlockQuality quality,
+		std::vector<unsigned char>& blocks);
+
+	/** \brief  Expands blocks back into RGBA8, e.g. to measure what the compression lost. */
+	static void decompress(const unsigned char* blocks, int width, int height, BlockFormat format, std::vector<unsigned char>& rgba);
+
+	/** \brief  Compresses an image and every level of its mip chain, levels[0] is the image itself.
+	*           Levels come from TextureCooker::generateMipChain(), down to 1x1.
+	*/
+	static void compressMipChain(const unsigned char* rgba, int width, int height, BlockFormat format, BlockQuality quality,
+		std::vector<std::vector<unsigned char> >& levels);
+
+	/** \brief  Writes levels as a DDS file with a DXT1 or DXT5 FourCC. */
+	static bool writeDDS(const char* path, int width, int height, BlockFormat format, const std::vector<std::vector<unsigned char> >& levels);
+
+	/** \brief  Loads an image file, compresses it with its mip chain and writes it as DDS. Prints what it did.
+	*           Rows are stored bottom up, like the TextureManager uploads images, so a DDS version of a
+	*           texture keeps the scene's texture coordinates.
+	*   \return True on success, errors are printed
+	*/
+	static bool compressFile(const char* imagePath, const char* ddsPath, BlockFormat format, BlockQuality quality);
+};
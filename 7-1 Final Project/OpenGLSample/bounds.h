@@ -0,0 +1,87 @@
+#ifndef BOUNDS_H
+#define BOUNDS_H
+
+#include <glm/glm.hpp>
+
+#include <cmath>
+#include <cfloat>
+#include <cstddef>
+#include <algorithm>
+
+// axis aligned bounding box
+struct AABB
+{
+	glm::vec3 min;
+	glm::vec3 max;
+};
+
+struct BoundingSphere
+{
+	glm::vec3 center;
+	float radius;
+};
+
+// bounds of interleaved vertex data with the position first; stride is in floats
+// ------------------------------------------------------------------------
+inline AABB computeAABB(const float* vertices, size_t vertexCount, size_t stride)
+{
+	AABB box;
+	box.min = glm::vec3(FLT_MAX);
+	box.max = glm::vec3(-FLT_MAX);
+	for (size_t i = 0; i < vertexCount; i++)
+	{
+		const float* p = vertices + i * stride;
+		box.min = glm::min(box.min, glm::vec3(p[0], p[1], p[2]));
+		box.max = glm::max(box.max, glm::vec3(p[0], p[1], p[2]));
+	}
+	return box;
+}
+
+// sphere around the box center that holds every vertex, tighter than the box's half diagonal
+inline BoundingSphere computeBoundingSphere(const float* vertices, size_t vertexCount, size_t stride, const AABB &box)
+{
+	BoundingSphere sphere;
+	sphere.center = (box.min + box.max) * 0.5f;
+	float radiusSquared = 0.0f;
+	for (size_t i = 0; i < vertexCount; i++)
+	{
+		const float* p = vertices + i * stride;
+		glm::vec3 d = glm::vec3(p[0], p[1], p[2]) - sphere.center;
+		radiusSquared = std::max(radiusSquared, glm::dot(d, d));
+	}
+	sphere.radius = std::sqrt(radiusSquared);
+	return sphere;
+}
+
+// ------------------------------------------------------------------------
+inline BoundingSphere transformBoundingSphere(const BoundingSphere &sphere, const glm::mat4 &model)
+{
+	// the largest axis scale keeps the sphere conservative under non-uniform scaling
+	float scaleX = glm::dot(glm::vec3(model[0]), glm::vec3(model[0]));
+	float scaleY = glm::dot(glm::vec3(model[1]), glm::vec3(model[1]));
+	float scaleZ = glm::dot(glm::vec3(model[2]), glm::vec3(model[2]));
+
+	BoundingSphere result;
+	result.center = glm::vec3(model * glm::vec4(sphere.center, 1.0f));
+	result.radius = sphere.radius * std::sqrt(std::max(scaleX, std::max(scaleY, scaleZ)));
+	return result;
+}
+
+// box around the transformed box (Arvo's method)
+inline AABB transformAABB(const AABB &box, const glm::mat4 &model)
+{
+	AABB result;
+	result.min = result.max = glm::vec3(model[3]);
+	for (int column = 0; column < 3; column++)
+	{
+		for (int row = 0; row < 3; row++)
+		{
+			float a = model[column][row] * box.min[column];
+			float b = model[column][row] * box.max[column];
+			result.min[row] += std::min(a, b);
+			result.max[row] += std::max(a, b);
+		}
+	}
+	return result;
+}
+#endif
@@ -0,0 +1,401 @@
+// STL
+#include <cfloat>
+#include <algorithm>
+
+// Project
+#include "bvh.h"
+
+namespace {
+
+	const uint32_t NO_PARENT = 0xFFFFFFFF;
+
+	AABB emptyBox()
+	{
+		AABB box;
+		box.min = glm::vec3(FLT_MAX);
+		box.max = glm::vec3(-FLT_MAX);
+		return box;
+	}
+
+	void grow(AABB& box, const AABB& other)
+	{
+		box.min = glm::min(box.min, other.min);
+		box.max = glm::max(box.max, other.max);
+	}
+
+	float surfaceArea(const AABB& box)
+	{
+		glm::vec3 e = box.max - box.min;
+		if (e.x < 0.0f)
+			return 0.0f;
+		return e.x * e.y + e.y * e.z + e.z * e.x;
+	}
+
+	bool sameBox(const AABB& a, const AABB& b)
+	{
+		return a.min == b.min && a.max == b.max;
+	}
+
+	// -1 outside, 0 intersecting, 1 fully inside
+	int classify(const Frustum& frustum, const AABB& box)
+	{
+		int result = 1;
+		for (int i = 0; i < 6; i++)
+		{
+			const glm::vec4& p = frustum.planes[i];
+			// corner furthest along the plane normal (p-vertex) and the one opposite to it
+			glm::vec3 positive(p.x >= 0.0f ? box.max.x : box.min.x, p.y >= 0.0f ? box.max.y : box.min.y, p.z >= 0.0f ? box.max.z : box.min.z);
+			glm::vec3 negative(p.x >= 0.0f ? box.min.x : box.max.x, p.y >= 0.0f ? box.min.y : box.max.y, p.z >= 0.0f ? box.min.z : box.max.z);
+			if (p.x * positive.x + p.y * positive.y + p.z * positive.z + p.w < 0.0f)
+				return -1;
+			if (p.x * negative.x + p.y * negative.y + p.z * negative.z + p.w < 0.0f)
+				result = 0;
+		}
+		return result;
+	}
+
+	bool overlaps(const BoundingSphere& sphere, const AABB& box)
+	{
+		glm::vec3 closest = glm::min(glm::max(sphere.center, box.min), box.max);
+		glm::vec3 d = closest - sphere.center;
+		return glm::dot(d, d) <= sphere.radius * sphere.radius;
+	}
+
+	// slab test, returns the entry distance or FLT_MAX on a miss
+	float intersect(const glm::vec3& origin, const glm::vec3& inverseDirection, float maxDistance, const AABB& box)
+	{
+		glm::vec3 t0 = (box.min - origin) * inverseDirection;
+		glm::vec3 t1 = (box.max - origin) * inverseDirection;
+		glm::vec3 tNear = glm::min(t0, t1);
+		glm::vec3 tFar = glm::max(t0, t1);
+		float enter = std::max(std::max(tNear.x, tNear.y), std::max(tNear.z, 0.0f));
+		float exit = std::min(std::min(tFar.x, tFar.y), std::min(tFar.z, maxDistance));
+		return enter <= exit ? enter : FLT_MAX;
+	}
+
+} // namespace
+
+void BVH::build(const std::vector<AABB>& bounds)
+{
+	const uint32_t count = (uint32_t)bounds.size();
+	_bounds = bounds;
+	_indices.resize(count);
+	_leaves.assign(count, 0);
+	_dirty.clear();
+	_nodes.clear();
+	_parents.clear();
+	if (count == 0)
+		return;
+
+	std::vector<glm::vec3> centroids(count);
+	for (uint32_t i = 0; i < count; i++)
+	{
+		_indices[i] = i;
+		centroids[i] = (bounds[i].min + bounds[i].max) * 0.5f;
+	}
+
+	// a binary tree with n leaves has at most 2n - 1 nodes
+	_nodes.reserve(2 * count);
+	_parents.reserve(2 * count);
+	Node root;
+	root.leftOrFirst = 0;
+	root.count = count;
+	_nodes.push_back(root);
+	_parents.push_back(NO_PARENT);
+	updateNodeBounds(0);
+	subdivide(0, centroids);
+}
+
+void BVH::subdivide(uint32_t rootNode, const std::vector<glm::vec3>& centroids)
+{
+	struct Bin
+	{
+		AABB bounds;
+		uint32_t count;
+	};
+
+	std::vector<uint32_t> stack(1, rootNode);
+	while (!stack.empty())
+	{
+		uint32_t nodeIndex = stack.back();
+		stack.pop_back();
+		const uint32_t first = _nodes[nodeIndex].leftOrFirst;
+		const uint32_t count = _nodes[nodeIndex].count;
+
+		AABB centroidBounds = emptyBox();
+		for (uint32_t i = 0; i < count; i++)
+		{
+			const glm::vec3& c = centroids[_indices[first + i]];
+			centroidBounds.min = glm::min(centroidBounds.min, c);
+			centroidBounds.max = glm::max(centroidBounds.max, c);
+		}
+
+		// best binned SAH split over all three axes
+		int bestAxis = -1;
+		int bestSplit = 0;
+		float bestCost = FLT_MAX;
+		for (int axis = 0; axis < 3 && count > 1; axis++)
+		{
+			float extent = centroidBounds.max[axis] - centroidBounds.min[axis];
+			if (extent <= 0.0f)
+				continue;
+			float scale = BIN_COUNT / extent;
+
+			Bin bins[BIN_COUNT];
+			for (int b = 0; b < BIN_COUNT; b++)
+			{
+				bins[b].bounds = emptyBox();
+				bins[b].count = 0;
+			}
+			for (uint32_t i = 0; i < count; i++)
+			{
+				uint32_t object = _indices[first + i];
+				int b = std::min(BIN_COUNT - 1, (int)((centroids[object][axis] - centroidBounds.min[axis]) * scale));
+				bins[b].count++;
+				grow(bins[b].bounds, _bounds[object]);
+			}
+
+			// sweep from both sides, split s puts bins [0, s) left and [s, BIN_COUNT) right
+			float leftArea[BIN_COUNT], rightArea[BIN_COUNT];
+			uint32_t leftCount[BIN_COUNT], rightCount[BIN_COUNT];
+			AABB leftBox = emptyBox(), rightBox = emptyBox();
+			uint32_t leftSum = 0, rightSum = 0;
+			for (int s = 1; s < BIN_COUNT; s++)
+			{
+				leftSum += bins[s - 1].count;
+				grow(leftBox, bins[s - 1].bounds);
+				leftCount[s] = leftSum;
+				leftArea[s] = surfaceArea(leftBox);
+
+				rightSum += bins[BIN_COUNT - s].count;
+				grow(rightBox, bins[BIN_COUNT - s].bounds);
+				rightCount[BIN_COUNT - s] = rightSum;
+				rightArea[BIN_COUNT - s] = surfaceArea(rightBox);
+			}
+			for (int s = 1; s < BIN_COUNT; s++)
+			{
+				if (leftCount[s] == 0 || rightCount[s] == 0)
+					continue;
+				float cost = leftCount[s] * leftArea[s] + rightCount[s] * rightArea[s];
+				if (cost < bestCost)
+				{
+					bestCost = cost;
+					bestAxis = axis;
+					bestSplit = s;
+				}
+			}
+		}
+
+		// stay a leaf when splitting is not cheaper than testing every object here
+		float leafCost = count * surfaceArea(_nodes[nodeIndex].bounds);
+		if (count <= (uint32_t)MAX_LEAF_SIZE && (bestAxis < 0 || bestCost >= leafCost))
+		{
+			for (uint32_t i = 0; i < count; i++)
+				_leaves[_indices[first + i]] = nodeIndex;
+			continue;
+		}
+
+		uint32_t leftCountTotal = count / 2;
+		if (bestAxis >= 0)
+		{
+			// partition the objects around the chosen bin boundary
+			float scale = BIN_COUNT / (centroidBounds.max[bestAxis] - centroidBounds.min[bestAxis]);
+			uint32_t* begin = &_indices[first];
+			uint32_t* middle = std::partition(begin, begin + count, [&](uint32_t object) {
+				int b = std::min(BIN_COUNT - 1, (int)((centroids[object][bestAxis] - centroidBounds.min[bestAxis]) * scale));
+				return b < bestSplit;
+			});
+			leftCountTotal = (uint32_t)(middle - begin);
+		}
+		// else all centroids coincide, any halving is as good as another
+
+		uint32_t left = (uint32_t)_nodes.size();
+		Node child;
+		child.leftOrFirst = first;
+		child.count = leftCountTotal;
+		_nodes.push_back(child);
+		child.leftOrFirst = first + leftCountTotal;
+		child.count = count - leftCountTotal;
+		_nodes.push_back(child);
+		_parents.push_back(nodeIndex);
+		_parents.push_back(nodeIndex);
+
+		_nodes[nodeIndex].leftOrFirst = left;
+		_nodes[nodeIndex].count = 0;
+		updateNodeBounds(left);
+		updateNodeBounds(left + 1);
+		stack.push_back(left);
+		stack.push_back(left + 1);
+	}
+}
+
+void BVH::updateNodeBounds(uint32_t nodeIndex)
+{
+	Node& node = _nodes[nodeIndex];
+	AABB box = emptyBox();
+	if (node.count > 0)
+	{
+		for (uint32_t i = 0; i < node.count; i++)
+			grow(box, _bounds[_indices[node.leftOrFirst + i]]);
+	}
+	else
+	{
+		grow(box, _nodes[node.leftOrFirst].bounds);
+		grow(box, _nodes[node.leftOrFirst + 1].bounds);
+	}
+	node.bounds = box;
+}
+
+void BVH::update(uint32_t object, const AABB& bounds)
+{
+	_bounds[object] = bounds;
+	_dirty.push_back(_leaves[object]);
+}
+
+void BVH::refit()
+{
+	// walk up from each touched leaf, a parent whose box did not change ends the walk
+	// because everything above it is still valid
+	for (size_t i = 0; i < _dirty.size(); i++)
+	{
+		uint32_t node = _dirty[i];
+		while (node != NO_PARENT)
+		{
+			AABB previous = _nodes[node].bounds;
+			updateNodeBounds(node);
+			if (sameBox(previous, _nodes[node].bounds) && node != _dirty[i])
+				break;
+			node = _parents[node];
+		}
+	}
+	_dirty.clear();
+}
+
+void BVH::queryFrustum(const Frustum& frustum, std::vector<uint32_t>& objects) const
+{
+	objects.clear();
+	if (_nodes.empty())
+		return;
+
+	// second member set: the node is fully inside, its subtree needs no more plane tests
+	std::vector<std::pair<uint32_t, bool>> stack;
+	stack.push_back(std::make_pair(0u, false));
+	while (!stack.empty())
+	{
+		uint32_t nodeIndex = stack.back().first;
+		bool inside = stack.back().second;
+		stack.pop_back();
+		const Node& node = _nodes[nodeIndex];
+
+		if (!inside)
+		{
+			int result = classify(frustum, node.bounds);
+			if (result < 0)
+				continue;
+			inside = result > 0;
+		}
+		if (node.count > 0)
+		{
+			for (uint32_t i = 0; i < node.count; i++)
+			{
+				uint32_t object = _indices[node.leftOrFirst + i];
+				if (inside || classify(frustum, _bounds[object]) >= 0)
+					objects.push_back(object);
+			}
+			continue;
+		}
+		stack.push_back(std::make_pair(node.leftOrFirst, inside));
+		stack.push_back(std::make_pair(node.leftOrFirst + 1, inside));
+	}
+}
+
+void BVH::querySphere(const BoundingSphere& sphere, std::vector<uint32_t>& objects) const
+{
+	objects.clear();
+	if (_nodes.empty())
+		return;
+
+	std::vector<uint32_t> stack(1, 0u);
+	while (!stack.empty())
+	{
+		const Node& node = _nodes[stack.back()];
+		stack.pop_back();
+		if (!overlaps(sphere, node.bounds))
+			continue;
+		if (node.count > 0)
+		{
+			for (uint32_t i = 0; i < node.count; i++)
+			{
+				uint32_t object = _indices[node.leftOrFirst + i];
+				if (overlaps(sphere, _bounds[object]))
+					objects.push_back(object);
+			}
+			continue;
+		}
+		stack.push_back(node.leftOrFirst);
+		stack.push_back(node.leftOrFirst + 1);
+	}
+}
+
+bool BVH::raycast(const Ray& ray, float maxDistance, uint32_t& object, float& distance) const
+{
+	if (_nodes.empty())
+		return false;
+
+	// IEEE division gives +-inf for axis parallel rays, which the slab test handles
+	glm::vec3 inverseDirection(1.0f / ray.direction.x, 1.0f / ray.direction.y, 1.0f / ray.direction.z);
+	float nearest = maxDistance;
+	bool hit = false;
+
+	std::vector<uint32_t> stack;
+	if (intersect(ray.origin, inverseDirection, nearest, _nodes[0].bounds) != FLT_MAX)
+		stack.push_back(0);
+	while (!stack.empty())
+	{
+		const Node& node = _nodes[stack.back()];
+		stack.pop_back();
+		if (node.count > 0)
+		{
+			for (uint32_t i = 0; i < node.count; i++)
+			{
+				uint32_t candidate = _indices[node.leftOrFirst + i];
+				float t = intersect(ray.origin, inverseDirection, nearest, _bounds[candidate]);
+				if (t != FLT_MAX && t <= nearest)
+				{
+					nearest = t;
+					object = candidate;
+					hit = true;
+				}
+			}
+			continue;
+		}
+
+		// visit the nearer child first so the far one is often rejected by the shrunk distance
+		uint32_t left = node.leftOrFirst;
+		uint32_t right = node.leftOrFirst + 1;
+		float tLeft = intersect(ray.origin, inverseDirection, nearest, _nodes[left].bounds);
+		float tRight = intersect(ray.origin, inverseDirection, nearest, _nodes[right].bounds);
+		if (tLeft > tRight)
+		{
+			std::swap(left, right);
+			std::swap(tLeft, tRight);
+		}
+		if (tRight != FLT_MAX)
+			stack.push_back(right);
+		if (tLeft != FLT_MAX)
+			stack.push_back(left);
+	}
+	if (hit)
+		distance = nearest;
+	return hit;
+}
+
+size_t BVH::size() const
+{
+	return _bounds.size();
+}
+
+size_t BVH::nodeCount() const
+{
+	return _nodes.size();
+}
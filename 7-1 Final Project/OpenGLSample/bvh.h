@@ -0,0 +1,75 @@
+#pragma once
+
+// STL
+#include <vector>
+#include <cstdint>
+
+// GLM
+#include <glm/glm.hpp>
+
+// Project
+#include "bounds.h"
+#include "frustumCuller.h"
+
+struct Ray
+{
+	glm::vec3 origin;
+	glm::vec3 direction; // does not have to be normalized, hit distances are in units of its length
+};
+
+/**
+* Bounding volume hierarchy over object AABBs. Built top down with binned SAH splits;
+* when objects move their boxes are updated and the tree is refit instead of rebuilt.
+* Queries report object indices, i.e. positions in the array passed to build().
+*/
+class BVH
+{
+public:
+	static const int BIN_COUNT = 16; // SAH candidate splits per axis
+	static const int MAX_LEAF_SIZE = 4; // larger nodes are always split
+
+	/** \brief  Builds the tree over the given boxes, object i is bounds[i]. */
+	void build(const std::vector<AABB>& bounds);
+
+	/** \brief  Changes the box of an object. The tree is updated on the next refit(). */
+	void update(uint32_t object, const AABB& bounds);
+
+	/** \brief  Refits the nodes above every updated object. The topology is kept, so after
+	*           large movements a rebuild gives faster queries.
+	*/
+	void refit();
+
+	/** \brief  Collects objects whose box is inside or intersects the frustum. */
+	void queryFrustum(const Frustum& frustum, std::vector<uint32_t>& objects) const;
+
+	/** \brief  Collects objects whose box overlaps the sphere. */
+	void querySphere(const BoundingSphere& sphere, std::vector<uint32_t>& objects) const;
+
+	/** \brief  Finds the nearest object box hit by the ray.
+	*   \param maxDistance  Hits further away are ignored
+	*   \return True on a hit, object and distance are only written then
+	*/
+	bool raycast(const Ray& ray, float maxDistance, uint32_t& object, float& distance) const;
+
+	size_t size() const;
+	size_t nodeCount() const;
+
+private:
+	// children are always allocated as a pair, the right child is leftOrFirst + 1
+	struct Node
+	{
+		AABB bounds;
+		uint32_t leftOrFirst; // inner node: left child, leaf: first entry in _indices
+		uint32_t count; // 0 for inner nodes
+	};
+
+	std::vector<Node> _nodes;
+	std::vector<uint32_t> _indices; // object indices, grouped by leaf
+	std::vector<AABB> _bounds; // per object
+	std::vector<uint32_t> _parents; // per node
+	std::vector<uint32_t> _leaves; // per object, the leaf holding it
+	std::vector<uint32_t> _dirty; // leaves touched by update()
+
+	void subdivide(uint32_t node, const std::vector<glm::vec3>& centroids);
+	void updateNodeBounds(uint32_t node);
+};
@@ -0,0 +1,152 @@
+// STL
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <iostream>
+#include <algorithm>
+#include <cmath>
+
+// Project
+#include "cameraPath.h"
+
+namespace {
+
+	// uniform Catmull-Rom between p1 and p2
+	glm::vec3 catmullRom(const glm::vec3& p0, const glm::vec3& p1, const glm::vec3& p2, const glm::vec3& p3, float t)
+	{
+		float t2 = t * t;
+		float t3 = t2 * t;
+		return 0.5f * ((2.0f * p1) + (p2 - p0) * t + (2.0f * p0 - 5.0f * p1 + 4.0f * p2 - p3) * t2
+			+ (3.0f * p1 - p0 - 3.0f * p2 + p3) * t3);
+	}
+
+} // namespace
+
+bool CameraPath::load(const char* path)
+{
+	std::ifstream file(path);
+	if (!file.is_open())
+	{
+		std::cout << "ERROR::CAMERA_PATH::FILE_NOT_SUCCESFULLY_READ: " << path << std::endl;
+		return false;
+	}
+
+	clear();
+	std::string line;
+	int lineNumber = 0;
+	while (std::getline(file, line))
+	{
+		lineNumber++;
+		size_t comment = line.find('#');
+		if (comment != std::string::npos)
+			line.erase(comment);
+
+		std::istringstream tokens(line);
+		CameraKeyframe keyframe;
+		if (!(tokens >> keyframe.time))
+			continue;
+		if (!(tokens >> keyframe.position.x >> keyframe.position.y >> keyframe.position.z >> keyframe.yaw >> keyframe.pitch))
+		{
+			std::cout << "ERROR::CAMERA_PATH::" << path << "(" << lineNumber << "): expected: <time> <x> <y> <z> <yaw> <pitch> [fov]" << std::endl;
+			return false;
+		}
+		if (!(tokens >> keyframe.fov))
+			keyframe.fov = 45.0f;
+		if (!_keyframes.empty() && keyframe.time < _keyframes.back().time)
+		{
+			std::cout << "ERROR::CAMERA_PATH::" << path << "(" << lineNumber << "): keyframes have to be ordered by time" << std::endl;
+			return false;
+		}
+		_keyframes.push_back(keyframe);
+	}
+	if (_keyframes.empty())
+	{
+		std::cout << "ERROR::CAMERA_PATH::" << path << ": no keyframes" << std::endl;
+		return false;
+	}
+	return true;
+}
+
+bool CameraPath::save(const char* path) const
+{
+	std::ofstream file(path);
+	if (!file.is_open())
+	{
+		std::cout << "ERROR::CAMERA_PATH::CANNOT_WRITE " << path << std::endl;
+		return false;
+	}
+	file << "# time  x y z  yaw pitch  fov\n";
+	for (size_t i = 0; i < _keyframes.size(); i++)
+	{
+		const CameraKeyframe& k = _keyframes[i];
+		file << k.time << " " << k.position.x << " " << k.position.y << " " << k.position.z << " "
+			<< k.yaw << " " << k.pitch << " " << k.fov << "\n";
+	}
+	return file.good();
+}
+
+void CameraPath::clear()
+{
+	_keyframes.clear();
+}
+
+void CameraPath::add(const CameraKeyframe& keyframe)
+{
+	_keyframes.push_back(keyframe);
+}
+
+bool CameraPath::empty() const
+{
+	return _keyframes.empty();
+}
+
+double CameraPath::getDuration() const
+{
+	return _keyframes.empty() ? 0.0 : _keyframes.back().time - _keyframes.front().time;
+}
+
+const std::vector<CameraKeyframe>& CameraPath::keyframes() const
+{
+	return _keyframes;
+}
+
+CameraKeyframe CameraPath::sample(double time) const
+{
+	if (_keyframes.empty())
+	{
+		CameraKeyframe origin = { time, glm::vec3(0.0f), -90.0f, 0.0f, 45.0f };
+		return origin;
+	}
+	time += _keyframes.front().time;
+	if (time <= _keyframes.front().time)
+		return _keyframes.front();
+	if (time >= _keyframes.back().time)
+		return _keyframes.back();
+
+	// segment i .. i + 1 holds the time
+	size_t i = 0;
+	while (_keyframes[i + 1].time <= time)
+		i++;
+	const CameraKeyframe& a = _keyframes[i];
+	const CameraKeyframe& b = _keyframes[i + 1];
+	const CameraKeyframe& before = _keyframes[i > 0 ? i - 1 : i];
+	const CameraKeyframe& after = _keyframes[std::min(i + 2, _keyframes.size() - 1)];
+	float t = (float)((time - a.time) / (b.time - a.time));
+
+	CameraKeyframe pose;
+	pose.time = time;
+	pose.position = catmullRom(before.position, a.position, b.position, after.position, t);
+	pose.yaw = a.yaw + (b.yaw - a.yaw) * t;
+	pose.pitch = a.pitch + (b.pitch - a.pitch) * t;
+	pose.fov = a.fov + (b.fov - a.fov) * t;
+	return pose;
+}
+
+glm::vec3 CameraPath::frontFromAngles(float yaw, float pitch)
+{
+	glm::vec3 front;
+	front.x = cos(glm::radians(yaw)) * cos(glm::radians(pitch));
+	front.y = sin(glm::radians(pitch));
+	front.z = sin(glm::radians(yaw)) * cos(glm::radians(pitch));
+	return glm::normalize(front);
+}
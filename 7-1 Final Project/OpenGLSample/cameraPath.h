@@ -0,0 +1,57 @@
+#pragma once
+
+// STL
+#include <vector>
+
+// GLM
+#include <glm/glm.hpp>
+
+/**
+* Camera pose at one point in time, angles in degrees like the mouse controls use them.
+*/
+struct CameraKeyframe
+{
+	double time; // seconds from the start of the path
+	glm::vec3 position;
+	float yaw;
+	float pitch;
+	float fov;
+};
+
+/**
+* Scripted camera: keyframes sampled at any time in between. Positions follow a Catmull-Rom
+* spline through the keyframes, angles and fov are blended linearly. Text format, one
+* keyframe per line, ordered by time:
+*
+*   # time  x y z  yaw pitch  [fov]
+*   0.0     -1 0 5  -90 0     45
+*/
+class CameraPath
+{
+public:
+	/** \brief  Loads a path file.
+	*   \return True on success, errors are printed.
+	*/
+	bool load(const char* path);
+
+	/** \brief  Writes the keyframes in the format load() reads, e.g. after recording a flight. */
+	bool save(const char* path) const;
+
+	void clear();
+
+	/** \brief  Appends a keyframe, its time must not be before the last one's. */
+	void add(const CameraKeyframe& keyframe);
+
+	bool empty() const;
+	double getDuration() const;
+	const std::vector<CameraKeyframe>& keyframes() const;
+
+	/** \brief  Gets the pose at a time, clamped to the first and last keyframe. */
+	CameraKeyframe sample(double time) const;
+
+	/** \brief  Gets the view direction for yaw / pitch in degrees, same convention as the mouse callback. */
+	static glm::vec3 frontFromAngles(float yaw, float pitch);
+
+private:
+	std::vector<CameraKeyframe> _keyframes;
+};
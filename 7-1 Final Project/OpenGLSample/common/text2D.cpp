@@ -1,124 +1,253 @@
-#include <vector>
-#include <cstring>
-
-#include <GL/glew.h>
-
-#include <glm/glm.hpp>
-#include <glm/gtc/matrix_transform.hpp>
-using namespace glm;
-
-#include "shader.hpp"
-#include "texture.hpp"
-
-#include "text2D.hpp"
-
-unsigned int Text2DTextureID;
-unsigned int Text2DVertexBufferID;
-unsigned int Text2DUVBufferID;
-unsigned int Text2DShaderID;
-unsigned int Text2DUniformID;
-
-void initText2D(const char * texturePath){
-
-	// Initialize texture
-	Text2DTextureID = loadDDS(texturePath);
-
-	// Initialize VBO
-	glGenBuffers(1, &Text2DVertexBufferID);
-	glGenBuffers(1, &Text2DUVBufferID);
-
-	// Initialize Shader
-	Text2DShaderID = LoadShaders( "TextVertexShader.vertexshader", "TextVertexShader.fragmentshader" );
-
-	// Initialize uniforms' IDs
-	Text2DUniformID = glGetUniformLocation( Text2DShaderID, "myTextureSampler" );
-
-}
-
-void printText2D(const char * text, int x, int y, int size){
-
-	unsigned int length = strlen(text);
-
-	// Fill buffers
-	std::vector<glm::vec2> vertices;
-	std::vector<glm::vec2> UVs;
-	for ( unsigned int i=0 ; i<length ; i++ ){
-		
-		glm::vec2 vertex_up_left    = glm::vec2( x+i*size     , y+size );
-		glm::vec2 vertex_up_right   = glm::vec2( x+i*size+size, y+size );
-		glm::vec2 vertex_down_right = glm::vec2( x+i*size+size, y      );
-		glm::vec2 vertex_down_left  = glm::vec2( x+i*size     , y      );
-
-		vertices.push_back(vertex_up_left   );
-		vertices.push_back(vertex_down_left );
-		vertices.push_back(vertex_up_right  );
-
-		vertices.push_back(vertex_down_right);
-		vertices.push_back(vertex_up_right);
-		vertices.push_back(vertex_down_left);
-
-		char character = text[i];
-		float uv_x = (character%16)/16.0f;
-		float uv_y = (character/16)/16.0f;
-
-		glm::vec2 uv_up_left    = glm::vec2( uv_x           , uv_y );
-		glm::vec2 uv_up_right   = glm::vec2( uv_x+1.0f/16.0f, uv_y );
-		glm::vec2 uv_down_right = glm::vec2( uv_x+1.0f/16.0f, (uv_y + 1.0f/16.0f) );
-		glm::vec2 uv_down_left  = glm::vec2( uv_x           , (uv_y + 1.0f/16.0f) );
-		UVs.push_back(uv_up_left   );
-		UVs.push_back(uv_down_left );
-		UVs.push_back(uv_up_right  );
-
-		UVs.push_back(uv_down_right);
-		UVs.push_back(uv_up_right);
-		UVs.push_back(uv_down_left);
-	}
-	glBindBuffer(GL_ARRAY_BUFFER, Text2DVertexBufferID);
-	glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(glm::vec2), &vertices[0], GL_STATIC_DRAW);
-	glBindBuffer(GL_ARRAY_BUFFER, Text2DUVBufferID);
-	glBufferData(GL_ARRAY_BUFFER, UVs.size() * sizeof(glm::vec2), &UVs[0], GL_STATIC_DRAW);
-
-	// Bind shader
-	glUseProgram(Text2DShaderID);
-
-	// Bind texture
-	glActiveTexture(GL_TEXTURE0);
-	glBindTexture(GL_TEXTURE_2D, Text2DTextureID);
-	// Set our "myTextureSampler" sampler to use Texture Unit 0
-	glUniform1i(Text2DUniformID, 0);
-
-	// 1rst attribute buffer : vertices
-	glEnableVertexAttribArray(0);
-	glBindBuffer(GL_ARRAY_BUFFER, Text2DVertexBufferID);
-	glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 0, (void*)0 );
-
-	// 2nd attribute buffer : UVs
-	glEnableVertexAttribArray(1);
-	glBindBuffer(GL_ARRAY_BUFFER, Text2DUVBufferID);
-	glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 0, (void*)0 );
-
-	glEnable(GL_BLEND);
-	glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-
-	// Draw call
-	glDrawArrays(GL_TRIANGLES, 0, vertices.size() );
-
-	glDisable(GL_BLEND);
-
-	glDisableVertexAttribArray(0);
-	glDisableVertexAttribArray(1);
-
-}
-
-void cleanupText2D(){
-
-	// Delete buffers
-	glDeleteBuffers(1, &Text2DVertexBufferID);
-	glDeleteBuffers(1, &Text2DUVBufferID);
-
-	// Delete texture
-	glDeleteTextures(1, &Text2DTextureID);
-
-	// Delete shader
-	glDeleteProgram(Text2DShaderID);
-}
+#include <vector>
+#include <cstring>
+#include <algorithm>
+
+#include <glad/glad.h>
+
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+using namespace glm;
+
+#include "texture.hpp"
+
+#include "text2D.hpp"
+#include "../glStateCache.h"
+#include "../shader.h"
+
+// one corner of a glyph quad, position and UV interleaved so a frame of text is one buffer range
+struct Text2DVertex
+{
+	float x, y;
+	float u, v;
+};
+
+// the vertex buffer is a ring; every drawText2D() appends its batch behind the previous one without
+// synchronizing, and only when the end is reached the storage is orphaned and writing starts over
+const unsigned int TEXT2D_MAX_CHARACTERS = 4096;	// per drawText2D(), more are dropped
+const unsigned int TEXT2D_RING_VERTICES = TEXT2D_MAX_CHARACTERS * 6 * 4;
+
+unsigned int Text2DTextureID;
+unsigned int Text2DVertexArrayID;
+unsigned int Text2DVertexBufferID;
+Shader Text2DShader;
+float Text2DAdvance;	// horizontal distance between characters, in glyph heights
+std::vector<Text2DVertex> Text2DVertices;	// queued since the last drawText2D(), the capacity is kept
+unsigned int Text2DRingOffset;	// in vertices
+
+// Built-in font: 3x5 glyphs, '#' set, top row first. Letters are upper case only,
+// lower case text is drawn with the upper case glyphs.
+struct Text2DGlyph
+{
+	char character;
+	const char* rows[5];
+};
+const Text2DGlyph TEXT2D_GLYPHS[] = {
+	{ '0', { "###", "#.#", "#.#", "#.#", "###" } }, { '1', { ".#.", "##.", ".#.", ".#.", "###" } },
+	{ '2', { "###", "..#", "###", "#..", "###" } }, { '3', { "###", "..#", "###", "..#", "###" } },
+	{ '4', { "#.#", "#.#", "###", "..#", "..#" } }, { '5', { "###", "#..", "###", "..#", "###" } },
+	{ '6', { "###", "#..", "###", "#.#", "###" } }, { '7', { "###", "..#", "..#", "..#", "..#" } },
+	{ '8', { "###", "#.#", "###", "#.#", "###" } }, { '9', { "###", "#.#", "###", "..#", "###" } },
+	{ 'A', { ".#.", "#.#", "###", "#.#", "#.#" } }, { 'B', { "##.", "#.#", "##.", "#.#", "##." } },
+	{ 'C', { ".##", "#..", "#..", "#..", ".##" } }, { 'D', { "##.", "#.#", "#.#", "#.#", "##." } },
+	{ 'E', { "###", "#..", "##.", "#..", "###" } }, { 'F', { "###", "#..", "##.", "#..", "#.." } },
+	{ 'G', { ".##", "#..", "#.#", "#.#", ".##" } }, { 'H', { "#.#", "#.#", "###", "#.#", "#.#" } },
+	{ 'I', { "###", ".#.", ".#.", ".#.", "###" } }, { 'J', { "..#", "..#", "..#", "#.#", ".#." } },
+	{ 'K', { "#.#", "#.#", "##.", "#.#", "#.#" } }, { 'L', { "#..", "#..", "#..", "#..", "###" } },
+	{ 'M', { "#.#", "###", "###", "#.#", "#.#" } }, { 'N', { "##.", "#.#", "#.#", "#.#", "#.#" } },
+	{ 'O', { ".#.", "#.#", "#.#", "#.#", ".#." } }, { 'P', { "##.", "#.#", "##.", "#..", "#.." } },
+	{ 'Q', { ".#.", "#.#", "#.#", "##.", ".##" } }, { 'R', { "##.", "#.#", "##.", "#.#", "#.#" } },
+	{ 'S', { ".##", "#..", ".#.", "..#", "##." } }, { 'T', { "###", ".#.", ".#.", ".#.", ".#." } },
+	{ 'U', { "#.#", "#.#", "#.#", "#.#", "###" } }, { 'V', { "#.#", "#.#", "#.#", "#.#", ".#." } },
+	{ 'W', { "#.#", "#.#", "###", "###", "#.#" } }, { 'X', { "#.#", "#.#", ".#.", "#.#", "#.#" } },
+	{ 'Y', { "#.#", "#.#", ".#.", ".#.", ".#." } }, { 'Z', { "###", "..#", ".#.", "#..", "###" } },
+	{ '.', { "...", "...", "...", "...", ".#." } }, { ',', { "...", "...", "...", ".#.", "#.." } },
+	{ ':', { "...", ".#.", "...", ".#.", "..." } }, { ';', { "...", ".#.", "...", ".#.", "#.." } },
+	{ '/', { "..#", "..#", ".#.", "#..", "#.." } }, { '%', { "#.#", "..#", ".#.", "#..", "#.#" } },
+	{ '-', { "...", "...", "###", "...", "..." } }, { '+', { "...", ".#.", "###", ".#.", "..." } },
+	{ '=', { "...", "###", "...", "###", "..." } }, { '_', { "...", "...", "...", "...", "###" } },
+	{ '(', { "..#", ".#.", ".#.", ".#.", "..#" } }, { ')', { "#..", ".#.", ".#.", ".#.", "#.." } },
+	{ '[', { ".##", ".#.", ".#.", ".#.", ".##" } }, { ']', { "##.", ".#.", ".#.", ".#.", "##." } },
+	{ '<', { "..#", ".#.", "#..", ".#.", "..#" } }, { '>', { "#..", ".#.", "..#", ".#.", "#.." } },
+	{ '!', { ".#.", ".#.", ".#.", "...", ".#." } }, { '?', { "##.", "..#", ".#.", "...", ".#." } },
+	{ '#', { "#.#", "###", "#.#", "###", "#.#" } }, { '*', { "...", "#.#", ".#.", "#.#", "..." } },
+	{ '|', { ".#.", ".#.", ".#.", ".#.", ".#." } }, { '\'', { ".#.", ".#.", "...", "...", "..." } },
+	{ '"', { "#.#", "#.#", "...", "...", "..." } },
+};
+const int TEXT2D_CELL = 6;	// texels per glyph cell, the glyph sits in the top left 3x5 with a texel of space around it
+
+// a 16x16 grid of cells, white with the glyphs in alpha, the same layout a font DDS has
+unsigned int createBuiltInFont(){
+
+	const int size = 16 * TEXT2D_CELL;
+	std::vector<unsigned char> pixels(size * size * 4, 0);
+	for (size_t i = 0; i < sizeof(TEXT2D_GLYPHS) / sizeof(TEXT2D_GLYPHS[0]); i++){
+		const Text2DGlyph& glyph = TEXT2D_GLYPHS[i];
+		const int characters[2] = { glyph.character, glyph.character >= 'A' && glyph.character <= 'Z' ? glyph.character - 'A' + 'a' : -1 };
+		for (int c = 0; c < 2; c++){
+			if (characters[c] < 0)
+				continue;
+			// first image row is v = 0, which printText2D() maps to the top of a glyph
+			int cellX = (characters[c] % 16) * TEXT2D_CELL + 1;
+			int cellY = (characters[c] / 16) * TEXT2D_CELL;
+			for (int row = 0; row < 5; row++){
+				for (int column = 0; column < 3; column++){
+					unsigned char* texel = &pixels[((cellY + row) * size + cellX + column) * 4];
+					texel[0] = texel[1] = texel[2] = 255;
+					texel[3] = glyph.rows[row][column] == '#' ? 255 : 0;
+				}
+			}
+		}
+	}
+
+	GLStateCache& glState = GLStateCache::get();
+	unsigned int texture;
+	glGenTextures(1, &texture);
+	glState.bindTexture(0, GL_TEXTURE_2D, texture);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+	// nearest keeps the pixel font sharp at whole multiples of its size
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+	glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, size, size, 0, GL_RGBA, GL_UNSIGNED_BYTE, pixels.data());
+	return texture;
+}
+
+void initText2D(const char * texturePath){
+
+	// Initialize texture
+	if (texturePath != NULL){
+		Text2DTextureID = loadDDS(texturePath);
+		Text2DAdvance = 1.0f;
+	}
+	else{
+		Text2DTextureID = createBuiltInFont();
+		Text2DAdvance = 4.0f / TEXT2D_CELL;	// glyph plus one texel, the quads overlap on transparent texels
+	}
+
+	// Initialize VBO, allocated once; drawText2D() only maps ranges of it
+	GLStateCache& glState = GLStateCache::get();
+	glGenBuffers(1, &Text2DVertexBufferID);
+	glState.bindBuffer(GL_ARRAY_BUFFER, Text2DVertexBufferID);
+	glBufferData(GL_ARRAY_BUFFER, TEXT2D_RING_VERTICES * sizeof(Text2DVertex), NULL, GL_STREAM_DRAW);
+	Text2DRingOffset = 0;
+	Text2DVertices.reserve(TEXT2D_MAX_CHARACTERS * 6);
+
+	// Initialize VAO, the attribute layout never changes so it is recorded once here
+	glGenVertexArrays(1, &Text2DVertexArrayID);
+	glState.bindVertexArray(Text2DVertexArrayID);
+
+	// 1rst attribute : vertices
+	glEnableVertexAttribArray(0);
+	glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, sizeof(Text2DVertex), (void*)0 );
+
+	// 2nd attribute : UVs
+	glEnableVertexAttribArray(1);
+	glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, sizeof(Text2DVertex), (void*)(2 * sizeof(float)) );
+
+	// Initialize Shader
+	Text2DShader = Shader("shaderfiles/text2D.vs", "shaderfiles/text2D.fs");
+	Text2DShader.use();
+	Text2DShader.setInt("font", 0);
+
+}
+
+void printText2D(const char * text, int x, int y, int size){
+
+	unsigned int length = strlen(text);
+	unsigned int room = TEXT2D_MAX_CHARACTERS - (unsigned int)Text2DVertices.size() / 6;
+	length = std::min(length, room);
+
+	// Fill the batch, the vector keeps its capacity between frames so this does not allocate
+	size_t first = Text2DVertices.size();
+	Text2DVertices.resize(first + length * 6);
+	Text2DVertex* vertex = &Text2DVertices[first];
+	const float cell = 1.0f / 16.0f;
+	for ( unsigned int i=0 ; i<length ; i++ ){
+
+		float left = x + i * size * Text2DAdvance;
+		float right = left + size;
+		float bottom = (float)y;
+		float top = (float)(y + size);
+
+		unsigned char character = text[i];
+		float uv_x = (character%16)/16.0f;
+		float uv_y = (character/16)/16.0f;
+
+		Text2DVertex up_left    = { left , top   , uv_x       , uv_y        };
+		Text2DVertex up_right   = { right, top   , uv_x + cell, uv_y        };
+		Text2DVertex down_right = { right, bottom, uv_x + cell, uv_y + cell };
+		Text2DVertex down_left  = { left , bottom, uv_x       , uv_y + cell };
+
+		*vertex++ = up_left;
+		*vertex++ = down_left;
+		*vertex++ = up_right;
+
+		*vertex++ = down_right;
+		*vertex++ = up_right;
+		*vertex++ = down_left;
+	}
+
+}
+
+void drawText2D(int canvasWidth, int canvasHeight){
+
+	GLsizei count = (GLsizei)Text2DVertices.size();
+	if (count == 0)
+		return;
+
+	// Append the batch to the ring; the GPU may still read earlier ranges, so a full ring is
+	// orphaned (the driver hands out fresh storage) instead of overwritten
+	GLStateCache& glState = GLStateCache::get();
+	glState.bindBuffer(GL_ARRAY_BUFFER, Text2DVertexBufferID);
+	if (Text2DRingOffset + count > TEXT2D_RING_VERTICES){
+		glBufferData(GL_ARRAY_BUFFER, TEXT2D_RING_VERTICES * sizeof(Text2DVertex), NULL, GL_STREAM_DRAW);
+		Text2DRingOffset = 0;
+	}
+	void* destination = glMapBufferRange(GL_ARRAY_BUFFER, Text2DRingOffset * sizeof(Text2DVertex), count * sizeof(Text2DVertex),
+		GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT | GL_MAP_UNSYNCHRONIZED_BIT);
+	if (destination == NULL){
+		Text2DVertices.clear();
+		return;
+	}
+	memcpy(destination, &Text2DVertices[0], count * sizeof(Text2DVertex));
+	glUnmapBuffer(GL_ARRAY_BUFFER);
+
+	// Bind shader and texture
+	Text2DShader.use();
+	Text2DShader.setVec2("canvasSize", (float)canvasWidth, (float)canvasHeight);
+	glState.bindTexture(0, GL_TEXTURE_2D, Text2DTextureID);
+	glState.bindVertexArray(Text2DVertexArrayID);
+
+	// text goes over everything, blended, and leaves depth alone
+	glState.setDepthTest(false);
+	glState.setBlend(true);
+	glState.setBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+
+	// Draw call, one for all strings of the frame
+	glDrawArrays(GL_TRIANGLES, Text2DRingOffset, count );
+
+	glState.setBlend(false);
+	glState.setDepthTest(true);
+
+	Text2DRingOffset += count;
+	Text2DVertices.clear();
+
+}
+
+void cleanupText2D(){
+
+	GLStateCache& glState = GLStateCache::get();
+
+	// Delete buffers
+	glState.deleteVertexArray(Text2DVertexArrayID);
+	glState.deleteBuffer(Text2DVertexBufferID);
+
+	// Delete texture
+	glState.deleteTexture(Text2DTextureID);
+
+	// Delete shader
+	glState.deleteProgram(Text2DShader.ID);
+	Text2DShader.ID = 0;
+	Text2DVertices.clear();
+}
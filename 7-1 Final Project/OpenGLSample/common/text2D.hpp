@@ -1,8 +1,12 @@
-#ifndef TEXT2D_HPP
-#define TEXT2D_HPP
-
-void initText2D(const char * texturePath);
-void printText2D(const char * text, int x, int y, int size);
-void cleanupText2D();
-
-#endif
\ No newline at end of file
+#ifndef TEXT2D_HPP
+#define TEXT2D_HPP
+
+// Loads the font (a .DDS with a 16x16 grid of glyphs in ASCII order), NULL uses the built-in 3x5 font
+void initText2D(const char * texturePath);
+// Queues a string; x, y is the lower left corner in pixels of the canvas drawText2D() gets, size is the glyph height
+void printText2D(const char * text, int x, int y, int size);
+// Draws everything queued since the last call with a single draw call, canvasWidth x canvasHeight pixels cover the viewport
+void drawText2D(int canvasWidth = 800, int canvasHeight = 600);
+void cleanupText2D();
+
+#endif
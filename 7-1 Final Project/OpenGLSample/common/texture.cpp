@@ -1,218 +1,770 @@
-#include <stdio.h>
-#include <stdlib.h>
-#include <string.h>
-
-#include <GL/glew.h>
-
-#include <GLFW/glfw3.h>
-
-
-GLuint loadBMP_custom(const char * imagepath){
-
-	printf("Reading image %s\n", imagepath);
-
-	// Data read from the header of the BMP file
-	unsigned char header[54];
-	unsigned int dataPos;
-	unsigned int imageSize;
-	unsigned int width, height;
-	// Actual RGB data
-	unsigned char * data;
-
-	// Open the file
-	FILE * file = fopen(imagepath,"rb");
-	if (!file){
-		printf("%s could not be opened. Are you in the right directory ? Don't forget to read the FAQ !\n", imagepath);
-		getchar();
-		return 0;
-	}
-
-	// Read the header, i.e. the 54 first bytes
-
-	// If less than 54 bytes are read, problem
-	if ( fread(header, 1, 54, file)!=54 ){ 
-		printf("Not a correct BMP file\n");
-		fclose(file);
-		return 0;
-	}
-	// A BMP files always begins with "BM"
-	if ( header[0]!='B' || header[1]!='M' ){
-		printf("Not a correct BMP file\n");
-		fclose(file);
-		return 0;
-	}
-	// Make sure this is a 24bpp file
-	if ( *(int*)&(header[0x1E])!=0  )         {printf("Not a correct BMP file\n");    fclose(file); return 0;}
-	if ( *(int*)&(header[0x1C])!=24 )         {printf("Not a correct BMP file\n");    fclose(file); return 0;}
-
-	// Read the information about the image
-	dataPos    = *(int*)&(header[0x0A]);
-	imageSize  = *(int*)&(header[0x22]);
-	width      = *(int*)&(header[0x12]);
-	height     = *(int*)&(header[0x16]);
-
-	// Some BMP files are misformatted, guess missing information
-	if (imageSize==0)    imageSize=width*height*3; // 3 : one byte for each Red, Green and Blue component
-	if (dataPos==0)      dataPos=54; // The BMP header is done that way
-
-	// Create a buffer
-	data = new unsigned char [imageSize];
-
-	// Read the actual data from the file into the buffer
-	fread(data,1,imageSize,file);
-
-	// Everything is in memory now, the file can be closed.
-	fclose (file);
-
-	// Create one OpenGL texture
-	GLuint textureID;
-	glGenTextures(1, &textureID);
-	
-	// "Bind" the newly created texture : all future texture functions will modify this texture
-	glBindTexture(GL_TEXTURE_2D, textureID);
-
-	// Give the image to OpenGL
-	glTexImage2D(GL_TEXTURE_2D, 0,GL_RGB, width, height, 0, GL_BGR, GL_UNSIGNED_BYTE, data);
-
-	// OpenGL has now copied the data. Free our own version
-	delete [] data;
-
-	// Poor filtering, or ...
-	//glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
-	//glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST); 
-
-	// ... nice trilinear filtering ...
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
-	// ... which requires mipmaps. Generate them automatically.
-	glGenerateMipmap(GL_TEXTURE_2D);
-
-	// Return the ID of the texture we just created
-	return textureID;
-}
-
-// Since GLFW 3, glfwLoadTexture2D() has been removed. You have to use another texture loading library, 
-// or do it yourself (just like loadBMP_custom and loadDDS)
-//GLuint loadTGA_glfw(const char * imagepath){
-//
-//	// Create one OpenGL texture
-//	GLuint textureID;
-//	glGenTextures(1, &textureID);
-//
-//	// "Bind" the newly created texture : all future texture functions will modify this texture
-//	glBindTexture(GL_TEXTURE_2D, textureID);
-//
-//	// Read the file, call glTexImage2D with the right parameters
-//	glfwLoadTexture2D(imagepath, 0);
-//
-//	// Nice trilinear filtering.
-//	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-//	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-//	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-//	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR); 
-//	glGenerateMipmap(GL_TEXTURE_2D);
-//
-//	// Return the ID of the texture we just created
-//	return textureID;
-//}
-
-
-
-#define FOURCC_DXT1 0x31545844 // Equivalent to "DXT1" in ASCII
-#define FOURCC_DXT3 0x33545844 // Equivalent to "DXT3" in ASCII
-#define FOURCC_DXT5 0x35545844 // Equivalent to "DXT5" in ASCII
-
-GLuint loadDDS(const char * imagepath){
-
-	unsigned char header[124];
-
-	FILE *fp; 
- 
-	/* try to open the file */ 
-	fp = fopen(imagepath, "rb"); 
-	if (fp == NULL){
-		printf("%s could not be opened. Are you in the right directory ? Don't forget to read the FAQ !\n", imagepath); getchar(); 
-		return 0;
-	}
-   
-	/* verify the type of file */ 
-	char filecode[4]; 
-	fread(filecode, 1, 4, fp); 
-	if (strncmp(filecode, "DDS ", 4) != 0) { 
-		fclose(fp); 
-		return 0; 
-	}
-	
-	/* get the surface desc */ 
-	fread(&header, 124, 1, fp); 
-
-	unsigned int height      = *(unsigned int*)&(header[8 ]);
-	unsigned int width	     = *(unsigned int*)&(header[12]);
-	unsigned int linearSize	 = *(unsigned int*)&(header[16]);
-	unsigned int mipMapCount = *(unsigned int*)&(header[24]);
-	unsigned int fourCC      = *(unsigned int*)&(header[80]);
-
- 
-	unsigned char * buffer;
-	unsigned int bufsize;
-	/* how big is it going to be including all mipmaps? */ 
-	bufsize = mipMapCount > 1 ? linearSize * 2 : linearSize; 
-	buffer = (unsigned char*)malloc(bufsize * sizeof(unsigned char)); 
-	fread(buffer, 1, bufsize, fp); 
-	/* close the file pointer */ 
-	fclose(fp);
-
-	unsigned int components  = (fourCC == FOURCC_DXT1) ? 3 : 4; 
-	unsigned int format;
-	switch(fourCC) 
-	{ 
-	case FOURCC_DXT1: 
-		format = GL_COMPRESSED_RGBA_S3TC_DXT1_EXT; 
-		break; 
-	case FOURCC_DXT3: 
-		format = GL_COMPRESSED_RGBA_S3TC_DXT3_EXT; 
-		break; 
-	case FOURCC_DXT5: 
-		format = GL_COMPRESSED_RGBA_S3TC_DXT5_EXT; 
-		break; 
-	default: 
-		free(buffer); 
-		return 0; 
-	}
-
-	// Create one OpenGL texture
-	GLuint textureID;
-	glGenTextures(1, &textureID);
-
-	// "Bind" the newly created texture : all future texture functions will modify this texture
-	glBindTexture(GL_TEXTURE_2D, textureID);
-	glPixelStorei(GL_UNPACK_ALIGNMENT,1);	
-	
-	unsigned int blockSize = (format == GL_COMPRESSED_RGBA_S3TC_DXT1_EXT) ? 8 : 16; 
-	unsigned int offset = 0;
-
-	/* load the mipmaps */ 
-	for (unsigned int level = 0; level < mipMapCount && (width || height); ++level) 
-	{ 
-		unsigned int size = ((width+3)/4)*((height+3)/4)*blockSize; 
-		glCompressedTexImage2D(GL_TEXTURE_2D, level, format, width, height,  
-			0, size, buffer + offset); 
-	 
-		offset += size; 
-		width  /= 2; 
-		height /= 2; 
-
-		// Deal with Non-Power-Of-Two textures. This code is not included in the webpage to reduce clutter.
-		if(width < 1) width = 1;
-		if(height < 1) height = 1;
-
-	} 
-
-	free(buffer); 
-
-	return textureID;
-
-
-}
\ No newline at end of file
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <vector>
+
+#include <glad/glad.h>
+
+#include <GLFW/glfw3.h>
+
+#include "../glStateCache.h"
+#include "../mappedFile.h"
+
+
+GLuint loadBMP_custom(const char * imagepath){
+
+	printf("Reading image %s\n", imagepath);
+
+	// Data read from the header of the BMP file
+	unsigned char header[54];
+	unsigned int dataPos;
+	unsigned int imageSize;
+	unsigned int width, height;
+	// Actual RGB data
+	unsigned char * data;
+
+	// Open the file
+	FILE * file = fopen(imagepath,"rb");
+	if (!file){
+		printf("%s could not be opened. Are you in the right directory ? Don't forget to read the FAQ !\n", imagepath);
+		getchar();
+		return 0;
+	}
+
+	// Read the header, i.e. the 54 first bytes
+
+	// If less than 54 bytes are read, problem
+	if ( fread(header, 1, 54, file)!=54 ){ 
+		printf("Not a correct BMP file\n");
+		fclose(file);
+		return 0;
+	}
+	// A BMP files always begins with "BM"
+	if ( header[0]!='B' || header[1]!='M' ){
+		printf("Not a correct BMP file\n");
+		fclose(file);
+		return 0;
+	}
+	// Make sure this is a 24bpp file
+	if ( *(int*)&(header[0x1E])!=0  )         {printf("Not a correct BMP file\n");    fclose(file); return 0;}
+	if ( *(int*)&(header[0x1C])!=24 )         {printf("Not a correct BMP file\n");    fclose(file); return 0;}
+
+	// Read the information about the image
+	dataPos    = *(int*)&(header[0x0A]);
+	imageSize  = *(int*)&(header[0x22]);
+	width      = *(int*)&(header[0x12]);
+	height     = *(int*)&(header[0x16]);
+
+	// Some BMP files are misformatted, guess missing information
+	if (imageSize==0)    imageSize=width*height*3; // 3 : one byte for each Red, Green and Blue component
+	if (dataPos==0)      dataPos=54; // The BMP header is done that way
+
+	// Create a buffer
+	data = new unsigned char [imageSize];
+
+	// Read the actual data from the file into the buffer
+	fread(data,1,imageSize,file);
+
+	// Everything is in memory now, the file can be closed.
+	fclose (file);
+
+	// Create one OpenGL texture
+	GLuint textureID;
+	glGenTextures(1, &textureID);
+	
+	// "Bind" the newly created texture : all future texture functions will modify this texture
+	GLStateCache::get().bindTexture(GL_TEXTURE_2D, textureID);
+
+	// Give the image to OpenGL
+	glTexImage2D(GL_TEXTURE_2D, 0,GL_RGB, width, height, 0, GL_BGR, GL_UNSIGNED_BYTE, data);
+
+	// OpenGL has now copied the data. Free our own version
+	delete [] data;
+
+	// Poor filtering, or ...
+	//glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+	//glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST); 
+
+	// ... nice trilinear filtering ...
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+	// ... which requires mipmaps. Generate them automatically.
+	glGenerateMipmap(GL_TEXTURE_2D);
+
+	// Return the ID of the texture we just created
+	return textureID;
+}
+
+// Since GLFW 3, glfwLoadTexture2D() has been removed. You have to use another texture loading library, 
+// or do it yourself (just like loadBMP_custom and loadDDS)
+//GLuint loadTGA_glfw(const char * imagepath){
+//
+//	// Create one OpenGL texture
+//	GLuint textureID;
+//	glGenTextures(1, &textureID);
+//
+//	// "Bind" the newly created texture : all future texture functions will modify this texture
+//	glBindTexture(GL_TEXTURE_2D, textureID);
+//
+//	// Read the file, call glTexImage2D with the right parameters
+//	glfwLoadTexture2D(imagepath, 0);
+//
+//	// Nice trilinear filtering.
+//	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+//	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+//	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+//	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR); 
+//	glGenerateMipmap(GL_TEXTURE_2D);
+//
+//	// Return the ID of the texture we just created
+//	return textureID;
+//}
+
+
+
+// EXT_texture_compression_s3tc and EXT_texture_sRGB, not part of the core profile glad is generated for
+#ifndef GL_COMPRESSED_RGBA_S3TC_DXT1_EXT
+#define GL_COMPRESSED_RGB_S3TC_DXT1_EXT  0x83F0
+#define GL_COMPRESSED_RGBA_S3TC_DXT1_EXT 0x83F1
+#define GL_COMPRESSED_RGBA_S3TC_DXT3_EXT 0x83F2
+#define GL_COMPRESSED_RGBA_S3TC_DXT5_EXT 0x83F3
+#endif
+#ifndef GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT1_EXT
+#define GL_COMPRESSED_SRGB_S3TC_DXT1_EXT       0x8C4C
+#define GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT1_EXT 0x8C4D
+#define GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT3_EXT 0x8C4E
+#define GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT 0x8C4F
+#endif
+
+#define FOURCC_DXT1 0x31545844 // Equivalent to "DXT1" in ASCII
+#define FOURCC_DXT3 0x33545844 // Equivalent to "DXT3" in ASCII
+#define FOURCC_DXT5 0x35545844 // Equivalent to "DXT5" in ASCII
+#define FOURCC_ATI1 0x31495441 // "ATI1", BC4
+#define FOURCC_BC4U 0x55344342 // "BC4U", BC4 too
+#define FOURCC_ATI2 0x32495441 // "ATI2", BC5
+#define FOURCC_BC5U 0x55354342 // "BC5U", BC5 too
+#define FOURCC_DX10 0x30315844 // "DX10", a DDS_HEADER_DXT10 follows the header
+
+// the few DDS header flags the loader looks at
+#define DDSD_MIPMAPCOUNT              0x20000
+#define DDPF_FOURCC                   0x4
+#define DDPF_RGB                      0x40
+#define DDSCAPS2_CUBEMAP              0x200
+#define DDSCAPS2_CUBEMAP_ALLFACES     0xFC00
+#define DDSCAPS2_VOLUME               0x200000
+#define DDS_RESOURCE_MISC_TEXTURECUBE 0x4
+#define DDS_DIMENSION_TEXTURE3D       4
+
+// DDS_HEADER, what follows the "DDS " magic
+struct DDSHeader {
+	unsigned int size, flags, height, width, pitchOrLinearSize, depth, mipMapCount;
+	unsigned int reserved1[11];
+	unsigned int formatSize, formatFlags, fourCC, rgbBitCount, redMask, greenMask, blueMask, alphaMask;
+	unsigned int caps, caps2, caps3, caps4, reserved2;
+};
+
+// DDS_HEADER_DXT10, after the header when its FourCC is "DX10"
+struct DDSHeaderDX10 {
+	unsigned int dxgiFormat, resourceDimension, miscFlag, arraySize, miscFlags2;
+};
+
+// How the texels of a file are stored, and the GL format that takes them as they are
+struct TextureFormat {
+	GLenum internalFormat;
+	GLenum format, type;     // of uncompressed texels, 0 for block compressed ones
+	unsigned int blockBytes; // bytes of a 4x4 block, or of one texel when uncompressed
+};
+
+// The shape of a texture in a file; the order of its images depends on the container.
+struct TextureLayout {
+	GLenum target;
+	TextureFormat format;
+	unsigned int width, height;
+	unsigned int levels;
+	unsigned int layers; // 1 when the texture is not an array
+	unsigned int faces;  // 6 for cube maps
+	unsigned int rowAlignment; // uncompressed rows in the file start at multiples of it
+};
+
+static TextureFormat blockFormat(GLenum internalFormat, unsigned int blockBytes){
+	TextureFormat format = { internalFormat, 0, 0, blockBytes };
+	return format;
+}
+
+static TextureFormat texelFormat(GLenum internalFormat, GLenum pixelFormat, GLenum type, unsigned int texelBytes){
+	TextureFormat format = { internalFormat, pixelFormat, type, texelBytes };
+	return format;
+}
+
+static unsigned int levelSize(unsigned int size, unsigned int level){
+	size >>= level;
+	return size > 0 ? size : 1;
+}
+
+// exact bytes of one image, a partial block at the edge counts as a whole one
+static size_t imageSize(const TextureLayout& layout, unsigned int level){
+	const TextureFormat& format = layout.format;
+	unsigned int width = levelSize(layout.width, level), height = levelSize(layout.height, level);
+	if (format.format != 0) {
+		size_t row = ((size_t)width * format.blockBytes + layout.rowAlignment - 1) / layout.rowAlignment * layout.rowAlignment;
+		return row * height;
+	}
+	return (size_t)((width + 3) / 4) * ((height + 3) / 4) * format.blockBytes;
+}
+
+static size_t layoutSize(const TextureLayout& layout){
+	size_t size = 0;
+	for (unsigned int level = 0; level < layout.levels; ++level)
+		size += imageSize(layout, level);
+	return size * layout.faces * layout.layers;
+}
+
+// picks the texture target for the layout and checks the context can make it
+static bool completeLayout(TextureLayout& layout, const char * imagepath){
+	if (layout.width == 0 || layout.height == 0 || (layout.faces == 6 && layout.width != layout.height)) {
+		printf("ERROR::TEXTURE::BAD_SIZE: %s is %ux%u\n", imagepath, layout.width, layout.height);
+		return false;
+	}
+	// levels past 1x1 do not exist
+	unsigned int largest = layout.width > layout.height ? layout.width : layout.height;
+	unsigned int fullLevels = 1;
+	while ((largest >> fullLevels) > 0)
+		fullLevels++;
+	if (layout.levels > fullLevels)
+		layout.levels = fullLevels;
+
+	if (layout.layers > 1 && layout.faces == 6) {
+		if (!GLAD_GL_VERSION_4_0) {
+			printf("ERROR::TEXTURE::CUBE_MAP_ARRAY_NEEDS_GL_4_0: %s\n", imagepath);
+			return false;
+		}
+		layout.target = GL_TEXTURE_CUBE_MAP_ARRAY;
+	}
+	else if (layout.layers > 1)
+		layout.target = GL_TEXTURE_2D_ARRAY;
+	else if (layout.faces == 6)
+		layout.target = GL_TEXTURE_CUBE_MAP;
+	else
+		layout.target = GL_TEXTURE_2D;
+	return true;
+}
+
+static bool isLayered(GLenum target){
+	return target == GL_TEXTURE_2D_ARRAY || target == GL_TEXTURE_CUBE_MAP_ARRAY;
+}
+
+// creates a texture with storage for every level, face and layer of the layout, pixels come later
+static GLuint createTexture(const TextureLayout& layout){
+	const TextureFormat& format = layout.format;
+	GLuint textureID;
+	glGenTextures(1, &textureID);
+	GLStateCache::get().bindTexture(layout.target, textureID);
+
+	GLsizei depth = layout.layers * (layout.target == GL_TEXTURE_CUBE_MAP_ARRAY ? 6 : 1);
+	if (isLayered(layout.target) && glTexStorage3D != NULL)
+		glTexStorage3D(layout.target, layout.levels, format.internalFormat, layout.width, layout.height, depth);
+	else if (!isLayered(layout.target) && glTexStorage2D != NULL)
+		glTexStorage2D(layout.target, layout.levels, format.internalFormat, layout.width, layout.height);
+	else {
+		for (unsigned int level = 0; level < layout.levels; ++level) {
+			GLsizei width = levelSize(layout.width, level), height = levelSize(layout.height, level);
+			GLsizei size = (GLsizei)imageSize(layout, level);
+			if (isLayered(layout.target) && format.format == 0)
+				glCompressedTexImage3D(layout.target, level, format.internalFormat, width, height, depth, 0, size * depth, NULL);
+			else if (isLayered(layout.target))
+				glTexImage3D(layout.target, level, format.internalFormat, width, height, depth, 0, format.format, format.type, NULL);
+			else {
+				for (unsigned int face = 0; face < layout.faces; ++face) {
+					GLenum faceTarget = layout.faces == 6 ? GL_TEXTURE_CUBE_MAP_POSITIVE_X + face : layout.target;
+					if (format.format == 0)
+						glCompressedTexImage2D(faceTarget, level, format.internalFormat, width, height, 0, size, NULL);
+					else
+						glTexImage2D(faceTarget, level, format.internalFormat, width, height, 0, format.format, format.type, NULL);
+				}
+			}
+		}
+	}
+
+	// the levels the file has make the texture complete, whether or not it has a full chain
+	glTexParameteri(layout.target, GL_TEXTURE_MAX_LEVEL, layout.levels - 1);
+	glTexParameteri(layout.target, GL_TEXTURE_MIN_FILTER, layout.levels > 1 ? GL_LINEAR_MIPMAP_LINEAR : GL_LINEAR);
+	glTexParameteri(layout.target, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+	if (layout.faces == 6) {
+		glTexParameteri(layout.target, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+		glTexParameteri(layout.target, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+	}
+
+	// pixels come from client memory, not from a pixel unpack buffer someone left bound
+	GLStateCache::get().bindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+	glPixelStorei(GL_UNPACK_ALIGNMENT, layout.rowAlignment);
+	return textureID;
+}
+
+// uploads the image of one level of one face of one layer; GL copies it before it returns
+static void uploadImage(const TextureLayout& layout, unsigned int level, unsigned int layer, unsigned int face, const unsigned char * pixels){
+	const TextureFormat& format = layout.format;
+	GLsizei width = levelSize(layout.width, level), height = levelSize(layout.height, level);
+	GLsizei size = (GLsizei)imageSize(layout, level);
+	if (isLayered(layout.target)) {
+		GLint z = layer * (layout.target == GL_TEXTURE_CUBE_MAP_ARRAY ? 6 : 1) + face;
+		if (format.format == 0)
+			glCompressedTexSubImage3D(layout.target, level, 0, 0, z, width, height, 1, format.internalFormat, size, pixels);
+		else
+			glTexSubImage3D(layout.target, level, 0, 0, z, width, height, 1, format.format, format.type, pixels);
+	}
+	else {
+		GLenum faceTarget = layout.faces == 6 ? GL_TEXTURE_CUBE_MAP_POSITIVE_X + face : layout.target;
+		if (format.format == 0)
+			glCompressedTexSubImage2D(faceTarget, level, 0, 0, width, height, format.internalFormat, size, pixels);
+		else
+			glTexSubImage2D(faceTarget, level, 0, 0, width, height, format.format, format.type, pixels);
+	}
+}
+
+// creates the texture and fills it from the mapped file, in DDS order: layer by layer, the faces
+// of a layer, then the levels of a face. The pages of every image are dropped once it is
+// uploaded, so a file never takes more resident memory than about one image of it.
+static GLuint uploadDDSImages(const TextureLayout& layout, const MappedFile& file, size_t offset){
+	GLuint textureID = createTexture(layout);
+	for (unsigned int layer = 0; layer < layout.layers; ++layer) {
+		for (unsigned int face = 0; face < layout.faces; ++face) {
+			for (unsigned int level = 0; level < layout.levels; ++level) {
+				size_t size = imageSize(layout, level);
+				uploadImage(layout, level, layer, face, file.getData() + offset);
+				file.release(offset, size);
+				offset += size;
+			}
+		}
+	}
+	return textureID;
+}
+
+static bool formatFromDDSPixelFormat(const DDSHeader& header, TextureFormat& format){
+	if (header.formatFlags & DDPF_FOURCC) {
+		switch (header.fourCC) {
+		case FOURCC_DXT1: format = blockFormat(GL_COMPRESSED_RGBA_S3TC_DXT1_EXT, 8); return true;
+		case FOURCC_DXT3: format = blockFormat(GL_COMPRESSED_RGBA_S3TC_DXT3_EXT, 16); return true;
+		case FOURCC_DXT5: format = blockFormat(GL_COMPRESSED_RGBA_S3TC_DXT5_EXT, 16); return true;
+		case FOURCC_ATI1:
+		case FOURCC_BC4U: format = blockFormat(GL_COMPRESSED_RED_RGTC1, 8); return true;
+		case FOURCC_ATI2:
+		case FOURCC_BC5U: format = blockFormat(GL_COMPRESSED_RG_RGTC2, 16); return true;
+		default: return false;
+		}
+	}
+	// 32 bit texels, in either byte order
+	if ((header.formatFlags & DDPF_RGB) && header.rgbBitCount == 32) {
+		if (header.redMask == 0x000000FF && header.greenMask == 0x0000FF00 && header.blueMask == 0x00FF0000) {
+			format = texelFormat(GL_RGBA8, GL_RGBA, GL_UNSIGNED_BYTE, 4);
+			return true;
+		}
+		if (header.redMask == 0x00FF0000 && header.greenMask == 0x0000FF00 && header.blueMask == 0x000000FF) {
+			format = texelFormat(GL_RGBA8, GL_BGRA, GL_UNSIGNED_BYTE, 4);
+			return true;
+		}
+	}
+	return false;
+}
+
+static bool formatFromDXGI(unsigned int dxgiFormat, TextureFormat& format){
+	switch (dxgiFormat) {
+	case 28: format = texelFormat(GL_RGBA8, GL_RGBA, GL_UNSIGNED_BYTE, 4); return true;        // R8G8B8A8_UNORM
+	case 29: format = texelFormat(GL_SRGB8_ALPHA8, GL_RGBA, GL_UNSIGNED_BYTE, 4); return true; // R8G8B8A8_UNORM_SRGB
+	case 87: format = texelFormat(GL_RGBA8, GL_BGRA, GL_UNSIGNED_BYTE, 4); return true;        // B8G8R8A8_UNORM
+	case 91: format = texelFormat(GL_SRGB8_ALPHA8, GL_BGRA, GL_UNSIGNED_BYTE, 4); return true; // B8G8R8A8_UNORM_SRGB
+	case 71: format = blockFormat(GL_COMPRESSED_RGBA_S3TC_DXT1_EXT, 8); return true;           // BC1_UNORM
+	case 72: format = blockFormat(GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT1_EXT, 8); return true;     // BC1_UNORM_SRGB
+	case 74: format = blockFormat(GL_COMPRESSED_RGBA_S3TC_DXT3_EXT, 16); return true;          // BC2_UNORM
+	case 75: format = blockFormat(GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT3_EXT, 16); return true;    // BC2_UNORM_SRGB
+	case 77: format = blockFormat(GL_COMPRESSED_RGBA_S3TC_DXT5_EXT, 16); return true;          // BC3_UNORM
+	case 78: format = blockFormat(GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT, 16); return true;    // BC3_UNORM_SRGB
+	case 80: format = blockFormat(GL_COMPRESSED_RED_RGTC1, 8); return true;                    // BC4_UNORM
+	case 81: format = blockFormat(GL_COMPRESSED_SIGNED_RED_RGTC1, 8); return true;             // BC4_SNORM
+	case 83: format = blockFormat(GL_COMPRESSED_RG_RGTC2, 16); return true;                    // BC5_UNORM
+	case 84: format = blockFormat(GL_COMPRESSED_SIGNED_RG_RGTC2, 16); return true;             // BC5_SNORM
+	case 95: format = blockFormat(GL_COMPRESSED_RGB_BPTC_UNSIGNED_FLOAT, 16); return true;     // BC6H_UF16
+	case 96: format = blockFormat(GL_COMPRESSED_RGB_BPTC_SIGNED_FLOAT, 16); return true;       // BC6H_SF16
+	case 98: format = blockFormat(GL_COMPRESSED_RGBA_BPTC_UNORM, 16); return true;             // BC7_UNORM
+	case 99: format = blockFormat(GL_COMPRESSED_SRGB_ALPHA_BPTC_UNORM, 16); return true;       // BC7_UNORM_SRGB
+	default: return false;
+	}
+}
+
+GLuint loadDDS(const char * imagepath, GLenum * target){
+
+	/* map the file, the images are uploaded from where they are in it */
+	MappedFile file;
+	if (!file.open(imagepath))
+		return 0;
+
+	/* verify the type of file */
+	DDSHeader header;
+	if (file.getSize() < 4 + sizeof(header) || memcmp(file.getData(), "DDS ", 4) != 0) {
+		printf("ERROR::TEXTURE::NOT_A_DDS_FILE: %s\n", imagepath);
+		return 0;
+	}
+
+	/* get the surface desc */
+	memcpy(&header, file.getData() + 4, sizeof(header));
+	size_t offset = 4 + sizeof(header);
+
+	TextureLayout layout;
+	layout.width = header.width;
+	layout.height = header.height;
+	layout.levels = (header.flags & DDSD_MIPMAPCOUNT) && header.mipMapCount > 0 ? header.mipMapCount : 1;
+	layout.layers = 1;
+	layout.faces = (header.caps2 & DDSCAPS2_CUBEMAP) ? 6 : 1;
+	layout.rowAlignment = 1;
+	bool supported = (header.caps2 & DDSCAPS2_VOLUME) == 0
+		&& (layout.faces == 1 || (header.caps2 & DDSCAPS2_CUBEMAP_ALLFACES) == DDSCAPS2_CUBEMAP_ALLFACES);
+	bool known;
+	if ((header.formatFlags & DDPF_FOURCC) && header.fourCC == FOURCC_DX10) {
+		DDSHeaderDX10 extension;
+		if (file.getSize() < offset + sizeof(extension)) {
+			printf("ERROR::TEXTURE::TRUNCATED_FILE: %s\n", imagepath);
+			return 0;
+		}
+		memcpy(&extension, file.getData() + offset, sizeof(extension));
+		offset += sizeof(extension);
+		known = formatFromDXGI(extension.dxgiFormat, layout.format);
+		// an array of cube maps counts cubes, not faces
+		layout.layers = extension.arraySize > 0 ? extension.arraySize : 1;
+		layout.faces = (extension.miscFlag & DDS_RESOURCE_MISC_TEXTURECUBE) ? 6 : 1;
+		supported = extension.resourceDimension != DDS_DIMENSION_TEXTURE3D;
+	}
+	else
+		known = formatFromDDSPixelFormat(header, layout.format);
+
+	if (!known) {
+		printf("ERROR::TEXTURE::UNSUPPORTED_DDS_FORMAT: %s\n", imagepath);
+		return 0;
+	}
+	if (!supported) {
+		printf("ERROR::TEXTURE::UNSUPPORTED_DDS_LAYOUT: %s, volume textures and cube maps without all faces are not loaded\n", imagepath);
+		return 0;
+	}
+	if (!completeLayout(layout, imagepath))
+		return 0;
+
+	/* the exact size of every image, nothing is read past the end of the file */
+	size_t size = layoutSize(layout);
+	if (file.getSize() - offset < size) {
+		printf("ERROR::TEXTURE::TRUNCATED_FILE: %s has %u bytes of images, %u expected\n", imagepath,
+			(unsigned int)(file.getSize() - offset), (unsigned int)size);
+		return 0;
+	}
+
+	GLuint textureID = uploadDDSImages(layout, file, offset);
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 4); // back to the default
+	if (target != NULL)
+		*target = layout.target;
+	return textureID;
+}
+
+
+
+// KTX 1.1 file header, all fields in the byte order of the file's endianness field
+struct KTX1Header {
+	unsigned char identifier[12];
+	unsigned int endianness;
+	unsigned int glType, glTypeSize, glFormat, glInternalFormat, glBaseInternalFormat;
+	unsigned int pixelWidth, pixelHeight, pixelDepth;
+	unsigned int numberOfArrayElements, numberOfFaces, numberOfMipmapLevels;
+	unsigned int bytesOfKeyValueData;
+};
+
+// KTX 2.0 file header and index, followed by one KTX2Level per level
+struct KTX2Header {
+	unsigned char identifier[12];
+	unsigned int vkFormat, typeSize;
+	unsigned int pixelWidth, pixelHeight, pixelDepth;
+	unsigned int layerCount, faceCount, levelCount;
+	unsigned int supercompressionScheme;
+	unsigned int dfdByteOffset, dfdByteLength, kvdByteOffset, kvdByteLength;
+	unsigned long long sgdByteOffset, sgdByteLength;
+};
+
+struct KTX2Level {
+	unsigned long long byteOffset, byteLength, uncompressedByteLength;
+};
+
+static const unsigned char KTX1_IDENTIFIER[12] = { 0xAB, 'K', 'T', 'X', ' ', '1', '1', 0xBB, '\r', '\n', 0x1A, '\n' };
+static const unsigned char KTX2_IDENTIFIER[12] = { 0xAB, 'K', 'T', 'X', ' ', '2', '0', 0xBB, '\r', '\n', 0x1A, '\n' };
+
+// bytes of a 4x4 block of the compressed formats the loaders take, 0 for any other
+static unsigned int compressedBlockBytes(GLenum internalFormat){
+	switch (internalFormat) {
+	case GL_COMPRESSED_RGB_S3TC_DXT1_EXT:
+	case GL_COMPRESSED_RGBA_S3TC_DXT1_EXT:
+	case GL_COMPRESSED_SRGB_S3TC_DXT1_EXT:
+	case GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT1_EXT:
+	case GL_COMPRESSED_RED_RGTC1:
+	case GL_COMPRESSED_SIGNED_RED_RGTC1:
+		return 8;
+	case GL_COMPRESSED_RGBA_S3TC_DXT3_EXT:
+	case GL_COMPRESSED_RGBA_S3TC_DXT5_EXT:
+	case GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT3_EXT:
+	case GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT:
+	case GL_COMPRESSED_RG_RGTC2:
+	case GL_COMPRESSED_SIGNED_RG_RGTC2:
+	case GL_COMPRESSED_RGB_BPTC_UNSIGNED_FLOAT:
+	case GL_COMPRESSED_RGB_BPTC_SIGNED_FLOAT:
+	case GL_COMPRESSED_RGBA_BPTC_UNORM:
+	case GL_COMPRESSED_SRGB_ALPHA_BPTC_UNORM:
+		return 16;
+	default:
+		return 0;
+	}
+}
+
+static bool formatFromKTX1(const KTX1Header& header, TextureFormat& format){
+	if (header.glType == 0) {
+		unsigned int blockBytes = compressedBlockBytes(header.glInternalFormat);
+		format = blockFormat(header.glInternalFormat, blockBytes);
+		return blockBytes > 0;
+	}
+	if (header.glType != GL_UNSIGNED_BYTE)
+		return false;
+	switch (header.glFormat) {
+	case GL_RED:  format = texelFormat(header.glInternalFormat, GL_RED, GL_UNSIGNED_BYTE, 1); return true;
+	case GL_RG:   format = texelFormat(header.glInternalFormat, GL_RG, GL_UNSIGNED_BYTE, 2); return true;
+	case GL_RGB:
+	case GL_BGR:  format = texelFormat(header.glInternalFormat, header.glFormat, GL_UNSIGNED_BYTE, 3); return true;
+	case GL_RGBA:
+	case GL_BGRA: format = texelFormat(header.glInternalFormat, header.glFormat, GL_UNSIGNED_BYTE, 4); return true;
+	default: return false;
+	}
+}
+
+static bool formatFromVulkan(unsigned int vkFormat, TextureFormat& format){
+	switch (vkFormat) {
+	case 9:   format = texelFormat(GL_R8, GL_RED, GL_UNSIGNED_BYTE, 1); return true;              // R8_UNORM
+	case 16:  format = texelFormat(GL_RG8, GL_RG, GL_UNSIGNED_BYTE, 2); return true;              // R8G8_UNORM
+	case 23:  format = texelFormat(GL_RGB8, GL_RGB, GL_UNSIGNED_BYTE, 3); return true;            // R8G8B8_UNORM
+	case 29:  format = texelFormat(GL_SRGB8, GL_RGB, GL_UNSIGNED_BYTE, 3); return true;           // R8G8B8_SRGB
+	case 30:  format = texelFormat(GL_RGB8, GL_BGR, GL_UNSIGNED_BYTE, 3); return true;            // B8G8R8_UNORM
+	case 36:  format = texelFormat(GL_SRGB8, GL_BGR, GL_UNSIGNED_BYTE, 3); return true;           // B8G8R8_SRGB
+	case 37:  format = texelFormat(GL_RGBA8, GL_RGBA, GL_UNSIGNED_BYTE, 4); return true;          // R8G8B8A8_UNORM
+	case 43:  format = texelFormat(GL_SRGB8_ALPHA8, GL_RGBA, GL_UNSIGNED_BYTE, 4); return true;   // R8G8B8A8_SRGB
+	case 44:  format = texelFormat(GL_RGBA8, GL_BGRA, GL_UNSIGNED_BYTE, 4); return true;          // B8G8R8A8_UNORM
+	case 50:  format = texelFormat(GL_SRGB8_ALPHA8, GL_BGRA, GL_UNSIGNED_BYTE, 4); return true;   // B8G8R8A8_SRGB
+	case 131: format = blockFormat(GL_COMPRESSED_RGB_S3TC_DXT1_EXT, 8); return true;              // BC1_RGB_UNORM_BLOCK
+	case 132: format = blockFormat(GL_COMPRESSED_SRGB_S3TC_DXT1_EXT, 8); return true;             // BC1_RGB_SRGB_BLOCK
+	case 133: format = blockFormat(GL_COMPRESSED_RGBA_S3TC_DXT1_EXT, 8); return true;             // BC1_RGBA_UNORM_BLOCK
+	case 134: format = blockFormat(GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT1_EXT, 8); return true;       // BC1_RGBA_SRGB_BLOCK
+	case 135: format = blockFormat(GL_COMPRESSED_RGBA_S3TC_DXT3_EXT, 16); return true;            // BC2_UNORM_BLOCK
+	case 136: format = blockFormat(GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT3_EXT, 16); return true;      // BC2_SRGB_BLOCK
+	case 137: format = blockFormat(GL_COMPRESSED_RGBA_S3TC_DXT5_EXT, 16); return true;            // BC3_UNORM_BLOCK
+	case 138: format = blockFormat(GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT, 16); return true;      // BC3_SRGB_BLOCK
+	case 139: format = blockFormat(GL_COMPRESSED_RED_RGTC1, 8); return true;                      // BC4_UNORM_BLOCK
+	case 140: format = blockFormat(GL_COMPRESSED_SIGNED_RED_RGTC1, 8); return true;               // BC4_SNORM_BLOCK
+	case 141: format = blockFormat(GL_COMPRESSED_RG_RGTC2, 16); return true;                      // BC5_UNORM_BLOCK
+	case 142: format = blockFormat(GL_COMPRESSED_SIGNED_RG_RGTC2, 16); return true;               // BC5_SNORM_BLOCK
+	case 143: format = blockFormat(GL_COMPRESSED_RGB_BPTC_UNSIGNED_FLOAT, 16); return true;       // BC6H_UFLOAT_BLOCK
+	case 144: format = blockFormat(GL_COMPRESSED_RGB_BPTC_SIGNED_FLOAT, 16); return true;         // BC6H_SFLOAT_BLOCK
+	case 145: format = blockFormat(GL_COMPRESSED_RGBA_BPTC_UNORM, 16); return true;               // BC7_UNORM_BLOCK
+	case 146: format = blockFormat(GL_COMPRESSED_SRGB_ALPHA_BPTC_UNORM, 16); return true;         // BC7_SRGB_BLOCK
+	default: return false;
+	}
+}
+
+// applies a "KTXswizzle" value like "rrr1" from the key/value data, which both versions store as
+// entries of a 4 byte length, then key and value each ending with a 0, padded to 4 bytes
+static void applyKTXSwizzle(GLenum target, const unsigned char * data, size_t size){
+	size_t offset = 0;
+	while (offset + 4 <= size) {
+		unsigned int length;
+		memcpy(&length, data + offset, 4);
+		offset += 4;
+		if (length > size - offset)
+			return;
+		const char * key = (const char *)(data + offset);
+		size_t keyLength = strnlen(key, length);
+		if (keyLength + 5 <= length && strcmp(key, "KTXswizzle") == 0) {
+			const char * value = key + keyLength + 1;
+			GLint swizzle[4];
+			for (int i = 0; i < 4; ++i) {
+				switch (value[i]) {
+				case 'r': swizzle[i] = GL_RED; break;
+				case 'g': swizzle[i] = GL_GREEN; break;
+				case 'b': swizzle[i] = GL_BLUE; break;
+				case 'a': swizzle[i] = GL_ALPHA; break;
+				case '0': swizzle[i] = GL_ZERO; break;
+				default:  swizzle[i] = GL_ONE; break;
+				}
+			}
+			glTexParameteriv(target, GL_TEXTURE_SWIZZLE_RGBA, swizzle);
+			return;
+		}
+		offset += (length + 3) & ~3u;
+	}
+}
+
+// the levels a KTX file says nothing about (it stores 0 levels) are built by GL, all others are read
+static void finishKTX(const TextureLayout& layout, unsigned int storedLevels){
+	if (storedLevels < layout.levels)
+		glGenerateMipmap(layout.target);
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 4); // back to the default
+}
+
+// KTX 1.1: per level its size, then the images of the level layer by layer, face by face.
+// Uncompressed rows are 4 byte aligned.
+static GLuint loadKTX1(const char * imagepath, const MappedFile& file, GLenum * target){
+
+	KTX1Header header;
+	if (file.getSize() < sizeof(header)) {
+		printf("ERROR::TEXTURE::TRUNCATED_FILE: %s\n", imagepath);
+		return 0;
+	}
+	memcpy(&header, file.getData(), sizeof(header));
+	if (header.endianness != 0x04030201) {
+		printf("ERROR::TEXTURE::UNSUPPORTED_KTX_ENDIANNESS: %s\n", imagepath);
+		return 0;
+	}
+
+	TextureLayout layout;
+	layout.width = header.pixelWidth;
+	layout.height = header.pixelHeight;
+	layout.layers = header.numberOfArrayElements > 0 ? header.numberOfArrayElements : 1;
+	layout.faces = header.numberOfFaces;
+	layout.rowAlignment = 4;
+	unsigned int storedLevels = header.numberOfMipmapLevels > 0 ? header.numberOfMipmapLevels : 1;
+	layout.levels = header.numberOfMipmapLevels > 0 ? header.numberOfMipmapLevels : 32;
+	if (!formatFromKTX1(header, layout.format)) {
+		printf("ERROR::TEXTURE::UNSUPPORTED_KTX_FORMAT: %s\n", imagepath);
+		return 0;
+	}
+	if (header.pixelDepth > 1 || (layout.faces != 1 && layout.faces != 6)) {
+		printf("ERROR::TEXTURE::UNSUPPORTED_KTX_LAYOUT: %s, 3D textures are not loaded\n", imagepath);
+		return 0;
+	}
+	if (!completeLayout(layout, imagepath))
+		return 0;
+	if (storedLevels > layout.levels)
+		storedLevels = layout.levels;
+
+	// check every level's size against the layout before anything is created
+	size_t keyValueOffset = sizeof(header);
+	size_t offset = keyValueOffset + header.bytesOfKeyValueData;
+	bool cubeFaces = layout.faces == 6 && header.numberOfArrayElements == 0; // then the stored size is of one face
+	for (unsigned int level = 0; level < storedLevels; ++level) {
+		size_t size = imageSize(layout, level);
+		size_t levelBytes = cubeFaces ? size : size * layout.faces * layout.layers;
+		unsigned int stored = 0;
+		if (offset <= file.getSize() && file.getSize() - offset >= 4)
+			memcpy(&stored, file.getData() + offset, 4);
+		if (offset > file.getSize() || file.getSize() - offset < 4 + size * layout.faces * layout.layers || stored != levelBytes) {
+			printf("ERROR::TEXTURE::KTX_LEVEL_MISMATCH: %s, level %u does not match the header\n", imagepath, level);
+			return 0;
+		}
+		offset += 4 + ((size * layout.faces * layout.layers + 3) & ~(size_t)3);
+	}
+
+	GLuint textureID = createTexture(layout);
+	applyKTXSwizzle(layout.target, file.getData() + keyValueOffset, header.bytesOfKeyValueData);
+	offset = keyValueOffset + header.bytesOfKeyValueData;
+	for (unsigned int level = 0; level < storedLevels; ++level) {
+		size_t levelStart = offset;
+		size_t size = imageSize(layout, level);
+		offset += 4;
+		for (unsigned int layer = 0; layer < layout.layers; ++layer) {
+			for (unsigned int face = 0; face < layout.faces; ++face) {
+				uploadImage(layout, level, layer, face, file.getData() + offset);
+				offset += (size + 3) & ~(size_t)3; // cube padding, sizes are multiples of 4 already for these formats
+			}
+		}
+		file.release(levelStart, offset - levelStart);
+	}
+	finishKTX(layout, storedLevels);
+	if (target != NULL)
+		*target = layout.target;
+	return textureID;
+}
+
+// KTX 2.0: an index with the offset of every level; a level holds its images layer by layer,
+// face by face, rows tightly packed. Supercompressed files (Basis, zstd) are not loaded.
+static GLuint loadKTX2(const char * imagepath, const MappedFile& file, GLenum * target){
+
+	KTX2Header header;
+	if (file.getSize() < sizeof(header)) {
+		printf("ERROR::TEXTURE::TRUNCATED_FILE: %s\n", imagepath);
+		return 0;
+	}
+	memcpy(&header, file.getData(), sizeof(header));
+
+	TextureLayout layout;
+	layout.width = header.pixelWidth;
+	layout.height = header.pixelHeight;
+	layout.layers = header.layerCount > 0 ? header.layerCount : 1;
+	layout.faces = header.faceCount;
+	layout.rowAlignment = 1;
+	unsigned int storedLevels = header.levelCount > 0 ? header.levelCount : 1;
+	layout.levels = header.levelCount > 0 ? header.levelCount : 32;
+	if (header.supercompressionScheme != 0 || !formatFromVulkan(header.vkFormat, layout.format)) {
+		printf("ERROR::TEXTURE::UNSUPPORTED_KTX_FORMAT: %s\n", imagepath);
+		return 0;
+	}
+	if (header.pixelDepth > 1 || (layout.faces != 1 && layout.faces != 6)) {
+		printf("ERROR::TEXTURE::UNSUPPORTED_KTX_LAYOUT: %s, 3D textures are not loaded\n", imagepath);
+		return 0;
+	}
+	if (!completeLayout(layout, imagepath))
+		return 0;
+
+	// the index lists the levels the file has, which a file without a full chain may have more of than used
+	size_t indexSize = (size_t)storedLevels * sizeof(KTX2Level);
+	if (file.getSize() - sizeof(header) < indexSize) {
+		printf("ERROR::TEXTURE::TRUNCATED_FILE: %s\n", imagepath);
+		return 0;
+	}
+	if (storedLevels > layout.levels)
+		storedLevels = layout.levels;
+	std::vector<KTX2Level> levels(storedLevels);
+	memcpy(levels.data(), file.getData() + sizeof(header), storedLevels * sizeof(KTX2Level));
+	for (unsigned int level = 0; level < storedLevels; ++level) {
+		unsigned long long levelBytes = (unsigned long long)imageSize(layout, level) * layout.faces * layout.layers;
+		if (levels[level].byteLength != levelBytes || levels[level].byteOffset > file.getSize()
+			|| file.getSize() - levels[level].byteOffset < levelBytes) {
+			printf("ERROR::TEXTURE::KTX_LEVEL_MISMATCH: %s, level %u does not match the header\n", imagepath, level);
+			return 0;
+		}
+	}
+
+	GLuint textureID = createTexture(layout);
+	if (header.kvdByteOffset <= file.getSize() && file.getSize() - header.kvdByteOffset >= header.kvdByteLength)
+		applyKTXSwizzle(layout.target, file.getData() + header.kvdByteOffset, header.kvdByteLength);
+	for (unsigned int level = 0; level < storedLevels; ++level) {
+		size_t offset = (size_t)levels[level].byteOffset;
+		size_t size = imageSize(layout, level);
+		for (unsigned int layer = 0; layer < layout.layers; ++layer) {
+			for (unsigned int face = 0; face < layout.faces; ++face) {
+				uploadImage(layout, level, layer, face, file.getData() + offset);
+				offset += size;
+			}
+		}
+		file.release((size_t)levels[level].byteOffset, (size_t)levels[level].byteLength);
+	}
+	finishKTX(layout, storedLevels);
+	if (target != NULL)
+		*target = layout.target;
+	return textureID;
+}
+
+GLuint loadKTX(const char * imagepath, GLenum * target){
+
+	/* map the file, the images are uploaded from where they are in it */
+	MappedFile file;
+	if (!file.open(imagepath))
+		return 0;
+
+	/* verify the type of file */
+	if (file.getSize() >= 12 && memcmp(file.getData(), KTX1_IDENTIFIER, 12) == 0)
+		return loadKTX1(imagepath, file, target);
+	if (file.getSize() >= 12 && memcmp(file.getData(), KTX2_IDENTIFIER, 12) == 0)
+		return loadKTX2(imagepath, file, target);
+	printf("ERROR::TEXTURE::NOT_A_KTX_FILE: %s\n", imagepath);
+	return 0;
+}
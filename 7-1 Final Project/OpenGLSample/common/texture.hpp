@@ -1,16 +1,23 @@
-#ifndef TEXTURE_HPP
-#define TEXTURE_HPP
-
-// Load a .BMP file using our custom loader
-GLuint loadBMP_custom(const char * imagepath);
-
-//// Since GLFW 3, glfwLoadTexture2D() has been removed. You have to use another texture loading library, 
-//// or do it yourself (just like loadBMP_custom and loadDDS)
-//// Load a .TGA file using GLFW's own loader
-//GLuint loadTGA_glfw(const char * imagepath);
-
-// Load a .DDS file using GLFW's own loader
-GLuint loadDDS(const char * imagepath);
-
-
+#ifndef TEXTURE_HPP
+#define TEXTURE_HPP
+
+// Load a .BMP file using our custom loader
+GLuint loadBMP_custom(const char * imagepath);
+
+//// Since GLFW 3, glfwLoadTexture2D() has been removed. You have to use another texture loading library, 
+//// or do it yourself (just like loadBMP_custom and loadDDS)
+//// Load a .TGA file using GLFW's own loader
+//GLuint loadTGA_glfw(const char * imagepath);
+
+// Load a .DDS file (BC1-BC7 or 32 bit RGBA, 2D, array or cube map, DX10 header or not) with the
+// mip levels it has. The file is memory mapped and every image is uploaded straight from it.
+// target, if given, receives GL_TEXTURE_2D, GL_TEXTURE_2D_ARRAY, GL_TEXTURE_CUBE_MAP or GL_TEXTURE_CUBE_MAP_ARRAY.
+GLuint loadDDS(const char * imagepath, GLenum * target = NULL);
+
+// Load a .KTX file, version 1.1 or 2.0 (uncompressed 8 bit or BC1-BC7, no supercompression), 2D,
+// array or cube map, with the mip levels stored in it; GL builds them only for files that store
+// none. Mapped and uploaded like loadDDS, and target receives the same.
+GLuint loadKTX(const char * imagepath, GLenum * target = NULL);
+
+
 #endif
\ No newline at end of file
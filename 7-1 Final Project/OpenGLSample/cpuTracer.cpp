@@ -0,0 +1,255 @@
+// Project
+#include "cpuTracer.h"
+
+#if OPENGLSAMPLE_CPU_TRACE
+
+// STL
+#include <iostream>
+
+namespace {
+
+	thread_local void* t_threadBuffer = nullptr;
+
+	// trace names are literals, escaping keeps a stray quote from breaking the whole file
+	void writeString(FILE* file, const char* text)
+	{
+		fputc('"', file);
+		for (const char* c = text; *c != '\0'; c++)
+		{
+			if (*c == '"' || *c == '\\')
+				fputc('\\', file);
+			if ((unsigned char)*c >= 0x20)
+				fputc(*c, file);
+		}
+		fputc('"', file);
+	}
+
+} // namespace
+
+std::atomic<bool> CpuTracer::_recording(false);
+
+CpuTracer& CpuTracer::get()
+{
+	static CpuTracer tracer;
+	return tracer;
+}
+
+CpuTracer::CpuTracer()
+	: _full(nullptr)
+	, _file(NULL)
+	, _firstEvent(true)
+	, _stopWriter(false)
+	, _startTicks(0)
+	, _nanosecondsPerTick(1.0)
+{
+}
+
+CpuTracer::~CpuTracer()
+{
+	stop();
+	std::lock_guard<std::mutex> lock(_threadsMutex);
+	for (size_t i = 0; i < _threads.size(); i++)
+	{
+		delete _threads[i]->current.load();
+		delete _threads[i];
+	}
+}
+
+bool CpuTracer::start(const char* path)
+{
+	stop();
+	_file = fopen(path, "w");
+	if (_file == NULL)
+	{
+		std::cout << "ERROR::TRACE::CANNOT_WRITE " << path << std::endl;
+		return false;
+	}
+	fprintf(_file, "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n");
+	_firstEvent = true;
+
+	// events left from an earlier trace are not written again
+	for (Chunk* chunk = _full.exchange(nullptr, std::memory_order_acquire); chunk != nullptr; )
+	{
+		Chunk* next = chunk->next;
+		delete chunk;
+		chunk = next;
+	}
+	{
+		std::lock_guard<std::mutex> lock(_threadsMutex);
+		for (size_t i = 0; i < _threads.size(); i++)
+		{
+			Chunk* chunk = _threads[i]->current.load(std::memory_order_acquire);
+			chunk->written = chunk->count.load(std::memory_order_acquire);
+		}
+	}
+
+	// ticks per nanosecond, measured against the steady clock over a few milliseconds
+#if defined(OPENGLSAMPLE_TRACE_TSC)
+	auto clockStart = std::chrono::steady_clock::now();
+	uint64_t ticksStart = now();
+	std::this_thread::sleep_for(std::chrono::milliseconds(10));
+	auto clockEnd = std::chrono::steady_clock::now();
+	uint64_t ticksEnd = now();
+	double nanoseconds = (double)std::chrono::duration_cast<std::chrono::nanoseconds>(clockEnd - clockStart).count();
+	_nanosecondsPerTick = nanoseconds / (double)(ticksEnd - ticksStart);
+#else
+	_nanosecondsPerTick = 1.0;
+#endif
+	_startTicks = now();
+
+	_stopWriter = false;
+	_writer = std::thread(&CpuTracer::writerLoop, this);
+	_recording.store(true, std::memory_order_relaxed);
+	return true;
+}
+
+void CpuTracer::stop()
+{
+	if (_file == NULL)
+		return;
+	_recording.store(false, std::memory_order_relaxed);
+	{
+		std::lock_guard<std::mutex> lock(_wakeMutex);
+		_stopWriter = true;
+	}
+	_wake.notify_one();
+	_writer.join();
+
+	flush(true);
+	writeThreadNames();
+	fprintf(_file, "\n]}\n");
+	fclose(_file);
+	_file = NULL;
+}
+
+void CpuTracer::setThreadName(const char* name)
+{
+	ThreadBuffer* thread = threadBuffer();
+	std::lock_guard<std::mutex> lock(_threadsMutex);
+	thread->name = name;
+}
+
+void CpuTracer::record(const char* name, uint64_t begin, uint64_t end)
+{
+	if (!isRecording())
+		return;
+	ThreadBuffer* thread = (ThreadBuffer*)t_threadBuffer;
+	if (thread == nullptr)
+		thread = get().threadBuffer();
+	Chunk* chunk = thread->current.load(std::memory_order_relaxed);
+	int count = chunk->count.load(std::memory_order_relaxed);
+	if (count == CHUNK_EVENTS)
+	{
+		// the new chunk is current before the full one is handed over, so the writer, once it
+		// has taken the full chunk, never finds it as a thread's current chunk again
+		Chunk* fresh = new Chunk();
+		fresh->written = 0;
+		fresh->thread = thread->id;
+		fresh->next = nullptr;
+		thread->current.store(fresh, std::memory_order_release);
+		CpuTracer& tracer = get();
+		chunk->next = tracer._full.load(std::memory_order_relaxed);
+		while (!tracer._full.compare_exchange_weak(chunk->next, chunk, std::memory_order_release, std::memory_order_relaxed))
+		{
+		}
+		chunk = fresh;
+		count = 0;
+	}
+	Event& event = chunk->events[count];
+	event.name = name;
+	event.begin = begin;
+	event.end = end;
+	chunk->count.store(count + 1, std::memory_order_release);
+}
+
+CpuTracer::ThreadBuffer* CpuTracer::threadBuffer()
+{
+	if (t_threadBuffer != nullptr)
+		return (ThreadBuffer*)t_threadBuffer;
+
+	ThreadBuffer* thread = new ThreadBuffer();
+	Chunk* chunk = new Chunk();
+	chunk->written = 0;
+	chunk->next = nullptr;
+	std::lock_guard<std::mutex> lock(_threadsMutex);
+	thread->id = (int)_threads.size() + 1;
+	chunk->thread = thread->id;
+	thread->current.store(chunk, std::memory_order_release);
+	_threads.push_back(thread);
+	t_threadBuffer = thread;
+	return thread;
+}
+
+void CpuTracer::writerLoop()
+{
+	std::unique_lock<std::mutex> lock(_wakeMutex);
+	while (!_stopWriter)
+	{
+		_wake.wait_for(lock, std::chrono::milliseconds(100));
+		lock.unlock();
+		flush(false);
+		lock.lock();
+	}
+}
+
+void CpuTracer::flush(bool all)
+{
+	// handed over chunks are complete and belong to the writer now
+	for (Chunk* chunk = _full.exchange(nullptr, std::memory_order_acquire); chunk != nullptr; )
+	{
+		Chunk* next = chunk->next;
+		writeEvents(chunk, CHUNK_EVENTS);
+		delete chunk;
+		chunk = next;
+	}
+
+	// the chunks being filled are written up to the last published event; while recording only
+	// once a quarter chunk piled up, so the file is not touched for every few events
+	std::lock_guard<std::mutex> lock(_threadsMutex);
+	for (size_t i = 0; i < _threads.size(); i++)
+	{
+		Chunk* chunk = _threads[i]->current.load(std::memory_order_acquire);
+		int count = chunk->count.load(std::memory_order_acquire);
+		if (all || count - chunk->written >= CHUNK_EVENTS / 4)
+			writeEvents(chunk, count);
+	}
+	fflush(_file);
+}
+
+void CpuTracer::writeEvents(Chunk* chunk, int count)
+{
+	const double microsecondsPerTick = _nanosecondsPerTick / 1000.0;
+	for (int i = chunk->written; i < count; i++)
+	{
+		const Event& event = chunk->events[i];
+		double begin = event.begin > _startTicks ? (event.begin - _startTicks) * microsecondsPerTick : 0.0;
+		double duration = event.end > event.begin ? (event.end - event.begin) * microsecondsPerTick : 0.0;
+		fputs(_firstEvent ? "" : ",\n", _file);
+		fputs("{\"name\":", _file);
+		writeString(_file, event.name);
+		fprintf(_file, ",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,\"pid\":1,\"tid\":%d}", begin, duration, chunk->thread);
+		_firstEvent = false;
+	}
+	chunk->written = count;
+}
+
+void CpuTracer::writeThreadNames()
+{
+	std::lock_guard<std::mutex> lock(_threadsMutex);
+	for (size_t i = 0; i < _threads.size(); i++)
+	{
+		const ThreadBuffer* thread = _threads[i];
+		if (thread->name.empty())
+			continue;
+		fputs(_firstEvent ? "" : ",\n", _file);
+		fprintf(_file, "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"args\":{\"name\":", thread->id);
+		writeString(_file, thread->name.c_str());
+		fputs("}}", _file);
+		// keeps the threads in creation order instead of by id
+		fprintf(_file, ",\n{\"name\":\"thread_sort_index\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"args\":{\"sort_index\":%d}}",
+			thread->id, thread->id);
+		_firstEvent = false;
+	}
+}
+
+#endif
@@ -0,0 +1,167 @@
+#pragma once
+
+// CPU tracing is on unless the build defines OPENGLSAMPLE_CPU_TRACE=0. Zones then cost one
+// relaxed load while no trace is being written, and about two timestamp reads and a store
+// into a thread local buffer while one is.
+#ifndef OPENGLSAMPLE_CPU_TRACE
+#define OPENGLSAMPLE_CPU_TRACE 1
+#endif
+
+#if OPENGLSAMPLE_CPU_TRACE
+
+// STL
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <intrin.h>
+#define OPENGLSAMPLE_TRACE_TSC
+#elif defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define OPENGLSAMPLE_TRACE_TSC
+#endif
+
+/**
+* Records timed zones of every thread into thread local buffers and writes them as a Chrome
+* trace (Trace Event JSON, opens in chrome://tracing and ui.perfetto.dev). Recording takes
+* no lock: each thread fills its own chunks of events and hands full ones over through a
+* lock free list, which a writer thread drains to the file in the background.
+*
+* Timestamps are raw CPU ticks (rdtsc, assumes the invariant TSC of every x86 since about
+* 2008), converted to nanoseconds when written; other CPUs use the steady clock.
+*
+*   CpuTracer::get().start("trace.json");
+*   { TRACE_ZONE("load textures"); ... }
+*   CpuTracer::get().stop();
+*/
+class CpuTracer
+{
+public:
+	static const int CHUNK_EVENTS = 4096; // events per buffer chunk, a thread hands over one chunk at a time
+
+	/** \brief  Gets the process wide tracer. */
+	static CpuTracer& get();
+
+	/** \brief  Opens the file and starts recording. Zones already open are not recorded.
+	*   \return False when the file can't be written, errors are printed.
+	*/
+	bool start(const char* path);
+
+	/** \brief  Stops recording, writes the remaining events and closes the file. Zones of other
+	*           threads that end after this are dropped.
+	*/
+	void stop();
+
+	/** \brief  Names the calling thread in the trace. Can be called before start(). */
+	void setThreadName(const char* name);
+
+	static bool isRecording()
+	{
+		return _recording.load(std::memory_order_relaxed);
+	}
+
+	static uint64_t now()
+	{
+#if defined(OPENGLSAMPLE_TRACE_TSC)
+		return __rdtsc();
+#else
+		return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+			std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+	}
+
+	/** \brief  Adds a finished zone of the calling thread.
+	*   \param name  Has to outlive the tracer, e.g. a literal
+	*/
+	static void record(const char* name, uint64_t begin, uint64_t end);
+
+private:
+	struct Event
+	{
+		const char* name;
+		uint64_t begin, end; // ticks
+	};
+	struct Chunk
+	{
+		Event events[CHUNK_EVENTS];
+		std::atomic<int> count; // written by the owning thread, released after each event
+		int written; // events already in the file, writer thread only
+		int thread; // tid of the owning thread
+		Chunk* next; // in the list of full chunks
+	};
+	struct ThreadBuffer
+	{
+		std::atomic<Chunk*> current;
+		int id; // tid in the trace
+		std::string name;
+	};
+
+	static std::atomic<bool> _recording;
+
+	std::mutex _threadsMutex; // guards _threads, taken once per thread and by the writer
+	std::vector<ThreadBuffer*> _threads; // never freed before the tracer, threads may exit any time
+	std::atomic<Chunk*> _full; // lock free stack of handed over chunks
+	FILE* _file;
+	bool _firstEvent;
+	std::thread _writer;
+	std::mutex _wakeMutex;
+	std::condition_variable _wake;
+	bool _stopWriter;
+	uint64_t _startTicks;
+	double _nanosecondsPerTick;
+
+	CpuTracer();
+	~CpuTracer();
+	ThreadBuffer* threadBuffer();
+	void writerLoop();
+	void flush(bool all);
+	void writeEvents(Chunk* chunk, int count);
+	void writeThreadNames();
+
+	CpuTracer(const CpuTracer&);
+	CpuTracer& operator=(const CpuTracer&);
+};
+
+/**
+* Times the enclosing block.
+*/
+class TraceZone
+{
+public:
+	explicit TraceZone(const char* name)
+		: _name(name)
+		, _begin(CpuTracer::isRecording() ? CpuTracer::now() : 0)
+	{
+	}
+	~TraceZone()
+	{
+		if (_begin != 0)
+			CpuTracer::record(_name, _begin, CpuTracer::now());
+	}
+
+private:
+	const char* _name;
+	uint64_t _begin; // 0 when the tracer was not recording at the start of the zone
+
+	TraceZone(const TraceZone&);
+	TraceZone& operator=(const TraceZone&);
+};
+
+#define TRACE_CONCAT_(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_(a, b)
+#define TRACE_ZONE(name) TraceZone TRACE_CONCAT(traceZone, __LINE__)(name)
+#define TRACE_THREAD_NAME(name) CpuTracer::get().setThreadName(name)
+
+#else
+
+#define TRACE_ZONE(name) ((void)0)
+#define TRACE_THREAD_NAME(name) ((void)0)
+
+#endif
@@ -0,0 +1,177 @@
+// STL
+#include <algorithm>
+#include <cmath>
+
+// GL
+#include <glad/glad.h>
+
+// Project
+#include "dynamicResolution.h"
+
+namespace {
+
+	const double TARGET_LOAD = 0.85; // fraction of the budget the scene is scaled to, the rest is headroom
+	const double SHRINK_LOAD = 0.95; // above this the scale drops right away
+	const double GROW_LOAD = 0.75; // below this at the next larger scale, the scale grows
+	const double GROW_STEP = 0.02; // per frame, growing slowly keeps it from oscillating
+	const double SMOOTHING = 0.2; // weight of the newest measurement
+	const int SIZE_ALIGNMENT = 8; // rendered sizes are multiples of this, so tiny scale changes do not resize
+
+	int scaledSize(int size, double scale)
+	{
+		int scaled = (int)(size * scale) / SIZE_ALIGNMENT * SIZE_ALIGNMENT;
+		return std::min(std::max(scaled, std::min(size, SIZE_ALIGNMENT)), size);
+	}
+
+} // namespace
+
+DynamicResolution::DynamicResolution(double budgetMilliseconds, double minScale)
+	: _windowWidth(0)
+	, _windowHeight(0)
+	, _width(0)
+	, _height(0)
+	, _budget(budgetMilliseconds)
+	, _minScale(minScale)
+	, _scale(1.0)
+	, _frame(0)
+	, _fullCost(-1.0)
+	, _cpuMilliseconds(0.0)
+	, _measuring(false)
+{
+	for (int i = 0; i < QUERY_LATENCY; i++)
+	{
+		_queries[i] = 0;
+		_queryScales[i] = 0.0;
+	}
+}
+
+DynamicResolution::~DynamicResolution()
+{
+	release();
+}
+
+void DynamicResolution::setBudget(double budgetMilliseconds)
+{
+	_budget = budgetMilliseconds;
+}
+
+void DynamicResolution::setMinScale(double minScale)
+{
+	_minScale = std::min(std::max(minScale, 0.1), 1.0);
+	_scale = std::max(_scale, _minScale);
+}
+
+bool DynamicResolution::begin(int windowWidth, int windowHeight)
+{
+	if (_queries[0] == 0)
+		glGenQueries(QUERY_LATENCY, _queries);
+	if (windowWidth <= 0 || windowHeight <= 0)
+		return false; // minimized
+
+	// the target has the window's size, lower scales use a part of it, so a scale change costs nothing
+	if (windowWidth != _windowWidth || windowHeight != _windowHeight)
+	{
+		_windowWidth = windowWidth;
+		_windowHeight = windowHeight;
+		if (!_target.create(windowWidth, windowHeight))
+		{
+			_windowWidth = _windowHeight = 0;
+			glBindFramebuffer(GL_FRAMEBUFFER, 0);
+			glViewport(0, 0, windowWidth, windowHeight);
+			return false;
+		}
+	}
+	_width = scaledSize(_windowWidth, _scale);
+	_height = scaledSize(_windowHeight, _scale);
+
+	// the slot of QUERY_LATENCY frames ago is reused now; a result that is not there yet is skipped
+	int slot = (int)(_frame % QUERY_LATENCY);
+	if (_queryScales[slot] > 0.0)
+	{
+		// the first frame compiles shaders and uploads buffers, its time says nothing about the scale
+		GLint available = 0;
+		glGetQueryObjectiv(_queries[slot], GL_QUERY_RESULT_AVAILABLE, &available);
+		if (available && _frame > QUERY_LATENCY)
+		{
+			GLuint64 nanoseconds = 0;
+			glGetQueryObjectui64v(_queries[slot], GL_QUERY_RESULT, &nanoseconds);
+			double cost = nanoseconds / 1000000.0 / (_queryScales[slot] * _queryScales[slot]);
+			_fullCost = _fullCost < 0.0 ? cost : _fullCost + SMOOTHING * (cost - _fullCost);
+		}
+		_queryScales[slot] = 0.0;
+	}
+
+	_target.bind();
+	glViewport(0, 0, _width, _height);
+	glBeginQuery(GL_TIME_ELAPSED, _queries[slot]);
+	// the sizes are rounded, the scale of the pixel count actually rendered is what the time belongs to
+	_queryScales[slot] = std::sqrt((double)_width * _height / ((double)_windowWidth * _windowHeight));
+	_measuring = true;
+	return true;
+}
+
+void DynamicResolution::end()
+{
+	if (!_measuring)
+		return;
+	glEndQuery(GL_TIME_ELAPSED);
+	_measuring = false;
+	_frame++;
+	_target.blit(_width, _height, 0, _windowWidth, _windowHeight);
+	glViewport(0, 0, _windowWidth, _windowHeight);
+}
+
+void DynamicResolution::update(double cpuMilliseconds)
+{
+	_cpuMilliseconds += SMOOTHING * (cpuMilliseconds - _cpuMilliseconds);
+	if (_fullCost <= 0.0 || _budget <= 0.0)
+		return;
+
+	// GPU time grows with the pixel count, the square of the scale
+	double gpu = _fullCost * _scale * _scale;
+	if (gpu > _budget * SHRINK_LOAD)
+	{
+		// when the CPU takes longer than the GPU, fewer pixels would not make the frame any faster
+		if (_cpuMilliseconds < gpu)
+			_scale = std::max(std::sqrt(_budget * TARGET_LOAD / _fullCost), _minScale);
+	}
+	else
+	{
+		double grown = std::min(_scale + GROW_STEP, 1.0);
+		if (grown > _scale && _fullCost * grown * grown < _budget * GROW_LOAD)
+			_scale = grown;
+	}
+}
+
+void DynamicResolution::release()
+{
+	_target.release();
+	if (_queries[0] != 0)
+		glDeleteQueries(QUERY_LATENCY, _queries);
+	for (int i = 0; i < QUERY_LATENCY; i++)
+	{
+		_queries[i] = 0;
+		_queryScales[i] = 0.0;
+	}
+	_windowWidth = _windowHeight = 0;
+}
+
+double DynamicResolution::getScale() const
+{
+	return _scale;
+}
+
+int DynamicResolution::getWidth() const
+{
+	return _width;
+}
+
+int DynamicResolution::getHeight() const
+{
+	return _height;
+}
+
+double DynamicResolution::getGpuMilliseconds() const
+{
+	return _fullCost < 0.0 ? -1.0 : _fullCost * _scale * _scale;
+}
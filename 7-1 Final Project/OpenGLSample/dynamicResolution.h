@@ -0,0 +1,71 @@
+#pragma once
+
+// Project
+#include "offscreenTarget.h"
+
+/**
+* Renders the scene at a fraction of the window's resolution into an offscreen target and
+* scales it up to the window, with the fraction chosen each frame so the GPU time of the
+* scene stays inside a frame budget. The GPU time is measured with a timer query read back
+* a few frames later and divided by the pixel fraction it was rendered at, so the controller
+* knows what every scale would cost. It shrinks as soon as the scene gets too expensive and
+* grows back slowly, and it does not shrink when the CPU is what holds the frame back.
+*
+*   resolution.begin(windowWidth, windowHeight);   // binds the target
+*   ... draw the scene ...
+*   resolution.end();                              // scales up into the window
+*   resolution.update(cpuMilliseconds);            // picks the next frame's scale
+*/
+class DynamicResolution
+{
+public:
+	static const int QUERY_LATENCY = 4; // frames between a timer query and its read back
+
+	/** \param budgetMilliseconds  GPU time a frame may take, e.g. 1000 / 60
+	*   \param minScale            Smallest fraction of the window width and height rendered
+	*/
+	DynamicResolution(double budgetMilliseconds = 1000.0 / 60.0, double minScale = 0.5);
+	~DynamicResolution();
+
+	void setBudget(double budgetMilliseconds);
+	void setMinScale(double minScale);
+
+	/** \brief  Binds the target with a viewport of the current scale, the target follows the window size.
+	*   \return False when the target could not be created; the window is bound then
+	*/
+	bool begin(int windowWidth, int windowHeight);
+
+	/** \brief  Ends the measurement and scales the image up into the window's framebuffer. */
+	void end();
+
+	/** \brief  Picks the scale of the next frame.
+	*   \param cpuMilliseconds  Time the CPU spent on the frame, without waiting for the frame slot
+	*/
+	void update(double cpuMilliseconds);
+
+	void release();
+
+	double getScale() const;
+	int getWidth() const;
+	int getHeight() const;
+
+	/** \brief  Gets the GPU time of the scene at the current scale, smoothed. Negative while unknown. */
+	double getGpuMilliseconds() const;
+
+private:
+	OffscreenTarget _target;
+	int _windowWidth, _windowHeight;
+	int _width, _height; // rendered, lower left corner of the target
+	double _budget;
+	double _minScale;
+	double _scale;
+	unsigned int _queries[QUERY_LATENCY];
+	double _queryScales[QUERY_LATENCY]; // the scale each query measured, 0 when not pending
+	unsigned long long _frame;
+	double _fullCost; // smoothed GPU milliseconds the scene would take at scale 1, negative while unknown
+	double _cpuMilliseconds; // smoothed
+	bool _measuring;
+
+	DynamicResolution(const DynamicResolution&);
+	DynamicResolution& operator=(const DynamicResolution&);
+};
@@ -0,0 +1,91 @@
+// STL
+#include <chrono>
+
+// Project
+#include "framePipeline.h"
+
+namespace {
+
+	typedef std::chrono::high_resolution_clock Clock;
+
+	double millisecondsSince(Clock::time_point start)
+	{
+		return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+	}
+
+} // namespace
+
+FramePipeline::FramePipeline()
+	: _simulated(0)
+	, _rendered(0)
+	, _stopped(false)
+	, _simulationWait(0.0)
+	, _renderWait(0.0)
+{
+}
+
+RenderPacket* FramePipeline::beginSimulation()
+{
+	Clock::time_point start = Clock::now();
+	std::unique_lock<std::mutex> lock(_mutex);
+	// with two packets published and not drawn yet, the next write would hit the one being drawn
+	_packetFree.wait(lock, [this]() { return _stopped || _simulated - _rendered < 2; });
+	_simulationWait = millisecondsSince(start);
+	if (_stopped)
+		return nullptr;
+
+	RenderPacket* packet = &_packets[_simulated % 2];
+	packet->frame = _simulated;
+	return packet;
+}
+
+void FramePipeline::endSimulation()
+{
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		_simulated++;
+	}
+	_packetReady.notify_one();
+}
+
+const RenderPacket* FramePipeline::beginRender()
+{
+	Clock::time_point start = Clock::now();
+	std::unique_lock<std::mutex> lock(_mutex);
+	_packetReady.wait(lock, [this]() { return _stopped || _simulated > _rendered; });
+	_renderWait = millisecondsSince(start);
+	if (_simulated == _rendered)
+		return nullptr;
+	return &_packets[_rendered % 2];
+}
+
+void FramePipeline::endRender()
+{
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		_rendered++;
+	}
+	_packetFree.notify_one();
+}
+
+void FramePipeline::stop()
+{
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		_stopped = true;
+	}
+	_packetFree.notify_all();
+	_packetReady.notify_all();
+}
+
+double FramePipeline::getSimulationWaitMilliseconds() const
+{
+	std::lock_guard<std::mutex> lock(_mutex);
+	return _simulationWait;
+}
+
+double FramePipeline::getRenderWaitMilliseconds() const
+{
+	std::lock_guard<std::mutex> lock(_mutex);
+	return _renderWait;
+}
@@ -0,0 +1,60 @@
+#pragma once
+
+// STL
+#include <mutex>
+#include <condition_variable>
+#include <cstdint>
+
+// Project
+#include "renderPacket.h"
+
+/**
+* Hands render packets from the simulation thread to the render (GL) thread through two
+* buffers. While frame N is submitted from one packet, frame N + 1 is simulated into the
+* other, so the simulation is never more than one frame ahead of rendering.
+*
+*   simulation thread:  while ((packet = beginSimulation()) != nullptr) { fill *packet; endSimulation(); }
+*   render thread:      while ((packet = beginRender()) != nullptr) { draw *packet; endRender(); }
+*/
+class FramePipeline
+{
+public:
+	FramePipeline();
+
+	/** \brief  Waits until a packet is free for writing.
+	*   \return The packet to fill, nullptr once stop() was called
+	*/
+	RenderPacket* beginSimulation();
+
+	/** \brief  Publishes the packet returned by beginSimulation() to the render thread. */
+	void endSimulation();
+
+	/** \brief  Waits for the next published packet.
+	*   \return The packet to draw, nullptr once stop() was called and every published packet was drawn
+	*/
+	const RenderPacket* beginRender();
+
+	/** \brief  Hands the packet returned by beginRender() back to the simulation thread.
+	*           Call it as soon as the packet is no longer read, i.e. before swapping buffers.
+	*/
+	void endRender();
+
+	/** \brief  Wakes up both threads and makes the begin calls return nullptr. */
+	void stop();
+
+	// time the threads spent blocked in the begin calls during the last frame, for balancing the work
+	double getSimulationWaitMilliseconds() const;
+	double getRenderWaitMilliseconds() const;
+
+private:
+	RenderPacket _packets[2];
+	uint64_t _simulated; // packets published, the next one is written to _packets[_simulated % 2]
+	uint64_t _rendered; // packets drawn, the next one is read from _packets[_rendered % 2]
+	bool _stopped;
+	double _simulationWait, _renderWait;
+	mutable std::mutex _mutex;
+	std::condition_variable _packetFree, _packetReady;
+
+	FramePipeline(const FramePipeline&);
+	FramePipeline& operator=(const FramePipeline&);
+};
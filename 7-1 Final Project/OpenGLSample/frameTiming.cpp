@@ -0,0 +1,126 @@
+// STL
+#include <thread>
+#include <algorithm>
+
+// Project
+#include "frameTiming.h"
+
+// ---------------------------------------------------------------------------
+// FixedTimestep
+// ---------------------------------------------------------------------------
+
+FixedTimestep::FixedTimestep(double step, int maxSteps)
+	: _step(step)
+	, _maxSteps(maxSteps)
+	, _lastTime(-1.0)
+	, _accumulator(0.0)
+	, _simulated(0.0)
+{
+}
+
+int FixedTimestep::advance(double now)
+{
+	if (_lastTime < 0.0)
+	{
+		_lastTime = now;
+		return 0;
+	}
+	_accumulator += std::max(now - _lastTime, 0.0);
+	_lastTime = now;
+
+	int steps = (int)(_accumulator / _step);
+	if (steps > _maxSteps)
+	{
+		steps = _maxSteps;
+		_accumulator = 0.0;
+	}
+	else
+	{
+		_accumulator -= steps * _step;
+	}
+	_simulated += steps * _step;
+	return steps;
+}
+
+double FixedTimestep::getStep() const
+{
+	return _step;
+}
+
+double FixedTimestep::getAlpha() const
+{
+	return std::min(_accumulator / _step, 1.0);
+}
+
+double FixedTimestep::getTime() const
+{
+	return _simulated;
+}
+
+// ---------------------------------------------------------------------------
+// FramePacer
+// ---------------------------------------------------------------------------
+
+FramePacer::FramePacer(double framesPerSecond)
+	: _sleepOvershoot(std::chrono::milliseconds(1))
+	, _frameMilliseconds(0.0)
+{
+	setTargetRate(framesPerSecond);
+	_lastFrame = Clock::now();
+	_deadline = _lastFrame + _period;
+}
+
+void FramePacer::setTargetRate(double framesPerSecond)
+{
+	_targetRate = std::max(framesPerSecond, 0.0);
+	_period = _targetRate > 0.0
+		? std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(1.0 / _targetRate))
+		: Clock::duration::zero();
+	_deadline = Clock::now() + _period;
+}
+
+double FramePacer::getTargetRate() const
+{
+	return _targetRate;
+}
+
+void FramePacer::wait()
+{
+	if (_targetRate > 0.0)
+	{
+		// sleep in short slices while a late wake up cannot miss the deadline
+		Clock::time_point now = Clock::now();
+		while (_deadline - now > _sleepOvershoot + std::chrono::milliseconds(1))
+		{
+			std::this_thread::sleep_for(std::chrono::milliseconds(1));
+			Clock::time_point woke = Clock::now();
+			Clock::duration overshoot = woke - now - std::chrono::milliseconds(1);
+			// follows increases right away, decreases slowly, so one lucky sleep does not cause a miss
+			if (overshoot > _sleepOvershoot)
+				_sleepOvershoot = overshoot;
+			else
+				_sleepOvershoot -= (_sleepOvershoot - std::max(overshoot, Clock::duration::zero())) / 16;
+			now = woke;
+		}
+		// spin the rest
+		while (now < _deadline)
+		{
+			std::this_thread::yield();
+			now = Clock::now();
+		}
+
+		// a missed slot restarts the schedule, otherwise the next slot follows this one exactly
+		_deadline += _period;
+		if (_deadline < now)
+			_deadline = now + _period;
+	}
+
+	Clock::time_point now = Clock::now();
+	_frameMilliseconds = std::chrono::duration<double, std::milli>(now - _lastFrame).count();
+	_lastFrame = now;
+}
+
+double FramePacer::getFrameMilliseconds() const
+{
+	return _frameMilliseconds;
+}
@@ -0,0 +1,76 @@
+#pragma once
+
+// STL
+#include <chrono>
+
+/**
+* Fixed timestep accumulator. Real time is fed in, whole steps are taken out, and the
+* remainder gives the blend factor between the last two simulated states for rendering.
+* All times are doubles in seconds, so precision holds over long uptimes.
+*
+*   int steps = timestep.advance(glfwGetTime());
+*   while (steps-- > 0) { previous = current; update(current, timestep.getStep()); }
+*   render(mix(previous, current, timestep.getAlpha()));
+*/
+class FixedTimestep
+{
+public:
+	/** \param step      Simulated seconds per update
+	*   \param maxSteps  Updates per advance() at most; time beyond that is dropped, so a long
+	*                    stall slows the simulation down for a moment instead of jumping it ahead
+	*/
+	FixedTimestep(double step = 1.0 / 120.0, int maxSteps = 8);
+
+	/** \brief  Adds the real time passed since the last call. The first call only starts the clock.
+	*   \return Number of updates to run now
+	*/
+	int advance(double now);
+
+	double getStep() const;
+
+	/** \brief  Gets how far the real time is between the last and the next update, in [0, 1). */
+	double getAlpha() const;
+
+	/** \brief  Gets the simulated time, i.e. updates run * step. */
+	double getTime() const;
+
+private:
+	double _step;
+	int _maxSteps;
+	double _lastTime; // negative before the first advance()
+	double _accumulator;
+	double _simulated;
+};
+
+/**
+* Holds frames to a target rate. wait() returns at the start of the next frame slot: it
+* sleeps while the deadline is far away and spins for the last part, because sleeps wake
+* up late by a platform dependent amount. That amount is measured and adapted to.
+*/
+class FramePacer
+{
+public:
+	/** \param framesPerSecond  Target rate, 0 disables pacing */
+	FramePacer(double framesPerSecond = 60.0);
+
+	void setTargetRate(double framesPerSecond);
+	double getTargetRate() const;
+
+	/** \brief  Waits for the next frame slot. If the frame ran late the schedule restarts from now
+	*           instead of rushing the following frames to catch up.
+	*/
+	void wait();
+
+	/** \brief  Gets the time between the last two wait() returns. */
+	double getFrameMilliseconds() const;
+
+private:
+	typedef std::chrono::steady_clock Clock;
+
+	double _targetRate;
+	Clock::duration _period;
+	Clock::time_point _deadline; // start of the next frame slot
+	Clock::time_point _lastFrame;
+	Clock::duration _sleepOvershoot; // how late sleep_for(1 ms) has returned, worst recent case
+	double _frameMilliseconds;
+};
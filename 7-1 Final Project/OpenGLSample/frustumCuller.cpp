@@ -0,0 +1,232 @@
+// STL
+#include <chrono>
+#include <cstring>
+#include <algorithm>
+
+// SIMD, SSE is always there on the x86 / x64 targets this is built for
+#if defined(__AVX__)
+#include <immintrin.h>
+#define FRUSTUM_CULLER_AVX
+#elif defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#include <xmmintrin.h>
+#define FRUSTUM_CULLER_SSE
+#endif
+
+// Project
+#include "frustumCuller.h"
+#include "jobSystem.h"
+
+namespace {
+
+	const size_t BATCH = 8;
+
+	size_t padded(size_t count)
+	{
+		return (count + BATCH - 1) / BATCH * BATCH;
+	}
+
+} // namespace
+
+// ---------------------------------------------------------------------------
+// Frustum
+// ---------------------------------------------------------------------------
+
+Frustum Frustum::fromMatrix(const glm::mat4& m)
+{
+	// glm is column major, row i is (m[0][i], m[1][i], m[2][i], m[3][i])
+	glm::vec4 row0(m[0][0], m[1][0], m[2][0], m[3][0]);
+	glm::vec4 row1(m[0][1], m[1][1], m[2][1], m[3][1]);
+	glm::vec4 row2(m[0][2], m[1][2], m[2][2], m[3][2]);
+	glm::vec4 row3(m[0][3], m[1][3], m[2][3], m[3][3]);
+
+	Frustum frustum;
+	frustum.planes[0] = row3 + row0; // left
+	frustum.planes[1] = row3 - row0; // right
+	frustum.planes[2] = row3 + row1; // bottom
+	frustum.planes[3] = row3 - row1; // top
+	frustum.planes[4] = row3 + row2; // near
+	frustum.planes[5] = row3 - row2; // far
+
+	// normalized so plane distances are real distances and comparable with radii
+	for (int i = 0; i < 6; i++)
+	{
+		glm::vec4& p = frustum.planes[i];
+		float length = std::sqrt(p.x * p.x + p.y * p.y + p.z * p.z);
+		p = p / length;
+	}
+	return frustum;
+}
+
+bool Frustum::intersects(const BoundingSphere& sphere) const
+{
+	for (int i = 0; i < 6; i++)
+	{
+		const glm::vec4& p = planes[i];
+		if (p.x * sphere.center.x + p.y * sphere.center.y + p.z * sphere.center.z + p.w < -sphere.radius)
+			return false;
+	}
+	return true;
+}
+
+// ---------------------------------------------------------------------------
+// FrustumCuller
+// ---------------------------------------------------------------------------
+
+FrustumCuller::FrustumCuller()
+	: _count(0)
+{
+	_stats.tested = _stats.culled = 0;
+	_stats.milliseconds = 0.0;
+}
+
+void FrustumCuller::clear()
+{
+	_centerX.clear();
+	_centerY.clear();
+	_centerZ.clear();
+	_radius.clear();
+	_count = 0;
+}
+
+uint32_t FrustumCuller::add(const BoundingSphere& sphere)
+{
+	uint32_t index = (uint32_t)_count++;
+	size_t size = padded(_count);
+	if (size != _radius.size())
+	{
+		// a negative radius puts the padding outside of every plane
+		_centerX.resize(size, 0.0f);
+		_centerY.resize(size, 0.0f);
+		_centerZ.resize(size, 0.0f);
+		_radius.resize(size, -FLT_MAX);
+	}
+	set(index, sphere);
+	return index;
+}
+
+void FrustumCuller::set(uint32_t index, const BoundingSphere& sphere)
+{
+	_centerX[index] = sphere.center.x;
+	_centerY[index] = sphere.center.y;
+	_centerZ[index] = sphere.center.z;
+	_radius[index] = sphere.radius;
+}
+
+size_t FrustumCuller::size() const
+{
+	return _count;
+}
+
+const FrustumCuller::CullStats& FrustumCuller::getStats() const
+{
+	return _stats;
+}
+
+void FrustumCuller::cull(const Frustum& frustum, std::vector<uint8_t>& visible)
+{
+	auto start = std::chrono::high_resolution_clock::now();
+
+	// written in whole batches, the padding is cut off again below
+	size_t size = padded(_count);
+	visible.resize(size);
+
+	if (_count < PARALLEL_THRESHOLD)
+	{
+		cullRange(frustum, 0, size, visible.data());
+	}
+	else
+	{
+		// split in whole batches, the job system spreads the chunks over its workers
+		uint8_t* out = visible.data();
+		JobSystem::get().parallelFor(size / BATCH, PARALLEL_THRESHOLD / BATCH / 2, [this, &frustum, out](size_t begin, size_t end)
+		{
+			cullRange(frustum, begin * BATCH, end * BATCH, out);
+		});
+	}
+	visible.resize(_count);
+
+	uint32_t culled = 0;
+	for (size_t i = 0; i < _count; i++)
+		culled += visible[i] ? 0 : 1;
+
+	auto end = std::chrono::high_resolution_clock::now();
+	_stats.tested = (uint32_t)_count;
+	_stats.culled = culled;
+	_stats.milliseconds = std::chrono::duration<double, std::milli>(end - start).count();
+}
+
+void FrustumCuller::cullRange(const Frustum& frustum, size_t begin, size_t end, uint8_t* visible) const
+{
+	const float* cx = _centerX.data();
+	const float* cy = _centerY.data();
+	const float* cz = _centerZ.data();
+	const float* r = _radius.data();
+
+#if defined(FRUSTUM_CULLER_AVX)
+	// a sphere is outside when center . normal + distance < -radius for any plane
+	__m256 px[6], py[6], pz[6], pw[6];
+	for (int p = 0; p < 6; p++)
+	{
+		px[p] = _mm256_set1_ps(frustum.planes[p].x);
+		py[p] = _mm256_set1_ps(frustum.planes[p].y);
+		pz[p] = _mm256_set1_ps(frustum.planes[p].z);
+		pw[p] = _mm256_set1_ps(frustum.planes[p].w);
+	}
+	const __m256 zero = _mm256_setzero_ps();
+	for (size_t i = begin; i < end; i += 8)
+	{
+		__m256 x = _mm256_loadu_ps(cx + i);
+		__m256 y = _mm256_loadu_ps(cy + i);
+		__m256 z = _mm256_loadu_ps(cz + i);
+		__m256 radius = _mm256_loadu_ps(r + i);
+		__m256 outside = zero;
+		for (int p = 0; p < 6; p++)
+		{
+			__m256 d = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(px[p], x), _mm256_mul_ps(py[p], y)),
+				_mm256_add_ps(_mm256_mul_ps(pz[p], z), pw[p]));
+			outside = _mm256_or_ps(outside, _mm256_cmp_ps(_mm256_add_ps(d, radius), zero, _CMP_LT_OQ));
+		}
+		int mask = _mm256_movemask_ps(outside);
+		for (int k = 0; k < 8; k++)
+			visible[i + k] = (uint8_t)(((mask >> k) & 1) ^ 1);
+	}
+#elif defined(FRUSTUM_CULLER_SSE)
+	__m128 px[6], py[6], pz[6], pw[6];
+	for (int p = 0; p < 6; p++)
+	{
+		px[p] = _mm_set1_ps(frustum.planes[p].x);
+		py[p] = _mm_set1_ps(frustum.planes[p].y);
+		pz[p] = _mm_set1_ps(frustum.planes[p].z);
+		pw[p] = _mm_set1_ps(frustum.planes[p].w);
+	}
+	const __m128 zero = _mm_setzero_ps();
+	for (size_t i = begin; i < end; i += 4)
+	{
+		__m128 x = _mm_loadu_ps(cx + i);
+		__m128 y = _mm_loadu_ps(cy + i);
+		__m128 z = _mm_loadu_ps(cz + i);
+		__m128 radius = _mm_loadu_ps(r + i);
+		__m128 outside = zero;
+		for (int p = 0; p < 6; p++)
+		{
+			__m128 d = _mm_add_ps(_mm_add_ps(_mm_mul_ps(px[p], x), _mm_mul_ps(py[p], y)),
+				_mm_add_ps(_mm_mul_ps(pz[p], z), pw[p]));
+			outside = _mm_or_ps(outside, _mm_cmplt_ps(_mm_add_ps(d, radius), zero));
+		}
+		int mask = _mm_movemask_ps(outside);
+		for (int k = 0; k < 4; k++)
+			visible[i + k] = (uint8_t)(((mask >> k) & 1) ^ 1);
+	}
+#else
+	for (size_t i = begin; i < end; i++)
+	{
+		bool inside = true;
+		for (int p = 0; p < 6 && inside; p++)
+		{
+			const glm::vec4& plane = frustum.planes[p];
+			inside = plane.x * cx[i] + plane.y * cy[i] + plane.z * cz[i] + plane.w >= -r[i];
+		}
+		visible[i] = inside ? 1 : 0;
+	}
+#endif
+}
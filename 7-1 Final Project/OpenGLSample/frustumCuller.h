@@ -0,0 +1,73 @@
+#pragma once
+
+// STL
+#include <vector>
+#include <cstdint>
+
+// GLM
+#include <glm/glm.hpp>
+
+// Project
+#include "bounds.h"
+
+/**
+* View frustum as six planes (left, right, bottom, top, near, far), normals pointing inwards.
+*/
+struct Frustum
+{
+	glm::vec4 planes[6]; // xyz = unit normal, w = distance
+
+	/** \brief  Extracts the planes from a projection * view matrix (Gribb / Hartmann). */
+	static Frustum fromMatrix(const glm::mat4& viewProjection);
+
+	/** \brief  Single sphere test, for the odd query outside the batched culler. */
+	bool intersects(const BoundingSphere& sphere) const;
+};
+
+/**
+* Culls world space bounding spheres against a frustum. Spheres are kept as structure of
+* arrays so 4 (SSE) or 8 (AVX) of them are tested against a plane per instruction, and large
+* sets are split in chunks that are culled by the job system's workers.
+*/
+class FrustumCuller
+{
+public:
+	// results of the last cull() call
+	struct CullStats
+	{
+		uint32_t tested;
+		uint32_t culled;
+		double milliseconds;
+	};
+
+	// below this many spheres the jobs cost more than they save
+	static const size_t PARALLEL_THRESHOLD = 16384;
+
+	FrustumCuller();
+
+	void clear();
+
+	/** \brief  Adds a sphere, returns its index. */
+	uint32_t add(const BoundingSphere& sphere);
+
+	/** \brief  Updates a sphere, e.g. after its object moved. */
+	void set(uint32_t index, const BoundingSphere& sphere);
+
+	size_t size() const;
+
+	/** \brief  Tests every sphere against the frustum.
+	*   \param visible  Resized to size(), 1 for spheres inside or intersecting the frustum, 0 for culled ones
+	*/
+	void cull(const Frustum& frustum, std::vector<uint8_t>& visible);
+
+	const CullStats& getStats() const;
+
+private:
+	// SoA storage, padded to a multiple of 8 with spheres that are always culled
+	std::vector<float> _centerX, _centerY, _centerZ, _radius;
+	size_t _count;
+	CullStats _stats;
+
+	// culls [begin, end), begin and end are multiples of 8
+	void cullRange(const Frustum& frustum, size_t begin, size_t end, uint8_t* visible) const;
+};
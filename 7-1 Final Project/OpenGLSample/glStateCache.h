@@ -0,0 +1,284 @@
+#ifndef GL_STATE_CACHE_H
+#define GL_STATE_CACHE_H
+
+#include <glad/glad.h>
+
+// Thin shadow of the OpenGL binding/enable state. Every call compares against the
+// value it last set and only reaches the driver when the state really changes.
+// All code that binds programs, VAOs, buffers or textures, or toggles depth/blend
+// state, has to go through here; a raw gl call behind its back leaves the shadow
+// stale (call invalidate() if that cannot be avoided, e.g. around third party code).
+class GLStateCache
+{
+public:
+	static const int MAX_TEXTURE_UNITS = 16;
+
+	// GL calls issued to the driver and calls dropped as redundant
+	struct FrameStats
+	{
+		unsigned int issued;
+		unsigned int elided;
+	};
+
+	// one cache per GL context, the application only ever has one
+	// ------------------------------------------------------------------------
+	static GLStateCache &get()
+	{
+		static GLStateCache cache;
+		return cache;
+	}
+
+	// closes the current frame's counters, getFrameStats() then reports that frame
+	// ------------------------------------------------------------------------
+	void beginFrame()
+	{
+		lastFrame = frame;
+		frame.issued = frame.elided = 0;
+	}
+	const FrameStats &getFrameStats() const
+	{
+		return lastFrame;
+	}
+	const FrameStats &getCurrentFrameStats() const
+	{
+		return frame;
+	}
+
+	// forgets everything, the next request of each kind always reaches GL
+	// ------------------------------------------------------------------------
+	void invalidate()
+	{
+		program = UNKNOWN;
+		vertexArray = UNKNOWN;
+		activeUnit = UNKNOWN;
+		for (int i = 0; i < BUFFER_TARGET_COUNT; i++)
+			buffers[i] = UNKNOWN;
+		for (int unit = 0; unit < MAX_TEXTURE_UNITS; unit++)
+			for (int i = 0; i < TEXTURE_TARGET_COUNT; i++)
+				textures[unit][i] = UNKNOWN;
+		depthTest = depthWrite = blend = UNKNOWN;
+		depthFunc = blendSrc = blendDst = UNKNOWN;
+	}
+
+	// programs and vertex arrays
+	// ------------------------------------------------------------------------
+	void useProgram(GLuint id)
+	{
+		if (program == id)
+		{
+			frame.elided++;
+			return;
+		}
+		program = id;
+		frame.issued++;
+		glUseProgram(id);
+	}
+	void bindVertexArray(GLuint id)
+	{
+		if (vertexArray == id)
+		{
+			frame.elided++;
+			return;
+		}
+		vertexArray = id;
+		// the element array binding is part of the VAO, so it changes along with it
+		buffers[bufferSlot(GL_ELEMENT_ARRAY_BUFFER)] = UNKNOWN;
+		frame.issued++;
+		glBindVertexArray(id);
+	}
+
+	// buffers; unknown targets are passed straight through
+	// ------------------------------------------------------------------------
+	void bindBuffer(GLenum target, GLuint id)
+	{
+		int slot = bufferSlot(target);
+		if (slot >= 0 && buffers[slot] == id)
+		{
+			frame.elided++;
+			return;
+		}
+		if (slot >= 0)
+			buffers[slot] = id;
+		frame.issued++;
+		glBindBuffer(target, id);
+	}
+
+	// textures
+	// ------------------------------------------------------------------------
+	void activeTexture(unsigned int unit)
+	{
+		if (activeUnit == unit)
+		{
+			frame.elided++;
+			return;
+		}
+		activeUnit = unit;
+		frame.issued++;
+		glActiveTexture(GL_TEXTURE0 + unit);
+	}
+	// binds a texture to the given unit, only switching the active unit when the binding changes
+	void bindTexture(unsigned int unit, GLenum target, GLuint id)
+	{
+		int slot = textureSlot(target);
+		if (slot >= 0 && unit < (unsigned int)MAX_TEXTURE_UNITS && textures[unit][slot] == id)
+		{
+			frame.elided++;
+			return;
+		}
+		activeTexture(unit);
+		if (slot >= 0 && unit < (unsigned int)MAX_TEXTURE_UNITS)
+			textures[unit][slot] = id;
+		frame.issued++;
+		glBindTexture(target, id);
+	}
+	// binds to whatever unit is active, like plain glBindTexture (used while creating textures)
+	void bindTexture(GLenum target, GLuint id)
+	{
+		bindTexture(activeUnit == UNKNOWN ? 0 : activeUnit, target, id);
+	}
+
+	// depth and blend state
+	// ------------------------------------------------------------------------
+	void setDepthTest(bool enabled)
+	{
+		setCapability(GL_DEPTH_TEST, enabled, depthTest);
+	}
+	void setDepthWrite(bool enabled)
+	{
+		if (depthWrite == (GLuint)enabled)
+		{
+			frame.elided++;
+			return;
+		}
+		depthWrite = enabled;
+		frame.issued++;
+		glDepthMask(enabled ? GL_TRUE : GL_FALSE);
+	}
+	void setDepthFunc(GLenum func)
+	{
+		if (depthFunc == func)
+		{
+			frame.elided++;
+			return;
+		}
+		depthFunc = func;
+		frame.issued++;
+		glDepthFunc(func);
+	}
+	void setBlend(bool enabled)
+	{
+		setCapability(GL_BLEND, enabled, blend);
+	}
+	void setBlendFunc(GLenum src, GLenum dst)
+	{
+		if (blendSrc == src && blendDst == dst)
+		{
+			frame.elided++;
+			return;
+		}
+		blendSrc = src;
+		blendDst = dst;
+		frame.issued++;
+		glBlendFunc(src, dst);
+	}
+
+	// deleting a bound object silently resets its binding to 0 in GL, and the name can be
+	// handed out again right away, so deletes have to update the shadow as well
+	// ------------------------------------------------------------------------
+	void deleteProgram(GLuint id)
+	{
+		if (program == id)
+			program = 0;
+		glDeleteProgram(id);
+	}
+	void deleteVertexArray(GLuint id)
+	{
+		if (vertexArray == id)
+		{
+			vertexArray = 0;
+			buffers[bufferSlot(GL_ELEMENT_ARRAY_BUFFER)] = UNKNOWN;
+		}
+		glDeleteVertexArrays(1, &id);
+	}
+	void deleteBuffer(GLuint id)
+	{
+		for (int i = 0; i < BUFFER_TARGET_COUNT; i++)
+		{
+			if (buffers[i] == id)
+				buffers[i] = 0;
+		}
+		glDeleteBuffers(1, &id);
+	}
+	void deleteTexture(GLuint id)
+	{
+		for (int unit = 0; unit < MAX_TEXTURE_UNITS; unit++)
+			for (int i = 0; i < TEXTURE_TARGET_COUNT; i++)
+				if (textures[unit][i] == id)
+					textures[unit][i] = 0;
+		glDeleteTextures(1, &id);
+	}
+
+private:
+	static const GLuint UNKNOWN = 0xFFFFFFFFu;
+	static const int BUFFER_TARGET_COUNT = 6;
+	static const int TEXTURE_TARGET_COUNT = 3;
+
+	GLuint program;
+	GLuint vertexArray;
+	GLuint activeUnit;
+	GLuint buffers[BUFFER_TARGET_COUNT];
+	GLuint textures[MAX_TEXTURE_UNITS][TEXTURE_TARGET_COUNT];
+	GLuint depthTest, depthWrite, blend;
+	GLuint depthFunc, blendSrc, blendDst;
+
+	FrameStats frame;
+	FrameStats lastFrame;
+
+	GLStateCache()
+	{
+		frame.issued = frame.elided = 0;
+		lastFrame = frame;
+		invalidate();
+	}
+	GLStateCache(const GLStateCache&);
+	GLStateCache &operator=(const GLStateCache&);
+
+	static int bufferSlot(GLenum target)
+	{
+		switch (target)
+		{
+		case GL_ARRAY_BUFFER: return 0;
+		case GL_ELEMENT_ARRAY_BUFFER: return 1;
+		case GL_PIXEL_UNPACK_BUFFER: return 2;
+		case GL_PIXEL_PACK_BUFFER: return 3;
+		case GL_UNIFORM_BUFFER: return 4;
+		case GL_COPY_WRITE_BUFFER: return 5;
+		default: return -1;
+		}
+	}
+	static int textureSlot(GLenum target)
+	{
+		switch (target)
+		{
+		case GL_TEXTURE_2D: return 0;
+		case GL_TEXTURE_2D_ARRAY: return 1;
+		case GL_TEXTURE_CUBE_MAP: return 2;
+		default: return -1;
+		}
+	}
+	void setCapability(GLenum cap, bool enabled, GLuint &state)
+	{
+		if (state == (GLuint)enabled)
+		{
+			frame.elided++;
+			return;
+		}
+		state = enabled;
+		frame.issued++;
+		if (enabled)
+			glEnable(cap);
+		else
+			glDisable(cap);
+	}
+};
+#endif
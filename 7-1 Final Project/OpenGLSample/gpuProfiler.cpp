@@ -0,0 +1,267 @@
+// Project
+#include "gpuProfiler.h"
+
+#if OPENGLSAMPLE_GPU_PROFILER
+
+// STL
+#include <algorithm>
+#include <cstring>
+
+// GL
+#include <glad/glad.h>
+
+GpuProfiler& GpuProfiler::get()
+{
+	static GpuProfiler profiler;
+	return profiler;
+}
+
+GpuProfiler::GpuProfiler()
+	: _available(false)
+	, _recording(false)
+	, _frame(0)
+	, _dropped(0)
+{
+}
+
+GpuProfiler::~GpuProfiler()
+{
+	// the context is usually gone by now, release() is the place to free the queries
+}
+
+bool GpuProfiler::init()
+{
+	release();
+
+	// GL 3.3 has timer queries, but a driver may still report a counter without bits
+	GLint bits = 0;
+	glGetQueryiv(GL_TIMESTAMP, GL_QUERY_COUNTER_BITS, &bits);
+	_available = bits > 0;
+	for (int i = 0; i < FRAME_LATENCY; i++)
+	{
+		_frames[i].used = 0;
+		_frames[i].pending = false;
+	}
+	return _available;
+}
+
+void GpuProfiler::release()
+{
+	for (int i = 0; i < FRAME_LATENCY; i++)
+	{
+		Frame& frame = _frames[i];
+		if (!frame.queries.empty())
+			glDeleteQueries((GLsizei)frame.queries.size(), &frame.queries[0]);
+		frame.queries.clear();
+		frame.records.clear();
+		frame.pending = false;
+	}
+	_stack.clear();
+	_keys.clear();
+	_scopes.clear();
+	_history.clear();
+	_available = false;
+	_recording = false;
+	_dropped = 0;
+}
+
+void GpuProfiler::beginFrame()
+{
+	if (!_available)
+		return;
+	if (_recording)
+		endFrame();
+
+	// collect oldest first; queries finish in order, so a pending frame means the newer ones are too
+	for (int age = FRAME_LATENCY - 1; age >= 1; age--)
+	{
+		if (_frame < (uint64_t)age)
+			continue;
+		Frame& frame = _frames[(_frame - age) % FRAME_LATENCY];
+		if (!frame.pending)
+			continue;
+		if (!ready(frame))
+			break;
+		collect(frame);
+	}
+
+	// the slot of FRAME_LATENCY frames ago is needed now; waiting for it would stall
+	Frame& frame = _frames[_frame % FRAME_LATENCY];
+	if (frame.pending)
+	{
+		if (ready(frame))
+			collect(frame);
+		else
+		{
+			frame.pending = false;
+			_dropped++;
+		}
+	}
+	frame.records.clear();
+	frame.used = 0;
+	_stack.clear();
+	_recording = true;
+}
+
+void GpuProfiler::endFrame()
+{
+	if (!_available || !_recording)
+		return;
+	while (!_stack.empty())
+		endScope();
+	Frame& frame = _frames[_frame % FRAME_LATENCY];
+	frame.pending = !frame.records.empty();
+	_recording = false;
+	_frame++;
+}
+
+void GpuProfiler::beginScope(const char* name)
+{
+	if (!_available || !_recording)
+		return;
+	Frame& frame = _frames[_frame % FRAME_LATENCY];
+	if (frame.records.size() >= (size_t)MAX_SCOPES_PER_FRAME)
+	{
+		_stack.push_back(-1); // still has to be balanced by endScope()
+		return;
+	}
+
+	Record record;
+	record.scope = findScope(name, (int)_stack.size());
+	record.begin = nextQuery(frame);
+	record.end = -1;
+	glQueryCounter(frame.queries[record.begin], GL_TIMESTAMP);
+	_stack.push_back((int)frame.records.size());
+	frame.records.push_back(record);
+}
+
+void GpuProfiler::endScope()
+{
+	if (!_available || !_recording || _stack.empty())
+		return;
+	int index = _stack.back();
+	_stack.pop_back();
+	if (index < 0)
+		return;
+	Frame& frame = _frames[_frame % FRAME_LATENCY];
+	Record& record = frame.records[index];
+	record.end = nextQuery(frame);
+	glQueryCounter(frame.queries[record.end], GL_TIMESTAMP);
+}
+
+bool GpuProfiler::isAvailable() const
+{
+	return _available;
+}
+
+const std::vector<GpuProfiler::ScopeStats>& GpuProfiler::getScopes() const
+{
+	return _scopes;
+}
+
+const GpuProfiler::ScopeStats* GpuProfiler::find(const char* name) const
+{
+	for (size_t i = 0; i < _scopes.size(); i++)
+	{
+		if (_scopes[i].name == name)
+			return &_scopes[i];
+	}
+	return NULL;
+}
+
+unsigned int GpuProfiler::getDroppedFrames() const
+{
+	return _dropped;
+}
+
+bool GpuProfiler::ready(const Frame& frame) const
+{
+	// the last query issued finishes last
+	GLint available = 0;
+	glGetQueryObjectiv(frame.queries[frame.used - 1], GL_QUERY_RESULT_AVAILABLE, &available);
+	return available != 0;
+}
+
+void GpuProfiler::collect(Frame& frame)
+{
+	frame.pending = false;
+	for (size_t i = 0; i < frame.records.size(); i++)
+	{
+		const Record& record = frame.records[i];
+		GLuint64 begin = 0, end = 0;
+		glGetQueryObjectui64v(frame.queries[record.begin], GL_QUERY_RESULT, &begin);
+		glGetQueryObjectui64v(frame.queries[record.end], GL_QUERY_RESULT, &end);
+		History& history = _history[record.scope];
+		history.frameTotal += end > begin ? (end - begin) / 1000000.0 : 0.0;
+		history.touched = true;
+	}
+
+	// one sample per scope and frame, then the rolling statistics of the scopes that got one
+	for (size_t s = 0; s < _history.size(); s++)
+	{
+		History& history = _history[s];
+		if (!history.touched)
+			continue;
+		history.samples[history.next] = history.frameTotal;
+		history.next = (history.next + 1) % HISTORY;
+		history.count = std::min(history.count + 1, HISTORY);
+
+		ScopeStats& stats = _scopes[s];
+		stats.last = history.frameTotal;
+		stats.samples++;
+		double total = 0.0;
+		stats.min = stats.max = history.samples[0];
+		for (int i = 0; i < history.count; i++)
+		{
+			total += history.samples[i];
+			stats.min = std::min(stats.min, history.samples[i]);
+			stats.max = std::max(stats.max, history.samples[i]);
+		}
+		stats.average = total / history.count;
+		history.frameTotal = 0.0;
+		history.touched = false;
+	}
+}
+
+int GpuProfiler::findScope(const char* name, int depth)
+{
+	for (size_t i = 0; i < _keys.size(); i++)
+	{
+		if (_keys[i] == name)
+			return (int)i;
+	}
+	for (size_t i = 0; i < _scopes.size(); i++)
+	{
+		if (strcmp(_scopes[i].name.c_str(), name) == 0)
+		{
+			_keys[i] = name; // the newest pointer of a name makes the next lookup a pointer compare
+			return (int)i;
+		}
+	}
+
+	ScopeStats stats;
+	stats.name = name;
+	stats.depth = depth;
+	stats.last = stats.average = stats.min = stats.max = 0.0;
+	stats.samples = 0;
+	_scopes.push_back(stats);
+	History history;
+	memset(&history, 0, sizeof(history));
+	_history.push_back(history);
+	_keys.push_back(name);
+	return (int)_scopes.size() - 1;
+}
+
+int GpuProfiler::nextQuery(Frame& frame)
+{
+	if (frame.used == (int)frame.queries.size())
+	{
+		// grows in blocks, after the first frames no queries are created anymore
+		size_t first = frame.queries.size();
+		frame.queries.resize(first + 32);
+		glGenQueries(32, &frame.queries[first]);
+	}
+	return frame.used++;
+}
+
+#endif
@@ -0,0 +1,153 @@
+#pragma once
+
+// GPU profiling is on unless the build defines OPENGLSAMPLE_GPU_PROFILER=0, which turns the
+// GPU_PROFILE_ macros into nothing and leaves no profiler code in the binary.
+#ifndef OPENGLSAMPLE_GPU_PROFILER
+#define OPENGLSAMPLE_GPU_PROFILER 1
+#endif
+
+#if OPENGLSAMPLE_GPU_PROFILER
+
+// STL
+#include <vector>
+#include <string>
+#include <cstdint>
+
+/**
+* GPU time of named scopes, measured with GL_TIMESTAMP queries so scopes can nest. Each frame
+* records into one slot of a FRAME_LATENCY deep ring and is read back only once the driver
+* reports its queries available, so the CPU never waits on the GPU; a frame still pending when
+* its slot comes around again is dropped instead. A scope opened several times in a frame counts
+* with the sum of its times. Works with any GL 3.3 driver that has a timestamp counter, software
+* rasterizers like llvmpipe included; without one every call does nothing.
+*
+*   GPU_PROFILE_FRAME_BEGIN();
+*   { GPU_PROFILE_SCOPE("scene"); draw(); }
+*   GPU_PROFILE_FRAME_END();
+*/
+class GpuProfiler
+{
+public:
+	static const int FRAME_LATENCY = 4; // frames of queries in flight
+	static const int HISTORY = 64; // frames the rolling statistics cover
+	static const int MAX_SCOPES_PER_FRAME = 256; // scope instances, further ones are not measured
+
+	struct ScopeStats
+	{
+		std::string name;
+		int depth; // nesting level the scope was first seen at, 0 = outermost
+		double last; // milliseconds in the newest measured frame
+		double average, min, max; // over the last HISTORY measured frames
+		unsigned int samples; // measured frames so far
+	};
+
+	/** \brief  Gets the profiler of the GL context, the application only ever has one. */
+	static GpuProfiler& get();
+
+	/** \brief  Creates the queries. Needs a current context with loaded GL functions.
+	*   \return False when the driver has no timestamp counter, profiling then stays off
+	*/
+	bool init();
+
+	void release();
+
+	/** \brief  Collects finished frames and starts recording a new one. */
+	void beginFrame();
+
+	void endFrame();
+
+	/** \param name  A string that lives as long as the profiler, e.g. a literal. Scopes are
+	*                matched by content, so equal names from different places share statistics.
+	*/
+	void beginScope(const char* name);
+
+	void endScope();
+
+	bool isAvailable() const;
+
+	/** \brief  Gets the statistics of every scope seen so far, in order of first appearance. */
+	const std::vector<ScopeStats>& getScopes() const;
+
+	/** \return The statistics of the scope, NULL when it was never measured */
+	const ScopeStats* find(const char* name) const;
+
+	/** \brief  Gets the frames whose results were not ready in time and were thrown away. */
+	unsigned int getDroppedFrames() const;
+
+private:
+	struct Record
+	{
+		int scope; // into _scopes
+		int begin, end; // into the frame's queries
+	};
+	struct Frame
+	{
+		std::vector<unsigned int> queries; // GL query names, grown on demand
+		std::vector<Record> records;
+		int used; // queries issued this frame
+		bool pending; // issued and not collected yet
+	};
+	struct History
+	{
+		double samples[HISTORY];
+		int next, count;
+		double frameTotal; // sum of the frame being collected
+		bool touched;
+	};
+
+	bool _available;
+	bool _recording;
+	uint64_t _frame;
+	Frame _frames[FRAME_LATENCY];
+	std::vector<int> _stack; // open records of the current frame
+	std::vector<const char*> _keys; // name pointers seen, for a quick match before comparing strings
+	std::vector<ScopeStats> _scopes;
+	std::vector<History> _history;
+	unsigned int _dropped;
+
+	GpuProfiler();
+	~GpuProfiler();
+	bool ready(const Frame& frame) const;
+	void collect(Frame& frame);
+	int findScope(const char* name, int depth);
+	int nextQuery(Frame& frame);
+
+	GpuProfiler(const GpuProfiler&);
+	GpuProfiler& operator=(const GpuProfiler&);
+};
+
+/**
+* Measures the enclosing block.
+*/
+class GpuProfileScope
+{
+public:
+	explicit GpuProfileScope(const char* name) { GpuProfiler::get().beginScope(name); }
+	~GpuProfileScope() { GpuProfiler::get().endScope(); }
+
+private:
+	GpuProfileScope(const GpuProfileScope&);
+	GpuProfileScope& operator=(const GpuProfileScope&);
+};
+
+#define GPU_PROFILE_CONCAT_(a, b) a##b
+#define GPU_PROFILE_CONCAT(a, b) GPU_PROFILE_CONCAT_(a, b)
+#define GPU_PROFILE_INIT() GpuProfiler::get().init()
+#define GPU_PROFILE_RELEASE() GpuProfiler::get().release()
+#define GPU_PROFILE_FRAME_BEGIN() GpuProfiler::get().beginFrame()
+#define GPU_PROFILE_FRAME_END() GpuProfiler::get().endFrame()
+#define GPU_PROFILE_SCOPE(name) GpuProfileScope GPU_PROFILE_CONCAT(gpuProfileScope, __LINE__)(name)
+#define GPU_PROFILE_BEGIN(name) GpuProfiler::get().beginScope(name)
+#define GPU_PROFILE_END() GpuProfiler::get().endScope()
+
+#else
+
+#define GPU_PROFILE_INIT() ((void)0)
+#define GPU_PROFILE_RELEASE() ((void)0)
+#define GPU_PROFILE_FRAME_BEGIN() ((void)0)
+#define GPU_PROFILE_FRAME_END() ((void)0)
+#define GPU_PROFILE_SCOPE(name) ((void)0)
+#define GPU_PROFILE_BEGIN(name) ((void)0)
+#define GPU_PROFILE_END() ((void)0)
+
+#endif
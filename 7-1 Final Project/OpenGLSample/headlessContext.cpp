@@ -0,0 +1,210 @@
+// STL
+#include <iostream>
+#include <cstring>
+
+// Project
+#include "headlessContext.h"
+
+#if !defined(OPENGLSAMPLE_HEADLESS_EGL) && !defined(OPENGLSAMPLE_HEADLESS_OSMESA) && defined(__linux__)
+#define OPENGLSAMPLE_HEADLESS_EGL
+#endif
+
+#if defined(OPENGLSAMPLE_HEADLESS_EGL)
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+#elif defined(OPENGLSAMPLE_HEADLESS_OSMESA)
+#include <GL/osmesa.h>
+#endif
+
+namespace {
+
+	const unsigned int GL_RENDERER_NAME = 0x1F01; // GL_RENDERER, without pulling in a GL header here
+	typedef const unsigned char* (*GetStringFunction)(unsigned int name);
+
+#if defined(OPENGLSAMPLE_HEADLESS_EGL)
+	bool hasExtension(const char* extensions, const char* name)
+	{
+		size_t length = strlen(name);
+		for (const char* p = extensions; p != NULL && (p = strstr(p, name)) != NULL; p += length)
+		{
+			if ((p == extensions || p[-1] == ' ') && (p[length] == ' ' || p[length] == '\0'))
+				return true;
+		}
+		return false;
+	}
+#endif
+
+} // namespace
+
+HeadlessContext::HeadlessContext()
+	: _display(NULL)
+	, _context(NULL)
+	, _buffer(NULL)
+{
+}
+
+HeadlessContext::~HeadlessContext()
+{
+	destroy();
+}
+
+#if defined(OPENGLSAMPLE_HEADLESS_EGL)
+
+bool HeadlessContext::create()
+{
+	destroy();
+
+	// a surfaceless platform display needs neither X11 nor a DRM device
+	EGLDisplay display = EGL_NO_DISPLAY;
+	const char* clientExtensions = eglQueryString(EGL_NO_DISPLAY, EGL_EXTENSIONS);
+	PFNEGLGETPLATFORMDISPLAYEXTPROC getPlatformDisplay =
+		(PFNEGLGETPLATFORMDISPLAYEXTPROC)eglGetProcAddress("eglGetPlatformDisplayEXT");
+	if (getPlatformDisplay != NULL && hasExtension(clientExtensions, "EGL_MESA_platform_surfaceless"))
+		display = getPlatformDisplay(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, NULL);
+	if (display == EGL_NO_DISPLAY)
+		display = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+
+	EGLint major, minor;
+	if (display == EGL_NO_DISPLAY || !eglInitialize(display, &major, &minor))
+	{
+		std::cout << "ERROR::HEADLESS::EGL_INITIALIZE_FAILED 0x" << std::hex << eglGetError() << std::dec << std::endl;
+		return false;
+	}
+	_display = display;
+
+	if (!hasExtension(eglQueryString(display, EGL_EXTENSIONS), "EGL_KHR_surfaceless_context") || !eglBindAPI(EGL_OPENGL_API))
+	{
+		std::cout << "ERROR::HEADLESS::EGL_NO_SURFACELESS_DESKTOP_GL" << std::endl;
+		destroy();
+		return false;
+	}
+
+	// no surface will ever be created, so the config only has to support desktop GL
+	const EGLint configAttributes[] = {
+		EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT,
+		EGL_SURFACE_TYPE, 0,
+		EGL_NONE
+	};
+	EGLConfig config;
+	EGLint configCount = 0;
+	if (!eglChooseConfig(display, configAttributes, &config, 1, &configCount) || configCount == 0)
+	{
+		std::cout << "ERROR::HEADLESS::EGL_NO_CONFIG" << std::endl;
+		destroy();
+		return false;
+	}
+
+	// same version and profile the window asks GLFW for
+	const EGLint contextAttributes[] = {
+		EGL_CONTEXT_MAJOR_VERSION, 3,
+		EGL_CONTEXT_MINOR_VERSION, 3,
+		EGL_CONTEXT_OPENGL_PROFILE_MASK, EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT,
+		EGL_NONE
+	};
+	EGLContext context = eglCreateContext(display, config, EGL_NO_CONTEXT, contextAttributes);
+	if (context == EGL_NO_CONTEXT)
+	{
+		std::cout << "ERROR::HEADLESS::EGL_CREATE_CONTEXT_FAILED 0x" << std::hex << eglGetError() << std::dec << std::endl;
+		destroy();
+		return false;
+	}
+	_context = context;
+
+	if (!eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, context))
+	{
+		std::cout << "ERROR::HEADLESS::EGL_MAKE_CURRENT_FAILED 0x" << std::hex << eglGetError() << std::dec << std::endl;
+		destroy();
+		return false;
+	}
+	return true;
+}
+
+void HeadlessContext::destroy()
+{
+	if (_display == NULL)
+		return;
+	eglMakeCurrent(_display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+	if (_context != NULL)
+		eglDestroyContext(_display, _context);
+	eglTerminate(_display);
+	_context = NULL;
+	_display = NULL;
+}
+
+void* HeadlessContext::getProcAddress(const char* name)
+{
+	return (void*)eglGetProcAddress(name);
+}
+
+#elif defined(OPENGLSAMPLE_HEADLESS_OSMESA)
+
+bool HeadlessContext::create()
+{
+	destroy();
+
+	const int attributes[] = {
+		OSMESA_FORMAT, OSMESA_RGBA,
+		OSMESA_DEPTH_BITS, 24,
+		OSMESA_PROFILE, OSMESA_CORE_PROFILE,
+		OSMESA_CONTEXT_MAJOR_VERSION, 3,
+		OSMESA_CONTEXT_MINOR_VERSION, 3,
+		0
+	};
+	OSMesaContext context = OSMesaCreateContextAttribs(attributes, NULL);
+	if (context == NULL)
+	{
+		std::cout << "ERROR::HEADLESS::OSMESA_CREATE_CONTEXT_FAILED" << std::endl;
+		return false;
+	}
+	_context = context;
+
+	// OSMesa only binds a context together with a color buffer; frames go to an FBO, so 1x1 is enough
+	_buffer = new unsigned char[4];
+	if (!OSMesaMakeCurrent(context, _buffer, GL_UNSIGNED_BYTE, 1, 1))
+	{
+		std::cout << "ERROR::HEADLESS::OSMESA_MAKE_CURRENT_FAILED" << std::endl;
+		destroy();
+		return false;
+	}
+	return true;
+}
+
+void HeadlessContext::destroy()
+{
+	if (_context != NULL)
+		OSMesaDestroyContext((OSMesaContext)_context);
+	_context = NULL;
+	delete[] _buffer;
+	_buffer = NULL;
+}
+
+void* HeadlessContext::getProcAddress(const char* name)
+{
+	return (void*)OSMesaGetProcAddress(name);
+}
+
+#else
+
+bool HeadlessContext::create()
+{
+	std::cout << "ERROR::HEADLESS::NOT_SUPPORTED build with OPENGLSAMPLE_HEADLESS_EGL or OPENGLSAMPLE_HEADLESS_OSMESA" << std::endl;
+	return false;
+}
+
+void HeadlessContext::destroy()
+{
+}
+
+void* HeadlessContext::getProcAddress(const char* /*name*/)
+{
+	return NULL;
+}
+
+#endif
+
+const char* HeadlessContext::getRenderer() const
+{
+	GetStringFunction getString = (GetStringFunction)getProcAddress("glGetString");
+	const unsigned char* renderer = getString != NULL ? getString(GL_RENDERER_NAME) : NULL;
+	return renderer != NULL ? (const char*)renderer : "unknown";
+}
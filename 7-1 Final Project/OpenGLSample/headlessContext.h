@@ -0,0 +1,39 @@
+#pragma once
+
+/**
+* OpenGL 3.3 core context without a window, for rendering on machines with no display
+* or GPU (Mesa's llvmpipe / softpipe). There is no default framebuffer; everything is
+* drawn into an OffscreenTarget.
+*
+* Backends, picked at compile time:
+*   OPENGLSAMPLE_HEADLESS_EGL     surfaceless EGL (EGL_MESA_platform_surfaceless or the default display), link libEGL
+*   OPENGLSAMPLE_HEADLESS_OSMESA  Mesa's off-screen interface, link libOSMesa
+* EGL is the default on Linux; other platforms get a context only with one of the two defined.
+*/
+class HeadlessContext
+{
+public:
+	HeadlessContext();
+	~HeadlessContext();
+
+	/** \brief  Creates the context and makes it current on the calling thread.
+	*   \return True on success, errors are printed.
+	*/
+	bool create();
+
+	void destroy();
+
+	/** \brief  Looks up a GL function, pass it to gladLoadGLLoader(). Only valid after create(). */
+	static void* getProcAddress(const char* name);
+
+	/** \brief  Gets the renderer string of the driver, e.g. "llvmpipe (LLVM 15.0.7, 256 bits)". */
+	const char* getRenderer() const;
+
+private:
+	void* _display; // EGLDisplay
+	void* _context; // EGLContext or OSMesaContext
+	unsigned char* _buffer; // OSMesa needs a color buffer to make the context current
+
+	HeadlessContext(const HeadlessContext&);
+	HeadlessContext& operator=(const HeadlessContext&);
+};
@@ -0,0 +1,183 @@
+#ifndef INSTANCE_BATCH_H
+#define INSTANCE_BATCH_H
+
+#include <glad/glad.h>
+
+#include <glm/glm.hpp>
+
+#include "glStateCache.h"
+
+#include <vector>
+#include <cstddef>
+
+// per-instance vertex data, laid out to match the INSTANCED camera shader permutation
+struct InstanceData
+{
+	glm::mat4 model;	// locations 5-8
+	glm::vec4 tint;		// location 9, multiplied into the sampled color
+	glm::vec4 textureRect;	// location 10, offset and scale of the image in its texture array layer
+	float textureLayer;	// location 11
+};
+
+// Collects the transforms of many copies of one mesh into a GPU instance buffer so they
+// can be drawn with a single glDraw*Instanced call instead of one draw per copy.
+class InstanceBatch
+{
+public:
+	// after the five attributes Mesh uses (position, normal, uv, tangent, bitangent)
+	static const GLuint FIRST_ATTRIBUTE_LOCATION = 5;
+
+	InstanceBatch() : buffer(0), vertexArray(0), capacity(0)
+	{
+	}
+	~InstanceBatch()
+	{
+		if (vertexArray != 0)
+			GLStateCache::get().deleteVertexArray(vertexArray);
+		if (buffer != 0)
+			GLStateCache::get().deleteBuffer(buffer);
+	}
+
+	// CPU side collection
+	// ------------------------------------------------------------------------
+	void clear()
+	{
+		instances.clear();
+	}
+	void add(const glm::mat4 &model, const glm::vec4 &tint = glm::vec4(1.0f),
+		const glm::vec4 &textureRect = glm::vec4(0.0f, 0.0f, 1.0f, 1.0f), float textureLayer = 0.0f)
+	{
+		InstanceData instance;
+		instance.model = model;
+		instance.tint = tint;
+		instance.textureRect = textureRect;
+		instance.textureLayer = textureLayer;
+		instances.push_back(instance);
+	}
+	GLsizei size() const
+	{
+		return (GLsizei)instances.size();
+	}
+	const InstanceData &operator[](size_t i) const
+	{
+		return instances[i];
+	}
+
+	// copies the collected instances into the instance buffer. The buffer only grows;
+	// when it does not have to, the old storage is orphaned first so the driver never
+	// waits for draws of the previous frame still reading it.
+	// ------------------------------------------------------------------------
+	void upload()
+	{
+		GLStateCache &glState = GLStateCache::get();
+		if (buffer == 0)
+			glGenBuffers(1, &buffer);
+		glState.bindBuffer(GL_ARRAY_BUFFER, buffer);
+
+		size_t bytes = instances.size() * sizeof(InstanceData);
+		if (instances.size() > capacity)
+		{
+			capacity = instances.size();
+			glBufferData(GL_ARRAY_BUFFER, bytes, instances.data(), GL_DYNAMIC_DRAW);
+		}
+		else if (bytes > 0)
+		{
+			glBufferData(GL_ARRAY_BUFFER, capacity * sizeof(InstanceData), NULL, GL_DYNAMIC_DRAW);
+			glBufferSubData(GL_ARRAY_BUFFER, 0, bytes, instances.data());
+		}
+	}
+
+	// creates the VAO instanced draws of this batch go through: a copy of the mesh VAO's vertex
+	// attributes and index buffer plus the instance attributes (divisor 1). The batch needs a VAO
+	// of its own because several batches can draw the same mesh, each from its own instance buffer.
+	// ------------------------------------------------------------------------
+	GLuint createVertexArray(GLuint meshVertexArray)
+	{
+		GLStateCache &glState = GLStateCache::get();
+		if (buffer == 0)
+			glGenBuffers(1, &buffer);
+		if (vertexArray == 0)
+			glGenVertexArrays(1, &vertexArray);
+
+		// read back the mesh attributes (the locations below the instance ones) and its index buffer
+		struct VertexAttribute
+		{
+			GLint enabled, size, type, normalized, stride, buffer, integer, divisor;
+			void* pointer;
+		};
+		VertexAttribute attributes[FIRST_ATTRIBUTE_LOCATION];
+		GLint elementBuffer = 0;
+		glState.bindVertexArray(meshVertexArray);
+		glGetIntegerv(GL_ELEMENT_ARRAY_BUFFER_BINDING, &elementBuffer);
+		for (GLuint location = 0; location < FIRST_ATTRIBUTE_LOCATION; location++)
+		{
+			VertexAttribute &attribute = attributes[location];
+			glGetVertexAttribiv(location, GL_VERTEX_ATTRIB_ARRAY_ENABLED, &attribute.enabled);
+			glGetVertexAttribiv(location, GL_VERTEX_ATTRIB_ARRAY_SIZE, &attribute.size);
+			glGetVertexAttribiv(location, GL_VERTEX_ATTRIB_ARRAY_TYPE, &attribute.type);
+			glGetVertexAttribiv(location, GL_VERTEX_ATTRIB_ARRAY_NORMALIZED, &attribute.normalized);
+			glGetVertexAttribiv(location, GL_VERTEX_ATTRIB_ARRAY_STRIDE, &attribute.stride);
+			glGetVertexAttribiv(location, GL_VERTEX_ATTRIB_ARRAY_BUFFER_BINDING, &attribute.buffer);
+			glGetVertexAttribiv(location, GL_VERTEX_ATTRIB_ARRAY_INTEGER, &attribute.integer);
+			glGetVertexAttribiv(location, GL_VERTEX_ATTRIB_ARRAY_DIVISOR, &attribute.divisor);
+			glGetVertexAttribPointerv(location, GL_VERTEX_ATTRIB_ARRAY_POINTER, &attribute.pointer);
+		}
+
+		glState.bindVertexArray(vertexArray);
+		glState.bindBuffer(GL_ELEMENT_ARRAY_BUFFER, (GLuint)elementBuffer);
+		for (GLuint location = 0; location < FIRST_ATTRIBUTE_LOCATION; location++)
+		{
+			const VertexAttribute &attribute = attributes[location];
+			if (!attribute.enabled)
+				continue;
+			glState.bindBuffer(GL_ARRAY_BUFFER, (GLuint)attribute.buffer);
+			if (attribute.integer)
+				glVertexAttribIPointer(location, attribute.size, attribute.type, attribute.stride, attribute.pointer);
+			else
+				glVertexAttribPointer(location, attribute.size, attribute.type, (GLboolean)attribute.normalized, attribute.stride, attribute.pointer);
+			glVertexAttribDivisor(location, attribute.divisor);
+			glEnableVertexAttribArray(location);
+		}
+
+		glState.bindBuffer(GL_ARRAY_BUFFER, buffer);
+		// a mat4 attribute takes four consecutive vec4 locations
+		for (GLuint column = 0; column < 4; column++)
+		{
+			GLuint location = FIRST_ATTRIBUTE_LOCATION + column;
+			glEnableVertexAttribArray(location);
+			glVertexAttribPointer(location, 4, GL_FLOAT, GL_FALSE, sizeof(InstanceData), (void*)(column * sizeof(glm::vec4)));
+			glVertexAttribDivisor(location, 1);
+		}
+		GLuint tintLocation = FIRST_ATTRIBUTE_LOCATION + 4;
+		glEnableVertexAttribArray(tintLocation);
+		glVertexAttribPointer(tintLocation, 4, GL_FLOAT, GL_FALSE, sizeof(InstanceData), (void*)offsetof(InstanceData, tint));
+		glVertexAttribDivisor(tintLocation, 1);
+
+		// only read by the TEXTURE_ARRAY permutation, so instances of one draw can use different images
+		GLuint rectLocation = FIRST_ATTRIBUTE_LOCATION + 5;
+		glEnableVertexAttribArray(rectLocation);
+		glVertexAttribPointer(rectLocation, 4, GL_FLOAT, GL_FALSE, sizeof(InstanceData), (void*)offsetof(InstanceData, textureRect));
+		glVertexAttribDivisor(rectLocation, 1);
+		GLuint layerLocation = FIRST_ATTRIBUTE_LOCATION + 6;
+		glEnableVertexAttribArray(layerLocation);
+		glVertexAttribPointer(layerLocation, 1, GL_FLOAT, GL_FALSE, sizeof(InstanceData), (void*)offsetof(InstanceData, textureLayer));
+		glVertexAttribDivisor(layerLocation, 1);
+
+		glState.bindVertexArray(0);
+		return vertexArray;
+	}
+	GLuint getVertexArray() const
+	{
+		return vertexArray;
+	}
+
+private:
+	GLuint buffer;
+	GLuint vertexArray;	// see createVertexArray
+	size_t capacity;	// in instances
+	std::vector<InstanceData> instances;
+
+	InstanceBatch(const InstanceBatch&);
+	InstanceBatch &operator=(const InstanceBatch&);
+};
+#endif
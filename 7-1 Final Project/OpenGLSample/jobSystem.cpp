@@ -0,0 +1,243 @@
+// STL
+#include <algorithm>
+#include <exception>
+#include <cstdio>
+
+// Project
+#include "jobSystem.h"
+#include "cpuTracer.h"
+
+namespace {
+
+	const int64_t QUEUE_MASK = (int64_t)JobSystem::MAX_JOBS_PER_THREAD - 1;
+
+	// the calling thread's slot, assigned on its first create()
+	thread_local void* t_threadState = nullptr;
+
+} // namespace
+
+// ---------------------------------------------------------------------------
+// WorkQueue
+// ---------------------------------------------------------------------------
+
+JobSystem::WorkQueue::WorkQueue()
+	: top(0)
+	, bottom(0)
+{
+	for (size_t i = 0; i < MAX_JOBS_PER_THREAD; i++)
+		jobs[i].store(nullptr, std::memory_order_relaxed);
+}
+
+bool JobSystem::WorkQueue::push(Job* job)
+{
+	int64_t b = bottom.load(std::memory_order_relaxed);
+	int64_t t = top.load(std::memory_order_acquire);
+	if (b - t > QUEUE_MASK)
+		return false;
+	jobs[b & QUEUE_MASK].store(job, std::memory_order_relaxed);
+	bottom.store(b + 1, std::memory_order_release); // publishes the job and its data to thieves
+	return true;
+}
+
+Job* JobSystem::WorkQueue::pop()
+{
+	int64_t b = bottom.load(std::memory_order_relaxed) - 1;
+	bottom.store(b, std::memory_order_relaxed);
+	std::atomic_thread_fence(std::memory_order_seq_cst);
+	int64_t t = top.load(std::memory_order_relaxed);
+	if (t > b)
+	{
+		// empty
+		bottom.store(b + 1, std::memory_order_relaxed);
+		return nullptr;
+	}
+
+	Job* job = jobs[b & QUEUE_MASK].load(std::memory_order_relaxed);
+	if (t == b)
+	{
+		// last job, a thief may be taking it at the same time and only one of us wins
+		if (!top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+			job = nullptr;
+		bottom.store(b + 1, std::memory_order_relaxed);
+	}
+	return job;
+}
+
+Job* JobSystem::WorkQueue::steal()
+{
+	int64_t t = top.load(std::memory_order_acquire);
+	std::atomic_thread_fence(std::memory_order_seq_cst);
+	int64_t b = bottom.load(std::memory_order_acquire);
+	if (t >= b)
+		return nullptr;
+
+	Job* job = jobs[t & QUEUE_MASK].load(std::memory_order_relaxed);
+	if (!top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+		return nullptr; // lost against the owner or another thief
+	return job;
+}
+
+// ---------------------------------------------------------------------------
+// JobSystem
+// ---------------------------------------------------------------------------
+
+JobSystem& JobSystem::get()
+{
+	static JobSystem instance;
+	return instance;
+}
+
+JobSystem::JobSystem()
+	: _threadCount(0)
+	, _queued(0)
+	, _sleeping(0)
+	, _stopping(false)
+{
+	for (size_t i = 0; i < MAX_THREADS; i++)
+		_threads[i].store(nullptr, std::memory_order_relaxed);
+
+	// the threads that create jobs take part in executing them, so one core is left for them
+	size_t cores = std::max(1u, std::thread::hardware_concurrency());
+	size_t workerCount = std::min(cores - 1, MAX_THREADS / 2);
+	for (size_t i = 0; i < workerCount; i++)
+		_workers.push_back(std::thread(&JobSystem::workerLoop, this, i));
+}
+
+JobSystem::~JobSystem()
+{
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		_stopping.store(true);
+	}
+	_wake.notify_all();
+	for (size_t i = 0; i < _workers.size(); i++)
+		_workers[i].join();
+	for (size_t i = 0; i < MAX_THREADS; i++)
+		delete _threads[i].load();
+}
+
+size_t JobSystem::getWorkerCount() const
+{
+	return _workers.size();
+}
+
+JobSystem::ThreadState& JobSystem::currentThread()
+{
+	ThreadState* state = static_cast<ThreadState*>(t_threadState);
+	if (state == nullptr)
+	{
+		uint32_t index = _threadCount.fetch_add(1);
+		if (index >= MAX_THREADS)
+		{
+			// out of slots, should never happen with the few threads of this program
+			_threadCount.fetch_sub(1);
+			std::terminate();
+		}
+		state = new ThreadState();
+		state->allocated = 0;
+		state->random = 2463534242u + index * 7919u;
+		_threads[index].store(state, std::memory_order_release);
+		t_threadState = state;
+	}
+	return *state;
+}
+
+Job* JobSystem::create(JobFunction function, Job* parent)
+{
+	ThreadState& thread = currentThread();
+	Job* job = &thread.jobs[thread.allocated++ & QUEUE_MASK];
+	job->function = function;
+	job->parent = parent;
+	job->unfinished.store(1, std::memory_order_relaxed);
+	if (parent != nullptr)
+		parent->unfinished.fetch_add(1, std::memory_order_relaxed);
+	return job;
+}
+
+void JobSystem::run(Job* job)
+{
+	if (!currentThread().queue.push(job))
+	{
+		execute(job);
+		return;
+	}
+	// pairs with the check in workerLoop: either a worker sees the job or we see the sleeper
+	_queued.fetch_add(1);
+	if (_sleeping.load() > 0)
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		_wake.notify_one();
+	}
+}
+
+void JobSystem::wait(const Job* job)
+{
+	while (job->unfinished.load(std::memory_order_acquire) > 0)
+	{
+		Job* next = findJob();
+		if (next != nullptr)
+			execute(next);
+		else
+			std::this_thread::yield();
+	}
+}
+
+Job* JobSystem::findJob()
+{
+	ThreadState& thread = currentThread();
+	Job* job = thread.queue.pop();
+	if (job == nullptr)
+	{
+		// start at a random thread so thieves do not all line up behind the same victim
+		uint32_t count = _threadCount.load(std::memory_order_acquire);
+		thread.random ^= thread.random << 13;
+		thread.random ^= thread.random >> 17;
+		thread.random ^= thread.random << 5;
+		uint32_t first = thread.random % count;
+		for (uint32_t i = 0; i < count && job == nullptr; i++)
+		{
+			ThreadState* victim = _threads[(first + i) % count].load(std::memory_order_acquire);
+			if (victim != nullptr && victim != &thread)
+				job = victim->queue.steal();
+		}
+	}
+	if (job != nullptr)
+		_queued.fetch_sub(1);
+	return job;
+}
+
+void JobSystem::execute(Job* job)
+{
+	TRACE_ZONE("job");
+	job->function(job, job->data);
+	finish(job);
+}
+
+void JobSystem::finish(Job* job)
+{
+	// the last one out notifies the parent, which may be waiting for its children only
+	while (job != nullptr && job->unfinished.fetch_sub(1, std::memory_order_acq_rel) == 1)
+		job = job->parent;
+}
+
+void JobSystem::workerLoop(size_t index)
+{
+	currentThread();
+	char name[32];
+	snprintf(name, sizeof(name), "job worker %u", (unsigned int)index + 1);
+	TRACE_THREAD_NAME(name);
+	while (!_stopping.load())
+	{
+		Job* job = findJob();
+		if (job != nullptr)
+		{
+			execute(job);
+			continue;
+		}
+
+		std::unique_lock<std::mutex> lock(_mutex);
+		_sleeping.fetch_add(1);
+		_wake.wait(lock, [this]() { return _queued.load() > 0 || _stopping.load(); });
+		_sleeping.fetch_sub(1);
+	}
+}
@@ -0,0 +1,160 @@
+#pragma once
+
+// STL
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+
+struct Job;
+typedef void (*JobFunction)(Job* job, const void* data);
+
+/**
+* One unit of work. A job counts itself and its unfinished children, it is finished once
+* its function returned and every child is finished; then its parent is notified in turn.
+* The parameters are copied into the job, so they have to fit into JOB_DATA_SIZE bytes,
+* which makes a job 64 bytes on x64.
+*/
+const size_t JOB_DATA_SIZE = 40;
+
+struct Job
+{
+	JobFunction function;
+	Job* parent;
+	std::atomic<int32_t> unfinished; // 1 for the job itself + running children
+	unsigned char data[JOB_DATA_SIZE];
+};
+
+/**
+* Work-stealing job system. Every thread that creates jobs gets its own lock-free deque
+* (Chase-Lev): the owner pushes and pops at the bottom, other threads steal from the top.
+* A worker thread per extra core executes jobs; threads waiting for a job help executing
+* others instead of blocking, so jobs may create and wait for jobs themselves.
+*
+*   Job* root = jobs.create(function, data);
+*   jobs.run(root);
+*   jobs.wait(root);
+*/
+class JobSystem
+{
+public:
+	static const size_t MAX_JOBS_PER_THREAD = 4096; // in flight per creating thread, power of two
+	static const size_t MAX_THREADS = 64; // workers plus other threads creating jobs
+
+	/** \brief  Gets the job system, the workers are started on first use (one less than the cores). */
+	static JobSystem& get();
+
+	/** \brief  Allocates a job from the calling thread's ring. Jobs are recycled after MAX_JOBS_PER_THREAD
+	*           further create() calls on the same thread, so they must be finished by then.
+	*   \param parent  Optional, the parent is not finished before this job
+	*/
+	Job* create(JobFunction function, Job* parent = nullptr);
+
+	/** \brief  Same, with trivially copyable parameters passed to the function as data. */
+	template <typename T>
+	Job* create(JobFunction function, const T& data, Job* parent = nullptr)
+	{
+		static_assert(sizeof(T) <= JOB_DATA_SIZE, "job data too large");
+		Job* job = create(function, parent);
+		memcpy(job->data, &data, sizeof(T));
+		return job;
+	}
+
+	/** \brief  Queues a job for execution. When the calling thread's deque is full it runs right away. */
+	void run(Job* job);
+
+	/** \brief  Executes other jobs until the job and all its children are finished. */
+	void wait(const Job* job);
+
+	/** \brief  Calls body(begin, end) for subranges of [0, count) no smaller than grain, in parallel,
+	*           and returns when all of them are done. Small ranges run on the calling thread.
+	*/
+	template <typename F>
+	void parallelFor(size_t count, size_t grain, const F& body)
+	{
+		if (grain == 0)
+			grain = 1;
+		if (count <= grain || _workers.empty())
+		{
+			if (count > 0)
+				body((size_t)0, count);
+			return;
+		}
+		ParallelForData<F> data = { &body, 0, count, grain };
+		Job* root = create(&parallelForJob<F>, data);
+		run(root);
+		wait(root);
+	}
+
+	size_t getWorkerCount() const;
+
+private:
+	// Chase-Lev deque with a fixed capacity
+	struct WorkQueue
+	{
+		std::atomic<int64_t> top;
+		std::atomic<int64_t> bottom;
+		std::atomic<Job*> jobs[MAX_JOBS_PER_THREAD];
+
+		WorkQueue();
+		bool push(Job* job); // owner only
+		Job* pop(); // owner only
+		Job* steal(); // any thread
+	};
+	// everything one thread owns
+	struct ThreadState
+	{
+		WorkQueue queue;
+		Job jobs[MAX_JOBS_PER_THREAD];
+		uint32_t allocated;
+		uint32_t random; // xorshift state for picking steal victims
+	};
+
+	template <typename F>
+	struct ParallelForData
+	{
+		const F* body;
+		size_t begin, end, grain;
+	};
+
+	// splits the range in halves until they are down to the grain size
+	template <typename F>
+	static void parallelForJob(Job* job, const void* data)
+	{
+		ParallelForData<F> range;
+		memcpy(&range, data, sizeof(range));
+		JobSystem& jobs = JobSystem::get();
+		while (range.end - range.begin > range.grain)
+		{
+			ParallelForData<F> upper = range;
+			upper.begin = range.begin + (range.end - range.begin) / 2;
+			range.end = upper.begin;
+			jobs.run(jobs.create(&parallelForJob<F>, upper, job));
+		}
+		(*range.body)(range.begin, range.end);
+	}
+
+	std::vector<std::thread> _workers;
+	std::atomic<ThreadState*> _threads[MAX_THREADS];
+	std::atomic<uint32_t> _threadCount;
+	std::atomic<int32_t> _queued; // pushed and not taken yet, workers sleep while it is 0
+	std::atomic<int32_t> _sleeping;
+	std::atomic<bool> _stopping;
+	std::mutex _mutex;
+	std::condition_variable _wake;
+
+	JobSystem();
+	~JobSystem();
+	JobSystem(const JobSystem&);
+	JobSystem& operator=(const JobSystem&);
+
+	ThreadState& currentThread();
+	Job* findJob();
+	void execute(Job* job);
+	void finish(Job* job);
+	void workerLoop(size_t index);
+};
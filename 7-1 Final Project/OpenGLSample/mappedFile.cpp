@@ -0,0 +1,131 @@
+// STL
+#include <iostream>
+#include <algorithm>
+
+#if defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+// Project
+#include "mappedFile.h"
+
+MappedFile::MappedFile()
+	: _data(NULL)
+	, _size(0)
+	, _file(NULL)
+	, _mapping(NULL)
+{
+}
+
+MappedFile::~MappedFile()
+{
+	close();
+}
+
+bool MappedFile::open(const char* path)
+{
+	close();
+#if defined(_WIN32)
+	HANDLE file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+	LARGE_INTEGER size;
+	if (file == INVALID_HANDLE_VALUE || !GetFileSizeEx(file, &size) || size.QuadPart == 0)
+	{
+		if (file != INVALID_HANDLE_VALUE)
+			CloseHandle(file);
+		std::cout << "ERROR::MAPPED_FILE::FILE_NOT_SUCCESFULLY_READ: " << path << std::endl;
+		return false;
+	}
+	HANDLE mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+	void* view = mapping != NULL ? MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0) : NULL;
+	if (view == NULL)
+	{
+		if (mapping != NULL)
+			CloseHandle(mapping);
+		CloseHandle(file);
+		std::cout << "ERROR::MAPPED_FILE::MAPPING_FAILED: " << path << std::endl;
+		return false;
+	}
+	_file = file;
+	_mapping = mapping;
+	_data = (const unsigned char*)view;
+	_size = (size_t)size.QuadPart;
+#else
+	int file = ::open(path, O_RDONLY);
+	struct stat status;
+	if (file < 0 || fstat(file, &status) != 0 || status.st_size == 0)
+	{
+		if (file >= 0)
+			::close(file);
+		std::cout << "ERROR::MAPPED_FILE::FILE_NOT_SUCCESFULLY_READ: " << path << std::endl;
+		return false;
+	}
+	// the mapping keeps the file alive, the descriptor is not needed past this
+	void* view = mmap(NULL, (size_t)status.st_size, PROT_READ, MAP_PRIVATE, file, 0);
+	::close(file);
+	if (view == MAP_FAILED)
+	{
+		std::cout << "ERROR::MAPPED_FILE::MAPPING_FAILED: " << path << std::endl;
+		return false;
+	}
+	madvise(view, (size_t)status.st_size, MADV_SEQUENTIAL);
+	_data = (const unsigned char*)view;
+	_size = (size_t)status.st_size;
+#endif
+	return true;
+}
+
+void MappedFile::close()
+{
+	if (_data == NULL)
+		return;
+#if defined(_WIN32)
+	UnmapViewOfFile(_data);
+	CloseHandle((HANDLE)_mapping);
+	CloseHandle((HANDLE)_file);
+#else
+	munmap((void*)_data, _size);
+#endif
+	_data = NULL;
+	_size = 0;
+	_file = NULL;
+	_mapping = NULL;
+}
+
+bool MappedFile::isOpen() const
+{
+	return _data != NULL;
+}
+
+const unsigned char* MappedFile::getData() const
+{
+	return _data;
+}
+
+size_t MappedFile::getSize() const
+{
+	return _size;
+}
+
+void MappedFile::release(size_t offset, size_t size) const
+{
+	if (_data == NULL || offset >= _size)
+		return;
+	size = std::min(size, _size - offset);
+#if defined(_WIN32)
+	// unlocking pages that are not locked takes them out of the working set
+	VirtualUnlock((LPVOID)(_data + offset), size);
+#else
+	// whole pages only, the ones the range touches; the neighbours are read again if they are needed
+	size_t page = (size_t)sysconf(_SC_PAGESIZE);
+	size_t begin = offset / page * page;
+	size_t end = std::min((offset + size + page - 1) / page * page, (_size + page - 1) / page * page);
+	madvise((void*)(_data + begin), end - begin, MADV_DONTNEED);
+#endif
+}
@@ -0,0 +1,46 @@
+#pragma once
+
+// STL
+#include <cstddef>
+
+/**
+* A file mapped read only into memory, so loaders can hand its bytes straight to GL with no
+* copy in between. Pages are read in by the OS when first touched; release() gives back
+* ranges that are no longer needed, which keeps the resident memory of a large file down to
+* what is in use at a time.
+*
+*   MappedFile file;
+*   if (file.open(path))
+*   {
+*       glCompressedTexSubImage2D(..., file.getData() + offset);
+*       file.release(offset, size);
+*   }
+*/
+class MappedFile
+{
+public:
+	MappedFile();
+	~MappedFile();
+
+	/** \brief  Maps the whole file, closing any file mapped before. Empty files fail to map.
+	*   \return True on success, errors are printed
+	*/
+	bool open(const char* path);
+	void close();
+	bool isOpen() const;
+
+	const unsigned char* getData() const;
+	size_t getSize() const;
+
+	/** \brief  Drops the pages of a range from the process's resident memory, they are read again if touched. */
+	void release(size_t offset, size_t size) const;
+
+private:
+	const unsigned char* _data;
+	size_t _size;
+	void* _file; // the platform's handles, when it has any besides the view
+	void* _mapping;
+
+	MappedFile(const MappedFile&);
+	MappedFile& operator=(const MappedFile&);
+};
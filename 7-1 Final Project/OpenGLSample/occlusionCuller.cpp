@@ -0,0 +1,305 @@
+// STL
+#include <chrono>
+#include <cmath>
+#include <algorithm>
+
+// SIMD, same selection as the frustum culler
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#include <xmmintrin.h>
+#define OCCLUSION_CULLER_SSE
+#endif
+
+// Project
+#include "occlusionCuller.h"
+#include "jobSystem.h"
+
+namespace {
+
+	typedef std::chrono::high_resolution_clock Clock;
+
+	double millisecondsSince(const Clock::time_point& start)
+	{
+		return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+	}
+
+	int roundUp(int value, int multiple)
+	{
+		return (value + multiple - 1) / multiple * multiple;
+	}
+
+} // namespace
+
+OcclusionCuller::OcclusionCuller(int width, int height)
+	: _width(roundUp(std::max(width, (int)TILE_SIZE), TILE_SIZE))
+	, _height(roundUp(std::max(height, (int)TILE_SIZE), TILE_SIZE))
+	, _viewProjection(1.0f)
+{
+	_tilesX = _width / TILE_SIZE;
+	_tilesY = _height / TILE_SIZE;
+	_depth.assign(_width * _height, 1.0f);
+	_tileDepth.assign(_tilesX * _tilesY, 1.0f);
+	_stats.occluderTriangles = _stats.tested = _stats.occluded = 0;
+	_stats.milliseconds = 0.0;
+}
+
+void OcclusionCuller::beginFrame(const glm::mat4& viewProjection)
+{
+	_viewProjection = viewProjection;
+	_triangles.clear();
+	_stats.occluderTriangles = _stats.tested = _stats.occluded = 0;
+	_stats.milliseconds = 0.0;
+}
+
+void OcclusionCuller::addOccluder(const glm::vec3* vertices, size_t vertexCount, const glm::mat4& model)
+{
+	Clock::time_point start = Clock::now();
+	glm::mat4 modelViewProjection = _viewProjection * model;
+	for (size_t i = 0; i + 2 < vertexCount; i += 3)
+	{
+		glm::vec4 clip[3];
+		for (int k = 0; k < 3; k++)
+			clip[k] = modelViewProjection * glm::vec4(vertices[i + k], 1.0f);
+		addTriangle(clip);
+	}
+	_stats.milliseconds += millisecondsSince(start);
+}
+
+void OcclusionCuller::addTriangle(const glm::vec4* clip)
+{
+	// clip against the near plane (z >= -w), leaves a triangle or a quad
+	glm::vec4 polygon[4];
+	int count = 0;
+	for (int k = 0; k < 3; k++)
+	{
+		const glm::vec4& a = clip[k];
+		const glm::vec4& b = clip[(k + 1) % 3];
+		float da = a.z + a.w;
+		float db = b.z + b.w;
+		if (da >= 0.0f)
+			polygon[count++] = a;
+		if ((da >= 0.0f) != (db >= 0.0f))
+			polygon[count++] = a + (b - a) * (da / (da - db));
+	}
+
+	// to pixels, depth to [0, 1]
+	glm::vec3 screen[4];
+	for (int k = 0; k < count; k++)
+	{
+		float w = std::max(polygon[k].w, 1e-6f);
+		screen[k] = glm::vec3((polygon[k].x / w * 0.5f + 0.5f) * _width,
+			(polygon[k].y / w * 0.5f + 0.5f) * _height,
+			std::min(std::max(polygon[k].z / w * 0.5f + 0.5f, 0.0f), 1.0f));
+	}
+
+	for (int k = 1; k + 1 < count; k++)
+	{
+		const glm::vec3& v0 = screen[0];
+		const glm::vec3& v1 = screen[k];
+		const glm::vec3& v2 = screen[k + 1];
+		float area = (v1.x - v0.x) * (v2.y - v0.y) - (v2.x - v0.x) * (v1.y - v0.y);
+		if (std::fabs(area) < 1e-8f)
+			continue;
+
+		Triangle t;
+		t.minX = std::max(0, (int)std::floor(std::min(v0.x, std::min(v1.x, v2.x))));
+		t.maxX = std::min(_width - 1, (int)std::ceil(std::max(v0.x, std::max(v1.x, v2.x))));
+		t.minY = std::max(0, (int)std::floor(std::min(v0.y, std::min(v1.y, v2.y))));
+		t.maxY = std::min(_height - 1, (int)std::ceil(std::max(v0.y, std::max(v1.y, v2.y))));
+		if (t.minX > t.maxX || t.minY > t.maxY)
+			continue;
+
+		// edge functions with the winding flipped so the inside is positive either way;
+		// occluders are not backface culled, open meshes like the bowls hide things from both sides
+		const glm::vec3* v[3] = { &v0, &v1, &v2 };
+		float sign = area > 0.0f ? 1.0f : -1.0f;
+		for (int e = 0; e < 3; e++)
+		{
+			const glm::vec3& a = *v[e];
+			const glm::vec3& b = *v[(e + 1) % 3];
+			t.edgeA[e] = sign * (a.y - b.y);
+			t.edgeB[e] = sign * (b.x - a.x);
+			t.edgeC[e] = sign * (a.x * b.y - b.x * a.y);
+		}
+
+		// depth plane z = A x + B y + C; moved back by the largest change within half a pixel,
+		// so a pixel never stores a depth nearer than the triangle really is anywhere in it
+		t.depthA = ((v1.z - v0.z) * (v2.y - v0.y) - (v2.z - v0.z) * (v1.y - v0.y)) / area;
+		t.depthB = ((v2.z - v0.z) * (v1.x - v0.x) - (v1.z - v0.z) * (v2.x - v0.x)) / area;
+		t.depthC = v0.z - t.depthA * v0.x - t.depthB * v0.y + 0.5f * (std::fabs(t.depthA) + std::fabs(t.depthB));
+		_triangles.push_back(t);
+	}
+}
+
+void OcclusionCuller::rasterize()
+{
+	Clock::time_point start = Clock::now();
+	std::fill(_depth.begin(), _depth.end(), 1.0f);
+	_stats.occluderTriangles = (uint32_t)_triangles.size();
+
+	// horizontal bands of whole tile rows, so every job also owns its tile depths
+	if (_triangles.size() < PARALLEL_TRIANGLES)
+	{
+		rasterizeBand(0, _height);
+	}
+	else
+	{
+		JobSystem::get().parallelFor(_tilesY, 2, [this](size_t begin, size_t end)
+		{
+			rasterizeBand((int)begin * TILE_SIZE, (int)end * TILE_SIZE);
+		});
+	}
+	_stats.milliseconds += millisecondsSince(start);
+}
+
+void OcclusionCuller::rasterizeBand(int firstRow, int endRow)
+{
+	for (size_t i = 0; i < _triangles.size(); i++)
+	{
+		const Triangle& t = _triangles[i];
+		int minY = std::max(t.minY, firstRow);
+		int maxY = std::min(t.maxY, endRow - 1);
+		// the rows are padded to a multiple of 4, so the SIMD loop can start 4-aligned
+		int minX = t.minX & ~3;
+
+		for (int y = minY; y <= maxY; y++)
+		{
+			float* row = &_depth[y * _width];
+			float py = y + 0.5f;
+#if defined(OCCLUSION_CULLER_SSE)
+			__m128 e0Row = _mm_set1_ps(t.edgeB[0] * py + t.edgeC[0]);
+			__m128 e1Row = _mm_set1_ps(t.edgeB[1] * py + t.edgeC[1]);
+			__m128 e2Row = _mm_set1_ps(t.edgeB[2] * py + t.edgeC[2]);
+			__m128 zRow = _mm_set1_ps(t.depthB * py + t.depthC);
+			__m128 a0 = _mm_set1_ps(t.edgeA[0]);
+			__m128 a1 = _mm_set1_ps(t.edgeA[1]);
+			__m128 a2 = _mm_set1_ps(t.edgeA[2]);
+			__m128 az = _mm_set1_ps(t.depthA);
+			const __m128 zero = _mm_setzero_ps();
+			const __m128 laneOffset = _mm_set_ps(3.5f, 2.5f, 1.5f, 0.5f);
+			for (int x = minX; x <= t.maxX; x += 4)
+			{
+				__m128 px = _mm_add_ps(_mm_set1_ps((float)x), laneOffset);
+				__m128 inside = _mm_and_ps(_mm_cmpge_ps(_mm_add_ps(_mm_mul_ps(a0, px), e0Row), zero),
+					_mm_and_ps(_mm_cmpge_ps(_mm_add_ps(_mm_mul_ps(a1, px), e1Row), zero),
+						_mm_cmpge_ps(_mm_add_ps(_mm_mul_ps(a2, px), e2Row), zero)));
+				if (_mm_movemask_ps(inside) == 0)
+					continue;
+				__m128 z = _mm_add_ps(_mm_mul_ps(az, px), zRow);
+				__m128 old = _mm_loadu_ps(row + x);
+				__m128 nearest = _mm_min_ps(old, z);
+				_mm_storeu_ps(row + x, _mm_or_ps(_mm_and_ps(inside, nearest), _mm_andnot_ps(inside, old)));
+			}
+#else
+			for (int x = minX; x <= t.maxX; x++)
+			{
+				float px = x + 0.5f;
+				if (t.edgeA[0] * px + t.edgeB[0] * py + t.edgeC[0] < 0.0f ||
+					t.edgeA[1] * px + t.edgeB[1] * py + t.edgeC[1] < 0.0f ||
+					t.edgeA[2] * px + t.edgeB[2] * py + t.edgeC[2] < 0.0f)
+					continue;
+				row[x] = std::min(row[x], t.depthA * px + t.depthB * py + t.depthC);
+			}
+#endif
+		}
+	}
+
+	// farthest depth per tile of this band
+	for (int tileY = firstRow / TILE_SIZE; tileY < endRow / TILE_SIZE; tileY++)
+	{
+		for (int tileX = 0; tileX < _tilesX; tileX++)
+		{
+			float farthest = 0.0f;
+			for (int y = tileY * TILE_SIZE; y < (tileY + 1) * TILE_SIZE; y++)
+			{
+				const float* row = &_depth[y * _width + tileX * TILE_SIZE];
+				for (int x = 0; x < TILE_SIZE; x++)
+					farthest = std::max(farthest, row[x]);
+			}
+			_tileDepth[tileY * _tilesX + tileX] = farthest;
+		}
+	}
+}
+
+bool OcclusionCuller::isVisible(const AABB& box)
+{
+	Clock::time_point start = Clock::now();
+	_stats.tested++;
+
+	// screen rectangle and nearest depth of the 8 corners
+	float minX = FLT_MAX, minY = FLT_MAX, maxX = -FLT_MAX, maxY = -FLT_MAX, nearest = FLT_MAX;
+	for (int corner = 0; corner < 8; corner++)
+	{
+		glm::vec4 p(corner & 1 ? box.max.x : box.min.x, corner & 2 ? box.max.y : box.min.y, corner & 4 ? box.max.z : box.min.z, 1.0f);
+		glm::vec4 clip = _viewProjection * p;
+		if (clip.z < -clip.w || clip.w <= 0.0f)
+		{
+			// reaches through the near plane, the camera may well be inside it
+			_stats.milliseconds += millisecondsSince(start);
+			return true;
+		}
+		float x = (clip.x / clip.w * 0.5f + 0.5f) * _width;
+		float y = (clip.y / clip.w * 0.5f + 0.5f) * _height;
+		minX = std::min(minX, x);
+		maxX = std::max(maxX, x);
+		minY = std::min(minY, y);
+		maxY = std::max(maxY, y);
+		nearest = std::min(nearest, clip.z / clip.w * 0.5f + 0.5f);
+	}
+
+	int x0 = std::max(0, (int)std::floor(minX));
+	int x1 = std::min(_width - 1, (int)std::ceil(maxX));
+	int y0 = std::max(0, (int)std::floor(minY));
+	int y1 = std::min(_height - 1, (int)std::ceil(maxY));
+	bool visible = x0 > x1 || y0 > y1; // off screen, leave that to the frustum culler
+
+	// coarse test per tile, pixels are only read where the tile alone can not decide
+	for (int tileY = y0 / TILE_SIZE; tileY <= y1 / TILE_SIZE && !visible; tileY++)
+	{
+		for (int tileX = x0 / TILE_SIZE; tileX <= x1 / TILE_SIZE && !visible; tileX++)
+		{
+			if (nearest > _tileDepth[tileY * _tilesX + tileX])
+				continue;
+			int rowBegin = std::max(y0, tileY * TILE_SIZE);
+			int rowEnd = std::min(y1, tileY * TILE_SIZE + TILE_SIZE - 1);
+			int columnBegin = std::max(x0, tileX * TILE_SIZE);
+			int columnEnd = std::min(x1, tileX * TILE_SIZE + TILE_SIZE - 1);
+			for (int y = rowBegin; y <= rowEnd && !visible; y++)
+			{
+				const float* row = &_depth[y * _width];
+				for (int x = columnBegin; x <= columnEnd; x++)
+				{
+					if (nearest <= row[x])
+					{
+						visible = true;
+						break;
+					}
+				}
+			}
+		}
+	}
+
+	if (!visible)
+		_stats.occluded++;
+	_stats.milliseconds += millisecondsSince(start);
+	return visible;
+}
+
+const OcclusionCuller::CullStats& OcclusionCuller::getStats() const
+{
+	return _stats;
+}
+
+const float* OcclusionCuller::getDepthBuffer() const
+{
+	return _depth.data();
+}
+
+int OcclusionCuller::getWidth() const
+{
+	return _width;
+}
+
+int OcclusionCuller::getHeight() const
+{
+	return _height;
+}
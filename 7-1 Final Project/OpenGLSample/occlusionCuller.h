@@ -0,0 +1,79 @@
+#pragma once
+
+// STL
+#include <vector>
+#include <cstdint>
+
+// GLM
+#include <glm/glm.hpp>
+
+// Project
+#include "bounds.h"
+
+/**
+* Software occlusion culling. A few large occluders are rasterized into a small CPU depth
+* buffer every frame, then the screen space boxes of other objects are tested against it
+* through a hierarchical (per tile) max depth. Nothing here touches GL, so the results can
+* be checked without a GPU.
+*/
+class OcclusionCuller
+{
+public:
+	struct CullStats
+	{
+		uint32_t occluderTriangles;
+		uint32_t tested;
+		uint32_t occluded;
+		double milliseconds; // rasterization and tests
+	};
+
+	static const int TILE_SIZE = 8; // pixels per side of one hierarchical depth tile
+	static const size_t PARALLEL_TRIANGLES = 256; // below this the bands are rasterized on the calling thread instead of as jobs
+
+	/** \brief  Width and height are rounded up to multiples of TILE_SIZE. */
+	OcclusionCuller(int width = 256, int height = 192);
+
+	/** \brief  Clears the depth buffer and the occluder list for a new frame. */
+	void beginFrame(const glm::mat4& viewProjection);
+
+	/** \brief  Queues occluder geometry.
+	*   \param vertices     Triangle list in model space, 3 vertices per triangle
+	*   \param vertexCount  Number of vertices
+	*/
+	void addOccluder(const glm::vec3* vertices, size_t vertexCount, const glm::mat4& model);
+
+	/** \brief  Rasterizes the queued occluders and builds the tile depths. Call once after the last addOccluder(). */
+	void rasterize();
+
+	/** \brief  Tests a world space box against the occluders.
+	*   \return False only when every pixel the box covers is behind an occluder
+	*/
+	bool isVisible(const AABB& box);
+
+	const CullStats& getStats() const;
+
+	// depth buffer for inspection, 0 = near plane, 1 = far plane / empty, row 0 is the bottom
+	const float* getDepthBuffer() const;
+	int getWidth() const;
+	int getHeight() const;
+
+private:
+	// screen space triangle ready for rasterization
+	struct Triangle
+	{
+		int minX, maxX, minY, maxY; // pixel bounds, inclusive
+		float edgeA[3], edgeB[3], edgeC[3]; // edge functions, >= 0 inside
+		float depthA, depthB, depthC; // depth plane, already pushed to the far end of each pixel
+	};
+
+	int _width, _height;
+	int _tilesX, _tilesY;
+	glm::mat4 _viewProjection;
+	std::vector<float> _depth; // per pixel, nearest occluder
+	std::vector<float> _tileDepth; // per tile, farthest pixel
+	std::vector<Triangle> _triangles;
+	CullStats _stats;
+
+	void addTriangle(const glm::vec4* clip);
+	void rasterizeBand(int firstRow, int endRow);
+};
@@ -0,0 +1,181 @@
+#ifndef OFFSCREEN_TARGET_H
+#define OFFSCREEN_TARGET_H
+
+#include <glad/glad.h>
+
+#include <vector>
+#include <cstdio>
+#include <iostream>
+
+// A framebuffer object with a color and a depth renderbuffer, for rendering without a
+// window (headless mode) or at a resolution other than the window's.
+class OffscreenTarget
+{
+public:
+	OffscreenTarget() : framebuffer(0), color(0), depth(0), width(0), height(0)
+	{
+	}
+	~OffscreenTarget()
+	{
+		release();
+	}
+
+	// (re)creates the attachments at the given size, returns false if the driver rejects them
+	// ------------------------------------------------------------------------
+	bool create(int targetWidth, int targetHeight)
+	{
+		release();
+		width = targetWidth;
+		height = targetHeight;
+
+		glGenFramebuffers(1, &framebuffer);
+		glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+		glGenRenderbuffers(1, &color);
+		glBindRenderbuffer(GL_RENDERBUFFER, color);
+		glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, width, height);
+		glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, color);
+		glGenRenderbuffers(1, &depth);
+		glBindRenderbuffer(GL_RENDERBUFFER, depth);
+		glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH24_STENCIL8, width, height);
+		glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER, depth);
+
+		GLenum status = glCheckFramebufferStatus(GL_FRAMEBUFFER);
+		glBindFramebuffer(GL_FRAMEBUFFER, 0);
+		if (status != GL_FRAMEBUFFER_COMPLETE)
+		{
+			std::cout << "ERROR::FRAMEBUFFER::INCOMPLETE 0x" << std::hex << status << std::dec << std::endl;
+			release();
+			return false;
+		}
+		return true;
+	}
+
+	void release()
+	{
+		if (framebuffer != 0)
+			glDeleteFramebuffers(1, &framebuffer);
+		if (color != 0)
+			glDeleteRenderbuffers(1, &color);
+		if (depth != 0)
+			glDeleteRenderbuffers(1, &depth);
+		framebuffer = color = depth = 0;
+	}
+
+	// draws go into the target from here on, with a viewport covering all of it
+	// ------------------------------------------------------------------------
+	void bind() const
+	{
+		glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+		glViewport(0, 0, width, height);
+	}
+
+	// copies the lower left sourceWidth x sourceHeight of the color buffer stretched over a
+	// destination framebuffer (0 = the window), filtered, e.g. to scale a lower resolution up
+	// ------------------------------------------------------------------------
+	void blit(int sourceWidth, int sourceHeight, GLuint destination, int destinationWidth, int destinationHeight) const
+	{
+		glBindFramebuffer(GL_READ_FRAMEBUFFER, framebuffer);
+		glBindFramebuffer(GL_DRAW_FRAMEBUFFER, destination);
+		glBlitFramebuffer(0, 0, sourceWidth, sourceHeight, 0, 0, destinationWidth, destinationHeight, GL_COLOR_BUFFER_BIT, GL_LINEAR);
+		glBindFramebuffer(GL_FRAMEBUFFER, destination);
+	}
+
+	// reads the color buffer back, RGBA8 rows bottom to top. Waits for rendering to finish.
+	// ------------------------------------------------------------------------
+	void readPixels(std::vector<unsigned char> &rgba) const
+	{
+		rgba.resize((size_t)width * height * 4);
+		glBindFramebuffer(GL_READ_FRAMEBUFFER, framebuffer);
+		glPixelStorei(GL_PACK_ALIGNMENT, 1);
+		glReadPixels(0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, rgba.data());
+	}
+
+	// writes the color buffer as a binary PPM, top row first like every image viewer expects
+	// ------------------------------------------------------------------------
+	bool savePPM(const char *path) const
+	{
+		std::vector<unsigned char> rgba;
+		readPixels(rgba);
+		return writePPM(path, rgba, width, height);
+	}
+
+	// writes RGBA8 rows bottom to top (as readPixels() returns them) as a binary PPM
+	// ------------------------------------------------------------------------
+	static bool writePPM(const char *path, const std::vector<unsigned char> &rgba, int imageWidth, int imageHeight)
+	{
+		FILE *file = fopen(path, "wb");
+		if (file == NULL)
+		{
+			std::cout << "ERROR::FRAMEBUFFER::CANNOT_WRITE " << path << std::endl;
+			return false;
+		}
+		fprintf(file, "P6\n%d %d\n255\n", imageWidth, imageHeight);
+		std::vector<unsigned char> row((size_t)imageWidth * 3);
+		for (int y = imageHeight - 1; y >= 0; y--)
+		{
+			const unsigned char *src = &rgba[(size_t)y * imageWidth * 4];
+			for (int x = 0; x < imageWidth; x++)
+			{
+				row[x * 3 + 0] = src[x * 4 + 0];
+				row[x * 3 + 1] = src[x * 4 + 1];
+				row[x * 3 + 2] = src[x * 4 + 2];
+			}
+			fwrite(row.data(), 1, row.size(), file);
+		}
+		fclose(file);
+		return true;
+	}
+
+	// reads a binary PPM written by writePPM() back into RGBA8 rows bottom to top, alpha 255
+	// ------------------------------------------------------------------------
+	static bool readPPM(const char *path, std::vector<unsigned char> &rgba, int &imageWidth, int &imageHeight)
+	{
+		FILE *file = fopen(path, "rb");
+		if (file == NULL)
+			return false;
+		int maxValue = 0;
+		bool valid = fscanf(file, "P6 %d %d %d", &imageWidth, &imageHeight, &maxValue) == 3 && maxValue == 255
+			&& imageWidth > 0 && imageHeight > 0 && fgetc(file) != EOF;
+		std::vector<unsigned char> row;
+		if (valid)
+		{
+			rgba.resize((size_t)imageWidth * imageHeight * 4);
+			row.resize((size_t)imageWidth * 3);
+		}
+		for (int y = imageHeight - 1; valid && y >= 0; y--)
+		{
+			valid = fread(row.data(), 1, row.size(), file) == row.size();
+			unsigned char *dst = valid ? &rgba[(size_t)y * imageWidth * 4] : NULL;
+			for (int x = 0; valid && x < imageWidth; x++)
+			{
+				dst[x * 4 + 0] = row[x * 3 + 0];
+				dst[x * 4 + 1] = row[x * 3 + 1];
+				dst[x * 4 + 2] = row[x * 3 + 2];
+				dst[x * 4 + 3] = 255;
+			}
+		}
+		fclose(file);
+		if (!valid)
+			std::cout << "ERROR::FRAMEBUFFER::NOT_A_PPM " << path << std::endl;
+		return valid;
+	}
+
+	int getWidth() const
+	{
+		return width;
+	}
+	int getHeight() const
+	{
+		return height;
+	}
+
+private:
+	GLuint framebuffer;
+	GLuint color;
+	GLuint depth;
+	int width, height;
+
+	OffscreenTarget(const OffscreenTarget&);
+	OffscreenTarget &operator=(const OffscreenTarget&);
+};
+#endif
@@ -0,0 +1,176 @@
+// STL
+#include <cstdio>
+
+// GL
+#include <glad/glad.h>
+
+#if defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#include <psapi.h>
+#pragma comment(lib, "psapi.lib")
+#elif defined(__linux__)
+#include <unistd.h>
+#endif
+
+// Project
+#include "performanceHud.h"
+#include "common/text2D.hpp"
+#include "gpuProfiler.h"
+
+namespace {
+
+	const int TEXT_SIZE = 12; // glyph height in pixels, a whole multiple of the built-in font's cell
+	const int LINE_HEIGHT = 16;
+	const int MARGIN = 8;
+	const double MEMORY_INTERVAL = 0.5; // seconds between memory queries
+
+} // namespace
+
+PerformanceHud::PerformanceHud()
+	: _initialized(false)
+	, _visible(true)
+	, _frame(0)
+	, _triangles(0)
+	, _memoryMegabytes(0.0)
+	, _milliseconds(0.0)
+{
+	for (int i = 0; i < QUERY_LATENCY; i++)
+	{
+		_queries[i] = 0;
+		_pending[i] = false;
+	}
+}
+
+PerformanceHud::~PerformanceHud()
+{
+	release();
+}
+
+bool PerformanceHud::init()
+{
+	release();
+	initText2D(NULL);
+	glGenQueries(QUERY_LATENCY, _queries);
+	_memoryMegabytes = getProcessMemoryMegabytes();
+	_memoryTime = Clock::now();
+	_initialized = true;
+	return true;
+}
+
+void PerformanceHud::release()
+{
+	if (!_initialized)
+		return;
+	cleanupText2D();
+	glDeleteQueries(QUERY_LATENCY, _queries);
+	for (int i = 0; i < QUERY_LATENCY; i++)
+	{
+		_queries[i] = 0;
+		_pending[i] = false;
+	}
+	_initialized = false;
+}
+
+void PerformanceHud::beginGeometry()
+{
+	if (!_initialized)
+		return;
+
+	// the slot of QUERY_LATENCY frames ago is reused now; a result that is not there yet is skipped
+	int slot = (int)(_frame % QUERY_LATENCY);
+	if (_pending[slot])
+	{
+		GLint available = 0;
+		glGetQueryObjectiv(_queries[slot], GL_QUERY_RESULT_AVAILABLE, &available);
+		if (available)
+		{
+			GLuint64 primitives = 0;
+			glGetQueryObjectui64v(_queries[slot], GL_QUERY_RESULT, &primitives);
+			_triangles = primitives;
+		}
+		_pending[slot] = false;
+	}
+	glBeginQuery(GL_PRIMITIVES_GENERATED, _queries[slot]);
+}
+
+void PerformanceHud::endGeometry()
+{
+	if (!_initialized)
+		return;
+	glEndQuery(GL_PRIMITIVES_GENERATED);
+	_pending[_frame % QUERY_LATENCY] = true;
+	_frame++;
+}
+
+void PerformanceHud::draw(const FrameStats& stats, int width, int height)
+{
+	if (!_initialized || !_visible)
+		return;
+	GPU_PROFILE_SCOPE("hud");
+	Clock::time_point start = Clock::now();
+
+	if (std::chrono::duration<double>(start - _memoryTime).count() >= MEMORY_INTERVAL)
+	{
+		_memoryMegabytes = getProcessMemoryMegabytes();
+		_memoryTime = start;
+	}
+
+	char lines[7][96];
+	if (stats.gpuMilliseconds >= 0.0)
+		snprintf(lines[0], sizeof(lines[0]), "frame %.2f ms (%.0f fps)  gpu %.2f ms", stats.frameMilliseconds,
+			stats.frameMilliseconds > 0.0 ? 1000.0 / stats.frameMilliseconds : 0.0, stats.gpuMilliseconds);
+	else
+		snprintf(lines[0], sizeof(lines[0]), "frame %.2f ms (%.0f fps)", stats.frameMilliseconds,
+			stats.frameMilliseconds > 0.0 ? 1000.0 / stats.frameMilliseconds : 0.0);
+	snprintf(lines[1], sizeof(lines[1]), "resolution %dx%d (%.0f%%)", stats.renderWidth, stats.renderHeight,
+		width > 0 ? 100.0 * stats.renderWidth / width : 0.0);
+	snprintf(lines[2], sizeof(lines[2]), "draw calls %u  objects %u", stats.drawCalls, stats.instances);
+	snprintf(lines[3], sizeof(lines[3]), "triangles %.3f m", _triangles / 1000000.0);
+	snprintf(lines[4], sizeof(lines[4]), "gl state %u set  %u skipped", stats.glCalls, stats.glCallsElided);
+	snprintf(lines[5], sizeof(lines[5]), "memory %.1f mb", _memoryMegabytes);
+	snprintf(lines[6], sizeof(lines[6]), "hud %.3f ms", _milliseconds);
+
+	// top left corner, text2D counts y from the bottom
+	for (int i = 0; i < 7; i++)
+		printText2D(lines[i], MARGIN, height - MARGIN - TEXT_SIZE - i * LINE_HEIGHT, TEXT_SIZE);
+	drawText2D(width, height);
+
+	_milliseconds = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+double PerformanceHud::getProcessMemoryMegabytes()
+{
+#if defined(_WIN32)
+	PROCESS_MEMORY_COUNTERS counters;
+	if (GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)))
+		return counters.WorkingSetSize / (1024.0 * 1024.0);
+#elif defined(__linux__)
+	FILE* file = fopen("/proc/self/statm", "r");
+	if (file != NULL)
+	{
+		unsigned long size = 0, resident = 0;
+		int read = fscanf(file, "%lu %lu", &size, &resident);
+		fclose(file);
+		if (read == 2)
+			return resident * (double)sysconf(_SC_PAGESIZE) / (1024.0 * 1024.0);
+	}
+#endif
+	return 0.0;
+}
+
+void PerformanceHud::setVisible(bool visible)
+{
+	_visible = visible;
+}
+
+bool PerformanceHud::isVisible() const
+{
+	return _visible;
+}
+
+double PerformanceHud::getMilliseconds() const
+{
+	return _milliseconds;
+}
@@ -0,0 +1,70 @@
+#pragma once
+
+// STL
+#include <chrono>
+#include <cstdint>
+
+/**
+* On-screen overlay with frame time, resolution, draw calls, triangles and memory, drawn with text2D.
+* All lines go into one batch and one draw call, so the overlay itself costs a few
+* microseconds and does not show up in the numbers it reports (its own CPU time is the
+* last line). Triangles are counted by the GPU with a GL_PRIMITIVES_GENERATED query
+* around the scene, read back a few frames later without waiting.
+*/
+class PerformanceHud
+{
+public:
+	static const int QUERY_LATENCY = 4; // frames between a primitives query and its read back
+
+	// what the application measured, the HUD adds triangles and memory itself
+	struct FrameStats
+	{
+		double frameMilliseconds; // time between presented frames
+		double gpuMilliseconds; // negative when not known
+		unsigned int drawCalls;
+		unsigned int instances;
+		unsigned int glCalls; // state changes that reached the driver
+		unsigned int glCallsElided; // state changes dropped as redundant
+		int renderWidth, renderHeight; // the scene's resolution, scaled up to the window
+	};
+
+	PerformanceHud();
+	~PerformanceHud();
+
+	/** \brief  Creates the font, text buffers and queries. Needs a current GL context. */
+	bool init();
+
+	void release();
+
+	/** \brief  Counts the triangles of the geometry drawn until endGeometry(). */
+	void beginGeometry();
+	void endGeometry();
+
+	/** \brief  Draws the overlay over the current framebuffer, width x height in pixels. */
+	void draw(const FrameStats& stats, int width, int height);
+
+	void setVisible(bool visible);
+	bool isVisible() const;
+
+	/** \brief  Gets the CPU time the last draw() took. */
+	double getMilliseconds() const;
+
+	/** \brief  Gets the resident memory of the process (working set on Windows), 0 where unknown. */
+	static double getProcessMemoryMegabytes();
+
+private:
+	typedef std::chrono::steady_clock Clock;
+
+	bool _initialized;
+	bool _visible;
+	unsigned int _queries[QUERY_LATENCY];
+	bool _pending[QUERY_LATENCY];
+	uint64_t _frame;
+	uint64_t _triangles; // of the newest frame read back
+	double _memoryMegabytes;
+	Clock::time_point _memoryTime; // the process is asked for its memory only a few times a second
+	double _milliseconds;
+
+	PerformanceHud(const PerformanceHud&);
+	PerformanceHud& operator=(const PerformanceHud&);
+};
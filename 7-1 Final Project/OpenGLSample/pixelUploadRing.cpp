@@ -0,0 +1,142 @@
+// STL
+#include <cstring>
+#include <iostream>
+
+// Project
+#include "pixelUploadRing.h"
+#include "glStateCache.h"
+
+namespace {
+
+	const size_t ALIGNMENT = 64; // regions start on cache lines
+	const GLuint64 WAIT_NANOSECONDS = 1000000000; // a fence that takes longer than this is waited for again
+
+} // namespace
+
+PixelUploadRing::PixelUploadRing()
+	: _buffer(0)
+	, _size(0)
+	, _head(0)
+	, _used(0)
+	, _unfenced(0)
+{
+}
+
+PixelUploadRing::~PixelUploadRing()
+{
+	release();
+}
+
+bool PixelUploadRing::init(size_t size)
+{
+	release();
+	GLStateCache& glState = GLStateCache::get();
+	glGenBuffers(1, &_buffer);
+	glState.bindBuffer(GL_PIXEL_UNPACK_BUFFER, _buffer);
+	glBufferData(GL_PIXEL_UNPACK_BUFFER, size, NULL, GL_STREAM_DRAW);
+	glState.bindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+	if (glGetError() != GL_NO_ERROR)
+	{
+		std::cout << "ERROR::UPLOAD_RING::CANNOT_ALLOCATE " << size << " bytes" << std::endl;
+		release();
+		return false;
+	}
+	_size = size;
+	return true;
+}
+
+void PixelUploadRing::release()
+{
+	for (size_t i = 0; i < _inFlight.size(); i++)
+		glDeleteSync(_inFlight[i].fence);
+	_inFlight.clear();
+	if (_buffer != 0)
+		GLStateCache::get().deleteBuffer(_buffer);
+	_buffer = 0;
+	_size = _head = _used = _unfenced = 0;
+}
+
+bool PixelUploadRing::isInitialized() const
+{
+	return _buffer != 0;
+}
+
+bool PixelUploadRing::stage(const void* pixels, size_t size, size_t& offset, bool wait)
+{
+	if (_buffer == 0 || size > _size)
+		return false;
+
+	// the region either follows the last one or, when it does not fit before the end, starts over at 0
+	retire(false);
+	size_t start = (_head + ALIGNMENT - 1) / ALIGNMENT * ALIGNMENT;
+	if (start + size > _size)
+		start = 0;
+	size_t needed = (start >= _head ? start - _head : _size - _head + start) + size;
+	while (_used + needed > _size)
+	{
+		if (!wait || _inFlight.empty())
+			return false;
+		retire(true);
+	}
+
+	GLStateCache::get().bindBuffer(GL_PIXEL_UNPACK_BUFFER, _buffer);
+	void* memory = glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, start, size,
+		GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT | GL_MAP_UNSYNCHRONIZED_BIT);
+	if (memory == NULL)
+		return false;
+	memcpy(memory, pixels, size);
+	glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+
+	_head = start + size;
+	_used += needed;
+	_unfenced += needed;
+	offset = start;
+	return true;
+}
+
+void PixelUploadRing::fence()
+{
+	if (_unfenced == 0)
+		return;
+	Region region = { glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0), _unfenced };
+	_inFlight.push_back(region);
+	_unfenced = 0;
+}
+
+void PixelUploadRing::unbind()
+{
+	GLStateCache::get().bindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+}
+
+size_t PixelUploadRing::getSize() const
+{
+	return _size;
+}
+
+size_t PixelUploadRing::getUsed() const
+{
+	return _used;
+}
+
+void PixelUploadRing::retire(bool wait)
+{
+	while (!_inFlight.empty())
+	{
+		// waiting flushes, so the fence is sure to reach the GPU
+		Region& region = _inFlight.front();
+		GLenum status = glClientWaitSync(region.fence, wait ? GL_SYNC_FLUSH_COMMANDS_BIT : 0, wait ? WAIT_NANOSECONDS : 0);
+		if (status != GL_ALREADY_SIGNALED && status != GL_CONDITION_SATISFIED)
+		{
+			if (!wait || status == GL_WAIT_FAILED)
+				return;
+			continue;
+		}
+		glDeleteSync(region.fence);
+		_used -= region.bytes;
+		_inFlight.pop_front();
+		wait = false; // one region was asked for, the others are only taken if they are done too
+	}
+	// with nothing in flight the next region may as well start at the beginning
+	if (_used == 0)
+		_head = 0;
+}
@@ -0,0 +1,77 @@
+#pragma once
+
+// STL
+#include <deque>
+#include <cstddef>
+
+// GL
+#include <glad/glad.h>
+
+/**
+* Staging memory for texture uploads: one pixel unpack buffer used as a ring. Pixels are
+* copied into the next free part and the texture is filled from there with glTexSubImage2D,
+* so the copy into driver memory happens on the GPU's time instead of inside the call.
+* Every fence() covers what was staged since the last one; that part is written again only
+* after the GPU passed the fence. Regions are mapped unsynchronized one at a time: the
+* fences already guarantee the GPU is done with them, and persistent mapping needs GL 4.4,
+* which the loader of this project does not provide.
+*
+*   size_t offset;
+*   if (ring.stage(pixels, size, offset, false))
+*   {
+*       glTexSubImage2D(..., (const void*)offset);
+*       ring.fence();
+*   }
+*   ring.unbind();
+*/
+class PixelUploadRing
+{
+public:
+	static const size_t DEFAULT_SIZE = 32 * 1024 * 1024;
+
+	PixelUploadRing();
+	~PixelUploadRing();
+
+	bool init(size_t size = DEFAULT_SIZE);
+	void release();
+	bool isInitialized() const;
+
+	/** \brief  Copies pixels into the ring and leaves the buffer bound to GL_PIXEL_UNPACK_BUFFER.
+	*   \param offset  Receives the offset to pass as the pixel pointer
+	*   \param wait    Waits for the GPU when the ring is full; without it the call fails instead
+	*   \return False when there is no room (or size is larger than the ring)
+	*/
+	bool stage(const void* pixels, size_t size, size_t& offset, bool wait);
+
+	/** \brief  Fences everything staged since the last fence, call it after the commands that read it. */
+	void fence();
+
+	/** \brief  Unbinds the unpack buffer, so later uploads from client memory work again. */
+	void unbind();
+
+	size_t getSize() const;
+
+	/** \brief  Gets the bytes staged and not yet passed by the GPU. */
+	size_t getUsed() const;
+
+private:
+	// staged bytes behind one fence, wasted bytes at the end of the ring included
+	struct Region
+	{
+		GLsync fence;
+		size_t bytes;
+	};
+
+	GLuint _buffer;
+	size_t _size;
+	size_t _head; // where the next stage() writes
+	size_t _used; // fenced and unfenced bytes the GPU may still read
+	size_t _unfenced; // staged since the last fence()
+	std::deque<Region> _inFlight;
+
+	// frees the regions whose fence the GPU passed, oldest first
+	void retire(bool wait);
+
+	PixelUploadRing(const PixelUploadRing&);
+	PixelUploadRing& operator=(const PixelUploadRing&);
+};
@@ -0,0 +1,310 @@
+// STL
+#include <fstream>
+#include <sstream>
+#include <iostream>
+#include <algorithm>
+#include <cstdio>
+#include <cmath>
+#include <cerrno>
+
+#if defined(_WIN32)
+#include <direct.h>
+#else
+#include <sys/stat.h>
+#endif
+
+// Project
+#include "regressionSuite.h"
+#include "offscreenTarget.h"
+
+namespace {
+
+	// creates a directory and the ones above it that are missing, true if it exists afterwards
+	bool createDirectories(const std::string& path)
+	{
+		for (size_t end = path.find_first_of("/\\", 1); ; end = path.find_first_of("/\\", end + 1))
+		{
+			std::string directory = path.substr(0, end);
+#if defined(_WIN32)
+			int status = _mkdir(directory.c_str());
+#else
+			int status = mkdir(directory.c_str(), 0755);
+#endif
+			if (status != 0 && errno != EEXIST)
+				return false;
+			if (end == std::string::npos)
+				return true;
+		}
+	}
+
+	// largest possible squared YIQ difference, between black and white
+	const double MAX_YIQ_DELTA = 35215.0;
+
+	// squared YIQ difference weighted the way the eye weighs brightness against color
+	// (Kotsarenko and Ramos, "Measuring perceived color difference using YIQ NTSC transmission color space")
+	double colorDelta(const unsigned char* a, const unsigned char* b)
+	{
+		double r = (double)a[0] - b[0];
+		double g = (double)a[1] - b[1];
+		double bl = (double)a[2] - b[2];
+		double y = r * 0.29889531 + g * 0.58662247 + bl * 0.11448223;
+		double i = r * 0.59597799 - g * 0.27417610 - bl * 0.32180189;
+		double q = r * 0.21147017 - g * 0.52261711 + bl * 0.31114694;
+		return 0.5053 * y * y + 0.299 * i * i + 0.1957 * q * q;
+	}
+
+	void writeSummary(FILE* file, const char* name, const FrameStatistics::Summary& summary)
+	{
+		fprintf(file, "\"%s\": { \"count\": %zu, \"median\": %.4f, \"p95\": %.4f, \"max\": %.4f }",
+			name, summary.count, summary.median, summary.p95, summary.max);
+	}
+
+} // namespace
+
+RegressionSuite::RegressionSuite()
+	: _memoryMegabytes(-1.0)
+	, _memoryPassed(true)
+{
+	_settings.width = 320;
+	_settings.height = 240;
+	_settings.frames = 30;
+	_settings.pixelThreshold = 0.1;
+	_settings.maxChanged = 0.001;
+	_settings.cpuP95 = 0.0;
+	_settings.gpuP95 = 0.0;
+	_settings.memoryMegabytes = 0.0;
+}
+
+bool RegressionSuite::load(const char* path)
+{
+	std::ifstream file(path);
+	if (!file.is_open())
+	{
+		std::cout << "ERROR::REGRESSION::FILE_NOT_SUCCESFULLY_READ: " << path << std::endl;
+		return false;
+	}
+
+	_cameras.clear();
+	_results.clear();
+	std::string line;
+	int lineNumber = 0;
+	while (std::getline(file, line))
+	{
+		lineNumber++;
+		size_t comment = line.find('#');
+		if (comment != std::string::npos)
+			line.erase(comment);
+
+		std::istringstream tokens(line);
+		std::string key;
+		if (!(tokens >> key))
+			continue;
+		bool valid;
+		if (key == "resolution")
+			valid = (bool)(tokens >> _settings.width >> _settings.height) && _settings.width > 0 && _settings.height > 0;
+		else if (key == "frames")
+			valid = (bool)(tokens >> _settings.frames) && _settings.frames > 0;
+		else if (key == "pixel_threshold")
+			valid = (bool)(tokens >> _settings.pixelThreshold);
+		else if (key == "max_changed")
+			valid = (bool)(tokens >> _settings.maxChanged);
+		else if (key == "cpu_p95_ms")
+			valid = (bool)(tokens >> _settings.cpuP95);
+		else if (key == "gpu_p95_ms")
+			valid = (bool)(tokens >> _settings.gpuP95);
+		else if (key == "memory_mb")
+			valid = (bool)(tokens >> _settings.memoryMegabytes);
+		else if (key == "camera")
+		{
+			RegressionCamera camera;
+			camera.pose.time = 0.0;
+			valid = (bool)(tokens >> camera.name >> camera.pose.position.x >> camera.pose.position.y >> camera.pose.position.z
+				>> camera.pose.yaw >> camera.pose.pitch);
+			if (valid && !(tokens >> camera.pose.fov))
+				camera.pose.fov = 45.0f;
+			if (valid)
+				_cameras.push_back(camera);
+		}
+		else
+		{
+			std::cout << "ERROR::REGRESSION::" << path << "(" << lineNumber << "): unknown setting " << key << std::endl;
+			return false;
+		}
+		if (!valid)
+		{
+			std::cout << "ERROR::REGRESSION::" << path << "(" << lineNumber << "): bad value for " << key << std::endl;
+			return false;
+		}
+	}
+	if (_cameras.empty())
+	{
+		std::cout << "ERROR::REGRESSION::" << path << ": no cameras" << std::endl;
+		return false;
+	}
+	return true;
+}
+
+const RegressionSuite::Settings& RegressionSuite::getSettings() const
+{
+	return _settings;
+}
+
+const std::vector<RegressionCamera>& RegressionSuite::cameras() const
+{
+	return _cameras;
+}
+
+bool RegressionSuite::check(const RegressionCamera& camera, const std::vector<unsigned char>& rgba, const FrameStatistics& cpu,
+	const FrameStatistics& gpu, const std::string& goldenDirectory, bool update)
+{
+	Result result;
+	result.camera = camera.name;
+	result.imageChecked = false;
+	result.imagePassed = true;
+	result.image.pixels = (size_t)_settings.width * _settings.height;
+	result.image.changed = result.image.shifted = 0;
+	result.image.maxDifference = 0.0;
+	result.cpu = cpu.summarize();
+	result.gpu = gpu.summarize();
+
+	std::string golden = goldenDirectory + "/" + camera.name + ".ppm";
+	std::string imageText;
+	if (update)
+	{
+		result.imagePassed = createDirectories(goldenDirectory) && OffscreenTarget::writePPM(golden.c_str(), rgba, _settings.width, _settings.height);
+		imageText = result.imagePassed ? "golden image written" : "golden image NOT written to " + golden;
+	}
+	else
+	{
+		std::vector<unsigned char> goldenPixels;
+		int goldenWidth, goldenHeight;
+		if (!OffscreenTarget::readPPM(golden.c_str(), goldenPixels, goldenWidth, goldenHeight))
+		{
+			result.imagePassed = false;
+			imageText = "no golden image " + golden;
+		}
+		else if (goldenWidth != _settings.width || goldenHeight != _settings.height)
+		{
+			result.imagePassed = false;
+			imageText = "golden image has a different size";
+		}
+		else
+		{
+			std::vector<unsigned char> difference;
+			result.imageChecked = true;
+			result.image = compareImages(rgba, goldenPixels, _settings.width, _settings.height, _settings.pixelThreshold, &difference);
+			result.imagePassed = result.image.changed <= _settings.maxChanged * result.image.pixels;
+			if (!result.imagePassed)
+			{
+				std::string prefix = goldenDirectory + "/" + camera.name;
+				OffscreenTarget::writePPM((prefix + ".actual.ppm").c_str(), rgba, _settings.width, _settings.height);
+				OffscreenTarget::writePPM((prefix + ".diff.ppm").c_str(), difference, _settings.width, _settings.height);
+			}
+			char text[128];
+			snprintf(text, sizeof(text), "%zu changed, %zu shifted pixels, max difference %.3f",
+				result.image.changed, result.image.shifted, result.image.maxDifference);
+			imageText = text;
+		}
+	}
+
+	// limits of 0 are not checked; the GPU time is not known without timer queries
+	result.timesPassed = (_settings.cpuP95 <= 0.0 || result.cpu.p95 <= _settings.cpuP95)
+		&& (_settings.gpuP95 <= 0.0 || result.gpu.count == 0 || result.gpu.p95 <= _settings.gpuP95);
+
+	printf("%-16s %s  image: %s\n", camera.name.c_str(), result.imagePassed && result.timesPassed ? "PASS" : "FAIL", imageText.c_str());
+	printf("%-16s      cpu p95 %.3f ms (limit %g), gpu p95 %.3f ms (limit %g)%s\n", "", result.cpu.p95, _settings.cpuP95,
+		result.gpu.p95, _settings.gpuP95, result.timesPassed ? "" : "  TOO SLOW");
+	_results.push_back(result);
+	return result.imagePassed && result.timesPassed;
+}
+
+bool RegressionSuite::checkMemory(double megabytes)
+{
+	_memoryMegabytes = megabytes;
+	_memoryPassed = _settings.memoryMegabytes <= 0.0 || megabytes <= _settings.memoryMegabytes;
+	printf("%-16s %s  %.1f mb (limit %g)\n", "memory", _memoryPassed ? "PASS" : "FAIL", megabytes, _settings.memoryMegabytes);
+	return _memoryPassed;
+}
+
+bool RegressionSuite::passed() const
+{
+	for (size_t i = 0; i < _results.size(); i++)
+	{
+		if (!_results[i].imagePassed || !_results[i].timesPassed)
+			return false;
+	}
+	return _memoryPassed;
+}
+
+bool RegressionSuite::saveReport(const char* path) const
+{
+	FILE* file = fopen(path, "w");
+	if (file == NULL)
+	{
+		std::cout << "ERROR::REGRESSION::CANNOT_WRITE " << path << std::endl;
+		return false;
+	}
+	fprintf(file, "{\n  \"passed\": %s,\n", passed() ? "true" : "false");
+	fprintf(file, "  \"resolution\": [%d, %d],\n", _settings.width, _settings.height);
+	fprintf(file, "  \"memory_mb\": %.1f,\n", std::max(_memoryMegabytes, 0.0));
+	fprintf(file, "  \"cameras\": [");
+	for (size_t i = 0; i < _results.size(); i++)
+	{
+		const Result& result = _results[i];
+		fprintf(file, "%s\n    { \"name\": \"%s\", \"image_passed\": %s, \"image_checked\": %s, \"changed\": %zu, \"shifted\": %zu, \"max_difference\": %.4f,\n",
+			i == 0 ? "" : ",", result.camera.c_str(), result.imagePassed ? "true" : "false", result.imageChecked ? "true" : "false",
+			result.image.changed, result.image.shifted, result.image.maxDifference);
+		fprintf(file, "      \"times_passed\": %s, ", result.timesPassed ? "true" : "false");
+		writeSummary(file, "cpu", result.cpu);
+		fprintf(file, ", ");
+		writeSummary(file, "gpu", result.gpu);
+		fprintf(file, " }");
+	}
+	fprintf(file, "\n  ]\n}\n");
+	fclose(file);
+	return true;
+}
+
+RegressionSuite::ImageComparison RegressionSuite::compareImages(const std::vector<unsigned char>& image, const std::vector<unsigned char>& golden,
+	int width, int height, double threshold, std::vector<unsigned char>* difference)
+{
+	ImageComparison comparison;
+	comparison.pixels = (size_t)width * height;
+	comparison.changed = comparison.shifted = 0;
+	comparison.maxDifference = 0.0;
+	if (difference != NULL)
+		difference->resize(comparison.pixels * 4);
+
+	const double maxDelta = MAX_YIQ_DELTA * threshold * threshold;
+	for (int y = 0; y < height; y++)
+	{
+		for (int x = 0; x < width; x++)
+		{
+			size_t index = ((size_t)y * width + x) * 4;
+			double delta = colorDelta(&image[index], &golden[index]);
+			comparison.maxDifference = std::max(comparison.maxDifference, std::sqrt(delta / MAX_YIQ_DELTA));
+
+			// an edge that moved by a pixel still finds its color next to where it was
+			bool shifted = false;
+			for (int ny = std::max(y - 1, 0); delta > maxDelta && !shifted && ny <= std::min(y + 1, height - 1); ny++)
+			{
+				for (int nx = std::max(x - 1, 0); !shifted && nx <= std::min(x + 1, width - 1); nx++)
+					shifted = colorDelta(&image[index], &golden[((size_t)ny * width + nx) * 4]) <= maxDelta;
+			}
+			if (delta > maxDelta)
+				(shifted ? comparison.shifted : comparison.changed)++;
+
+			// the golden image faded to gray, with the differences on top
+			if (difference != NULL)
+			{
+				unsigned char* out = &(*difference)[index];
+				unsigned char gray = (unsigned char)(191 + (golden[index] * 0.299 + golden[index + 1] * 0.587 + golden[index + 2] * 0.114) / 4.0);
+				out[0] = delta > maxDelta ? 255 : gray;
+				out[1] = delta > maxDelta ? (shifted ? 255 : 0) : gray;
+				out[2] = delta > maxDelta ? 0 : gray;
+				out[3] = 255;
+			}
+		}
+	}
+	return comparison;
+}
@@ -0,0 +1,109 @@
+#pragma once
+
+// STL
+#include <vector>
+#include <string>
+#include <cstddef>
+
+// Project
+#include "cameraPath.h"
+#include "benchmark.h"
+
+/**
+* A fixed camera of a regression suite, its golden image is <name>.ppm.
+*/
+struct RegressionCamera
+{
+	std::string name;
+	CameraKeyframe pose;
+};
+
+/**
+* Image and performance checks for rendering changes: the scene is rendered from a set of
+* fixed cameras, each image is compared with a stored golden image and the frame times and
+* process memory are checked against thresholds. Suite file format, one setting or camera
+* per line:
+*
+*   resolution      320 240   # of the images, independent of the window
+*   frames          30        # measured per camera, after a few warm up frames
+*   pixel_threshold 0.1       # perceptual difference (0..1) above which a pixel counts as changed
+*   max_changed     0.001     # fraction of the pixels that may change
+*   cpu_p95_ms      20        # frame time limits, 0 or left out = not checked
+*   gpu_p95_ms      20
+*   memory_mb       1024
+*   # camera <name>  x y z  yaw pitch  [fov]
+*   camera overview  -1 0 5  -90 0  45
+*/
+class RegressionSuite
+{
+public:
+	struct Settings
+	{
+		int width, height;
+		int frames;
+		double pixelThreshold;
+		double maxChanged;
+		double cpuP95;
+		double gpuP95;
+		double memoryMegabytes;
+	};
+
+	struct ImageComparison
+	{
+		size_t pixels;
+		size_t changed; // beyond the threshold, with no matching pixel next to it in the golden image
+		size_t shifted; // beyond the threshold, but matching a neighbour (anti-aliasing, sub pixel movement)
+		double maxDifference; // perceptual, 0..1
+	};
+
+	RegressionSuite();
+
+	/** \brief  Loads a suite file.
+	*   \return True on success, errors are printed.
+	*/
+	bool load(const char* path);
+
+	const Settings& getSettings() const;
+	const std::vector<RegressionCamera>& cameras() const;
+
+	/** \brief  Checks the image (RGBA8, as OffscreenTarget::readPixels() returns it) and frame times of a camera.
+	*           A failed image is written next to the golden one as <name>.actual.ppm along with
+	*           <name>.diff.ppm, changed pixels red and shifted ones yellow. The result is printed.
+	*   \param update  Writes the image as the new golden image instead of comparing, creating the directory if needed
+	*   \return False when the image or a frame time is beyond its threshold or there is no golden image
+	*/
+	bool check(const RegressionCamera& camera, const std::vector<unsigned char>& rgba, const FrameStatistics& cpu,
+		const FrameStatistics& gpu, const std::string& goldenDirectory, bool update);
+
+	/** \brief  Checks the process memory after all cameras, the result is printed. */
+	bool checkMemory(double megabytes);
+
+	/** \brief  True when every check so far passed. */
+	bool passed() const;
+
+	/** \brief  Writes all results as JSON. */
+	bool saveReport(const char* path) const;
+
+	/** \brief  Compares two RGBA8 images of the same size using the YIQ color difference.
+	*   \param difference  Receives a visualization of the differences when not NULL
+	*/
+	static ImageComparison compareImages(const std::vector<unsigned char>& image, const std::vector<unsigned char>& golden,
+		int width, int height, double threshold, std::vector<unsigned char>* difference);
+
+private:
+	struct Result
+	{
+		std::string camera;
+		bool imageChecked; // false when the golden image was written
+		bool imagePassed;
+		ImageComparison image;
+		FrameStatistics::Summary cpu, gpu;
+		bool timesPassed;
+	};
+
+	Settings _settings;
+	std::vector<RegressionCamera> _cameras;
+	std::vector<Result> _results;
+	double _memoryMegabytes; // negative until checked
+	bool _memoryPassed;
+};
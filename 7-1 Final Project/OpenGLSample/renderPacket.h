@@ -0,0 +1,50 @@
+#pragma once
+
+// STL
+#include <vector>
+#include <cstdint>
+
+// GLM
+#include <glm/glm.hpp>
+
+// Project
+#include "frustumCuller.h"
+#include "occlusionCuller.h"
+
+/**
+* One draw group of the scene that survived culling. Its transforms are the visible
+* objects of the group, in scene order.
+*/
+struct RenderPacketDraw
+{
+	uint32_t group; // draw group of the Scene
+	uint32_t firstTransform; // into RenderPacket::transforms
+	uint32_t transformCount;
+	float viewDepth; // of the nearest transform, for the sort key
+};
+
+/**
+* Everything the render thread needs to draw one frame, produced by the simulation thread.
+* Once published a packet is only read, so the render thread never touches simulation state.
+* Packets are reused frame to frame, the vectors keep their storage.
+*/
+struct RenderPacket
+{
+	uint64_t frame; // simulation frame that produced the packet
+
+	// camera
+	glm::mat4 view;
+	glm::mat4 projection;
+	glm::vec3 cameraPosition;
+	float nearPlane;
+	float farPlane;
+
+	std::vector<RenderPacketDraw> draws;
+	std::vector<glm::mat4> transforms;
+	std::vector<uint8_t> visible; // per scene object, 1 when it is drawn
+
+	// culling reports of the frame
+	FrustumCuller::CullStats cullStats;
+	OcclusionCuller::CullStats occlusionStats;
+	double simulationMilliseconds; // input, camera and culling
+};
@@ -0,0 +1,271 @@
+#ifndef RENDER_QUEUE_H
+#define RENDER_QUEUE_H
+
+#include <glad/glad.h>
+
+#include <glm/glm.hpp>
+
+#include "shader.h"
+#include "glStateCache.h"
+#include "gpuProfiler.h"
+#include "common/staticMesh3D.h"
+
+#include <vector>
+#include <cstdint>
+#include <algorithm>
+
+// Passes are the top bits of every sort key, so all draws of one pass run before the next.
+enum RenderPass
+{
+	RENDER_PASS_OPAQUE = 0,
+	RENDER_PASS_TRANSPARENT = 1,
+	RENDER_PASS_OVERLAY = 2
+};
+
+// draws a mesh object that the queue only knows as a pointer
+typedef void (*MeshDrawFunction)(void* mesh);
+// instanced draws go through a VAO that holds the mesh attributes and the instance attributes
+typedef void (*MeshDrawInstancedFunction)(void* mesh, GLuint vertexArray, GLsizei count);
+
+// draw adapters for the mesh types of this project
+// ------------------------------------------------------------------------
+template <typename T>
+inline void drawIndexedMesh(void* mesh)
+{
+	// Sphere / HalfSphere style meshes with a Draw() method
+	static_cast<T*>(mesh)->Draw();
+}
+inline void drawStaticMesh(void* mesh)
+{
+	// everything derived from static_meshes_3D::StaticMesh3D (Cylinder)
+	static_cast<static_meshes_3D::StaticMesh3D*>(mesh)->render();
+}
+template <typename T>
+inline void drawIndexedMeshInstanced(void* mesh, GLuint vertexArray, GLsizei count)
+{
+	static_cast<T*>(mesh)->DrawInstanced(vertexArray, count);
+}
+inline void drawStaticMeshInstanced(void* mesh, GLuint vertexArray, GLsizei count)
+{
+	static_cast<static_meshes_3D::StaticMesh3D*>(mesh)->renderInstanced(vertexArray, count);
+}
+
+// a plain VAO drawn with glDrawArrays, like the plane and the butter block
+struct VertexArrayMesh
+{
+	GLuint vao;
+	GLint first;
+	GLsizei count;
+
+	void Draw()
+	{
+		GLStateCache::get().bindVertexArray(vao);
+		glDrawArrays(GL_TRIANGLES, first, count);
+	}
+	void DrawInstanced(GLuint vertexArray, GLsizei instances)
+	{
+		GLStateCache::get().bindVertexArray(vertexArray);
+		glDrawArraysInstanced(GL_TRIANGLES, first, count, instances);
+	}
+};
+
+// the payload of one queued draw
+struct RenderCommand
+{
+	Shader* shader;
+	GLuint texture;		// bound to unit 0
+	GLenum textureTarget;	// GL_TEXTURE_2D, or GL_TEXTURE_2D_ARRAY for a TEXTURE_ARRAY permutation
+	MeshDrawFunction draw;
+	void* mesh;
+	glm::mat4 model;
+	// instanced draws: shader must be an INSTANCED permutation, model is then ignored
+	MeshDrawInstancedFunction drawInstanced;
+	GLsizei instanceCount;
+	GLuint vertexArray;	// the InstanceBatch VAO of the mesh, see InstanceBatch::createVertexArray
+	// GPU profiler scope of the draw, consecutive draws with the same name share one; may be null
+	const char* profileName;
+	// texture arrays: offset and scale of the image in its layer, and the layer. Instanced
+	// draws take them from the instance attributes instead
+	glm::vec4 textureRect;
+	float textureLayer;
+};
+
+// Collects the draws of a frame, each with a packed 64 bit sort key, radix sorts the keys
+// and executes the draws in key order. Keys put state first for opaque geometry (fewest
+// program/texture/VAO switches, then front to back for early-Z) and depth first for
+// transparent geometry (back to front for correct blending).
+class RenderQueue
+{
+public:
+	// key layout, most significant bits first
+	//   opaque:      pass(2) | program(12) | texture set(12) | mesh(12) | depth(26)
+	//   transparent: pass(2) | inverted depth(26) | program(12) | texture set(12) | mesh(12)
+	static const int ID_BITS = 12;
+	static const int DEPTH_BITS = 26;
+
+	// what the last execute() issued
+	struct ExecuteStats
+	{
+		unsigned int drawCalls;
+		unsigned int instances;	// objects drawn, instanced draws count every instance
+		unsigned int programChanges;
+	};
+
+	RenderQueue()
+	{
+		stats.drawCalls = stats.instances = stats.programChanges = 0;
+	}
+
+	// packs a sort key. ids are masked to 12 bits, so they should be small dense numbers
+	// (GL object names are). viewDepth is the distance along the view direction and gets
+	// quantized over [nearPlane, farPlane].
+	// ------------------------------------------------------------------------
+	static uint64_t makeKey(RenderPass pass, unsigned int program, unsigned int textureSet, unsigned int mesh,
+		float viewDepth, float nearPlane, float farPlane)
+	{
+		const uint64_t idMask = (1u << ID_BITS) - 1;
+		const uint64_t depthMax = (1u << DEPTH_BITS) - 1;
+
+		float t = (viewDepth - nearPlane) / (farPlane - nearPlane);
+		t = t < 0.0f ? 0.0f : (t > 1.0f ? 1.0f : t);
+		// in double: depthMax does not fit a float's mantissa and rounds up past it near t = 1
+		uint64_t depth = std::min((uint64_t)((double)t * depthMax), depthMax);
+
+		uint64_t state = ((program & idMask) << (2 * ID_BITS)) | ((textureSet & idMask) << ID_BITS) | (mesh & idMask);
+		uint64_t key = (uint64_t)pass << (3 * ID_BITS + DEPTH_BITS);
+		if (pass == RENDER_PASS_TRANSPARENT)
+			key |= ((depthMax - depth) << (3 * ID_BITS)) | state;
+		else
+			key |= (state << DEPTH_BITS) | depth;
+		return key;
+	}
+
+	// ------------------------------------------------------------------------
+	void clear()
+	{
+		commands.clear();
+		entries.clear();
+	}
+	void submit(uint64_t key, const RenderCommand &command)
+	{
+		SortEntry entry;
+		entry.key = key;
+		entry.index = (uint32_t)commands.size();
+		entries.push_back(entry);
+		commands.push_back(command);
+	}
+	size_t size() const
+	{
+		return commands.size();
+	}
+
+	// LSD radix sort over the 8 key bytes. Stable, so equal keys keep submission order,
+	// and a byte that is the same for every key (e.g. the pass when there is only one)
+	// costs only its histogram. The buffers are reused so steady state does not allocate.
+	// ------------------------------------------------------------------------
+	void sort()
+	{
+		size_t count = entries.size();
+		scratch.resize(count);
+		SortEntry* src = entries.empty() ? nullptr : &entries[0];
+		SortEntry* dst = scratch.empty() ? nullptr : &scratch[0];
+
+		for (int shift = 0; shift < 64; shift += 8)
+		{
+			size_t histogram[256] = { 0 };
+			for (size_t i = 0; i < count; i++)
+				histogram[(src[i].key >> shift) & 0xFF]++;
+			if (count == 0 || histogram[(src[0].key >> shift) & 0xFF] == count)
+				continue;
+
+			size_t offset = 0;
+			for (int b = 0; b < 256; b++)
+			{
+				size_t n = histogram[b];
+				histogram[b] = offset;
+				offset += n;
+			}
+			for (size_t i = 0; i < count; i++)
+				dst[histogram[(src[i].key >> shift) & 0xFF]++] = src[i];
+
+			SortEntry* swap = src;
+			src = dst;
+			dst = swap;
+		}
+		// the result has to end up in entries
+		if (count > 0 && src != &entries[0])
+			entries.swap(scratch);
+	}
+
+	// runs the queued draws in key order. view/projection are set whenever a program is
+	// used for the first time; the shader's uniform shadow drops repeated uploads.
+	// ------------------------------------------------------------------------
+	void execute(const glm::mat4 &view, const glm::mat4 &projection)
+	{
+		GLStateCache &glState = GLStateCache::get();
+		Shader* current = nullptr;
+		stats.drawCalls = stats.instances = stats.programChanges = 0;
+#if OPENGLSAMPLE_GPU_PROFILER
+		const char* scope = nullptr;
+#endif
+		for (size_t i = 0; i < entries.size(); i++)
+		{
+			RenderCommand &command = commands[entries[i].index];
+#if OPENGLSAMPLE_GPU_PROFILER
+			if (command.profileName != scope)
+			{
+				if (scope != nullptr)
+					GPU_PROFILE_END();
+				scope = command.profileName;
+				if (scope != nullptr)
+					GPU_PROFILE_BEGIN(scope);
+			}
+#endif
+			if (command.shader != current)
+			{
+				current = command.shader;
+				current->use();
+				stats.programChanges++;
+				current->setMat4("projection", projection);
+				current->setMat4("view", view);
+			}
+			glState.bindTexture(0, command.textureTarget, command.texture);
+			stats.drawCalls++;
+			if (command.instanceCount > 0)
+			{
+				command.drawInstanced(command.mesh, command.vertexArray, command.instanceCount);
+				stats.instances += command.instanceCount;
+				continue;
+			}
+			stats.instances++;
+			current->setMat4("model", command.model);
+			if (command.textureTarget == GL_TEXTURE_2D_ARRAY)
+			{
+				current->setVec4("textureRect", command.textureRect);
+				current->setFloat("textureLayer", command.textureLayer);
+			}
+			command.draw(command.mesh);
+		}
+#if OPENGLSAMPLE_GPU_PROFILER
+		if (scope != nullptr)
+			GPU_PROFILE_END();
+#endif
+	}
+
+	const ExecuteStats &getStats() const
+	{
+		return stats;
+	}
+
+private:
+	struct SortEntry
+	{
+		uint64_t key;
+		uint32_t index;	// into commands
+	};
+	std::vector<RenderCommand> commands;
+	std::vector<SortEntry> entries;
+	std::vector<SortEntry> scratch;
+	ExecuteStats stats;
+};
+#endif
@@ -0,0 +1,1018 @@
+// STL
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <iostream>
+#include <algorithm>
+#include <map>
+
+// GLM
+#include <glm/gtc/matrix_transform.hpp>
+
+// Project
+#include "scene.h"
+#include "glStateCache.h"
+#include "cpuTracer.h"
+#include "cylinder.h"
+#include "Sphere.h"
+#include "HalfSphere.h"
+#include "texturePacker.h"
+#include "stb_image.h"
+
+namespace {
+
+	// "images/egg.jpg" -> "egg"
+	std::string fileStem(const char* path)
+	{
+		std::string name(path);
+		size_t slash = name.find_last_of("/\\");
+		if (slash != std::string::npos)
+			name = name.substr(slash + 1);
+		size_t dot = name.find_last_of('.');
+		return dot != std::string::npos && dot > 0 ? name.substr(0, dot) : name;
+	}
+
+	// unit cube, 6 faces of 2 triangles, position + texture coordinate (same UV layout as the old butter block)
+	const float UNIT_BOX_VERTICES[] = {
+		-1.0f, -1.0f, -1.0f, 0.0f, 0.0f,   1.0f, -1.0f, -1.0f, 1.0f, 0.0f,   1.0f,  1.0f, -1.0f, 1.0f, 1.0f,
+		 1.0f,  1.0f, -1.0f, 1.0f, 1.0f,  -1.0f,  1.0f, -1.0f, 0.0f, 1.0f,  -1.0f, -1.0f, -1.0f, 0.0f, 0.0f,
+
+		-1.0f, -1.0f,  1.0f, 0.0f, 0.0f,   1.0f, -1.0f,  1.0f, 1.0f, 0.0f,   1.0f,  1.0f,  1.0f, 1.0f, 1.0f,
+		 1.0f,  1.0f,  1.0f, 1.0f, 1.0f,  -1.0f,  1.0f,  1.0f, 0.0f, 1.0f,  -1.0f, -1.0f,  1.0f, 0.0f, 0.0f,
+
+		-1.0f,  1.0f,  1.0f, 1.0f, 0.0f,  -1.0f,  1.0f, -1.0f, 1.0f, 1.0f,  -1.0f, -1.0f, -1.0f, 0.0f, 1.0f,
+		-1.0f, -1.0f, -1.0f, 0.0f, 1.0f,  -1.0f, -1.0f,  1.0f, 0.0f, 0.0f,  -1.0f,  1.0f,  1.0f, 1.0f, 0.0f,
+
+		 1.0f,  1.0f,  1.0f, 1.0f, 0.0f,   1.0f,  1.0f, -1.0f, 1.0f, 1.0f,   1.0f, -1.0f, -1.0f, 0.0f, 1.0f,
+		 1.0f, -1.0f, -1.0f, 0.0f, 1.0f,   1.0f, -1.0f,  1.0f, 0.0f, 0.0f,   1.0f,  1.0f,  1.0f, 1.0f, 0.0f,
+
+		-1.0f, -1.0f, -1.0f, 0.0f, 1.0f,   1.0f, -1.0f, -1.0f, 1.0f, 1.0f,   1.0f, -1.0f,  1.0f, 1.0f, 0.0f,
+		 1.0f, -1.0f,  1.0f, 1.0f, 0.0f,  -1.0f, -1.0f,  1.0f, 0.0f, 0.0f,  -1.0f, -1.0f, -1.0f, 0.0f, 1.0f,
+
+		-1.0f,  1.0f, -1.0f, 0.0f, 1.0f,   1.0f,  1.0f, -1.0f, 1.0f, 1.0f,   1.0f,  1.0f,  1.0f, 1.0f, 0.0f,
+		 1.0f,  1.0f,  1.0f, 1.0f, 0.0f,  -1.0f,  1.0f,  1.0f, 0.0f, 0.0f,  -1.0f,  1.0f, -1.0f, 0.0f, 1.0f
+	};
+
+	// uploads position + texture coordinate triangles into a new VAO/VBO
+	VertexArrayMesh* createVertexArrayMesh(const std::vector<float>& vertices, GLuint& vbo)
+	{
+		GLStateCache& glState = GLStateCache::get();
+		VertexArrayMesh* mesh = new VertexArrayMesh();
+		mesh->first = 0;
+		mesh->count = (GLsizei)(vertices.size() / 5);
+
+		glGenVertexArrays(1, &mesh->vao);
+		glGenBuffers(1, &vbo);
+		glState.bindVertexArray(mesh->vao);
+		glState.bindBuffer(GL_ARRAY_BUFFER, vbo);
+		glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(float), vertices.data(), GL_STATIC_DRAW);
+
+		// position attribute
+		glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 5 * sizeof(float), (void*)0);
+		glEnableVertexAttribArray(0);
+		// texture coord attribute
+		glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 5 * sizeof(float), (void*)(3 * sizeof(float)));
+		glEnableVertexAttribArray(1);
+
+		glState.bindVertexArray(0);
+		return mesh;
+	}
+
+	// horizontal square at the given height, texture stretched once over it
+	VertexArrayMesh* createPlane(float halfSize, float height, GLuint& vbo)
+	{
+		const float s = halfSize;
+		const float h = height;
+		std::vector<float> vertices = {
+			-s, h, -s,  0.0f, 0.0f,
+			 s, h, -s,  1.0f, 0.0f,
+			 s, h,  s,  1.0f, 1.0f,
+			 s, h,  s,  1.0f, 1.0f,
+			-s, h,  s,  0.0f, 1.0f,
+			-s, h, -s,  0.0f, 0.0f,
+		};
+		return createVertexArrayMesh(vertices, vbo);
+	}
+
+	VertexArrayMesh* createBox(const glm::vec3& halfExtents, GLuint& vbo)
+	{
+		std::vector<float> vertices(UNIT_BOX_VERTICES, UNIT_BOX_VERTICES + sizeof(UNIT_BOX_VERTICES) / sizeof(float));
+		for (size_t i = 0; i < vertices.size(); i += 5)
+		{
+			vertices[i + 0] *= halfExtents.x;
+			vertices[i + 1] *= halfExtents.y;
+			vertices[i + 2] *= halfExtents.z;
+		}
+		return createVertexArrayMesh(vertices, vbo);
+	}
+
+	void addQuad(std::vector<glm::vec3>& triangles, const glm::vec3& a, const glm::vec3& b, const glm::vec3& c, const glm::vec3& d)
+	{
+		triangles.push_back(a);
+		triangles.push_back(b);
+		triangles.push_back(c);
+		triangles.push_back(c);
+		triangles.push_back(d);
+		triangles.push_back(a);
+	}
+
+	// Occluder stand-ins for the software occlusion buffer. Curved meshes use a coarse version
+	// with its vertices on the real surface; for closed meshes the flat faces then stay inside
+	// it and never hide more than the real mesh does.
+	void buildOccluder(const SceneMeshRecord& record, std::vector<glm::vec3>& triangles)
+	{
+		const int sectors = 8;
+		const float pi = 3.14159265f;
+		triangles.clear();
+		switch (record.type)
+		{
+		case SCENE_MESH_PLANE:
+		{
+			float s = record.params[0];
+			float h = record.params[1];
+			addQuad(triangles, glm::vec3(-s, h, -s), glm::vec3(s, h, -s), glm::vec3(s, h, s), glm::vec3(-s, h, s));
+			break;
+		}
+		case SCENE_MESH_BOX:
+		{
+			glm::vec3 e(record.params[0], record.params[1], record.params[2]);
+			glm::vec3 c[8];
+			for (int i = 0; i < 8; i++)
+				c[i] = glm::vec3(i & 1 ? e.x : -e.x, i & 2 ? e.y : -e.y, i & 4 ? e.z : -e.z);
+			addQuad(triangles, c[0], c[1], c[3], c[2]); // -z
+			addQuad(triangles, c[4], c[5], c[7], c[6]); // +z
+			addQuad(triangles, c[0], c[2], c[6], c[4]); // -x
+			addQuad(triangles, c[1], c[3], c[7], c[5]); // +x
+			addQuad(triangles, c[0], c[1], c[5], c[4]); // -y
+			addQuad(triangles, c[2], c[3], c[7], c[6]); // +y
+			break;
+		}
+		case SCENE_MESH_SPHERE:
+		case SCENE_MESH_HALF_SPHERE:
+		{
+			// same parametrization as Sphere / HalfSphere: stacks from the +z pole down
+			float r = record.params[0];
+			int stacks = record.type == SCENE_MESH_SPHERE ? 6 : 3;
+			float lastAngle = record.type == SCENE_MESH_SPHERE ? -pi / 2 : 0.0f;
+			for (int i = 0; i < stacks; i++)
+			{
+				float a0 = pi / 2 + (lastAngle - pi / 2) * i / stacks;
+				float a1 = pi / 2 + (lastAngle - pi / 2) * (i + 1) / stacks;
+				for (int j = 0; j < sectors; j++)
+				{
+					float s0 = 2 * pi * j / sectors;
+					float s1 = 2 * pi * (j + 1) / sectors;
+					addQuad(triangles,
+						glm::vec3(r * cosf(a0) * cosf(s0), r * cosf(a0) * sinf(s0), r * sinf(a0)),
+						glm::vec3(r * cosf(a1) * cosf(s0), r * cosf(a1) * sinf(s0), r * sinf(a1)),
+						glm::vec3(r * cosf(a1) * cosf(s1), r * cosf(a1) * sinf(s1), r * sinf(a1)),
+						glm::vec3(r * cosf(a0) * cosf(s1), r * cosf(a0) * sinf(s1), r * sinf(a0)));
+				}
+			}
+			break;
+		}
+		case SCENE_MESH_CYLINDER:
+		{
+			// prism along y with caps, like Cylinder
+			float r = record.params[0];
+			float h = record.params[1] / 2.0f;
+			for (int j = 0; j < sectors; j++)
+			{
+				float s0 = 2 * pi * j / sectors;
+				float s1 = 2 * pi * (j + 1) / sectors;
+				glm::vec3 p0(r * cosf(s0), 0.0f, r * sinf(s0));
+				glm::vec3 p1(r * cosf(s1), 0.0f, r * sinf(s1));
+				glm::vec3 up(0.0f, h, 0.0f);
+				addQuad(triangles, p0 - up, p1 - up, p1 + up, p0 + up);
+				triangles.push_back(up);
+				triangles.push_back(p0 + up);
+				triangles.push_back(p1 + up);
+				triangles.push_back(-up);
+				triangles.push_back(p1 - up);
+				triangles.push_back(p0 - up);
+			}
+			break;
+		}
+		}
+	}
+
+	bool sameMesh(const SceneMeshRecord& a, const SceneMeshRecord& b)
+	{
+		return memcmp(&a, &b, sizeof(SceneMeshRecord)) == 0;
+	}
+
+	// packs the textures into texture arrays by the image sizes stbi_info() reads from the headers;
+	// images that cannot be read are left as textures of their own, loading reports them
+	void packTextures(std::vector<SceneTextureRecord>& textures, std::vector<SceneTextureArrayRecord>& arrays)
+	{
+		TRACE_ZONE("pack textures");
+		std::vector<TexturePackImage> images(textures.size());
+		for (size_t i = 0; i < textures.size(); i++)
+		{
+			TexturePackImage& image = images[i];
+			if (!stbi_info(textures[i].path, &image.width, &image.height, &image.channels))
+				image.width = image.height = image.channels = 0;
+		}
+		std::vector<TexturePackArray> packed;
+		std::vector<TexturePackPlacement> placements;
+		TexturePacker::pack(images, packed, placements);
+
+		for (size_t i = 0; i < textures.size(); i++)
+		{
+			const TexturePackPlacement& placement = placements[i];
+			SceneTextureRecord& record = textures[i];
+			record.array = placement.array >= 0 ? (uint32_t)placement.array : SCENE_NO_TEXTURE_ARRAY;
+			record.layer = placement.layer;
+			record.x = placement.x;
+			record.y = placement.y;
+			record.width = placement.width;
+			record.height = placement.height;
+		}
+		arrays.resize(packed.size());
+		for (size_t i = 0; i < packed.size(); i++)
+		{
+			SceneTextureArrayRecord& record = arrays[i];
+			record.width = packed[i].width;
+			record.height = packed[i].height;
+			record.channels = packed[i].channels;
+			record.layers = packed[i].layers;
+			record.levels = packed[i].levels;
+			record.gutter = packed[i].gutter;
+		}
+	}
+
+	// objects of materials with the same binding can be one draw: the same texture, or the same texture array
+	uint32_t textureBinding(const SceneTextureRecord* textures, uint32_t arrayCount, uint32_t texture)
+	{
+		return textures[texture].array != SCENE_NO_TEXTURE_ARRAY ? textures[texture].array : arrayCount + texture;
+	}
+
+	void printSceneError(const char* path, int line, const std::string& message)
+	{
+		std::cout << "ERROR::SCENE::" << path << "(" << line << "): " << message << std::endl;
+	}
+
+} // namespace
+
+// ---------------------------------------------------------------------------
+// SceneData
+// ---------------------------------------------------------------------------
+
+bool SceneData::load(const char* path)
+{
+	TRACE_ZONE("read scene");
+	FILE* file = fopen(path, "rb");
+	if (file == NULL)
+	{
+		std::cout << "ERROR::SCENE::FILE_NOT_SUCCESFULLY_READ: " << path << std::endl;
+		return false;
+	}
+	uint32_t magic = 0;
+	size_t read = fread(&magic, 1, sizeof(magic), file);
+	fclose(file);
+
+	if (read == sizeof(magic) && magic == SCENE_BINARY_MAGIC)
+		return loadBinary(path);
+	return loadText(path);
+}
+
+bool SceneData::loadText(const char* path)
+{
+	std::ifstream file(path);
+	if (!file.is_open())
+	{
+		std::cout << "ERROR::SCENE::FILE_NOT_SUCCESFULLY_READ: " << path << std::endl;
+		return false;
+	}
+
+	std::vector<SceneTextureRecord> textures;
+	std::vector<SceneMeshRecord> meshes;
+	std::vector<SceneMaterialRecord> materials;
+	std::vector<SceneObjectRecord> objects;
+	std::map<std::string, uint32_t> textureNames, meshNames, materialNames;
+	glm::mat4 model(1.0f);
+
+	std::string line;
+	int lineNumber = 0;
+	while (std::getline(file, line))
+	{
+		lineNumber++;
+		size_t comment = line.find('#');
+		if (comment != std::string::npos)
+			line.erase(comment);
+
+		std::istringstream tokens(line);
+		std::string command;
+		if (!(tokens >> command))
+			continue;
+
+		if (command == "texture")
+		{
+			std::string name, texturePath;
+			if (!(tokens >> name >> texturePath) || texturePath.size() >= SCENE_PATH_LENGTH)
+			{
+				printSceneError(path, lineNumber, "expected: texture <name> <path shorter than 128 characters>");
+				return false;
+			}
+			// textures with the same path share one record
+			uint32_t index = (uint32_t)textures.size();
+			for (uint32_t i = 0; i < textures.size(); i++)
+			{
+				if (texturePath == textures[i].path)
+					index = i;
+			}
+			if (index == textures.size())
+			{
+				SceneTextureRecord record;
+				memset(&record, 0, sizeof(record));
+				strncpy(record.path, texturePath.c_str(), SCENE_PATH_LENGTH - 1);
+				textures.push_back(record);
+			}
+			textureNames[name] = index;
+		}
+		else if (command == "material")
+		{
+			std::string name, texture;
+			if (!(tokens >> name >> texture) || textureNames.find(texture) == textureNames.end())
+			{
+				printSceneError(path, lineNumber, "expected: material <name> <texture name>");
+				return false;
+			}
+			SceneMaterialRecord record;
+			record.texture = textureNames[texture];
+			record.features = 0;
+			materialNames[name] = (uint32_t)materials.size();
+			materials.push_back(record);
+		}
+		else if (command == "mesh")
+		{
+			std::string name, type;
+			SceneMeshRecord record;
+			memset(&record, 0, sizeof(record));
+			bool ok = (bool)(tokens >> name >> type);
+			if (ok && type == "plane")
+			{
+				record.type = SCENE_MESH_PLANE;
+				ok = (bool)(tokens >> record.params[0] >> record.params[1]);
+			}
+			else if (ok && type == "box")
+			{
+				record.type = SCENE_MESH_BOX;
+				ok = (bool)(tokens >> record.params[0] >> record.params[1] >> record.params[2]);
+			}
+			else if (ok && (type == "sphere" || type == "halfsphere"))
+			{
+				record.type = type == "sphere" ? SCENE_MESH_SPHERE : SCENE_MESH_HALF_SPHERE;
+				ok = (bool)(tokens >> record.params[0] >> record.detail[0] >> record.detail[1]);
+			}
+			else if (ok && type == "cylinder")
+			{
+				record.type = SCENE_MESH_CYLINDER;
+				ok = (bool)(tokens >> record.params[0] >> record.detail[0] >> record.params[1]);
+			}
+			else
+			{
+				ok = false;
+			}
+			if (!ok)
+			{
+				printSceneError(path, lineNumber, "expected: mesh <name> plane|box|sphere|halfsphere|cylinder <parameters>");
+				return false;
+			}
+			// identical generator parameters share one mesh
+			uint32_t index = (uint32_t)meshes.size();
+			for (uint32_t i = 0; i < meshes.size(); i++)
+			{
+				if (sameMesh(meshes[i], record))
+					index = i;
+			}
+			if (index == meshes.size())
+				meshes.push_back(record);
+			meshNames[name] = index;
+		}
+		else if (command == "object")
+		{
+			std::string mesh, material;
+			if (!(tokens >> mesh >> material) || meshNames.find(mesh) == meshNames.end() || materialNames.find(material) == materialNames.end())
+			{
+				printSceneError(path, lineNumber, "expected: object <mesh name> <material name>");
+				return false;
+			}
+			SceneObjectRecord record;
+			record.mesh = meshNames[mesh];
+			record.material = materialNames[material];
+			record.flags = 0;
+			objects.push_back(record);
+			model = glm::mat4(1.0f);
+			memcpy(objects.back().model, &model[0][0], sizeof(record.model));
+		}
+		else if (command == "occluder")
+		{
+			if (objects.empty())
+			{
+				printSceneError(path, lineNumber, "expected: occluder after an object");
+				return false;
+			}
+			objects.back().flags |= SCENE_OBJECT_OCCLUDER;
+		}
+		else if (command == "translate" || command == "rotate" || command == "scale")
+		{
+			// transforms are applied to the last object in the order they are written,
+			// the same way chained glm::translate / glm::rotate calls compose
+			float angle = 0.0f;
+			glm::vec3 v;
+			if (objects.empty() || (command == "rotate" && !(tokens >> angle)) || !(tokens >> v.x >> v.y >> v.z))
+			{
+				printSceneError(path, lineNumber, "expected: translate|scale <x> <y> <z> or rotate <degrees> <x> <y> <z> after an object");
+				return false;
+			}
+			if (command == "translate")
+				model = glm::translate(model, v);
+			else if (command == "rotate")
+				model = glm::rotate(model, glm::radians(angle), v);
+			else
+				model = glm::scale(model, v);
+			memcpy(objects.back().model, &model[0][0], sizeof(objects.back().model));
+		}
+		else
+		{
+			printSceneError(path, lineNumber, "unknown command '" + command + "'");
+			return false;
+		}
+	}
+
+	// materials whose texture went into an array sample it through the array permutation
+	std::vector<SceneTextureArrayRecord> textureArrays;
+	packTextures(textures, textureArrays);
+	for (size_t i = 0; i < materials.size(); i++)
+	{
+		if (textures[materials[i].texture].array != SCENE_NO_TEXTURE_ARRAY)
+			materials[i].features |= CAMERA_FEATURE_TEXTURE_ARRAY;
+	}
+
+	// group objects by shader features, texture binding, then mesh and material, so draws
+	// that can be merged are adjacent
+	uint32_t arrayCount = (uint32_t)textureArrays.size();
+	std::stable_sort(objects.begin(), objects.end(), [&](const SceneObjectRecord& a, const SceneObjectRecord& b) {
+		const SceneMaterialRecord& materialA = materials[a.material];
+		const SceneMaterialRecord& materialB = materials[b.material];
+		if (materialA.features != materialB.features)
+			return materialA.features < materialB.features;
+		uint32_t bindingA = textureBinding(textures.data(), arrayCount, materialA.texture);
+		uint32_t bindingB = textureBinding(textures.data(), arrayCount, materialB.texture);
+		if (bindingA != bindingB)
+			return bindingA < bindingB;
+		return a.mesh != b.mesh ? a.mesh < b.mesh : a.material < b.material;
+	});
+
+	// lay the records out in one block
+	SceneFileHeader header;
+	header.magic = SCENE_BINARY_MAGIC;
+	header.version = SCENE_BINARY_VERSION;
+	uint32_t offset = sizeof(SceneFileHeader);
+	header.textureCount = (uint32_t)textures.size();
+	header.textureOffset = offset;
+	offset += header.textureCount * sizeof(SceneTextureRecord);
+	header.textureArrayCount = arrayCount;
+	header.textureArrayOffset = offset;
+	offset += header.textureArrayCount * sizeof(SceneTextureArrayRecord);
+	header.meshCount = (uint32_t)meshes.size();
+	header.meshOffset = offset;
+	offset += header.meshCount * sizeof(SceneMeshRecord);
+	header.materialCount = (uint32_t)materials.size();
+	header.materialOffset = offset;
+	offset += header.materialCount * sizeof(SceneMaterialRecord);
+	header.objectCount = (uint32_t)objects.size();
+	header.objectOffset = offset;
+	offset += header.objectCount * sizeof(SceneObjectRecord);
+	header.totalSize = offset;
+
+	_block.assign(offset / sizeof(uint32_t), 0);
+	unsigned char* bytes = reinterpret_cast<unsigned char*>(_block.data());
+	memcpy(bytes, &header, sizeof(header));
+	if (!textures.empty())
+		memcpy(bytes + header.textureOffset, textures.data(), textures.size() * sizeof(SceneTextureRecord));
+	if (!textureArrays.empty())
+		memcpy(bytes + header.textureArrayOffset, textureArrays.data(), textureArrays.size() * sizeof(SceneTextureArrayRecord));
+	if (!meshes.empty())
+		memcpy(bytes + header.meshOffset, meshes.data(), meshes.size() * sizeof(SceneMeshRecord));
+	if (!materials.empty())
+		memcpy(bytes + header.materialOffset, materials.data(), materials.size() * sizeof(SceneMaterialRecord));
+	if (!objects.empty())
+		memcpy(bytes + header.objectOffset, objects.data(), objects.size() * sizeof(SceneObjectRecord));
+	return true;
+}
+
+bool SceneData::loadBinary(const char* path)
+{
+	FILE* file = fopen(path, "rb");
+	if (file == NULL)
+	{
+		std::cout << "ERROR::SCENE::FILE_NOT_SUCCESFULLY_READ: " << path << std::endl;
+		return false;
+	}
+	fseek(file, 0, SEEK_END);
+	long size = ftell(file);
+	fseek(file, 0, SEEK_SET);
+	if (size < (long)sizeof(SceneFileHeader) || size % sizeof(uint32_t) != 0)
+	{
+		fclose(file);
+		std::cout << "ERROR::SCENE::NOT_A_SCENE_FILE: " << path << std::endl;
+		return false;
+	}
+
+	// the one and only read, the records are used straight out of this block
+	_block.resize(size / sizeof(uint32_t));
+	size_t read = fread(_block.data(), 1, size, file);
+	fclose(file);
+	if (read != (size_t)size || !validate(path))
+	{
+		_block.clear();
+		return false;
+	}
+	return true;
+}
+
+bool SceneData::saveBinary(const char* path) const
+{
+	if (!isLoaded())
+		return false;
+	FILE* file = fopen(path, "wb");
+	if (file == NULL)
+	{
+		std::cout << "ERROR::SCENE::FILE_NOT_SUCCESFULLY_WRITTEN: " << path << std::endl;
+		return false;
+	}
+	size_t written = fwrite(_block.data(), 1, header().totalSize, file);
+	fclose(file);
+	return written == header().totalSize;
+}
+
+bool SceneData::validate(const char* path) const
+{
+	const uint32_t size = (uint32_t)(_block.size() * sizeof(uint32_t));
+	const SceneFileHeader& h = header();
+	bool ok = h.magic == SCENE_BINARY_MAGIC && h.version == SCENE_BINARY_VERSION && h.totalSize == size;
+
+	// every array has to lie inside the block (64 bit math, counts come from the file)
+	ok = ok && (uint64_t)h.textureOffset + (uint64_t)h.textureCount * sizeof(SceneTextureRecord) <= size;
+	ok = ok && (uint64_t)h.textureArrayOffset + (uint64_t)h.textureArrayCount * sizeof(SceneTextureArrayRecord) <= size;
+	ok = ok && (uint64_t)h.meshOffset + (uint64_t)h.meshCount * sizeof(SceneMeshRecord) <= size;
+	ok = ok && (uint64_t)h.materialOffset + (uint64_t)h.materialCount * sizeof(SceneMaterialRecord) <= size;
+	ok = ok && (uint64_t)h.objectOffset + (uint64_t)h.objectCount * sizeof(SceneObjectRecord) <= size;
+	ok = ok && h.textureOffset % 4 == 0 && h.textureArrayOffset % 4 == 0 && h.meshOffset % 4 == 0 && h.materialOffset % 4 == 0 && h.objectOffset % 4 == 0;
+
+	for (uint32_t i = 0; ok && i < h.textureArrayCount; i++)
+	{
+		const SceneTextureArrayRecord& array = textureArrays()[i];
+		ok = array.width > 0 && array.height > 0 && array.channels >= 1 && array.channels <= 4 && array.layers > 0 && array.levels > 0;
+	}
+	for (uint32_t i = 0; ok && i < h.textureCount; i++)
+	{
+		const SceneTextureRecord& texture = textures()[i];
+		ok = memchr(texture.path, 0, SCENE_PATH_LENGTH) != NULL;
+		if (ok && texture.array != SCENE_NO_TEXTURE_ARRAY)
+		{
+			// the image has to lie inside its layer (64 bit math again)
+			const SceneTextureArrayRecord* array = texture.array < h.textureArrayCount ? &textureArrays()[texture.array] : NULL;
+			ok = array != NULL && texture.layer < array->layers
+				&& (uint64_t)texture.x + texture.width <= array->width && (uint64_t)texture.y + texture.height <= array->height;
+		}
+	}
+	for (uint32_t i = 0; ok && i < h.meshCount; i++)
+		ok = meshes()[i].type <= SCENE_MESH_CYLINDER;
+	for (uint32_t i = 0; ok && i < h.materialCount; i++)
+		ok = materials()[i].texture < h.textureCount;
+	for (uint32_t i = 0; ok && i < h.objectCount; i++)
+		ok = objects()[i].mesh < h.meshCount && objects()[i].material < h.materialCount;
+
+	if (!ok)
+		std::cout << "ERROR::SCENE::CORRUPT_SCENE_FILE: " << path << std::endl;
+	return ok;
+}
+
+bool SceneData::isLoaded() const
+{
+	return !_block.empty();
+}
+
+const SceneFileHeader& SceneData::header() const
+{
+	return *reinterpret_cast<const SceneFileHeader*>(_block.data());
+}
+
+template <typename T>
+const T* SceneData::records(uint32_t offset) const
+{
+	return reinterpret_cast<const T*>(reinterpret_cast<const unsigned char*>(_block.data()) + offset);
+}
+
+const SceneTextureRecord* SceneData::textures() const
+{
+	return records<SceneTextureRecord>(header().textureOffset);
+}
+
+const SceneTextureArrayRecord* SceneData::textureArrays() const
+{
+	return records<SceneTextureArrayRecord>(header().textureArrayOffset);
+}
+
+const SceneMeshRecord* SceneData::meshes() const
+{
+	return records<SceneMeshRecord>(header().meshOffset);
+}
+
+const SceneMaterialRecord* SceneData::materials() const
+{
+	return records<SceneMaterialRecord>(header().materialOffset);
+}
+
+const SceneObjectRecord* SceneData::objects() const
+{
+	return records<SceneObjectRecord>(header().objectOffset);
+}
+
+// ---------------------------------------------------------------------------
+// Scene
+// ---------------------------------------------------------------------------
+
+Scene::Scene()
+{
+}
+
+Scene::~Scene()
+{
+	release();
+}
+
+bool Scene::load(const char* path, TextureManager& textures)
+{
+	release();
+	if (!_data.load(path))
+		return false;
+
+	TRACE_ZONE("create scene");
+	const SceneFileHeader& header = _data.header();
+	loadTextures(textures);
+
+	_meshes.resize(header.meshCount);
+	for (uint32_t i = 0; i < header.meshCount; i++)
+		createMesh(_data.meshes()[i], _meshes[i]);
+
+	// the scene is static, world bounds are computed once
+	_boxes.resize(header.objectCount);
+	for (uint32_t i = 0; i < header.objectCount; i++)
+	{
+		const MeshResource& mesh = _meshes[_data.objects()[i].mesh];
+		glm::mat4 model = getModelMatrix(i);
+		_culler.add(transformBoundingSphere(mesh.bounds, model));
+		_boxes[i] = transformAABB(mesh.box, model);
+		if (_data.objects()[i].flags & SCENE_OBJECT_OCCLUDER)
+			_occluders.push_back(i);
+	}
+	_previousVisible.assign(header.objectCount, 1);
+	_bvh.build(_boxes);
+
+	// objects are stored ordered by texture binding and mesh, runs that can share a draw become
+	// one instanced draw: the same material, or materials with the same features in one texture array
+	const SceneObjectRecord* objects = _data.objects();
+	const SceneMaterialRecord* materials = _data.materials();
+	for (uint32_t i = 0; i < header.objectCount; )
+	{
+		DrawGroup group;
+		group.firstObject = i;
+		group.mesh = objects[i].mesh;
+		group.material = objects[i].material;
+		group.objectCount = 0;
+		const SceneMaterialRecord& material = materials[group.material];
+		uint32_t array = _data.textures()[material.texture].array;
+		while (i < header.objectCount && objects[i].mesh == group.mesh)
+		{
+			const SceneMaterialRecord& other = materials[objects[i].material];
+			bool shared = objects[i].material == group.material
+				|| (array != SCENE_NO_TEXTURE_ARRAY && _data.textures()[other.texture].array == array && other.features == material.features);
+			if (!shared)
+				break;
+			std::string stem = fileStem(_data.textures()[other.texture].path);
+			if (group.objectCount == 0)
+				group.name = stem;
+			else if (("+" + group.name + "+").find("+" + stem + "+") == std::string::npos)
+				group.name += "+" + stem;
+			group.objectCount++;
+			i++;
+		}
+		group.instances = nullptr;
+		if (group.objectCount > 1)
+		{
+			// the scene is static, so the instance buffer is filled once here
+			group.instances = new InstanceBatch();
+			for (uint32_t j = 0; j < group.objectCount; j++)
+				addInstance(*group.instances, group.firstObject + j, getModelMatrix(group.firstObject + j));
+			group.instances->upload();
+			group.instances->createVertexArray(_meshes[group.mesh].vao);
+		}
+		_groups.push_back(group);
+	}
+	return true;
+}
+
+void Scene::release()
+{
+	for (size_t i = 0; i < _groups.size(); i++)
+		delete _groups[i].instances;
+	_groups.clear();
+	for (size_t i = 0; i < _meshes.size(); i++)
+		destroyMesh(_meshes[i]);
+	_meshes.clear();
+	_textures.clear();
+	_textureArrays.clear();
+	_textureRects.clear();
+	_culler.clear();
+	_previousVisible.clear();
+	_bvh.build(std::vector<AABB>());
+	_boxes.clear();
+	_occluders.clear();
+}
+
+void Scene::cull(RenderPacket& packet)
+{
+	std::vector<uint8_t>& visible = packet.visible;
+	glm::mat4 viewProjection = packet.projection * packet.view;
+	{
+		TRACE_ZONE("frustum cull");
+		_culler.cull(Frustum::fromMatrix(viewProjection), visible);
+	}
+
+	// occluders in view go into the software depth buffer, everything else in view is tested against it
+	{
+		TRACE_ZONE("occlusion cull");
+		_occlusion.beginFrame(viewProjection);
+		for (size_t i = 0; i < _occluders.size(); i++)
+		{
+			uint32_t object = _occluders[i];
+			const MeshResource& mesh = _meshes[_data.objects()[object].mesh];
+			if (visible[object] && !mesh.occluder.empty())
+				_occlusion.addOccluder(mesh.occluder.data(), mesh.occluder.size(), getModelMatrix(object));
+		}
+		_occlusion.rasterize();
+		for (size_t i = 0; i < visible.size(); i++)
+		{
+			if (visible[i] && !(_data.objects()[i].flags & SCENE_OBJECT_OCCLUDER) && !_occlusion.isVisible(_boxes[i]))
+				visible[i] = 0;
+		}
+	}
+
+	// one packet draw per group with anything visible, holding the transforms of its visible objects
+	packet.draws.clear();
+	packet.transforms.clear();
+	for (size_t g = 0; g < _groups.size(); g++)
+	{
+		const DrawGroup& group = _groups[g];
+		RenderPacketDraw draw;
+		draw.group = (uint32_t)g;
+		draw.firstTransform = (uint32_t)packet.transforms.size();
+		draw.viewDepth = packet.farPlane;
+		for (uint32_t j = 0; j < group.objectCount; j++)
+		{
+			if (!visible[group.firstObject + j])
+				continue;
+			glm::mat4 model = getModelMatrix(group.firstObject + j);
+			draw.viewDepth = std::min(draw.viewDepth, -(packet.view * model[3]).z);
+			packet.transforms.push_back(model);
+		}
+		draw.transformCount = (uint32_t)packet.transforms.size() - draw.firstTransform;
+		if (draw.transformCount > 0)
+			packet.draws.push_back(draw);
+	}
+	packet.cullStats = _culler.getStats();
+	packet.occlusionStats = _occlusion.getStats();
+}
+
+void Scene::submit(RenderQueue& queue, ShaderPermutationCache& shaders, const RenderPacket& packet)
+{
+	for (size_t d = 0; d < packet.draws.size(); d++)
+	{
+		const RenderPacketDraw& draw = packet.draws[d];
+		const DrawGroup& group = _groups[draw.group];
+		const SceneMaterialRecord& material = _data.materials()[group.material];
+		const SceneTextureRecord& textureRecord = _data.textures()[material.texture];
+		MeshResource& mesh = _meshes[group.mesh];
+		bool inArray = textureRecord.array != SCENE_NO_TEXTURE_ARRAY;
+		GLuint texture = inArray ? _textureArrays[textureRecord.array].id() : _textures[material.texture].id();
+		GLenum textureTarget = inArray ? GL_TEXTURE_2D_ARRAY : GL_TEXTURE_2D;
+		const glm::mat4* transforms = &packet.transforms[draw.firstTransform];
+
+		if (group.instances == nullptr)
+		{
+			Shader& shader = shaders.get(material.features);
+			RenderCommand command = { &shader, texture, textureTarget, mesh.draw, mesh.object, transforms[0], nullptr, 0, 0, group.name.c_str(),
+				_textureRects[material.texture], (float)textureRecord.layer };
+			queue.submit(RenderQueue::makeKey(RENDER_PASS_OPAQUE, shader.ID, texture, group.mesh, draw.viewDepth,
+				packet.nearPlane, packet.farPlane), command);
+			continue;
+		}
+
+		// the instance buffer only holds visible instances, refilled when the set changes
+		// (objects are static, so the same set means the same transforms)
+		const uint8_t* visible = &packet.visible[group.firstObject];
+		if (memcmp(visible, &_previousVisible[group.firstObject], group.objectCount) != 0)
+		{
+			group.instances->clear();
+			for (uint32_t j = 0, transform = 0; j < group.objectCount; j++)
+			{
+				if (visible[j])
+					addInstance(*group.instances, group.firstObject + j, transforms[transform++]);
+			}
+			group.instances->upload();
+			memcpy(&_previousVisible[group.firstObject], visible, group.objectCount);
+		}
+
+		// one instanced draw, sorted by its nearest instance
+		Shader& shader = shaders.get(material.features | CAMERA_FEATURE_INSTANCED);
+		RenderCommand command = { &shader, texture, textureTarget, nullptr, mesh.object, glm::mat4(1.0f), mesh.drawInstanced, group.instances->size(),
+			group.instances->getVertexArray(), group.name.c_str(), glm::vec4(0.0f, 0.0f, 1.0f, 1.0f), 0.0f };
+		queue.submit(RenderQueue::makeKey(RENDER_PASS_OPAQUE, shader.ID, texture, group.mesh, draw.viewDepth,
+			packet.nearPlane, packet.farPlane), command);
+	}
+}
+
+const FrustumCuller::CullStats& Scene::getCullStats() const
+{
+	return _culler.getStats();
+}
+
+const OcclusionCuller::CullStats& Scene::getOcclusionStats() const
+{
+	return _occlusion.getStats();
+}
+
+const SceneData& Scene::data() const
+{
+	return _data;
+}
+
+const BVH& Scene::getBVH() const
+{
+	return _bvh;
+}
+
+glm::mat4 Scene::getModelMatrix(uint32_t object) const
+{
+	glm::mat4 model;
+	memcpy(&model[0][0], _data.objects()[object].model, sizeof(float) * 16);
+	return model;
+}
+
+void Scene::loadTextures(TextureManager& textures)
+{
+	const SceneFileHeader& header = _data.header();
+	const SceneTextureRecord* records = _data.textures();
+
+	// textures of their own stream in as one batch while the scene is already shown, update() uploads them
+	std::vector<std::string> paths;
+	std::vector<uint32_t> pathRecords;
+	for (uint32_t i = 0; i < header.textureCount; i++)
+	{
+		if (records[i].array == SCENE_NO_TEXTURE_ARRAY)
+		{
+			paths.push_back(records[i].path);
+			pathRecords.push_back(i);
+		}
+	}
+	std::vector<TextureHandle> loaded;
+	textures.loadAsync(paths, loaded);
+	_textures.assign(header.textureCount, TextureHandle());
+	for (size_t i = 0; i < loaded.size(); i++)
+		_textures[pathRecords[i]] = loaded[i];
+
+	// the packed ones array by array, where they go was decided when the scene was compiled
+	_textureArrays.resize(header.textureArrayCount);
+	for (uint32_t a = 0; a < header.textureArrayCount; a++)
+	{
+		const SceneTextureArrayRecord& record = _data.textureArrays()[a];
+		TexturePackArray array = { (int)record.width, (int)record.height, (int)record.channels, (int)record.layers, (int)record.levels, (int)record.gutter };
+		std::vector<TexturePackPlacement> placements;
+		paths.clear();
+		for (uint32_t i = 0; i < header.textureCount; i++)
+		{
+			if (records[i].array != a)
+				continue;
+			TexturePackPlacement placement = { (int)a, (int)records[i].layer, (int)records[i].x, (int)records[i].y, (int)records[i].width, (int)records[i].height };
+			placements.push_back(placement);
+			paths.push_back(records[i].path);
+		}
+		_textureArrays[a] = textures.loadArray(array, paths, placements);
+	}
+
+	_textureRects.assign(header.textureCount, glm::vec4(0.0f, 0.0f, 1.0f, 1.0f));
+	for (uint32_t i = 0; i < header.textureCount; i++)
+	{
+		if (records[i].array == SCENE_NO_TEXTURE_ARRAY)
+			continue;
+		const SceneTextureArrayRecord& array = _data.textureArrays()[records[i].array];
+		float width = (float)array.width;
+		float height = (float)array.height;
+		_textureRects[i] = glm::vec4(records[i].x / width, records[i].y / height, records[i].width / width, records[i].height / height);
+	}
+}
+
+void Scene::addInstance(InstanceBatch& instances, uint32_t object, const glm::mat4& model) const
+{
+	uint32_t texture = _data.materials()[_data.objects()[object].material].texture;
+	instances.add(model, glm::vec4(1.0f), _textureRects[texture], (float)_data.textures()[texture].layer);
+}
+
+bool Scene::createMesh(const SceneMeshRecord& record, MeshResource& mesh)
+{
+	TRACE_ZONE("create mesh");
+	mesh.type = record.type;
+	mesh.vbo = 0;
+	buildOccluder(record, mesh.occluder);
+	switch (record.type)
+	{
+	case SCENE_MESH_PLANE:
+	case SCENE_MESH_BOX:
+	{
+		VertexArrayMesh* vertexArray = record.type == SCENE_MESH_PLANE
+			? createPlane(record.params[0], record.params[1], mesh.vbo)
+			: createBox(glm::vec3(record.params[0], record.params[1], record.params[2]), mesh.vbo);
+		mesh.object = vertexArray;
+		mesh.draw = drawIndexedMesh<VertexArrayMesh>;
+		mesh.drawInstanced = drawIndexedMeshInstanced<VertexArrayMesh>;
+		mesh.vao = vertexArray->vao;
+		if (record.type == SCENE_MESH_PLANE)
+		{
+			mesh.box.min = glm::vec3(-record.params[0], record.params[1], -record.params[0]);
+			mesh.box.max = glm::vec3(record.params[0], record.params[1], record.params[0]);
+		}
+		else
+		{
+			mesh.box.max = glm::vec3(record.params[0], record.params[1], record.params[2]);
+			mesh.box.min = -mesh.box.max;
+		}
+		mesh.bounds.center = (mesh.box.min + mesh.box.max) * 0.5f;
+		mesh.bounds.radius = glm::length(mesh.box.max - mesh.bounds.center);
+		return true;
+	}
+	case SCENE_MESH_SPHERE:
+	{
+		Sphere* sphere = new Sphere(record.params[0], record.detail[0], record.detail[1]);
+		mesh.object = sphere;
+		mesh.draw = drawIndexedMesh<Sphere>;
+		mesh.drawInstanced = drawIndexedMeshInstanced<Sphere>;
+		mesh.vao = sphere->getVAO();
+		mesh.bounds = sphere->getBoundingSphere();
+		mesh.box = sphere->getBounds();
+		return true;
+	}
+	case SCENE_MESH_HALF_SPHERE:
+	{
+		HalfSphere* halfSphere = new HalfSphere(record.params[0], record.detail[0], record.detail[1]);
+		mesh.object = halfSphere;
+		mesh.draw = drawIndexedMesh<HalfSphere>;
+		mesh.drawInstanced = drawIndexedMeshInstanced<HalfSphere>;
+		mesh.vao = halfSphere->getVAO();
+		mesh.bounds = halfSphere->getBoundingSphere();
+		mesh.box = halfSphere->getBounds();
+		return true;
+	}
+	case SCENE_MESH_CYLINDER:
+	{
+		static_meshes_3D::Cylinder* cylinder = new static_meshes_3D::Cylinder(record.params[0], record.detail[0], record.params[1], true, true, true);
+		mesh.object = cylinder;
+		mesh.draw = drawStaticMesh;
+		mesh.drawInstanced = drawStaticMeshInstanced;
+		mesh.vao = cylinder->getVAO();
+		mesh.bounds = cylinder->getBoundingSphere();
+		mesh.box = cylinder->getBounds();
+		return true;
+	}
+	default:
+		mesh.object = nullptr;
+		return false;
+	}
+}
+
+void Scene::destroyMesh(MeshResource& mesh)
+{
+	switch (mesh.type)
+	{
+	case SCENE_MESH_PLANE:
+	case SCENE_MESH_BOX:
+		GLStateCache::get().deleteVertexArray(mesh.vao);
+		GLStateCache::get().deleteBuffer(mesh.vbo);
+		delete static_cast<VertexArrayMesh*>(mesh.object);
+		break;
+	case SCENE_MESH_SPHERE:
+		delete static_cast<Sphere*>(mesh.object);
+		break;
+	case SCENE_MESH_HALF_SPHERE:
+		delete static_cast<HalfSphere*>(mesh.object);
+		break;
+	case SCENE_MESH_CYLINDER:
+		delete static_cast<static_meshes_3D::Cylinder*>(mesh.object);
+		break;
+	}
+	mesh.object = nullptr;
+}
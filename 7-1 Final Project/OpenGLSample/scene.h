@@ -0,0 +1,241 @@
+#pragma once
+
+// STL
+#include <vector>
+#include <string>
+#include <cstdint>
+
+// GLM
+#include <glm/glm.hpp>
+
+// Project
+#include "shaderPermutations.h"
+#include "renderQueue.h"
+#include "instanceBatch.h"
+#include "frustumCuller.h"
+#include "bvh.h"
+#include "occlusionCuller.h"
+#include "renderPacket.h"
+#include "textureManager.h"
+
+/**
+* Feature bits of the camera shader permutations, bit i enables define i of the
+* permutation cache ("DETAIL_TEXTURE", "INSTANCED", "TEXTURE_ARRAY"). Materials store these bits.
+*/
+enum CameraShaderFeature
+{
+	CAMERA_FEATURE_DETAIL_TEXTURE = 1 << 0, // mixes a second texture (texture2) over the base texture
+	CAMERA_FEATURE_INSTANCED = 1 << 1, // model matrix and tint come from per-instance attributes
+	CAMERA_FEATURE_TEXTURE_ARRAY = 1 << 2 // the base texture is a layer, or part of one, of a texture array
+};
+
+/**
+* Mesh generators a scene can reference.
+*/
+enum SceneMeshType
+{
+	SCENE_MESH_PLANE = 0, // params: half size, height
+	SCENE_MESH_BOX = 1, // params: half extents x, y, z
+	SCENE_MESH_SPHERE = 2, // params: radius; detail: sectors, stacks
+	SCENE_MESH_HALF_SPHERE = 3, // params: radius; detail: sectors, stacks
+	SCENE_MESH_CYLINDER = 4 // params: radius, height; detail: slices
+};
+
+// Binary scene layout. The whole file is one contiguous block: a header followed by
+// arrays of fixed size records, referenced by byte offsets from the start of the file.
+// Loading is a single read into memory plus a header check, nothing is parsed.
+// All records are 4-byte aligned plain data, so the arrays are used in place.
+
+const uint32_t SCENE_BINARY_MAGIC = 0x424E4353; // "SCNB"
+const uint32_t SCENE_BINARY_VERSION = 3;
+const int SCENE_PATH_LENGTH = 128;
+
+struct SceneFileHeader
+{
+	uint32_t magic;
+	uint32_t version;
+	uint32_t totalSize; // in bytes, including the header
+	uint32_t textureCount, textureOffset;
+	uint32_t textureArrayCount, textureArrayOffset;
+	uint32_t meshCount, meshOffset;
+	uint32_t materialCount, materialOffset;
+	uint32_t objectCount, objectOffset;
+};
+
+// texture records that are not part of a texture array
+const uint32_t SCENE_NO_TEXTURE_ARRAY = 0xFFFFFFFF;
+
+struct SceneTextureRecord
+{
+	char path[SCENE_PATH_LENGTH];
+	uint32_t array; // index into the texture array records, SCENE_NO_TEXTURE_ARRAY for a texture of its own
+	uint32_t layer;
+	uint32_t x, y, width, height; // the image in its layer, in pixels from the lower left corner
+};
+
+// a texture array the textures were packed into when the scene was compiled (see TexturePacker)
+struct SceneTextureArrayRecord
+{
+	uint32_t width, height, channels;
+	uint32_t layers;
+	uint32_t levels;
+	uint32_t gutter; // atlas layers only
+};
+
+struct SceneMeshRecord
+{
+	uint32_t type; // SceneMeshType
+	float params[3];
+	int32_t detail[2];
+};
+
+struct SceneMaterialRecord
+{
+	uint32_t texture; // index into the texture records
+	uint32_t features; // CameraShaderFeature bits
+};
+
+// object flags
+const uint32_t SCENE_OBJECT_OCCLUDER = 1 << 0; // rasterized into the software occlusion buffer
+
+struct SceneObjectRecord
+{
+	float model[16]; // column major model matrix
+	uint32_t mesh;
+	uint32_t material;
+	uint32_t flags; // SCENE_OBJECT_ bits
+};
+
+/**
+* Scene description in its binary form. Text scenes are compiled into the same block
+* on load, so the rest of the engine only ever sees the binary layout.
+*/
+class SceneData
+{
+public:
+	/** \brief  Loads a text (.scene) or binary scene, chosen by the file contents.
+	*   \return True on success, errors are printed.
+	*/
+	bool load(const char* path);
+
+	/** \brief  Compiles a text scene. Textures and meshes are shared between all objects that use
+	*           the same path or parameters, textures are packed into texture arrays where they fit,
+	*           and objects are ordered by texture binding, mesh and material so draws that can be
+	*           merged end up next to each other.
+	*/
+	bool loadText(const char* path);
+
+	/** \brief  Loads a binary scene with a single read. */
+	bool loadBinary(const char* path);
+
+	/** \brief  Writes the binary form, e.g. to cook a text scene for faster loading. */
+	bool saveBinary(const char* path) const;
+
+	bool isLoaded() const;
+	const SceneFileHeader& header() const;
+	const SceneTextureRecord* textures() const;
+	const SceneTextureArrayRecord* textureArrays() const;
+	const SceneMeshRecord* meshes() const;
+	const SceneMaterialRecord* materials() const;
+	const SceneObjectRecord* objects() const;
+
+private:
+	std::vector<uint32_t> _block; // whole binary file, uint32_t keeps the records aligned
+
+	bool validate(const char* path) const;
+	template <typename T> const T* records(uint32_t offset) const;
+};
+
+/**
+* GPU side of a scene: textures, meshes and draw groups created from SceneData.
+* Objects sharing a mesh and a texture binding are merged into one instanced draw; with
+* texture arrays that binding is shared by several materials, every instance then carries
+* the layer and rectangle of its own image.
+*/
+class Scene
+{
+public:
+	Scene();
+	~Scene();
+
+	/** \brief  Loads the scene description and creates all GL resources for it.
+	*   \param path          Text or binary scene file
+	*   \param textures      Loads the images. Textures of their own are streamed in (TextureManager::loadAsync),
+	*                        their objects draw untextured until TextureManager::update() uploaded them
+	*/
+	bool load(const char* path, TextureManager& textures);
+
+	/** \brief  Frees all GL resources. */
+	void release();
+
+	/** \brief  Frustum and occlusion culls the objects and collects the visible ones into a packet.
+	*           Touches no GL state, so it can run on a simulation thread while another packet is drawn.
+	*   \param packet  Camera fields must be set, draws, transforms, visibility and stats are filled in
+	*/
+	void cull(RenderPacket& packet);
+
+	/** \brief  Queues the draws of a packet made by cull(). Updates instance buffers, so GL thread only.
+	*   \param shaders  Camera shader permutations, materials pick their variant from it
+	*/
+	void submit(RenderQueue& queue, ShaderPermutationCache& shaders, const RenderPacket& packet);
+
+	/** \brief  Gets objects tested / culled and the time spent by the last cull(). */
+	const FrustumCuller::CullStats& getCullStats() const;
+
+	/** \brief  Gets occluder triangles, objects tested / occluded and the time spent by the last cull(). */
+	const OcclusionCuller::CullStats& getOcclusionStats() const;
+
+	const SceneData& data() const;
+
+	/** \brief  Gets the spatial index over the world space object boxes, for picking and overlap tests. */
+	const BVH& getBVH() const;
+
+	/** \brief  Gets model matrix of object i (in the order of the scene data). */
+	glm::mat4 getModelMatrix(uint32_t object) const;
+
+private:
+	// one generated mesh, accessed through the same adapters the render queue uses
+	struct MeshResource
+	{
+		void* object;
+		MeshDrawFunction draw;
+		MeshDrawInstancedFunction drawInstanced;
+		GLuint vao;
+		GLuint vbo; // only for meshes generated here (plane, box)
+		uint32_t type;
+		BoundingSphere bounds; // local space
+		AABB box; // local space
+		std::vector<glm::vec3> occluder; // low detail triangle list that lies inside the real surface
+	};
+	// consecutive objects with equal mesh and material, or materials in the same texture array
+	struct DrawGroup
+	{
+		uint32_t firstObject;
+		uint32_t objectCount;
+		uint32_t mesh;
+		uint32_t material; // of the first object, the features and binding are the same for all
+		InstanceBatch* instances; // only when objectCount > 1, holds the visible instances
+		std::string name; // GPU profiler scope, the stems of the textures ("egg" for images/egg.jpg, "egg+flour")
+	};
+
+	SceneData _data;
+	std::vector<TextureHandle> _textures; // per texture record, empty for the ones in arrays
+	std::vector<TextureHandle> _textureArrays; // per texture array record
+	std::vector<glm::vec4> _textureRects; // per texture record, offset and scale in its array layer
+	std::vector<MeshResource> _meshes;
+	std::vector<DrawGroup> _groups;
+	FrustumCuller _culler; // world space bounds, one per object
+	std::vector<uint8_t> _previousVisible; // render side, visibility the instance buffers were last filled with
+	BVH _bvh; // object i is object i of the scene data
+	std::vector<AABB> _boxes; // world space, per object
+	std::vector<uint32_t> _occluders; // objects flagged as occluders
+	OcclusionCuller _occlusion;
+
+	void loadTextures(TextureManager& textures);
+	bool createMesh(const SceneMeshRecord& record, MeshResource& mesh);
+	void addInstance(InstanceBatch& instances, uint32_t object, const glm::mat4& model) const;
+	void destroyMesh(MeshResource& mesh);
+
+	Scene(const Scene&);
+	Scene& operator=(const Scene&);
+};
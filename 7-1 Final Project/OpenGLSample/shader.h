@@ -1,313 +1,488 @@
-#ifndef SHADER_H
-#define SHADER_H
-
-#include <glad/glad.h>
-
-#include <glm/glm.hpp>
-
-#include <string>
-#include <fstream>
-#include <sstream>
-#include <iostream>
-
-class Shader
-{
-public:
-	unsigned int ID;
-	// constructor generates the shader on the fly
-	// ------------------------------------------------------------------------
-	Shader(const char* vertexPath, const char* fragmentPath, const char* geometryPath = nullptr)
-	{
-		// 1. retrieve the vertex/fragment source code from filePath
-		std::string vertexCode;
-		std::string fragmentCode;
-		std::string geometryCode;
-		std::ifstream vShaderFile;
-		std::ifstream fShaderFile;
-		std::ifstream gShaderFile;
-		// ensure ifstream objects can throw exceptions:
-		vShaderFile.exceptions(std::ifstream::failbit | std::ifstream::badbit);
-		fShaderFile.exceptions(std::ifstream::failbit | std::ifstream::badbit);
-		gShaderFile.exceptions(std::ifstream::failbit | std::ifstream::badbit);
-		try
-		{
-			// open files
-			vShaderFile.open(vertexPath);
-			fShaderFile.open(fragmentPath);
-			std::stringstream vShaderStream, fShaderStream;
-			// read file's buffer contents into streams
-			vShaderStream << vShaderFile.rdbuf();
-			fShaderStream << fShaderFile.rdbuf();
-			// close file handlers
-			vShaderFile.close();
-			fShaderFile.close();
-			// convert stream into string
-			vertexCode = vShaderStream.str();
-			fragmentCode = fShaderStream.str();
-			// if geometry shader path is present, also load a geometry shader
-			if (geometryPath != nullptr)
-			{
-				gShaderFile.open(geometryPath);
-				std::stringstream gShaderStream;
-				gShaderStream << gShaderFile.rdbuf();
-				gShaderFile.close();
-				geometryCode = gShaderStream.str();
-			}
-		}
-		catch (std::ifstream::failure& e)
-		{
-			std::cout << "ERROR::SHADER::FILE_NOT_SUCCESFULLY_READ" << std::endl;
-		}
-		const char* vShaderCode = vertexCode.c_str();
-		const char * fShaderCode = fragmentCode.c_str();
-		// 2. compile shaders
-		unsigned int vertex, fragment;
-		// vertex shader
-		vertex = glCreateShader(GL_VERTEX_SHADER);
-		glShaderSource(vertex, 1, &vShaderCode, NULL);
-		glCompileShader(vertex);
-		checkCompileErrors(vertex, "VERTEX");
-		// fragment Shader
-		fragment = glCreateShader(GL_FRAGMENT_SHADER);
-		glShaderSource(fragment, 1, &fShaderCode, NULL);
-		glCompileShader(fragment);
-		checkCompileErrors(fragment, "FRAGMENT");
-		// if geometry shader is given, compile geometry shader
-		unsigned int geometry;
-		if (geometryPath != nullptr)
-		{
-			const char * gShaderCode = geometryCode.c_str();
-			geometry = glCreateShader(GL_GEOMETRY_SHADER);
-			glShaderSource(geometry, 1, &gShaderCode, NULL);
-			glCompileShader(geometry);
-			checkCompileErrors(geometry, "GEOMETRY");
-		}
-		// shader Program
-		ID = glCreateProgram();
-		glAttachShader(ID, vertex);
-		glAttachShader(ID, fragment);
-		if (geometryPath != nullptr)
-			glAttachShader(ID, geometry);
-		glLinkProgram(ID);
-		checkCompileErrors(ID, "PROGRAM");
-		// delete the shaders as they're linked into our program now and no longer necessery
-		glDeleteShader(vertex);
-		glDeleteShader(fragment);
-		if (geometryPath != nullptr)
-			glDeleteShader(geometry);
-
-	}
-	// activate the shader
-	// ------------------------------------------------------------------------
-	void use()
-	{
-		glUseProgram(ID);
-	}
-	// utility uniform functions
-	// ------------------------------------------------------------------------
-	void setBool(const std::string &name, bool value) const
-	{
-		glUniform1i(glGetUniformLocation(ID, name.c_str()), (int)value);
-	}
-	// ------------------------------------------------------------------------
-	void setInt(const std::string &name, int value) const
-	{
-		glUniform1i(glGetUniformLocation(ID, name.c_str()), value);
-	}
-	// ------------------------------------------------------------------------
-	void setFloat(const std::string &name, float value) const
-	{
-		glUniform1f(glGetUniformLocation(ID, name.c_str()), value);
-	}
-	// ------------------------------------------------------------------------
-	void setVec2(const std::string &name, const glm::vec2 &value) const
-	{
-		glUniform2fv(glGetUniformLocation(ID, name.c_str()), 1, &value[0]);
-	}
-	void setVec2(const std::string &name, float x, float y) const
-	{
-		glUniform2f(glGetUniformLocation(ID, name.c_str()), x, y);
-	}
-	// ------------------------------------------------------------------------
-	void setVec3(const std::string &name, const glm::vec3 &value) const
-	{
-		glUniform3fv(glGetUniformLocation(ID, name.c_str()), 1, &value[0]);
-	}
-	void setVec3(const std::string &name, float x, float y, float z) const
-	{
-		glUniform3f(glGetUniformLocation(ID, name.c_str()), x, y, z);
-	}
-	// ------------------------------------------------------------------------
-	void setVec4(const std::string &name, const glm::vec4 &value) const
-	{
-		glUniform4fv(glGetUniformLocation(ID, name.c_str()), 1, &value[0]);
-	}
-	void setVec4(const std::string &name, float x, float y, float z, float w)
-	{
-		glUniform4f(glGetUniformLocation(ID, name.c_str()), x, y, z, w);
-	}
-	// ------------------------------------------------------------------------
-	void setMat2(const std::string &name, const glm::mat2 &mat) const
-	{
-		glUniformMatrix2fv(glGetUniformLocation(ID, name.c_str()), 1, GL_FALSE, &mat[0][0]);
-	}
-	// ------------------------------------------------------------------------
-	void setMat3(const std::string &name, const glm::mat3 &mat) const
-	{
-		glUniformMatrix3fv(glGetUniformLocation(ID, name.c_str()), 1, GL_FALSE, &mat[0][0]);
-	}
-	// ------------------------------------------------------------------------
-	void setMat4(const std::string &name, const glm::mat4 &mat) const
-	{
-		glUniformMatrix4fv(glGetUniformLocation(ID, name.c_str()), 1, GL_FALSE, &mat[0][0]);
-	}
-
-private:
-	// utility function for checking shader compilation/linking errors.
-	// ------------------------------------------------------------------------
-	void checkCompileErrors(GLuint shader, std::string type)
-	{
-		GLint success;
-		GLchar infoLog[1024];
-		if (type != "PROGRAM")
-		{
-			glGetShaderiv(shader, GL_COMPILE_STATUS, &success);
-			if (!success)
-			{
-				glGetShaderInfoLog(shader, 1024, NULL, infoLog);
-				std::cout << "ERROR::SHADER_COMPILATION_ERROR of type: " << type << "\n" << infoLog << "\n -- --------------------------------------------------- -- " << std::endl;
-			}
-		}
-		else
-		{
-			glGetProgramiv(shader, GL_LINK_STATUS, &success);
-			if (!success)
-			{
-				glGetProgramInfoLog(shader, 1024, NULL, infoLog);
-				std::cout << "ERROR::PROGRAM_LINKING_ERROR of type: " << type << "\n" << infoLog << "\n -- --------------------------------------------------- -- " << std::endl;
-			}
-		}
-	}
-};
-#endif
-//#ifndef SHADER_H
-//#define SHADER_H
-//
-//#include <glad/glad.h>
-//
-//#include <string>
-//#include <fstream>
-//#include <sstream>
-//#include <iostream>
-//
-//class Shader
-//{
-//public:
-//	unsigned int ID;
-//	// constructor generates the shader on the fly
-//	// ------------------------------------------------------------------------
-//	Shader(const char* vertexPath, const char* fragmentPath)
-//	{
-//		// 1. retrieve the vertex/fragment source code from filePath
-//		std::string vertexCode;
-//		std::string fragmentCode;
-//		std::ifstream vShaderFile;
-//		std::ifstream fShaderFile;
-//		// ensure ifstream objects can throw exceptions:
-//		vShaderFile.exceptions(std::ifstream::failbit | std::ifstream::badbit);
-//		fShaderFile.exceptions(std::ifstream::failbit | std::ifstream::badbit);
-//		try
-//		{
-//			// open files
-//			vShaderFile.open(vertexPath);
-//			fShaderFile.open(fragmentPath);
-//			std::stringstream vShaderStream, fShaderStream;
-//			// read file's buffer contents into streams
-//			vShaderStream << vShaderFile.rdbuf();
-//			fShaderStream << fShaderFile.rdbuf();
-//			// close file handlers
-//			vShaderFile.close();
-//			fShaderFile.close();
-//			// convert stream into string
-//			vertexCode = vShaderStream.str();
-//			fragmentCode = fShaderStream.str();
-//		}
-//		catch (std::ifstream::failure& e)
-//		{
-//			std::cout << "ERROR::SHADER::FILE_NOT_SUCCESFULLY_READ" << std::endl;
-//		}
-//		const char* vShaderCode = vertexCode.c_str();
-//		const char * fShaderCode = fragmentCode.c_str();
-//		// 2. compile shaders
-//		unsigned int vertex, fragment;
-//		// vertex shader
-//		vertex = glCreateShader(GL_VERTEX_SHADER);
-//		glShaderSource(vertex, 1, &vShaderCode, NULL);
-//		glCompileShader(vertex);
-//		checkCompileErrors(vertex, "VERTEX");
-//		// fragment Shader
-//		fragment = glCreateShader(GL_FRAGMENT_SHADER);
-//		glShaderSource(fragment, 1, &fShaderCode, NULL);
-//		glCompileShader(fragment);
-//		checkCompileErrors(fragment, "FRAGMENT");
-//		// shader Program
-//		ID = glCreateProgram();
-//		glAttachShader(ID, vertex);
-//		glAttachShader(ID, fragment);
-//		glLinkProgram(ID);
-//		checkCompileErrors(ID, "PROGRAM");
-//		// delete the shaders as they're linked into our program now and no longer necessary
-//		glDeleteShader(vertex);
-//		glDeleteShader(fragment);
-//	}
-//	// activate the shader
-//	// ------------------------------------------------------------------------
-//	void use()
-//	{
-//		glUseProgram(ID);
-//	}
-//	// utility uniform functions
-//	// ------------------------------------------------------------------------
-//	void setBool(const std::string &name, bool value) const
-//	{
-//		glUniform1i(glGetUniformLocation(ID, name.c_str()), (int)value);
-//	}
-//	// ------------------------------------------------------------------------
-//	void setInt(const std::string &name, int value) const
-//	{
-//		glUniform1i(glGetUniformLocation(ID, name.c_str()), value);
-//	}
-//	// ------------------------------------------------------------------------
-//	void setFloat(const std::string &name, float value) const
-//	{
-//		glUniform1f(glGetUniformLocation(ID, name.c_str()), value);
-//	}
-//
-//private:
-//	// utility function for checking shader compilation/linking errors.
-//	// ------------------------------------------------------------------------
-//	void checkCompileErrors(unsigned int shader, std::string type)
-//	{
-//		int success;
-//		char infoLog[1024];
-//		if (type != "PROGRAM")
-//		{
-//			glGetShaderiv(shader, GL_COMPILE_STATUS, &success);
-//			if (!success)
-//			{
-//				glGetShaderInfoLog(shader, 1024, NULL, infoLog);
-//				std::cout << "ERROR::SHADER_COMPILATION_ERROR of type: " << type << "\n" << infoLog << "\n -- --------------------------------------------------- -- " << std::endl;
-//			}
-//		}
-//		else
-//		{
-//			glGetProgramiv(shader, GL_LINK_STATUS, &success);
-//			if (!success)
-//			{
-//				glGetProgramInfoLog(shader, 1024, NULL, infoLog);
-//				std::cout << "ERROR::PROGRAM_LINKING_ERROR of type: " << type << "\n" << infoLog << "\n -- --------------------------------------------------- -- " << std::endl;
-//			}
-//		}
-//	}
-//};
+#ifndef SHADER_H
+#define SHADER_H
+
+#include <glad/glad.h>
+
+#include "glStateCache.h"
+#include "cpuTracer.h"
+
+#include <glm/glm.hpp>
+
+#include <string>
+#include <fstream>
+#include <sstream>
+#include <iostream>
+#include <vector>
+#include <unordered_map>
+#include <cstring>
+
+// resolves #include directives and injects #define lines ahead of compilation
+class ShaderPreprocessor
+{
+public:
+	// reads a shader file and recursively expands every #include "file" it contains.
+	// include paths are relative to the including file and each file is pasted only once.
+	// ------------------------------------------------------------------------
+	static bool load(const std::string &path, std::string &out)
+	{
+		std::vector<std::string> includeStack;
+		std::vector<std::string> included;
+		out.clear();
+		return expand(path, out, includeStack, included);
+	}
+	// inserts one "#define NAME" line per entry right after the #version line
+	// ------------------------------------------------------------------------
+	static std::string injectDefines(const std::string &source, const std::vector<std::string> &defines)
+	{
+		if (defines.empty())
+			return source;
+
+		std::string block;
+		for (unsigned int i = 0; i < defines.size(); i++)
+			block += "#define " + defines[i] + "\n";
+
+		// #version has to stay the first statement, so the defines go after it;
+		// #line keeps compiler error line numbers pointing at the original file
+		size_t versionPos = source.find("#version");
+		if (versionPos == std::string::npos)
+			return block + "#line 1\n" + source;
+		size_t lineEnd = source.find('\n', versionPos);
+		if (lineEnd == std::string::npos)
+			return source + "\n" + block;
+		return source.substr(0, lineEnd + 1) + block + "#line 2\n" + source.substr(lineEnd + 1);
+	}
+
+private:
+	static const int MAX_INCLUDE_DEPTH = 16;
+
+	static bool expand(const std::string &path, std::string &out, std::vector<std::string> &includeStack, std::vector<std::string> &included)
+	{
+		if ((int)includeStack.size() >= MAX_INCLUDE_DEPTH)
+		{
+			std::cout << "ERROR::SHADER::INCLUDE_TOO_DEEP: " << path << std::endl;
+			return false;
+		}
+
+		std::ifstream file(path.c_str());
+		if (!file.is_open())
+		{
+			std::cout << "ERROR::SHADER::FILE_NOT_SUCCESFULLY_READ: " << path << std::endl;
+			return false;
+		}
+		includeStack.push_back(path);
+		included.push_back(path);
+
+		std::string directory;
+		size_t slash = path.find_last_of("/\\");
+		if (slash != std::string::npos)
+			directory = path.substr(0, slash + 1);
+
+		std::string line;
+		while (std::getline(file, line))
+		{
+			size_t first = line.find_first_not_of(" \t");
+			if (first != std::string::npos && line.compare(first, 8, "#include") == 0)
+			{
+				size_t open = line.find('"', first + 8);
+				size_t close = open == std::string::npos ? open : line.find('"', open + 1);
+				if (close == std::string::npos)
+				{
+					std::cout << "ERROR::SHADER::MALFORMED_INCLUDE in " << path << ": " << line << std::endl;
+					includeStack.pop_back();
+					return false;
+				}
+				std::string includePath = directory + line.substr(open + 1, close - open - 1);
+				// a file still being expanded is also in included, so cycles are caught before the include-once skip
+				for (unsigned int i = 0; i < includeStack.size(); i++)
+				{
+					if (includeStack[i] == includePath)
+					{
+						std::cout << "ERROR::SHADER::RECURSIVE_INCLUDE in " << path << ": " << includePath << std::endl;
+						includeStack.pop_back();
+						return false;
+					}
+				}
+				bool alreadyIncluded = false;
+				for (unsigned int i = 0; i < included.size(); i++)
+					alreadyIncluded = alreadyIncluded || included[i] == includePath;
+				if (!alreadyIncluded && !expand(includePath, out, includeStack, included))
+				{
+					includeStack.pop_back();
+					return false;
+				}
+				// blank line in place of the directive so line counts stay stable
+				out += "\n";
+				continue;
+			}
+			out += line;
+			out += '\n';
+		}
+		includeStack.pop_back();
+		return true;
+	}
+};
+
+class Shader
+{
+public:
+	unsigned int ID;
+	// empty shader, compile() has to be called before use
+	// ------------------------------------------------------------------------
+	Shader() : ID(0)
+	{
+	}
+	// constructor generates the shader on the fly; when a file cannot be loaded
+	// nothing is compiled and ID stays 0
+	// ------------------------------------------------------------------------
+	Shader(const char* vertexPath, const char* fragmentPath, const char* geometryPath = nullptr) : ID(0)
+	{
+		// 1. retrieve the vertex/fragment source code from filePath, resolving #include's
+		std::string vertexCode;
+		std::string fragmentCode;
+		std::string geometryCode;
+		bool loaded = ShaderPreprocessor::load(vertexPath, vertexCode);
+		loaded = ShaderPreprocessor::load(fragmentPath, fragmentCode) && loaded;
+		// if geometry shader path is present, also load a geometry shader
+		if (geometryPath != nullptr)
+			loaded = ShaderPreprocessor::load(geometryPath, geometryCode) && loaded;
+		if (!loaded)
+			return;
+		// 2. compile shaders
+		compile(vertexCode.c_str(), fragmentCode.c_str(), geometryPath != nullptr ? geometryCode.c_str() : nullptr);
+	}
+	// compiles and links already loaded shader sources into ID
+	// ------------------------------------------------------------------------
+	void compile(const char* vShaderCode, const char* fShaderCode, const char* gShaderCode = nullptr)
+	{
+		TRACE_ZONE("compile shader");
+		unsigned int vertex, fragment;
+		// vertex shader
+		vertex = glCreateShader(GL_VERTEX_SHADER);
+		glShaderSource(vertex, 1, &vShaderCode, NULL);
+		glCompileShader(vertex);
+		checkCompileErrors(vertex, "VERTEX");
+		// fragment Shader
+		fragment = glCreateShader(GL_FRAGMENT_SHADER);
+		glShaderSource(fragment, 1, &fShaderCode, NULL);
+		glCompileShader(fragment);
+		checkCompileErrors(fragment, "FRAGMENT");
+		// if geometry shader is given, compile geometry shader
+		unsigned int geometry;
+		if (gShaderCode != nullptr)
+		{
+			geometry = glCreateShader(GL_GEOMETRY_SHADER);
+			glShaderSource(geometry, 1, &gShaderCode, NULL);
+			glCompileShader(geometry);
+			checkCompileErrors(geometry, "GEOMETRY");
+		}
+		// shader Program; a fresh program starts with default uniform values
+		uniformShadows.clear();
+		ID = glCreateProgram();
+		glAttachShader(ID, vertex);
+		glAttachShader(ID, fragment);
+		if (gShaderCode != nullptr)
+			glAttachShader(ID, geometry);
+		glLinkProgram(ID);
+		checkCompileErrors(ID, "PROGRAM");
+		// delete the shaders as they're linked into our program now and no longer necessery
+		glDeleteShader(vertex);
+		glDeleteShader(fragment);
+		if (gShaderCode != nullptr)
+			glDeleteShader(geometry);
+
+	}
+	// activate the shader
+	// ------------------------------------------------------------------------
+	void use()
+	{
+		GLStateCache::get().useProgram(ID);
+	}
+	// utility uniform functions
+	// every setter first compares against a CPU-side shadow of the value last uploaded
+	// to that uniform of this program and skips the glUniform* call when nothing changed.
+	// uniform values are per-program state, so the shadow stays valid across use() calls.
+	// ------------------------------------------------------------------------
+	void setBool(const std::string &name, bool value) const
+	{
+		setInt(name, (int)value);
+	}
+	// ------------------------------------------------------------------------
+	void setInt(const std::string &name, int value) const
+	{
+		GLint location = changedUniform(name, &value, sizeof(value));
+		if (location != -1)
+			glUniform1i(location, value);
+	}
+	// ------------------------------------------------------------------------
+	void setFloat(const std::string &name, float value) const
+	{
+		GLint location = changedUniform(name, &value, sizeof(value));
+		if (location != -1)
+			glUniform1f(location, value);
+	}
+	// ------------------------------------------------------------------------
+	void setVec2(const std::string &name, const glm::vec2 &value) const
+	{
+		GLint location = changedUniform(name, &value[0], 2 * sizeof(float));
+		if (location != -1)
+			glUniform2fv(location, 1, &value[0]);
+	}
+	void setVec2(const std::string &name, float x, float y) const
+	{
+		setVec2(name, glm::vec2(x, y));
+	}
+	// ------------------------------------------------------------------------
+	void setVec3(const std::string &name, const glm::vec3 &value) const
+	{
+		GLint location = changedUniform(name, &value[0], 3 * sizeof(float));
+		if (location != -1)
+			glUniform3fv(location, 1, &value[0]);
+	}
+	void setVec3(const std::string &name, float x, float y, float z) const
+	{
+		setVec3(name, glm::vec3(x, y, z));
+	}
+	// ------------------------------------------------------------------------
+	void setVec4(const std::string &name, const glm::vec4 &value) const
+	{
+		GLint location = changedUniform(name, &value[0], 4 * sizeof(float));
+		if (location != -1)
+			glUniform4fv(location, 1, &value[0]);
+	}
+	void setVec4(const std::string &name, float x, float y, float z, float w)
+	{
+		setVec4(name, glm::vec4(x, y, z, w));
+	}
+	// ------------------------------------------------------------------------
+	void setMat2(const std::string &name, const glm::mat2 &mat) const
+	{
+		GLint location = changedUniform(name, &mat[0][0], 4 * sizeof(float));
+		if (location != -1)
+			glUniformMatrix2fv(location, 1, GL_FALSE, &mat[0][0]);
+	}
+	// ------------------------------------------------------------------------
+	void setMat3(const std::string &name, const glm::mat3 &mat) const
+	{
+		GLint location = changedUniform(name, &mat[0][0], 9 * sizeof(float));
+		if (location != -1)
+			glUniformMatrix3fv(location, 1, GL_FALSE, &mat[0][0]);
+	}
+	// ------------------------------------------------------------------------
+	void setMat4(const std::string &name, const glm::mat4 &mat) const
+	{
+		GLint location = changedUniform(name, &mat[0][0], 16 * sizeof(float));
+		if (location != -1)
+			glUniformMatrix4fv(location, 1, GL_FALSE, &mat[0][0]);
+	}
+
+	// uniform upload counters
+	// ------------------------------------------------------------------------
+	struct UniformUploadStats
+	{
+		unsigned int issued;	// glUniform* calls that reached the driver
+		unsigned int skipped;	// set* calls dropped because the value was unchanged
+	};
+	// counters of this program since the last resetUniformStats()
+	const UniformUploadStats &getUniformStats() const
+	{
+		return uniformStats;
+	}
+	void resetUniformStats()
+	{
+		uniformStats.issued = uniformStats.skipped = 0;
+	}
+	// counters summed over every program, reset them once per frame to get per-frame numbers
+	static UniformUploadStats &getUniformStatsTotal()
+	{
+		static UniformUploadStats total = { 0, 0 };
+		return total;
+	}
+
+private:
+	// last value uploaded to one uniform location of this program
+	struct UniformShadow
+	{
+		GLint location;
+		unsigned int size;	// 0 until the first upload
+		unsigned char value[sizeof(glm::mat4)];
+	};
+	mutable std::unordered_map<std::string, UniformShadow> uniformShadows;
+	mutable UniformUploadStats uniformStats = { 0, 0 };
+
+	// looks up (and caches) the uniform location, returns -1 when there is nothing to upload:
+	// either the uniform does not exist in this program or it already holds exactly this value
+	// ------------------------------------------------------------------------
+	GLint changedUniform(const std::string &name, const void* value, unsigned int size) const
+	{
+		std::unordered_map<std::string, UniformShadow>::iterator it = uniformShadows.find(name);
+		if (it == uniformShadows.end())
+		{
+			UniformShadow shadow;
+			shadow.location = glGetUniformLocation(ID, name.c_str());
+			shadow.size = 0;
+			it = uniformShadows.insert(std::make_pair(name, shadow)).first;
+		}
+		UniformShadow &shadow = it->second;
+		if (shadow.location == -1)
+			return -1;
+		if (shadow.size == size && memcmp(shadow.value, value, size) == 0)
+		{
+			uniformStats.skipped++;
+			getUniformStatsTotal().skipped++;
+			return -1;
+		}
+		memcpy(shadow.value, value, size);
+		shadow.size = size;
+		uniformStats.issued++;
+		getUniformStatsTotal().issued++;
+		return shadow.location;
+	}
+
+	// utility function for checking shader compilation/linking errors.
+	// ------------------------------------------------------------------------
+	void checkCompileErrors(GLuint shader, std::string type)
+	{
+		GLint success;
+		GLchar infoLog[1024];
+		if (type != "PROGRAM")
+		{
+			glGetShaderiv(shader, GL_COMPILE_STATUS, &success);
+			if (!success)
+			{
+				glGetShaderInfoLog(shader, 1024, NULL, infoLog);
+				std::cout << "ERROR::SHADER_COMPILATION_ERROR of type: " << type << "\n" << infoLog << "\n -- --------------------------------------------------- -- " << std::endl;
+			}
+		}
+		else
+		{
+			glGetProgramiv(shader, GL_LINK_STATUS, &success);
+			if (!success)
+			{
+				glGetProgramInfoLog(shader, 1024, NULL, infoLog);
+				std::cout << "ERROR::PROGRAM_LINKING_ERROR of type: " << type << "\n" << infoLog << "\n -- --------------------------------------------------- -- " << std::endl;
+			}
+		}
+	}
+};
+#endif
+//#ifndef SHADER_H
+//#define SHADER_H
+//
+//#include <glad/glad.h>
+//
+//#include <string>
+//#include <fstream>
+//#include <sstream>
+//#include <iostream>
+//
+//class Shader
+//{
+//public:
+//	unsigned int ID;
+//	// constructor generates the shader on the fly
+//	// ------------------------------------------------------------------------
+//	Shader(const char* vertexPath, const char* fragmentPath)
+//	{
+//		// 1. retrieve the vertex/fragment source code from filePath
+//		std::string vertexCode;
+//		std::string fragmentCode;
+//		std::ifstream vShaderFile;
+//		std::ifstream fShaderFile;
+//		// ensure ifstream objects can throw exceptions:
+//		vShaderFile.exceptions(std::ifstream::failbit | std::ifstream::badbit);
+//		fShaderFile.exceptions(std::ifstream::failbit | std::ifstream::badbit);
+//		try
+//		{
+//			// open files
+//			vShaderFile.open(vertexPath);
+//			fShaderFile.open(fragmentPath);
+//			std::stringstream vShaderStream, fShaderStream;
+//			// read file's buffer contents into streams
+//			vShaderStream << vShaderFile.rdbuf();
+//			fShaderStream << fShaderFile.rdbuf();
+//			// close file handlers
+//			vShaderFile.close();
+//			fShaderFile.close();
+//			// convert stream into string
+//			vertexCode = vShaderStream.str();
+//			fragmentCode = fShaderStream.str();
+//		}
+//		catch (std::ifstream::failure& e)
+//		{
+//			std::cout << "ERROR::SHADER::FILE_NOT_SUCCESFULLY_READ" << std::endl;
+//		}
+//		const char* vShaderCode = vertexCode.c_str();
+//		const char * fShaderCode = fragmentCode.c_str();
+//		// 2. compile shaders
+//		unsigned int vertex, fragment;
+//		// vertex shader
+//		vertex = glCreateShader(GL_VERTEX_SHADER);
+//		glShaderSource(vertex, 1, &vShaderCode, NULL);
+//		glCompileShader(vertex);
+//		checkCompileErrors(vertex, "VERTEX");
+//		// fragment Shader
+//		fragment = glCreateShader(GL_FRAGMENT_SHADER);
+//		glShaderSource(fragment, 1, &fShaderCode, NULL);
+//		glCompileShader(fragment);
+//		checkCompileErrors(fragment, "FRAGMENT");
+//		// shader Program
+//		ID = glCreateProgram();
+//		glAttachShader(ID, vertex);
+//		glAttachShader(ID, fragment);
+//		glLinkProgram(ID);
+//		checkCompileErrors(ID, "PROGRAM");
+//		// delete the shaders as they're linked into our program now and no longer necessary
+//		glDeleteShader(vertex);
+//		glDeleteShader(fragment);
+//	}
+//	// activate the shader
+//	// ------------------------------------------------------------------------
+//	void use()
+//	{
+//		glUseProgram(ID);
+//	}
+//	// utility uniform functions
+//	// ------------------------------------------------------------------------
+//	void setBool(const std::string &name, bool value) const
+//	{
+//		glUniform1i(glGetUniformLocation(ID, name.c_str()), (int)value);
+//	}
+//	// ------------------------------------------------------------------------
+//	void setInt(const std::string &name, int value) const
+//	{
+//		glUniform1i(glGetUniformLocation(ID, name.c_str()), value);
+//	}
+//	// ------------------------------------------------------------------------
+//	void setFloat(const std::string &name, float value) const
+//	{
+//		glUniform1f(glGetUniformLocation(ID, name.c_str()), value);
+//	}
+//
+//private:
+//	// utility function for checking shader compilation/linking errors.
+//	// ------------------------------------------------------------------------
+//	void checkCompileErrors(unsigned int shader, std::string type)
+//	{
+//		int success;
+//		char infoLog[1024];
+//		if (type != "PROGRAM")
+//		{
+//			glGetShaderiv(shader, GL_COMPILE_STATUS, &success);
+//			if (!success)
+//			{
+//				glGetShaderInfoLog(shader, 1024, NULL, infoLog);
+//				std::cout << "ERROR::SHADER_COMPILATION_ERROR of type: " << type << "\n" << infoLog << "\n -- --------------------------------------------------- -- " << std::endl;
+//			}
+//		}
+//		else
+//		{
+//			glGetProgramiv(shader, GL_LINK_STATUS, &success);
+//			if (!success)
+//			{
+//				glGetProgramInfoLog(shader, 1024, NULL, infoLog);
+//				std::cout << "ERROR::PROGRAM_LINKING_ERROR of type: " << type << "\n" << infoLog << "\n -- --------------------------------------------------- -- " << std::endl;
+//			}
+//		}
+//	}
+//};
 //#endif
\ No newline at end of file
@@ -1,6 +1,6 @@
-#ifndef SHADER_HPP
-#define SHADER_HPP
-
-GLuint LoadShaders(const char * vertex_file_path,const char * fragment_file_path);
-
-#endif
+#ifndef SHADER_HPP
+#define SHADER_HPP
+
+GLuint LoadShaders(const char * vertex_file_path,const char * fragment_file_path);
+
+#endif
@@ -0,0 +1,73 @@
+#ifndef SHADER_PERMUTATIONS_H
+#define SHADER_PERMUTATIONS_H
+
+#include "shader.h"
+
+#include <string>
+#include <vector>
+#include <unordered_map>
+
+// Compiles specialized variants ("permutations") of one vertex/fragment shader pair.
+// Every bit of a feature mask maps to one preprocessor define, so a material that only
+// needs the cheap path gets a program with the unused code compiled out of it.
+class ShaderPermutationCache
+{
+public:
+	// featureDefines[i] is the define injected when bit (1 << i) is set in a feature mask
+	// ------------------------------------------------------------------------
+	ShaderPermutationCache(const char* vertexPath, const char* fragmentPath, const std::vector<std::string> &featureDefines)
+		: featureDefines(featureDefines)
+	{
+		// sources are read and #include-expanded once, permutations only differ in their defines
+		loaded = ShaderPreprocessor::load(vertexPath, vertexSource);
+		loaded = ShaderPreprocessor::load(fragmentPath, fragmentSource) && loaded;
+	}
+	~ShaderPermutationCache()
+	{
+		for (std::unordered_map<unsigned int, Shader>::iterator it = permutations.begin(); it != permutations.end(); ++it)
+			GLStateCache::get().deleteProgram(it->second.ID);
+	}
+	// returns the program for the given feature mask, compiling it on first use.
+	// references stay valid for the lifetime of the cache. If the sources could not be
+	// loaded, every permutation is an empty program with ID 0.
+	// ------------------------------------------------------------------------
+	Shader &get(unsigned int features)
+	{
+		std::unordered_map<unsigned int, Shader>::iterator it = permutations.find(features);
+		if (it != permutations.end())
+			return it->second;
+
+		std::vector<std::string> defines;
+		for (unsigned int i = 0; i < featureDefines.size(); i++)
+		{
+			if (features & (1u << i))
+				defines.push_back(featureDefines[i]);
+		}
+		std::string vertexCode = ShaderPreprocessor::injectDefines(vertexSource, defines);
+		std::string fragmentCode = ShaderPreprocessor::injectDefines(fragmentSource, defines);
+
+		Shader &shader = permutations[features];
+		if (!loaded)
+			return shader;
+		shader.compile(vertexCode.c_str(), fragmentCode.c_str());
+		return shader;
+	}
+	// number of permutations compiled so far
+	// ------------------------------------------------------------------------
+	size_t size() const
+	{
+		return permutations.size();
+	}
+
+private:
+	std::vector<std::string> featureDefines;
+	bool loaded; // both sources read, errors have been printed otherwise
+	std::string vertexSource;
+	std::string fragmentSource;
+	std::unordered_map<unsigned int, Shader> permutations;
+
+	// programs are owned by the cache, copying it would delete them twice
+	ShaderPermutationCache(const ShaderPermutationCache&);
+	ShaderPermutationCache &operator=(const ShaderPermutationCache&);
+};
+#endif
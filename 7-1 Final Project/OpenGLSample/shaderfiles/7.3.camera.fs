@@ -1,14 +1,53 @@
-#version 330 core
-out vec4 FragColor;
-
-in vec2 TexCoord;
-
-// texture samplers
-uniform sampler2D texture1;
-uniform sampler2D texture2;
-
-void main()
-{
-	// linearly interpolate between both textures (80% container, 20% awesomeface)
-	FragColor = mix(texture(texture1, TexCoord), texture(texture2, TexCoord), 0.2);
+#version 330 core
+out vec4 FragColor;
+
+in vec2 TexCoord;
+#ifdef INSTANCED
+in vec4 Tint;
+#endif
+#ifdef TEXTURE_ARRAY
+flat in vec4 TextureRect;
+flat in float TextureLayer;
+#endif
+
+// texture samplers
+#ifdef TEXTURE_ARRAY
+uniform sampler2DArray texture1;
+#else
+uniform sampler2D texture1;
+#endif
+#ifdef DETAIL_TEXTURE
+uniform sampler2D texture2;
+#endif
+
+// share of the detail texture in the color. Materials without one mix in black instead, which is
+// what the original two texture shader sampled from its empty second unit, so they keep its look
+const float DETAIL_WEIGHT = 0.2;
+
+#ifdef TEXTURE_ARRAY
+// an atlas image covers part of its layer, it is clamped instead of wrapping into its neighbours
+vec4 sampleBase()
+{
+	vec2 uv = TextureRect.z < 1.0 || TextureRect.w < 1.0 ? clamp(TexCoord, 0.0, 1.0) : TexCoord;
+	return texture(texture1, vec3(TextureRect.xy + uv * TextureRect.zw, TextureLayer));
+}
+#else
+vec4 sampleBase()
+{
+	return texture(texture1, TexCoord);
+}
+#endif
+
+void main()
+{
+#ifdef DETAIL_TEXTURE
+	// linearly interpolate between both textures (80% base, 20% detail)
+	FragColor = mix(sampleBase(), texture(texture2, TexCoord), DETAIL_WEIGHT);
+#else
+	// single texture materials skip the second fetch entirely
+	FragColor = mix(sampleBase(), vec4(0.0, 0.0, 0.0, 1.0), DETAIL_WEIGHT);
+#endif
+#ifdef INSTANCED
+	FragColor *= Tint;
+#endif
 }
\ No newline at end of file
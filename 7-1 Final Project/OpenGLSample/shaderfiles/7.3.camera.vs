@@ -1,15 +1,49 @@
-#version 330 core
-layout (location = 0) in vec3 aPos;
-layout (location = 1) in vec2 aTexCoord;
-
-out vec2 TexCoord;
-
-uniform mat4 model;
-uniform mat4 view;
-uniform mat4 projection;
-
-void main()
-{
-	gl_Position = projection * view * model * vec4(aPos, 1.0f);
-	TexCoord = vec2(aTexCoord.x, aTexCoord.y);
+#version 330 core
+layout (location = 0) in vec3 aPos;
+layout (location = 1) in vec2 aTexCoord;
+#ifdef INSTANCED
+// per-instance attributes, advanced once per instance (divisor 1)
+layout (location = 5) in mat4 aInstanceModel;
+layout (location = 9) in vec4 aInstanceTint;
+
+out vec4 Tint;
+#endif
+#ifdef TEXTURE_ARRAY
+// where the image of the object lies in the texture array
+#ifdef INSTANCED
+layout (location = 10) in vec4 aInstanceTextureRect;
+layout (location = 11) in float aInstanceTextureLayer;
+#else
+uniform vec4 textureRect;
+uniform float textureLayer;
+#endif
+
+flat out vec4 TextureRect;
+flat out float TextureLayer;
+#endif
+
+out vec2 TexCoord;
+
+uniform mat4 model;
+uniform mat4 view;
+uniform mat4 projection;
+
+void main()
+{
+#ifdef INSTANCED
+	gl_Position = projection * view * aInstanceModel * vec4(aPos, 1.0f);
+	Tint = aInstanceTint;
+#else
+	gl_Position = projection * view * model * vec4(aPos, 1.0f);
+#endif
+	TexCoord = vec2(aTexCoord.x, aTexCoord.y);
+#ifdef TEXTURE_ARRAY
+#ifdef INSTANCED
+	TextureRect = aInstanceTextureRect;
+	TextureLayer = aInstanceTextureLayer;
+#else
+	TextureRect = textureRect;
+	TextureLayer = textureLayer;
+#endif
+#endif
 }
\ No newline at end of file
@@ -0,0 +1,13 @@
+#version 330 core
+layout (location = 0) in vec2 aPos;	// pixels, origin in the lower left corner
+layout (location = 1) in vec2 aTexCoord;
+
+out vec2 TexCoord;
+
+uniform vec2 canvasSize;
+
+void main()
+{
+	gl_Position = vec4(aPos / canvasSize * 2.0 - 1.0, 0.0, 1.0);
+	TexCoord = aTexCoord;
+}
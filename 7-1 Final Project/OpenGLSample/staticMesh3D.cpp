@@ -2,6 +2,7 @@
 
 // Project
 #include "common/staticMesh3D.h"
+#include "glStateCache.h"
 #include <glm/glm.hpp>
 
 
@@ -27,7 +28,7 @@ void StaticMesh3D::deleteMesh()
         return;
     }
 
-    glDeleteVertexArrays(1, &_vao);
+    GLStateCache::get().deleteVertexArray(_vao);
     _vbo.deleteVBO();
 
     _isInitialized = false;
@@ -48,6 +49,11 @@ bool StaticMesh3D::hasNormals() const
     return _hasNormals;
 }
 
+GLuint StaticMesh3D::getVAO() const
+{
+    return _vao;
+}
+
 int StaticMesh3D::getVertexByteSize() const
 {
     int result = 0;
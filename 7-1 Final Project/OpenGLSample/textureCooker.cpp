@@ -0,0 +1,180 @@
+// STL
+#include <cstdio>
+#include <cstring>
+#include <cstdint>
+#include <iostream>
+#include <algorithm>
+#include <string>
+#include <chrono>
+
+// GL
+#include <glad/glad.h>
+
+// Project
+#include "textureCooker.h"
+#include "cpuTracer.h"
+#include "stb_image.h"
+
+namespace {
+
+	const unsigned char KTX_IDENTIFIER[12] = { 0xAB, 'K', 'T', 'X', ' ', '1', '1', 0xBB, '\r', '\n', 0x1A, '\n' };
+	const uint32_t KTX_ENDIANNESS = 0x04030201;
+	// EXT_texture_compression_s3tc, the formats loadDDS() uses for DXT1 and DXT5 as well
+	const uint32_t KTX_FORMAT_BC1 = 0x83F1; // GL_COMPRESSED_RGBA_S3TC_DXT1_EXT
+	const uint32_t KTX_FORMAT_BC3 = 0x83F3; // GL_COMPRESSED_RGBA_S3TC_DXT5_EXT
+
+	const GLenum FORMATS[] = { GL_RED, GL_RG, GL_RGB, GL_RGBA };
+	const GLenum INTERNAL_FORMATS[] = { GL_R8, GL_RG8, GL_RGB8, GL_RGBA8 };
+	const char* FORMAT_NAMES[] = { "R8", "RG8", "RGB8", "RGBA8" };
+
+	// what goes into the header, the levels themselves are written as they are
+	struct KtxFormat
+	{
+		uint32_t glType, glFormat, glInternalFormat, glBaseInternalFormat;
+		int texelBytes; // 0 for block compressed levels, whose size needs no padding
+	};
+
+	void appendKeyValue(std::vector<unsigned char>& data, const char* key, const char* value)
+	{
+		uint32_t length = (uint32_t)(strlen(key) + 1 + strlen(value) + 1);
+		data.insert(data.end(), (const unsigned char*)&length, (const unsigned char*)&length + 4);
+		data.insert(data.end(), key, key + strlen(key) + 1);
+		data.insert(data.end(), value, value + strlen(value) + 1);
+		data.resize((data.size() + 3) & ~(size_t)3);
+	}
+
+	// KTX 1.1 with one face and no array, rows of uncompressed levels padded to 4 bytes like the format wants
+	bool writeKTX(const char* path, const KtxFormat& format, int width, int height, const std::vector<std::vector<unsigned char> >& levels,
+		const char* swizzle)
+	{
+		std::vector<unsigned char> keyValues;
+		appendKeyValue(keyValues, "KTXorientation", "S=r,T=u"); // first row at the bottom
+		if (swizzle != NULL)
+			appendKeyValue(keyValues, "KTXswizzle", swizzle);
+
+		uint32_t header[13] = { KTX_ENDIANNESS, format.glType, 1, format.glFormat, format.glInternalFormat, format.glBaseInternalFormat,
+			(uint32_t)width, (uint32_t)height, 0, 0, 1, (uint32_t)levels.size(), (uint32_t)keyValues.size() };
+
+		FILE* file = fopen(path, "wb");
+		if (file == NULL)
+		{
+			std::cout << "ERROR::TEXTURE_COOKER::FILE_NOT_SUCCESFULLY_WRITTEN: " << path << std::endl;
+			return false;
+		}
+		bool ok = fwrite(KTX_IDENTIFIER, 1, sizeof(KTX_IDENTIFIER), file) == sizeof(KTX_IDENTIFIER)
+			&& fwrite(header, 1, sizeof(header), file) == sizeof(header)
+			&& fwrite(keyValues.data(), 1, keyValues.size(), file) == keyValues.size();
+
+		std::vector<unsigned char> padded;
+		const unsigned char zeros[3] = { 0, 0, 0 };
+		for (size_t level = 0; ok && level < levels.size(); level++)
+		{
+			const std::vector<unsigned char>* data = &levels[level];
+			if (format.texelBytes > 0)
+			{
+				int levelWidth = std::max(width >> level, 1), levelHeight = std::max(height >> level, 1);
+				size_t row = (size_t)levelWidth * format.texelBytes;
+				size_t paddedRow = (row + 3) & ~(size_t)3;
+				padded.assign(paddedRow * levelHeight, 0);
+				for (int y = 0; y < levelHeight; y++)
+					memcpy(&padded[y * paddedRow], &levels[level][y * row], row);
+				data = &padded;
+			}
+			uint32_t imageSize = (uint32_t)data->size();
+			ok = fwrite(&imageSize, 1, 4, file) == 4
+				&& fwrite(data->data(), 1, data->size(), file) == data->size()
+				&& fwrite(zeros, 1, (4 - data->size() % 4) % 4, file) == (4 - data->size() % 4) % 4;
+		}
+		fclose(file);
+		if (!ok)
+			std::cout << "ERROR::TEXTURE_COOKER::FILE_NOT_SUCCESFULLY_WRITTEN: " << path << std::endl;
+		return ok;
+	}
+
+} // namespace
+
+void TextureCooker::downsample(const unsigned char* pixels, int width, int height, int channels, std::vector<unsigned char>& target)
+{
+	int targetWidth = std::max(width / 2, 1), targetHeight = std::max(height / 2, 1);
+	target.resize((size_t)targetWidth * targetHeight * channels);
+	for (int y = 0; y < targetHeight; y++)
+	{
+		const unsigned char* row0 = pixels + (size_t)std::min(2 * y, height - 1) * width * channels;
+		const unsigned char* row1 = pixels + (size_t)std::min(2 * y + 1, height - 1) * width * channels;
+		unsigned char* out = &target[(size_t)y * targetWidth * channels];
+		for (int x = 0; x < targetWidth; x++)
+		{
+			int x0 = std::min(2 * x, width - 1) * channels, x1 = std::min(2 * x + 1, width - 1) * channels;
+			for (int c = 0; c < channels; c++)
+				out[x * channels + c] = (unsigned char)((row0[x0 + c] + row0[x1 + c] + row1[x0 + c] + row1[x1 + c] + 2) / 4);
+		}
+	}
+}
+
+void TextureCooker::generateMipChain(const unsigned char* pixels, int width, int height, int channels,
+	std::vector<std::vector<unsigned char> >& levels)
+{
+	TRACE_ZONE("generate mip chain");
+	levels.assign(1, std::vector<unsigned char>(pixels, pixels + (size_t)width * height * channels));
+	while (width > 1 || height > 1)
+	{
+		levels.push_back(std::vector<unsigned char>());
+		downsample(levels[levels.size() - 2].data(), width, height, channels, levels.back());
+		width = std::max(width / 2, 1);
+		height = std::max(height / 2, 1);
+	}
+}
+
+bool TextureCooker::cookFile(const char* imagePath, const char* ktxPath, TextureCookFormat format, BlockQuality quality)
+{
+	std::chrono::high_resolution_clock::time_point start = std::chrono::high_resolution_clock::now();
+	bool compressed = format != TEXTURE_COOK_UNCOMPRESSED;
+	int width, height, channels;
+	stbi_set_flip_vertically_on_load(true);
+	// the block compressor takes RGBA, uncompressed textures keep the channels the image has
+	unsigned char* pixels = stbi_load(imagePath, &width, &height, &channels, compressed ? 4 : 0);
+	if (pixels == NULL || channels < 1 || channels > 4)
+	{
+		stbi_image_free(pixels);
+		std::cout << "ERROR::TEXTURE_COOKER::IMAGE_NOT_SUCCESFULLY_READ: " << imagePath << std::endl;
+		return false;
+	}
+
+	std::vector<std::vector<unsigned char> > levels;
+	KtxFormat ktxFormat;
+	std::string formatName;
+	const char* swizzle = NULL;
+	if (compressed)
+	{
+		BlockFormat blockFormat = format == TEXTURE_COOK_BC1 ? BLOCK_FORMAT_BC1
+			: format == TEXTURE_COOK_BC3 ? BLOCK_FORMAT_BC3
+			: BlockCompressor::chooseFormat(pixels, width, height);
+		BlockCompressor::compressMipChain(pixels, width, height, blockFormat, quality, levels);
+		KtxFormat blocks = { 0, 0, blockFormat == BLOCK_FORMAT_BC1 ? KTX_FORMAT_BC1 : KTX_FORMAT_BC3, GL_RGBA, 0 };
+		ktxFormat = blocks;
+		formatName = blockFormat == BLOCK_FORMAT_BC1 ? "BC1" : "BC3";
+	}
+	else
+	{
+		generateMipChain(pixels, width, height, channels, levels);
+		KtxFormat texels = { GL_UNSIGNED_BYTE, FORMATS[channels - 1], INTERNAL_FORMATS[channels - 1], FORMATS[channels - 1], channels };
+		ktxFormat = texels;
+		formatName = FORMAT_NAMES[channels - 1];
+		// gray images read as gray RGB, like the TextureManager swizzles them
+		if (channels <= 2)
+			swizzle = channels == 1 ? "rrr1" : "rrrg";
+	}
+	stbi_image_free(pixels);
+
+	if (!writeKTX(ktxPath, ktxFormat, width, height, levels, swizzle))
+		return false;
+	size_t bytes = 0;
+	for (size_t i = 0; i < levels.size(); i++)
+		bytes += levels[i].size();
+	double seconds = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start).count();
+	char line[256];
+	snprintf(line, sizeof(line), "%s -> %s: %dx%d %s, %d levels, %.2f MB, %.0f ms", imagePath, ktxPath, width, height,
+		formatName.c_str(), (int)levels.size(), bytes / (1024.0 * 1024.0), seconds * 1000.0);
+	std::cout << line << std::endl;
+	return true;
+}
@@ -0,0 +1,45 @@
+#pragma once
+
+// STL
+#include <vector>
+
+// Project
+#include "blockCompressor.h"
+
+/**
+* What a cooked texture stores.
+*/
+enum TextureCookFormat
+{
+	TEXTURE_COOK_UNCOMPRESSED = 0, // the image's own channels, 8 bit each
+	TEXTURE_COOK_BC1 = 1,
+	TEXTURE_COOK_BC3 = 2,
+	TEXTURE_COOK_BC_AUTO = 3 // BC3 for images with alpha below 255, BC1 otherwise
+};
+
+/**
+* Asset step that turns an image into a KTX 1.1 file with its whole mip chain, so loading it
+* is an upload of the stored levels: no decoding and no glGenerateMipmap at startup. The
+* TextureManager loads .ktx paths that way. Rows are stored bottom up like the manager uploads
+* decoded images, so a scene keeps its texture coordinates when it switches to the cooked file.
+*
+*   OpenGLSample --cook-texture images/egg.jpg images/egg.ktx [uncompressed|bc1|bc3|auto] [fast|normal|high]
+*/
+class TextureCooker
+{
+public:
+	/** \brief  Halves an image, every pixel the rounded average of the 2x2 above it like glGenerateMipmap;
+	*           at odd sizes the last row and column repeat.
+	*/
+	static void downsample(const unsigned char* pixels, int width, int height, int channels, std::vector<unsigned char>& target);
+
+	/** \brief  Builds the levels of a full mip chain down to 1x1, levels[0] is a copy of the image. */
+	static void generateMipChain(const unsigned char* pixels, int width, int height, int channels,
+		std::vector<std::vector<unsigned char> >& levels);
+
+	/** \brief  Loads an image file and writes it with its mip chain as KTX. Prints what it did.
+	*   \param quality  Only used by the BC formats
+	*   \return True on success, errors are printed
+	*/
+	static bool cookFile(const char* imagePath, const char* ktxPath, TextureCookFormat format, BlockQuality quality);
+};
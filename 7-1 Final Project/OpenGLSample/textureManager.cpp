@@ -0,0 +1,826 @@
+// STL
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <sstream>
+#include <algorithm>
+#include <cctype>
+#include <atomic>
+#include <set>
+#include <thread>
+
+// GL
+#include <glad/glad.h>
+
+#define STB_IMAGE_IMPLEMENTATION
+#include "stb_image.h"
+
+// Project
+#include "textureManager.h"
+#include "glStateCache.h"
+#include "jobSystem.h"
+#include "cpuTracer.h"
+#include "common/texture.hpp"
+
+struct TextureHandle::Entry
+{
+	GLuint id;
+	GLenum target; // GL_TEXTURE_2D, GL_TEXTURE_2D_ARRAY for loadArray(), or what a KTX / DDS file holds
+	bool ready; // all pixels uploaded and the mip chain built
+	int references;
+	int width, height;
+	size_t bytes;
+	uint64_t hash;
+	std::vector<std::string> paths; // every path it was loaded by
+	TextureManager::Upload* upload; // while it is streamed in
+	// a streamed image whose bytes turned out to be those of another texture gets no texture of
+	// its own: it holds a reference to that one and its handles read it instead
+	Entry* sharedWith;
+};
+
+struct TextureManager::Upload
+{
+	std::string path;
+	std::vector<unsigned char> file;
+	uint64_t hash;
+	int sameAs; // earlier image of a batch with the same content, -1 if none
+	Entry* entry; // texture the pixels go into; for a streamed image null once nothing refers to it anymore
+	unsigned char* pixels;
+	int width, height, channels;
+	int layer, x, y; // where the image goes in the texture, only arrays use other than 0
+	std::vector<unsigned char> padded; // an atlas image with its gutter, pixels points into it then
+	int nextRow; // rows uploaded so far
+	std::atomic<bool> decoded; // set by the worker, the fields above belong to the GL thread after that
+};
+
+namespace {
+
+	const GLenum FORMATS[] = { GL_RED, GL_RG, GL_RGB, GL_RGBA };
+	const GLenum INTERNAL_FORMATS[] = { GL_R8, GL_RG8, GL_RGB8, GL_RGBA8 };
+
+	// FNV-1a, the files are only hashed to find copies of the same image
+	uint64_t hashBytes(const std::vector<unsigned char>& bytes)
+	{
+		uint64_t hash = 14695981039346656037ull;
+		for (size_t i = 0; i < bytes.size(); i++)
+			hash = (hash ^ bytes[i]) * 1099511628211ull;
+		return hash;
+	}
+
+	bool readFile(const std::string& path, std::vector<unsigned char>& bytes)
+	{
+		FILE* file = fopen(path.c_str(), "rb");
+		if (file == NULL)
+			return false;
+		fseek(file, 0, SEEK_END);
+		long size = ftell(file);
+		fseek(file, 0, SEEK_SET);
+		bytes.resize(size > 0 ? (size_t)size : 0);
+		bool ok = size > 0 && fread(bytes.data(), 1, bytes.size(), file) == bytes.size();
+		fclose(file);
+		if (!ok)
+			bytes.clear();
+		return ok;
+	}
+
+	size_t fileSize(const std::string& path)
+	{
+		FILE* file = fopen(path.c_str(), "rb");
+		if (file == NULL)
+			return 0;
+		fseek(file, 0, SEEK_END);
+		long size = ftell(file);
+		fclose(file);
+		return size > 0 ? (size_t)size : 0;
+	}
+
+	std::string lowerExtension(const std::string& path)
+	{
+		size_t dot = path.find_last_of('.');
+		std::string extension = dot == std::string::npos ? "" : path.substr(dot + 1);
+		std::transform(extension.begin(), extension.end(), extension.begin(), ::tolower);
+		return extension;
+	}
+
+	// KTX and DDS files hold finished textures, mip levels included
+	bool isContainer(const std::string& path)
+	{
+		std::string extension = lowerExtension(path);
+		return extension == "ktx" || extension == "ktx2" || extension == "dds";
+	}
+
+	// flips so the first row is the bottom row, like OpenGL expects; frees the file
+	void decode(std::vector<unsigned char>& file, unsigned char*& pixels, int& width, int& height, int& channels)
+	{
+		TRACE_ZONE("decode texture");
+		pixels = stbi_load_from_memory(file.data(), (int)file.size(), &width, &height, &channels, 0);
+		std::vector<unsigned char>().swap(file);
+		if (pixels != NULL && (channels < 1 || channels > 4))
+		{
+			stbi_image_free(pixels);
+			pixels = NULL;
+		}
+	}
+
+	// immutable storage with the mip levels (plain glTexImage2D/3D before GL 4.2), pixels come later.
+	// layers is 0 for a GL_TEXTURE_2D; atlases clamp, their images are not the whole layer
+	GLuint createStorage(int width, int height, int layers, int levels, int channels, bool clamp, size_t& bytes)
+	{
+		GLenum target = layers > 0 ? GL_TEXTURE_2D_ARRAY : GL_TEXTURE_2D;
+		GLuint texture;
+		glGenTextures(1, &texture);
+		GLStateCache::get().bindTexture(0, target, texture);
+		if (layers > 0 && glTexStorage3D != NULL)
+			glTexStorage3D(target, levels, INTERNAL_FORMATS[channels - 1], width, height, layers);
+		else if (layers > 0)
+			glTexImage3D(target, 0, INTERNAL_FORMATS[channels - 1], width, height, layers, 0, FORMATS[channels - 1], GL_UNSIGNED_BYTE, NULL);
+		else if (glTexStorage2D != NULL)
+			glTexStorage2D(target, levels, INTERNAL_FORMATS[channels - 1], width, height);
+		else
+			glTexImage2D(target, 0, INTERNAL_FORMATS[channels - 1], width, height, 0, FORMATS[channels - 1], GL_UNSIGNED_BYTE, NULL);
+
+		glTexParameteri(target, GL_TEXTURE_MAX_LEVEL, levels - 1);
+		glTexParameteri(target, GL_TEXTURE_WRAP_S, clamp ? GL_CLAMP_TO_EDGE : GL_REPEAT);
+		glTexParameteri(target, GL_TEXTURE_WRAP_T, clamp ? GL_CLAMP_TO_EDGE : GL_REPEAT);
+		glTexParameteri(target, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+		glTexParameteri(target, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+		// gray (and gray + alpha) images read as gray RGB, like they did when expanded on load
+		if (channels <= 2)
+		{
+			GLint swizzle[4] = { GL_RED, GL_RED, GL_RED, channels == 2 ? GL_GREEN : GL_ONE };
+			glTexParameteriv(target, GL_TEXTURE_SWIZZLE_RGBA, swizzle);
+		}
+
+		// a full chain adds a third to the base level
+		bytes = (size_t)width * height * std::max(layers, 1) * channels * 4 / 3;
+		return texture;
+	}
+
+	// copies an image into the middle of a buffer gutter pixels larger on every side, the gutter
+	// repeats the edge pixels, so filtering at the edge of an atlas image never reads its neighbour
+	void addGutter(const unsigned char* pixels, int width, int height, int channels, int gutter, std::vector<unsigned char>& padded)
+	{
+		int paddedWidth = width + 2 * gutter;
+		padded.resize((size_t)paddedWidth * (height + 2 * gutter) * channels);
+		for (int y = 0; y < height + 2 * gutter; y++)
+		{
+			const unsigned char* row = pixels + (size_t)std::min(std::max(y - gutter, 0), height - 1) * width * channels;
+			unsigned char* out = &padded[(size_t)y * paddedWidth * channels];
+			for (int x = 0; x < gutter; x++)
+			{
+				memcpy(out + x * channels, row, channels);
+				memcpy(out + (gutter + width + x) * channels, row + (width - 1) * channels, channels);
+			}
+			memcpy(out + gutter * channels, row, (size_t)width * channels);
+		}
+	}
+
+} // namespace
+
+// ---------------------------------------------------------------------------
+// TextureHandle
+// ---------------------------------------------------------------------------
+
+TextureHandle::TextureHandle()
+	: _entry(nullptr)
+{
+}
+
+TextureHandle::TextureHandle(Entry* entry)
+	: _entry(entry)
+{
+	if (_entry != nullptr)
+		TextureManager::get().addReference(_entry);
+}
+
+TextureHandle::TextureHandle(const TextureHandle& other)
+	: _entry(other._entry)
+{
+	if (_entry != nullptr)
+		TextureManager::get().addReference(_entry);
+}
+
+TextureHandle& TextureHandle::operator=(const TextureHandle& other)
+{
+	if (other._entry != nullptr)
+		TextureManager::get().addReference(other._entry);
+	reset();
+	_entry = other._entry;
+	return *this;
+}
+
+TextureHandle::~TextureHandle()
+{
+	reset();
+}
+
+void TextureHandle::reset()
+{
+	if (_entry != nullptr)
+		TextureManager::get().removeReference(_entry);
+	_entry = nullptr;
+}
+
+unsigned int TextureHandle::id() const
+{
+	const Entry* entry = texture();
+	return entry != nullptr && entry->ready ? entry->id : 0;
+}
+
+bool TextureHandle::isReady() const
+{
+	const Entry* entry = texture();
+	return entry != nullptr && entry->ready;
+}
+
+int TextureHandle::getWidth() const
+{
+	const Entry* entry = texture();
+	return entry != nullptr ? entry->width : 0;
+}
+
+int TextureHandle::getHeight() const
+{
+	const Entry* entry = texture();
+	return entry != nullptr ? entry->height : 0;
+}
+
+const TextureHandle::Entry* TextureHandle::texture() const
+{
+	return _entry != nullptr && _entry->sharedWith != nullptr ? _entry->sharedWith : _entry;
+}
+
+// ---------------------------------------------------------------------------
+// TextureManager
+// ---------------------------------------------------------------------------
+
+TextureManager& TextureManager::get()
+{
+	static TextureManager manager;
+	return manager;
+}
+
+TextureManager::TextureManager()
+	: _bytes(0)
+{
+}
+
+TextureManager::~TextureManager()
+{
+	// textures still referenced at exit go with the context, only the bookkeeping is freed;
+	// images a worker may still be decoding are left to the process exit. Streamed entries
+	// are only known by path until they are complete, arrays and shared ones only by one map
+	std::set<Entry*> entries;
+	for (std::map<uint64_t, Entry*>::iterator i = _byHash.begin(); i != _byHash.end(); ++i)
+		entries.insert(i->second);
+	for (std::map<std::string, Entry*>::iterator i = _byPath.begin(); i != _byPath.end(); ++i)
+		entries.insert(i->second);
+	for (std::set<Entry*>::iterator i = entries.begin(); i != entries.end(); ++i)
+		delete *i;
+	for (size_t i = 0; i < _streaming.size(); i++)
+	{
+		if (_streaming[i]->decoded.load(std::memory_order_acquire))
+		{
+			stbi_image_free(_streaming[i]->pixels);
+			delete _streaming[i];
+		}
+	}
+}
+
+void TextureManager::load(const std::vector<std::string>& paths, std::vector<TextureHandle>& handles)
+{
+	TRACE_ZONE("load textures");
+	handles.assign(paths.size(), TextureHandle());
+
+	// paths loaded before are done, the others are read once each
+	std::vector<Upload*> pending;
+	std::vector<int> pendingOf(paths.size(), -1);
+	for (size_t i = 0; i < paths.size(); i++)
+	{
+		std::map<std::string, Entry*>::iterator loaded = _byPath.find(paths[i]);
+		if (loaded != _byPath.end())
+		{
+			handles[i] = TextureHandle(loaded->second);
+			continue;
+		}
+		if (isContainer(paths[i]))
+		{
+			handles[i] = TextureHandle(loadContainer(paths[i]));
+			continue;
+		}
+		for (size_t j = 0; j < pending.size() && pendingOf[i] < 0; j++)
+		{
+			if (pending[j]->path == paths[i])
+				pendingOf[i] = (int)j;
+		}
+		if (pendingOf[i] < 0)
+		{
+			pendingOf[i] = (int)pending.size();
+			pending.push_back(createUpload(paths[i]));
+		}
+	}
+	if (pending.empty())
+		return;
+
+	JobSystem& jobs = JobSystem::get();
+	jobs.parallelFor(pending.size(), 1, [&](size_t begin, size_t end)
+	{
+		for (size_t i = begin; i < end; i++)
+		{
+			TRACE_ZONE("read texture");
+			if (readFile(pending[i]->path, pending[i]->file))
+				pending[i]->hash = hashBytes(pending[i]->file);
+		}
+	});
+
+	// the same bytes under another path are not decoded again
+	for (size_t i = 0; i < pending.size(); i++)
+	{
+		Upload& image = *pending[i];
+		if (image.file.empty())
+			continue;
+		// texture arrays and KTX / DDS files are in the map too, under hashes of their own keys
+		std::map<uint64_t, Entry*>::iterator loaded = _byHash.find(image.hash);
+		if (loaded != _byHash.end() && loaded->second->target == GL_TEXTURE_2D)
+			image.entry = loaded->second;
+		for (size_t j = 0; j < i && image.entry == nullptr && image.sameAs < 0; j++)
+		{
+			if (pending[j]->hash == image.hash && !pending[j]->file.empty() && pending[j]->sameAs < 0)
+				image.sameAs = (int)j;
+		}
+	}
+
+	stbi_set_flip_vertically_on_load(true);
+	jobs.parallelFor(pending.size(), 1, [&](size_t begin, size_t end)
+	{
+		for (size_t i = begin; i < end; i++)
+		{
+			Upload& image = *pending[i];
+			if (!image.file.empty() && image.entry == nullptr && image.sameAs < 0)
+				decode(image.file, image.pixels, image.width, image.height, image.channels);
+		}
+	});
+
+	// uploads need the GL context, they happen here and wait for staging memory when the ring is full
+	for (size_t i = 0; i < pending.size(); i++)
+	{
+		Upload& image = *pending[i];
+		if (image.sameAs >= 0)
+			image.entry = pending[image.sameAs]->entry;
+		if (image.entry == nullptr && image.pixels != NULL)
+		{
+			TRACE_ZONE("upload texture");
+			size_t budget = (size_t)-1;
+			image.entry = createEntry(image);
+			uploadRows(image, budget, true);
+			finish(image.entry);
+			_byHash[image.hash] = image.entry;
+		}
+		stbi_image_free(image.pixels);
+		image.pixels = NULL;
+
+		if (image.entry == nullptr)
+		{
+			std::cout << "Failed to load texture: " << image.path << std::endl;
+			continue;
+		}
+		image.entry->paths.push_back(image.path);
+		_byPath[image.path] = image.entry;
+	}
+	_ring.unbind();
+
+	for (size_t i = 0; i < paths.size(); i++)
+	{
+		if (pendingOf[i] >= 0)
+			handles[i] = TextureHandle(pending[pendingOf[i]]->entry);
+	}
+	for (size_t i = 0; i < pending.size(); i++)
+		delete pending[i];
+}
+
+TextureHandle TextureManager::load(const std::string& path)
+{
+	std::vector<TextureHandle> handles;
+	load(std::vector<std::string>(1, path), handles);
+	return handles[0];
+}
+
+TextureHandle TextureManager::loadArray(const TexturePackArray& array, const std::vector<std::string>& paths,
+	const std::vector<TexturePackPlacement>& placements)
+{
+	TRACE_ZONE("load texture array");
+
+	// the same layout of the same files is the same texture
+	std::ostringstream layout;
+	layout << array.width << ' ' << array.height << ' ' << array.channels << ' ' << array.layers << ' ' << array.levels << ' ' << array.gutter;
+	for (size_t i = 0; i < paths.size(); i++)
+		layout << '\n' << paths[i] << ' ' << placements[i].layer << ' ' << placements[i].x << ' ' << placements[i].y;
+	std::string key = layout.str();
+	uint64_t hash = hashBytes(std::vector<unsigned char>(key.begin(), key.end()));
+	std::map<uint64_t, Entry*>::iterator loaded = _byHash.find(hash);
+	if (loaded != _byHash.end())
+		return TextureHandle(loaded->second);
+
+	std::vector<Upload*> images(paths.size());
+	std::vector<char> mismatched(paths.size(), 0);
+	for (size_t i = 0; i < paths.size(); i++)
+	{
+		images[i] = createUpload(paths[i]);
+		images[i]->layer = placements[i].layer;
+		images[i]->x = placements[i].x;
+		images[i]->y = placements[i].y;
+	}
+
+	stbi_set_flip_vertically_on_load(true);
+	JobSystem::get().parallelFor(images.size(), 1, [&](size_t begin, size_t end)
+	{
+		for (size_t i = begin; i < end; i++)
+		{
+			Upload& image = *images[i];
+			if (readFile(image.path, image.file))
+				decode(image.file, image.pixels, image.width, image.height, image.channels);
+			if (image.pixels == NULL)
+				continue;
+			// the packer placed the image by the size it had then
+			if (image.width != placements[i].width || image.height != placements[i].height || image.channels != array.channels)
+			{
+				stbi_image_free(image.pixels);
+				image.pixels = NULL;
+				mismatched[i] = 1;
+				continue;
+			}
+			if (array.gutter > 0)
+			{
+				addGutter(image.pixels, image.width, image.height, image.channels, array.gutter, image.padded);
+				stbi_image_free(image.pixels);
+				image.pixels = image.padded.data();
+				image.width += 2 * array.gutter;
+				image.height += 2 * array.gutter;
+				image.x -= array.gutter;
+				image.y -= array.gutter;
+			}
+		}
+	});
+
+	Entry* entry = new Entry();
+	entry->target = GL_TEXTURE_2D_ARRAY;
+	entry->ready = false;
+	entry->references = 0;
+	entry->width = array.width;
+	entry->height = array.height;
+	entry->hash = hash;
+	entry->upload = nullptr;
+	entry->sharedWith = nullptr;
+	entry->id = createStorage(array.width, array.height, array.layers, array.levels, array.channels, array.gutter > 0, entry->bytes);
+	_bytes += entry->bytes;
+
+	// images that failed leave their place empty, the others are still usable
+	for (size_t i = 0; i < images.size(); i++)
+	{
+		Upload& image = *images[i];
+		if (mismatched[i])
+			std::cout << "ERROR::TEXTURE::IMAGE_CHANGED_SINCE_PACKED: " << image.path << std::endl;
+		else if (image.pixels == NULL)
+			std::cout << "Failed to load texture: " << image.path << std::endl;
+		if (image.pixels != NULL)
+		{
+			size_t budget = (size_t)-1;
+			image.entry = entry;
+			uploadRows(image, budget, true);
+			if (image.padded.empty())
+				stbi_image_free(image.pixels);
+		}
+		delete images[i];
+	}
+	finish(entry);
+	_byHash[hash] = entry;
+	return TextureHandle(entry);
+}
+
+void TextureManager::loadAsync(const std::vector<std::string>& paths, std::vector<TextureHandle>& handles)
+{
+	handles.assign(paths.size(), TextureHandle());
+	stbi_set_flip_vertically_on_load(true);
+	JobSystem& jobs = JobSystem::get();
+	for (size_t i = 0; i < paths.size(); i++)
+	{
+		std::map<std::string, Entry*>::iterator loaded = _byPath.find(paths[i]);
+		if (loaded != _byPath.end())
+		{
+			handles[i] = TextureHandle(loaded->second);
+			continue;
+		}
+		// nothing to decode, the upload is all there is to it
+		if (isContainer(paths[i]))
+		{
+			handles[i] = TextureHandle(loadContainer(paths[i]));
+			continue;
+		}
+
+		// the entry exists from the start, so handles can be given out; it gets its size once decoded
+		Upload* upload = createUpload(paths[i]);
+		Entry* entry = new Entry();
+		entry->id = 0;
+		entry->target = GL_TEXTURE_2D;
+		entry->ready = false;
+		entry->references = 0;
+		entry->width = entry->height = 0;
+		entry->bytes = 0;
+		entry->hash = 0;
+		entry->paths.push_back(paths[i]);
+		entry->upload = upload;
+		entry->sharedWith = nullptr;
+		upload->entry = entry;
+		_byPath[paths[i]] = entry;
+		_streaming.push_back(upload);
+		handles[i] = TextureHandle(entry);
+
+		// without workers nobody would pick the job up, update() decodes then
+		if (jobs.getWorkerCount() > 0)
+			jobs.run(jobs.create(&TextureManager::decodeJob, upload));
+	}
+}
+
+void TextureManager::update(size_t budgetBytes)
+{
+	if (_streaming.empty())
+		return;
+	TRACE_ZONE("stream textures");
+	bool decodeHere = JobSystem::get().getWorkerCount() == 0;
+	size_t budget = budgetBytes;
+	size_t kept = 0;
+	for (size_t i = 0; i < _streaming.size(); i++)
+	{
+		Upload& image = *_streaming[i];
+		Entry* shared;
+		if (!image.decoded.load(std::memory_order_acquire) && decodeHere)
+		{
+			decodeJob(nullptr, &_streaming[i]);
+			decodeHere = false; // one a frame
+		}
+
+		bool done = false;
+		if (image.decoded.load(std::memory_order_acquire))
+		{
+			if (image.entry == nullptr)
+			{
+				done = true; // nothing refers to it anymore
+			}
+			else if (image.pixels == NULL)
+			{
+				std::cout << "Failed to load texture: " << image.path << std::endl;
+				image.entry->upload = nullptr;
+				done = true;
+			}
+			else if (image.entry->id == 0 && (shared = findSameImage(image)) != nullptr)
+			{
+				// the same bytes under another path are not uploaded again
+				Entry* entry = image.entry;
+				entry->sharedWith = shared;
+				entry->hash = image.hash;
+				entry->upload = nullptr;
+				addReference(shared);
+				done = true;
+			}
+			else if (budget > 0)
+			{
+				if (image.entry->id == 0)
+				{
+					Entry* entry = image.entry;
+					entry->width = image.width;
+					entry->height = image.height;
+					entry->hash = image.hash;
+					entry->id = createStorage(image.width, image.height, 0, TexturePacker::fullMipLevels(image.width, image.height),
+						image.channels, false, entry->bytes);
+					_bytes += entry->bytes;
+				}
+				done = uploadRows(image, budget, false);
+				if (done)
+				{
+					finish(image.entry);
+					image.entry->upload = nullptr;
+					if (_byHash.find(image.hash) == _byHash.end())
+						_byHash[image.hash] = image.entry;
+				}
+			}
+		}
+
+		if (done)
+		{
+			stbi_image_free(image.pixels);
+			delete _streaming[i];
+		}
+		else
+		{
+			_streaming[kept++] = _streaming[i];
+		}
+	}
+	_streaming.resize(kept);
+	_ring.unbind();
+}
+
+void TextureManager::flush()
+{
+	TRACE_ZONE("flush textures");
+	while (!_streaming.empty())
+	{
+		update((size_t)-1);
+		// the rest is still being decoded by the workers
+		if (!_streaming.empty())
+			std::this_thread::yield();
+	}
+}
+
+size_t TextureManager::getLoadingCount() const
+{
+	return _streaming.size();
+}
+
+size_t TextureManager::getTextureCount() const
+{
+	return _byHash.size();
+}
+
+size_t TextureManager::getTextureBytes() const
+{
+	return _bytes;
+}
+
+TextureManager::Upload* TextureManager::createUpload(const std::string& path)
+{
+	Upload* upload = new Upload();
+	upload->path = path;
+	upload->hash = 0;
+	upload->sameAs = -1;
+	upload->entry = nullptr;
+	upload->pixels = NULL;
+	upload->width = upload->height = upload->channels = 0;
+	upload->layer = upload->x = upload->y = 0;
+	upload->nextRow = 0;
+	upload->decoded.store(false, std::memory_order_relaxed);
+	return upload;
+}
+
+TextureManager::Entry* TextureManager::createEntry(Upload& upload)
+{
+	Entry* entry = new Entry();
+	entry->target = GL_TEXTURE_2D;
+	entry->ready = false;
+	entry->references = 0;
+	entry->width = upload.width;
+	entry->height = upload.height;
+	entry->hash = upload.hash;
+	entry->upload = nullptr;
+	entry->sharedWith = nullptr;
+	entry->id = createStorage(upload.width, upload.height, 0, TexturePacker::fullMipLevels(upload.width, upload.height),
+		upload.channels, false, entry->bytes);
+	_bytes += entry->bytes;
+	return entry;
+}
+
+// stages blocks of rows and copies them into level 0 until the image is complete (returns true),
+// the budget is used up or, without waiting, the ring has no room
+bool TextureManager::uploadRows(Upload& upload, size_t& budget, bool wait)
+{
+	// without the ring (it could not be allocated) the rows go straight from client memory
+	if (!_ring.isInitialized())
+		_ring.init();
+	GLenum target = upload.entry->target;
+	GLStateCache::get().bindTexture(0, target, upload.entry->id);
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 1); // rows of RGB and gray images are not 4 byte aligned
+
+	// blocks of at most half the ring, so one can be filled while the GPU reads the other
+	size_t rowBytes = (size_t)upload.width * upload.channels;
+	int blockRows = (int)std::max(_ring.getSize() / 2 / rowBytes, (size_t)1);
+	bool uploaded = false;
+	while (upload.nextRow < upload.height)
+	{
+		int rows = std::min(upload.height - upload.nextRow, blockRows);
+		if (budget < (size_t)rows * rowBytes)
+			rows = (int)(budget / rowBytes);
+		if (rows == 0)
+		{
+			// a single row larger than the whole budget still has to go at some point
+			if (uploaded || budget == 0)
+				break;
+			rows = 1;
+		}
+
+		const unsigned char* pixels = upload.pixels + (size_t)upload.nextRow * rowBytes;
+		size_t offset;
+		bool staged = _ring.stage(pixels, (size_t)rows * rowBytes, offset, wait);
+		if (!staged && !wait && rowBytes <= _ring.getSize())
+			break; // the GPU still reads the ring, next frame
+
+		// rows too long for the ring, or no ring at all, go from client memory
+		if (!staged)
+			_ring.unbind();
+		const void* source = staged ? (const void*)offset : pixels;
+		if (target == GL_TEXTURE_2D_ARRAY)
+			glTexSubImage3D(target, 0, upload.x, upload.y + upload.nextRow, upload.layer, upload.width, rows, 1, FORMATS[upload.channels - 1], GL_UNSIGNED_BYTE, source);
+		else
+			glTexSubImage2D(target, 0, upload.x, upload.y + upload.nextRow, upload.width, rows, FORMATS[upload.channels - 1], GL_UNSIGNED_BYTE, source);
+		if (staged)
+			_ring.fence();
+		upload.nextRow += rows;
+		budget -= std::min(budget, (size_t)rows * rowBytes);
+		uploaded = true;
+	}
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+	return upload.nextRow == upload.height;
+}
+
+// a KTX / DDS file is a whole texture already, loaded at once on this thread
+TextureManager::Entry* TextureManager::loadContainer(const std::string& path)
+{
+	TRACE_ZONE("load texture container");
+	_ring.unbind();
+	GLenum target = GL_TEXTURE_2D;
+	GLuint id = lowerExtension(path) == "dds" ? loadDDS(path.c_str(), &target) : loadKTX(path.c_str(), &target);
+	if (id == 0)
+	{
+		std::cout << "Failed to load texture: " << path << std::endl;
+		return nullptr;
+	}
+
+	Entry* entry = new Entry();
+	entry->id = id;
+	entry->target = target;
+	entry->ready = true;
+	entry->references = 0;
+	GLenum level = target == GL_TEXTURE_CUBE_MAP ? GL_TEXTURE_CUBE_MAP_POSITIVE_X : target;
+	glGetTexLevelParameteriv(level, 0, GL_TEXTURE_WIDTH, &entry->width);
+	glGetTexLevelParameteriv(level, 0, GL_TEXTURE_HEIGHT, &entry->height);
+	entry->bytes = fileSize(path); // the levels and a small header
+	// shared by path only, hashing the contents would read the whole file
+	entry->hash = hashBytes(std::vector<unsigned char>(path.begin(), path.end()));
+	entry->upload = nullptr;
+	entry->sharedWith = nullptr;
+	entry->paths.push_back(path);
+	_bytes += entry->bytes;
+	_byPath[path] = entry;
+	_byHash[entry->hash] = entry;
+	return entry;
+}
+
+// a texture with the same bytes as a decoded streamed image, loaded before or still being streamed in
+TextureManager::Entry* TextureManager::findSameImage(const Upload& upload) const
+{
+	std::map<uint64_t, Entry*>::const_iterator loaded = _byHash.find(upload.hash);
+	if (loaded != _byHash.end() && loaded->second->target == GL_TEXTURE_2D)
+		return loaded->second;
+	for (size_t i = 0; i < _streaming.size(); i++)
+	{
+		const Upload& other = *_streaming[i];
+		if (&other != &upload && other.decoded.load(std::memory_order_acquire) && other.hash == upload.hash
+			&& other.entry != nullptr && other.entry->id != 0)
+			return other.entry;
+	}
+	return nullptr;
+}
+
+// builds the mip chain of a texture whose level 0 is complete, the handles return it from then on
+void TextureManager::finish(Entry* entry)
+{
+	_ring.unbind();
+	GLStateCache::get().bindTexture(0, entry->target, entry->id);
+	glGenerateMipmap(entry->target);
+	entry->ready = true;
+}
+
+void TextureManager::decodeJob(Job* /*job*/, const void* data)
+{
+	Upload* upload;
+	memcpy(&upload, data, sizeof(upload));
+	if (readFile(upload->path, upload->file))
+	{
+		upload->hash = hashBytes(upload->file);
+		decode(upload->file, upload->pixels, upload->width, upload->height, upload->channels);
+	}
+	upload->decoded.store(true, std::memory_order_release);
+}
+
+void TextureManager::addReference(Entry* entry)
+{
+	entry->references++;
+}
+
+void TextureManager::removeReference(Entry* entry)
+{
+	if (--entry->references > 0)
+		return;
+	if (entry->sharedWith != nullptr)
+		removeReference(entry->sharedWith);
+	// a streamed image still decoding is dropped once the worker is done with it
+	if (entry->upload != nullptr)
+		entry->upload->entry = nullptr;
+	for (size_t i = 0; i < entry->paths.size(); i++)
+		_byPath.erase(entry->paths[i]);
+	std::map<uint64_t, Entry*>::iterator hashed = _byHash.find(entry->hash);
+	if (hashed != _byHash.end() && hashed->second == entry)
+		_byHash.erase(hashed);
+	_bytes -= entry->bytes;
+	if (entry->id != 0)
+		GLStateCache::get().deleteTexture(entry->id);
+	delete entry;
+}
@@ -0,0 +1,138 @@
+#pragma once
+
+// STL
+#include <vector>
+#include <string>
+#include <map>
+#include <cstdint>
+#include <cstddef>
+
+// Project
+#include "pixelUploadRing.h"
+#include "texturePacker.h"
+
+class TextureManager;
+struct Job;
+
+/**
+* Counted reference to a texture of the TextureManager; copies share the texture, which is
+* deleted when its last handle goes away. Handles are created and dropped on the GL thread.
+*/
+class TextureHandle
+{
+public:
+	TextureHandle();
+	TextureHandle(const TextureHandle& other);
+	TextureHandle& operator=(const TextureHandle& other);
+	~TextureHandle();
+
+	/** \brief  Drops the reference, the handle is empty afterwards. */
+	void reset();
+
+	/** \brief  Gets the GL texture, 0 for an empty handle, an image that failed to load or one still loading. */
+	unsigned int id() const;
+
+	/** \brief  True once the texture has all of its pixels. */
+	bool isReady() const;
+
+	int getWidth() const;
+	int getHeight() const;
+
+	struct Entry; // the texture and its reference count, kept by the manager
+
+private:
+	friend class TextureManager;
+
+	explicit TextureHandle(Entry* entry);
+	const Entry* texture() const; // the entry with the texture, which is another one for a shared streamed image
+
+	Entry* _entry;
+};
+
+/**
+* Loads image files into GL textures once. Textures are shared by path, and by the hash of
+* the file's bytes, so two paths to the same image share one texture too. A batch of files
+* is read and decoded in parallel on the job system's workers; only the upload happens on
+* the calling thread, so a batch takes about as long as its slowest image. Textures get
+* immutable storage (glTexStorage2D) with a full mip chain where the context has it, and
+* keep the image's channel count: gray images are swizzled to gray RGB.
+*
+* Pixels reach the textures through a ring of pixel unpack buffer memory, row blocks at a
+* time. load() waits until every texture is complete. loadAsync() returns right away and
+* update(), once per frame, uploads at most a budget of bytes of what the workers decoded,
+* so textures streamed in while the scene is shown do not stall a frame; a streamed image is
+* matched by hash once decoded, and a copy of another texture shares it instead of uploading.
+* loadArray() fills the texture arrays the TexturePacker laid out, image by image through the
+* same ring.
+*
+* KTX and DDS files (see TextureCooker) are not decoded: loadKTX() / loadDDS() upload the mip
+* levels they store straight from the mapped file, so they cost no glGenerateMipmap. Both
+* load() and loadAsync() finish them right away.
+*/
+class TextureManager
+{
+public:
+	static const size_t UPLOAD_BUDGET = 4 * 1024 * 1024; // bytes of pixels per update()
+
+	/** \brief  Gets the manager. Its functions are for the GL thread only. */
+	static TextureManager& get();
+
+	/** \brief  Loads a batch of images, handles[i] refers to paths[i]. Failed images give empty handles. */
+	void load(const std::vector<std::string>& paths, std::vector<TextureHandle>& handles);
+
+	/** \brief  Loads one image. */
+	TextureHandle load(const std::string& path);
+
+	/** \brief  Loads images into one GL_TEXTURE_2D_ARRAY laid out by TexturePacker::pack(), waiting like load().
+	*   \param paths       Image of each placement
+	*   \param placements  Where each image goes; images that fail or no longer match theirs leave it empty
+	*/
+	TextureHandle loadArray(const TexturePackArray& array, const std::vector<std::string>& paths,
+		const std::vector<TexturePackPlacement>& placements);
+
+	/** \brief  Starts loading images in the background. The handles' id() is 0 until update() uploaded them. */
+	void loadAsync(const std::vector<std::string>& paths, std::vector<TextureHandle>& handles);
+
+	/** \brief  Uploads background loads that finished decoding, up to budgetBytes of pixels. Call once per frame. */
+	void update(size_t budgetBytes = UPLOAD_BUDGET);
+
+	/** \brief  Waits for all background loads and uploads them completely, for when every texture is needed now. */
+	void flush();
+
+	/** \brief  Gets the number of background loads not uploaded completely yet. */
+	size_t getLoadingCount() const;
+
+	/** \brief  Gets the number of textures alive. */
+	size_t getTextureCount() const;
+
+	/** \brief  Gets the bytes of all textures alive, mip chains included. */
+	size_t getTextureBytes() const;
+
+private:
+	friend class TextureHandle;
+	typedef TextureHandle::Entry Entry;
+	struct Upload; // an image on its way from the file into a texture
+
+	std::map<std::string, Entry*> _byPath;
+	std::map<uint64_t, Entry*> _byHash;
+	size_t _bytes;
+	PixelUploadRing _ring;
+	std::vector<Upload*> _streaming; // loadAsync() images, oldest first
+
+	Upload* createUpload(const std::string& path);
+	Entry* createEntry(Upload& upload);
+	Entry* loadContainer(const std::string& path);
+	Entry* findSameImage(const Upload& upload) const;
+	bool uploadRows(Upload& upload, size_t& budget, bool wait);
+	void finish(Entry* entry);
+	static void decodeJob(Job* job, const void* data);
+
+	TextureManager();
+	~TextureManager();
+
+	void addReference(Entry* entry);
+	void removeReference(Entry* entry);
+
+	TextureManager(const TextureManager&);
+	TextureManager& operator=(const TextureManager&);
+};
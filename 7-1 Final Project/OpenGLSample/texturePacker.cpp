@@ -0,0 +1,156 @@
+// STL
+#include <algorithm>
+
+// Project
+#include "texturePacker.h"
+
+namespace {
+
+	int alignUp(int value, int alignment)
+	{
+		return (value + alignment - 1) / alignment * alignment;
+	}
+
+	// square power of two side that would hold the area, so a few small images do not get a huge layer
+	int atlasWidth(const std::vector<int>& cellWidths, const std::vector<int>& cellHeights)
+	{
+		long long area = 0;
+		int widest = 0;
+		for (size_t i = 0; i < cellWidths.size(); i++)
+		{
+			area += (long long)cellWidths[i] * cellHeights[i];
+			widest = std::max(widest, cellWidths[i]);
+		}
+		int width = TexturePacker::ATLAS_GUTTER;
+		while (width < TexturePacker::ATLAS_MAX_SIZE && (long long)width * width < area)
+			width *= 2;
+		return std::max(width, widest);
+	}
+
+	void packAtlas(const std::vector<TexturePackImage>& images, const std::vector<int>& small,
+		std::vector<TexturePackArray>& arrays, std::vector<TexturePackPlacement>& placements)
+	{
+		const int gutter = TexturePacker::ATLAS_GUTTER;
+		std::vector<int> cellWidths(small.size()), cellHeights(small.size());
+		for (size_t i = 0; i < small.size(); i++)
+		{
+			cellWidths[i] = alignUp(images[small[i]].width + 2 * gutter, gutter);
+			cellHeights[i] = alignUp(images[small[i]].height + 2 * gutter, gutter);
+		}
+
+		// shelves, tallest images first so every shelf wastes little above its images
+		std::vector<size_t> order(small.size());
+		for (size_t i = 0; i < order.size(); i++)
+			order[i] = i;
+		std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) { return cellHeights[a] > cellHeights[b]; });
+
+		TexturePackArray atlas;
+		atlas.width = atlasWidth(cellWidths, cellHeights);
+		atlas.height = 0;
+		atlas.channels = images[small[0]].channels;
+		atlas.layers = 1;
+		atlas.levels = TexturePacker::ATLAS_LEVELS;
+		atlas.gutter = gutter;
+		int index = (int)arrays.size();
+
+		int x = 0, y = 0, shelfHeight = 0;
+		for (size_t i = 0; i < order.size(); i++)
+		{
+			size_t cell = order[i];
+			if (x + cellWidths[cell] > atlas.width)
+			{
+				x = 0;
+				y += shelfHeight;
+				shelfHeight = 0;
+			}
+			if (y + cellHeights[cell] > TexturePacker::ATLAS_MAX_SIZE)
+			{
+				if (atlas.layers == TexturePacker::MAX_LAYERS)
+					break; // the rest keep their own textures
+				atlas.layers++;
+				x = y = 0;
+				shelfHeight = 0;
+			}
+			TexturePackPlacement& placement = placements[small[cell]];
+			placement.array = index;
+			placement.layer = atlas.layers - 1;
+			placement.x = x + gutter;
+			placement.y = y + gutter;
+			x += cellWidths[cell];
+			shelfHeight = std::max(shelfHeight, cellHeights[cell]);
+			atlas.height = std::max(atlas.height, y + shelfHeight);
+		}
+		arrays.push_back(atlas);
+	}
+
+} // namespace
+
+void TexturePacker::pack(const std::vector<TexturePackImage>& images, std::vector<TexturePackArray>& arrays,
+	std::vector<TexturePackPlacement>& placements)
+{
+	arrays.clear();
+	placements.resize(images.size());
+	for (size_t i = 0; i < images.size(); i++)
+	{
+		TexturePackPlacement& placement = placements[i];
+		placement.array = -1;
+		placement.layer = placement.x = placement.y = 0;
+		placement.width = images[i].width;
+		placement.height = images[i].height;
+	}
+
+	// images of equal size share an array, a layer each; they keep their full mip chain and wrapping
+	for (size_t i = 0; i < images.size(); i++)
+	{
+		const TexturePackImage& image = images[i];
+		if (placements[i].array >= 0 || image.width <= 0 || image.height <= 0)
+			continue;
+		std::vector<int> same;
+		for (size_t j = i; j < images.size(); j++)
+		{
+			if (placements[j].array < 0 && images[j].width == image.width && images[j].height == image.height && images[j].channels == image.channels)
+				same.push_back((int)j);
+		}
+		for (size_t first = 0; same.size() - first >= 2; first += MAX_LAYERS)
+		{
+			TexturePackArray array;
+			array.width = image.width;
+			array.height = image.height;
+			array.channels = image.channels;
+			array.layers = (int)std::min(same.size() - first, (size_t)MAX_LAYERS);
+			array.levels = fullMipLevels(image.width, image.height);
+			array.gutter = 0;
+			for (int layer = 0; layer < array.layers; layer++)
+			{
+				placements[same[first + layer]].array = (int)arrays.size();
+				placements[same[first + layer]].layer = layer;
+			}
+			arrays.push_back(array);
+			if (same.size() - first <= (size_t)MAX_LAYERS)
+				break;
+		}
+	}
+
+	// small images left over go into atlases, one per channel count
+	for (int channels = 1; channels <= 4; channels++)
+	{
+		std::vector<int> small;
+		for (size_t i = 0; i < images.size(); i++)
+		{
+			const TexturePackImage& image = images[i];
+			if (placements[i].array < 0 && image.channels == channels && image.width > 0 && image.height > 0
+				&& image.width <= ATLAS_MAX_IMAGE && image.height <= ATLAS_MAX_IMAGE)
+				small.push_back((int)i);
+		}
+		if (small.size() >= 2)
+			packAtlas(images, small, arrays, placements);
+	}
+}
+
+int TexturePacker::fullMipLevels(int width, int height)
+{
+	int levels = 1;
+	while ((std::max(width, height) >> levels) > 0)
+		levels++;
+	return levels;
+}
@@ -0,0 +1,60 @@
+#pragma once
+
+// STL
+#include <vector>
+
+/**
+* Size and channel count of one image, e.g. from stbi_info().
+*/
+struct TexturePackImage
+{
+	int width, height, channels;
+};
+
+/**
+* One GL_TEXTURE_2D_ARRAY the packer decided on. Layers of a same size array hold one
+* image each; layers of an atlas hold many small images, each surrounded by a gutter of
+* its own edge pixels so filtering and the few mip levels it gets do not bleed.
+*/
+struct TexturePackArray
+{
+	int width, height, channels;
+	int layers;
+	int levels; // mip levels to allocate
+	int gutter; // 0 for same size arrays
+};
+
+/**
+* Where an image ended up. x, y are the lower left corner of the image itself (inside the
+* gutter), in pixels of the layer with rows bottom up like OpenGL's.
+*/
+struct TexturePackPlacement
+{
+	int array; // into the arrays, -1 when the image stays a texture of its own
+	int layer;
+	int x, y;
+	int width, height;
+};
+
+/**
+* Groups the textures of a scene into texture arrays at asset time, so objects with
+* different textures can share one binding and one instanced draw. Images of the same size
+* and channel count become layers of one array; small images that are left are packed into
+* atlas layers. Everything else is left alone.
+*/
+class TexturePacker
+{
+public:
+	static const int MAX_LAYERS = 256; // GL_MAX_ARRAY_TEXTURE_LAYERS is at least 256 in GL 3.3
+	static const int ATLAS_MAX_IMAGE = 512; // images up to this size on both sides go into atlases
+	static const int ATLAS_MAX_SIZE = 2048;
+	static const int ATLAS_GUTTER = 8; // also the cell alignment, which keeps the first mip levels apart
+	static const int ATLAS_LEVELS = 4; // down to a one pixel gutter
+
+	/** \brief  Packs the images. placements[i] belongs to images[i]; an image of size 0 is never packed. */
+	static void pack(const std::vector<TexturePackImage>& images, std::vector<TexturePackArray>& arrays,
+		std::vector<TexturePackPlacement>& placements);
+
+	/** \brief  Gets the mip levels of a full chain for the size. */
+	static int fullMipLevels(int width, int height);
+};
@@ -1,148 +1,149 @@
-// STL
-#include <iostream>
-#include <cstring>
-
-// Project
-#include "common/vertexBufferObject.h"
-
-void VertexBufferObject::createVBO(size_t reserveSizeBytes)
-{
-    if (_isBufferCreated)
-    {
-        std::cerr << "This buffer is already created! You need to delete it before re-creating it!" << std::endl;
-        return;
-    }
-
-    glGenBuffers(1, &_bufferID);
-    _rawData.reserve(reserveSizeBytes > 0 ? reserveSizeBytes : 1024);
-
-    //std::cout << "Created vertex buffer object with ID " << _bufferID << " and initial reserved size " << _rawData.capacity() << " bytes" << std::endl;
-    _isBufferCreated = true;
-}
-
-//void VertexBufferObject::createVBO(uint32_t reserveSizeBytes)
-//{
-//}
-
-void VertexBufferObject::bindVBO(GLenum bufferType)
-{
-    if (!_isBufferCreated)
-    {
-        std::cerr << "This buffer is not created yet! You cannot bind it before you create it!" << std::endl;
-        return;
-    }
-
-    _bufferType = bufferType;
-    glBindBuffer(_bufferType, _bufferID);
-}
-
-//void VertexBufferObject::addRawData(const void* ptrData, uint32_t dataSizeBytes, int repeat)
-//{
-//}
-
-void VertexBufferObject::addRawData(const void* ptrData, size_t dataSize, int repeat)
-{
-    const auto bytesToAdd = dataSize * repeat;
-    const auto requiredCapacity = _bytesAdded + bytesToAdd;
-    if (requiredCapacity > _rawData.capacity())
-    {
-        auto newCapacity = _rawData.capacity() * 2;
-        while (newCapacity < requiredCapacity) {
-            newCapacity *= 2;
-        }
-
-        std::vector<unsigned char> newRawData;
-        newRawData.reserve(newCapacity);
-        memcpy(newRawData.data(), _rawData.data(), _bytesAdded);
-        _rawData = std::move(newRawData);
-    }
-
-    for (int i = 0; i < repeat; i++)
-    {
-        memcpy(_rawData.data() + _bytesAdded, ptrData, dataSize);
-        _bytesAdded += dataSize;
-    }
-}
-
-void* VertexBufferObject::getRawDataPointer()
-{
-    return _rawData.data();
-}
-
-void VertexBufferObject::uploadDataToGPU(GLenum usageHint)
-{
-    if (!_isBufferCreated)
-    {
-        std::cerr << "This buffer is not created yet! Call createVBO before uploading data to GPU!" << std::endl;
-        return;
-    }
-
-    glBufferData(_bufferType, _bytesAdded, _rawData.data(), usageHint);
-    _isDataUploaded = true;
-    _uploadedDataSize = _bytesAdded;
-    _bytesAdded = 0;
-}
-
-void* VertexBufferObject::mapBufferToMemory(GLenum usageHint) const
-{
-    if (!_isDataUploaded) {
-        return nullptr;
-    }
-
-    return glMapBuffer(_bufferType, usageHint);
-}
-
-void* VertexBufferObject::mapSubBufferToMemory(GLenum usageHint, size_t offset, size_t length) const
-{
-    if (!_isDataUploaded) {
-        return nullptr;
-    }
-
-    return glMapBufferRange(_bufferType, offset, length, usageHint);
-}
-
-void VertexBufferObject::unmapBuffer() const
-{
-    glUnmapBuffer(_bufferType);
-}
-
-GLuint VertexBufferObject::getBufferID() const
-{
-    return _bufferID;
-}
-
-void* VertexBufferObject::mapBufferToMemory(GLenum usageHint)
-{
-    return nullptr;
-}
-
-void* VertexBufferObject::mapSubBufferToMemory(GLenum usageHint, uint32_t offset, uint32_t length)
-{
-    return nullptr;
-}
-
-void VertexBufferObject::unmapBuffer()
-{
-}
-
-GLuint VertexBufferObject::getBufferID()
-{
-    return GLuint();
-}
-
-size_t VertexBufferObject::getBufferSize()
-{
-    return _isDataUploaded ? _uploadedDataSize : _bytesAdded;
-}
-
-void VertexBufferObject::deleteVBO()
-{
-    if (!_isBufferCreated) {
-        return;
-    }
-
-    //std::cout << "Deleting vertex buffer object with ID " << _bufferID << "..." << std::endl;
-    glDeleteBuffers(1, &_bufferID);
-    _isDataUploaded = false;
-    _isBufferCreated = false;
-}
+// STL
+#include <iostream>
+#include <cstring>
+
+// Project
+#include "common/vertexBufferObject.h"
+#include "glStateCache.h"
+
+void VertexBufferObject::createVBO(size_t reserveSizeBytes)
+{
+    if (_isBufferCreated)
+    {
+        std::cerr << "This buffer is already created! You need to delete it before re-creating it!" << std::endl;
+        return;
+    }
+
+    glGenBuffers(1, &_bufferID);
+    _rawData.reserve(reserveSizeBytes > 0 ? reserveSizeBytes : 1024);
+
+    //std::cout << "Created vertex buffer object with ID " << _bufferID << " and initial reserved size " << _rawData.capacity() << " bytes" << std::endl;
+    _isBufferCreated = true;
+}
+
+//void VertexBufferObject::createVBO(uint32_t reserveSizeBytes)
+//{
+//}
+
+void VertexBufferObject::bindVBO(GLenum bufferType)
+{
+    if (!_isBufferCreated)
+    {
+        std::cerr << "This buffer is not created yet! You cannot bind it before you create it!" << std::endl;
+        return;
+    }
+
+    _bufferType = bufferType;
+    GLStateCache::get().bindBuffer(_bufferType, _bufferID);
+}
+
+//void VertexBufferObject::addRawData(const void* ptrData, uint32_t dataSizeBytes, int repeat)
+//{
+//}
+
+void VertexBufferObject::addRawData(const void* ptrData, size_t dataSize, int repeat)
+{
+    const auto bytesToAdd = dataSize * repeat;
+    const auto requiredCapacity = _bytesAdded + bytesToAdd;
+    if (requiredCapacity > _rawData.capacity())
+    {
+        auto newCapacity = _rawData.capacity() * 2;
+        while (newCapacity < requiredCapacity) {
+            newCapacity *= 2;
+        }
+
+        std::vector<unsigned char> newRawData;
+        newRawData.reserve(newCapacity);
+        memcpy(newRawData.data(), _rawData.data(), _bytesAdded);
+        _rawData = std::move(newRawData);
+    }
+
+    for (int i = 0; i < repeat; i++)
+    {
+        memcpy(_rawData.data() + _bytesAdded, ptrData, dataSize);
+        _bytesAdded += dataSize;
+    }
+}
+
+void* VertexBufferObject::getRawDataPointer()
+{
+    return _rawData.data();
+}
+
+void VertexBufferObject::uploadDataToGPU(GLenum usageHint)
+{
+    if (!_isBufferCreated)
+    {
+        std::cerr << "This buffer is not created yet! Call createVBO before uploading data to GPU!" << std::endl;
+        return;
+    }
+
+    glBufferData(_bufferType, _bytesAdded, _rawData.data(), usageHint);
+    _isDataUploaded = true;
+    _uploadedDataSize = _bytesAdded;
+    _bytesAdded = 0;
+}
+
+void* VertexBufferObject::mapBufferToMemory(GLenum usageHint) const
+{
+    if (!_isDataUploaded) {
+        return nullptr;
+    }
+
+    return glMapBuffer(_bufferType, usageHint);
+}
+
+void* VertexBufferObject::mapSubBufferToMemory(GLenum usageHint, size_t offset, size_t length) const
+{
+    if (!_isDataUploaded) {
+        return nullptr;
+    }
+
+    return glMapBufferRange(_bufferType, offset, length, usageHint);
+}
+
+void VertexBufferObject::unmapBuffer() const
+{
+    glUnmapBuffer(_bufferType);
+}
+
+GLuint VertexBufferObject::getBufferID() const
+{
+    return _bufferID;
+}
+
+void* VertexBufferObject::mapBufferToMemory(GLenum usageHint)
+{
+    return nullptr;
+}
+
+void* VertexBufferObject::mapSubBufferToMemory(GLenum usageHint, uint32_t offset, uint32_t length)
+{
+    return nullptr;
+}
+
+void VertexBufferObject::unmapBuffer()
+{
+}
+
+GLuint VertexBufferObject::getBufferID()
+{
+    return GLuint();
+}
+
+size_t VertexBufferObject::getBufferSize()
+{
+    return _isDataUploaded ? _uploadedDataSize : _bytesAdded;
+}
+
+void VertexBufferObject::deleteVBO()
+{
+    if (!_isBufferCreated) {
+        return;
+    }
+
+    //std::cout << "Deleting vertex buffer object with ID " << _bufferID << "..." << std::endl;
+    GLStateCache::get().deleteBuffer(_bufferID);
+    _isDataUploaded = false;
+    _isBufferCreated = false;
+}